@@ -0,0 +1,311 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <deque>
+#include <vector>
+#include "captured_payloads.h"
+#include "../src/helpers/helpers.h"
+#include "../src/logger/logger.h"
+#include "../src/webview_protocol/command_handler/command_handler.h"
+#include "../src/webview_protocol/event_emitter/event_emitter.h"
+#include "../src/webview_protocol/transport_constants.h"
+#ifdef STREMATO_HAS_MPV
+#include "../src/mpv/mpv_manager.h"
+#endif
+#ifdef STREMATO_BENCH_DISCORD
+#include <discord-rpc.hpp>
+#include "serialization.hpp"
+#endif
+
+using namespace WebViewProtocol;
+
+// Accepts every post on the calling thread, so emits measure serialization,
+// queueing and the flush without any WebView2 cost.
+class DiscardTransport : public EventTransport
+{
+public:
+    bool IsDispatchThread() const override { return true; }
+    void RequestFlush() override {}
+    void Post(std::string message) override { benchmark::DoNotOptimize(message.data()); }
+};
+
+// Installs a DiscardTransport for the lifetime of a benchmark.
+class ScopedTransport
+{
+public:
+    ScopedTransport() { EventEmitter::SetTransport(std::make_shared<DiscardTransport>()); }
+    ~ScopedTransport() { EventEmitter::SetTransport(nullptr); }
+};
+
+static void RegisterNoopHandlers(CommandHandler& handler)
+{
+    auto noop = [](const json& payload, const std::optional<std::string>&) { benchmark::DoNotOptimize(&payload); };
+    handler.RegisterCommand(Commands::PLAY, [](const json& payload, const std::optional<std::string>&) {
+        benchmark::DoNotOptimize(payload.get<PlayPayload>());
+    });
+    handler.RegisterCommand(Commands::SEEK, [](const json& payload, const std::optional<std::string>&) {
+        benchmark::DoNotOptimize(payload.get<SeekPayload>());
+    });
+    handler.RegisterCommand(Commands::SET_PROPERTY, [](const json& payload, const std::optional<std::string>&) {
+        benchmark::DoNotOptimize(payload.get<SetPropertyPayload>());
+    });
+    handler.RegisterCommand(Commands::SET_RPC, noop);
+    handler.RegisterRequest(Commands::GET_SETTING, [](const json& /*payload*/, const RequestHandle& request) {
+        request->Resolve(50);
+    });
+}
+
+static void BM_HandleCommand(benchmark::State& state, const char* message)
+{
+    ScopedTransport transport;
+    CommandHandler handler;
+    RegisterNoopHandlers(handler);
+    const std::wstring wide = Utf8ToWstring(message);
+    for (auto _ : state) {
+        handler.HandleCommand(wide);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(strlen(message)));
+}
+BENCHMARK_CAPTURE(BM_HandleCommand, play, CapturedPayloads::PLAY_COMMAND);
+BENCHMARK_CAPTURE(BM_HandleCommand, seek, CapturedPayloads::SEEK_COMMAND);
+BENCHMARK_CAPTURE(BM_HandleCommand, set_property, CapturedPayloads::SET_PROPERTY_COMMAND);
+BENCHMARK_CAPTURE(BM_HandleCommand, set_rpc, CapturedPayloads::SET_RPC_COMMAND);
+BENCHMARK_CAPTURE(BM_HandleCommand, get_setting_request, CapturedPayloads::GET_SETTING_REQUEST);
+
+// Stands in for a handler blocked on IPC or disk.
+static void Spin(std::chrono::microseconds duration)
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+// Floods the handler the way a busy frontend does: seeks run inline, presence
+// updates are serialized on the pool and other slow commands run on any worker.
+// ui_share is the part of the flood's wall time, until the pool has drained,
+// that the UI thread spent inside HandleCommand.
+static void BM_CommandFlood(benchmark::State& state)
+{
+    constexpr int ROUNDS = 100;
+    const auto work = std::chrono::microseconds(state.range(0));
+    ScopedTransport transport;
+    CommandHandler handler;
+    std::atomic<int> pending{0};
+
+    CommandOptions serialized;
+    serialized.affinity = CommandAffinity::Serialized;
+    serialized.serialKey = "discord";
+    CommandOptions anyThread;
+    anyThread.affinity = CommandAffinity::AnyThread;
+    handler.RegisterCommand(Commands::SEEK, [](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        benchmark::DoNotOptimize(payload.get<SeekPayload>());
+    });
+    handler.RegisterCommand(Commands::SET_RPC, [&](const json& /*payload*/, const std::optional<std::string>& /*messageId*/) {
+        Spin(work);
+        pending.fetch_sub(1);
+    }, serialized);
+    handler.RegisterCommand("flood-work", [&](const json& /*payload*/, const std::optional<std::string>& /*messageId*/) {
+        Spin(work);
+        pending.fetch_sub(1);
+    }, anyThread);
+
+    const std::wstring seek = Utf8ToWstring(CapturedPayloads::SEEK_COMMAND);
+    const std::wstring presence = Utf8ToWstring(CapturedPayloads::SET_RPC_COMMAND);
+    const std::wstring slow = Utf8ToWstring(json{{"command", "flood-work"}, {"payload", json::object()}}.dump());
+
+    std::chrono::nanoseconds uiTime{0}, wallTime{0};
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        pending.fetch_add(2 * ROUNDS);
+        for (int i = 0; i < ROUNDS; i++) {
+            for (const std::wstring* message : { &seek, &presence, &slow }) {
+                const auto before = std::chrono::steady_clock::now();
+                handler.HandleCommand(*message);
+                uiTime += std::chrono::steady_clock::now() - before;
+            }
+        }
+        while (pending.load() > 0) std::this_thread::yield();
+        wallTime += std::chrono::steady_clock::now() - start;
+    }
+
+    const json stats = handler.GetStats();
+    state.SetItemsProcessed(state.iterations() * 3 * ROUNDS);
+    state.counters["ui_share"] = wallTime.count() > 0 ? static_cast<double>(uiTime.count()) / wallTime.count() : 0.0;
+    state.counters["ui_max_us"] = stats["uiThread"]["maxUs"].get<double>();
+    state.counters["steals"] = stats["steals"].get<double>();
+}
+BENCHMARK(BM_CommandFlood)->Arg(50)->Arg(500)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_EmitPropertyChange_TimePos(benchmark::State& state)
+{
+    ScopedTransport transport;
+    const json value = CapturedPayloads::TIME_POS;
+    for (auto _ : state) {
+        EventEmitter::emitPropertyChange("time-pos", value);
+    }
+}
+BENCHMARK(BM_EmitPropertyChange_TimePos);
+
+static void BM_EmitPropertyChange_TrackList(benchmark::State& state)
+{
+    ScopedTransport transport;
+    const json value = json::parse(CapturedPayloads::TRACK_LIST);
+    for (auto _ : state) {
+        EventEmitter::emitPropertyChange("track-list", value);
+    }
+}
+BENCHMARK(BM_EmitPropertyChange_TrackList);
+
+#ifdef STREMATO_HAS_MPV
+// Builds the mpv_node tree mpv hands to property observers, owning all storage.
+class NodeTree
+{
+public:
+    explicit NodeTree(const json& value) { Build(value, m_root); }
+    const mpv_node* Root() const { return &m_root; }
+
+private:
+    void Build(const json& value, mpv_node& node)
+    {
+        if (value.is_string()) {
+            node.format = MPV_FORMAT_STRING;
+            node.u.string = m_strings.emplace_back(value.get<std::string>()).data();
+        } else if (value.is_boolean()) {
+            node.format = MPV_FORMAT_FLAG;
+            node.u.flag = value.get<bool>();
+        } else if (value.is_number_integer()) {
+            node.format = MPV_FORMAT_INT64;
+            node.u.int64 = value.get<int64_t>();
+        } else if (value.is_number()) {
+            node.format = MPV_FORMAT_DOUBLE;
+            node.u.double_ = value.get<double>();
+        } else if (value.is_array() || value.is_object()) {
+            auto& values = m_values.emplace_back(value.size());
+            auto& list = m_lists.emplace_back();
+            list.num = static_cast<int>(value.size());
+            list.values = values.data();
+            list.keys = nullptr;
+            if (value.is_object()) {
+                auto& keys = m_keys.emplace_back();
+                for (const auto& [key, item] : value.items()) keys.push_back(m_strings.emplace_back(key).data());
+                list.keys = keys.data();
+            }
+            int i = 0;
+            for (const auto& item : value) Build(item, values[i++]);
+            node.format = value.is_array() ? MPV_FORMAT_NODE_ARRAY : MPV_FORMAT_NODE_MAP;
+            node.u.list = &list;
+        } else {
+            node.format = MPV_FORMAT_NONE;
+        }
+    }
+
+    mpv_node m_root{};
+    std::deque<std::string> m_strings;
+    std::deque<std::vector<mpv_node>> m_values;
+    std::deque<std::vector<char*>> m_keys;
+    std::deque<mpv_node_list> m_lists;
+};
+
+static void BM_MpvNodeToJson(benchmark::State& state, const char* captured)
+{
+    NodeTree tree(json::parse(captured));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MPVManager::MpvNodeToJson(tree.Root()));
+    }
+}
+BENCHMARK_CAPTURE(BM_MpvNodeToJson, track_list, CapturedPayloads::TRACK_LIST);
+BENCHMARK_CAPTURE(BM_MpvNodeToJson, chapter_list, CapturedPayloads::CHAPTER_LIST);
+
+static void BM_MpvNodeToJson_Double(benchmark::State& state)
+{
+    mpv_node node{};
+    node.format = MPV_FORMAT_DOUBLE;
+    node.u.double_ = CapturedPayloads::TIME_POS;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MPVManager::MpvNodeToJson(&node));
+    }
+}
+BENCHMARK(BM_MpvNodeToJson_Double);
+#endif
+
+static void BM_WStringToUtf8(benchmark::State& state)
+{
+    const std::wstring wide = Utf8ToWstring(CapturedPayloads::MEDIA_TITLE);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(WStringToUtf8(wide));
+    }
+}
+BENCHMARK(BM_WStringToUtf8);
+
+static void BM_Utf8ToWstring(benchmark::State& state)
+{
+    const std::string utf8 = CapturedPayloads::MEDIA_TITLE;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utf8ToWstring(utf8));
+    }
+}
+BENCHMARK(BM_Utf8ToWstring);
+
+static std::string ExtensionCss()
+{
+    std::string css;
+    for (int i = 0; i < CapturedPayloads::EXTENSION_CSS_REPEAT; i++) css += CapturedPayloads::EXTENSION_CSS_BLOCK;
+    return css;
+}
+
+static void BM_Base64Encode(benchmark::State& state)
+{
+    const std::string css = ExtensionCss();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Base64Encode(css));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(css.size()));
+}
+BENCHMARK(BM_Base64Encode);
+
+static void BM_MakeInjectCssScript(benchmark::State& state)
+{
+    const std::string css = ExtensionCss();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MakeInjectCssScript(L"amoled-theme", css));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(css.size()));
+}
+BENCHMARK(BM_MakeInjectCssScript);
+
+static void BM_LoggerFormatMessage(benchmark::State& state)
+{
+    const std::string message = CapturedPayloads::LOG_MESSAGE;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Logger::FormatMessage(LogLevel::INFO, __FILE__, __func__, "MPVManager", message));
+    }
+}
+BENCHMARK(BM_LoggerFormatMessage);
+
+#ifdef STREMATO_BENCH_DISCORD
+static void BM_SerializePresence(benchmark::State& state)
+{
+    discord::Presence presence;
+    presence.setActivityType(discord::ActivityType::Watching)
+        .setDetails("Watching The Expanse")
+        .setState("Triple Point (S3-E5)")
+        .setLargeImageKey("https://images.metahub.space/poster/medium/tt3230854/img")
+        .setLargeImageText("The Expanse")
+        .setSmallImageKey("https://episodes.metahub.space/tt3230854/3/5/w780.jpg")
+        .setSmallImageText("Triple Point")
+        .setStartTimestamp(1699012455)
+        .setEndTimestamp(1699013382)
+        .setButton1("More Details", "https://web.stremio.com/#/detail/series/tt3230854")
+        .setButton2("Watch on Stremato", "stremato://detail/series/tt3230854");
+    std::string buffer;
+    int nonce = 0;
+    for (auto _ : state) {
+        discord::serializePresence(buffer, presence, 4242, nonce++);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_SerializePresence);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,57 @@
+#ifndef CAPTURED_PAYLOADS_H
+#define CAPTURED_PAYLOADS_H
+
+// Bridge traffic captured from a playback session (stream URLs and ids
+// shortened, otherwise verbatim), used as benchmark inputs so numbers track
+// what the app actually moves per message.
+namespace CapturedPayloads {
+
+    // Inbound commands, as posted by the frontend.
+    inline constexpr const char* PLAY_COMMAND =
+        R"json({"command":"play","payload":{"url":"http://127.0.0.1:11470/5b1c8e0f2f3a4d6e9a7b1c2d3e4f5a6b7c8d9e0f/0?tr=udp%3A%2F%2Ftracker.opentrackr.org%3A1337%2Fannounce&tr=udp%3A%2F%2Fopen.stealth.si%3A80%2Fannounce&f=The.Expanse.S03E05.1080p.WEB-DL.DD5.1.H264.mkv","startTime":1312.48}})json";
+
+    inline constexpr const char* SEEK_COMMAND =
+        R"json({"command":"seek","payload":{"time":1877.2513}})json";
+
+    inline constexpr const char* SET_PROPERTY_COMMAND =
+        R"json({"command":"set-property","payload":{"property":"sub-scale","value":"1.15"}})json";
+
+    inline constexpr const char* GET_SETTING_REQUEST =
+        R"json({"command":"get-setting","payload":{"key":"initialVolume"},"messageId":"m-1699012455812-17"})json";
+
+    inline constexpr const char* SET_RPC_COMMAND =
+        R"json({"command":"set-rpc","payload":{"args":["watching","series","The Expanse","3","5","Triple Point","https://episodes.metahub.space/tt3230854/3/5/w780.jpg","https://images.metahub.space/poster/medium/tt3230854/img","1877","2804","0","https://web.stremio.com/#/detail/series/tt3230854","stremato://detail/series/tt3230854"]}})json";
+
+    // property-change values as mpv reports them.
+    inline constexpr const char* TRACK_LIST =
+        R"json([{"id":1,"type":"video","src-id":0,"image":false,"albumart":false,"default":true,"forced":false,"dependent":false,"visual-impaired":false,"hearing-impaired":false,"external":false,"selected":true,"main-selection":0,"ff-index":0,"decoder-desc":"h264 (H.264 / AVC / MPEG-4 AVC / MPEG-4 part 10)","codec":"h264","codec-desc":"H.264 / AVC / MPEG-4 AVC / MPEG-4 part 10","codec-profile":"High","demux-w":1920,"demux-h":1080,"demux-fps":23.976023976023978,"demux-par":1.0},)json"
+        R"json({"id":1,"type":"audio","src-id":1,"title":"English 5.1","lang":"eng","image":false,"albumart":false,"default":true,"forced":false,"dependent":false,"visual-impaired":false,"hearing-impaired":false,"external":false,"selected":true,"main-selection":0,"ff-index":1,"decoder-desc":"ac3 (ATSC A/52A (AC-3))","codec":"ac3","codec-desc":"ATSC A/52A (AC-3)","demux-channel-count":6,"demux-channels":"5.1(side)","demux-samplerate":48000,"demux-bitrate":384000,"audio-channels":6},)json"
+        R"json({"id":1,"type":"sub","src-id":2,"title":"English SDH","lang":"eng","image":false,"albumart":false,"default":false,"forced":false,"dependent":false,"visual-impaired":false,"hearing-impaired":true,"external":false,"selected":false,"ff-index":2,"codec":"subrip","codec-desc":"SubRip subtitle"},)json"
+        R"json({"id":2,"type":"sub","src-id":3,"title":"Español (Latinoamérica)","lang":"spa","image":false,"albumart":false,"default":false,"forced":false,"dependent":false,"visual-impaired":false,"hearing-impaired":false,"external":false,"selected":false,"ff-index":3,"codec":"subrip","codec-desc":"SubRip subtitle"},)json"
+        R"json({"id":3,"type":"sub","src-id":4,"title":"Français","lang":"fre","image":false,"albumart":false,"default":false,"forced":false,"dependent":false,"visual-impaired":false,"hearing-impaired":false,"external":false,"selected":false,"ff-index":4,"codec":"subrip","codec-desc":"SubRip subtitle"}])json";
+
+    inline constexpr const char* CHAPTER_LIST =
+        R"json([{"title":"Recap","time":0.0},{"title":"Intro","time":62.437},{"title":"Episode","time":131.214},{"title":"Credits","time":2741.906}])json";
+
+    inline constexpr double TIME_POS = 1877.2513;
+
+    // Text that crosses the UTF-8/UTF-16 boundary: titles, file names, log lines.
+    inline constexpr const char* MEDIA_TITLE =
+        "Le Fabuleux Destin d'Amélie Poulain (2001) — 1080p BluRay 「アメリ」 Ελληνικοί υπότιτλοι 🎬";
+
+    inline constexpr const char* LOG_MESSAGE =
+        "Property changed: demuxer-cache-state -> {\"bof-cached\":false,\"cache-end\":1912.34,\"eof-cached\":false,\"fw-bytes\":52428800,\"raw-input-rate\":1843200}";
+
+    // A mid-sized extension stylesheet, repeated to the size of typical webmods.
+    inline constexpr const char* EXTENSION_CSS_BLOCK =
+        ":root{--primary-accent-color:#7b5bf5;--secondary-accent-color:#22b365;--overlay-color:rgba(255,255,255,.05)}\n"
+        ".horizontal-nav-bar-container-Y_zvK{background:linear-gradient(180deg,rgba(12,11,17,.95) 0,rgba(12,11,17,0) 100%);backdrop-filter:blur(12px)}\n"
+        ".meta-item-container-Tj0Ib .poster-container-qkw48{border-radius:.75rem;box-shadow:0 .5rem 1.5rem rgba(0,0,0,.35);transition:transform .2s ease}\n"
+        ".meta-item-container-Tj0Ib:hover .poster-container-qkw48{transform:scale(1.04) translateY(-2px)}\n"
+        "/* Ünïcödé in comments is common in community themes — keep it. */\n"
+        ".seek-bar-container-JGGTa .track-gItfW{height:.35rem;border-radius:1rem;background:var(--overlay-color)}\n";
+
+    inline constexpr int EXTENSION_CSS_REPEAT = 24;
+}
+
+#endif // CAPTURED_PAYLOADS_H
@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "../src/mpv/audio_fingerprint.h"
+
+// Audio as the intro detector decodes it: 8 kHz mono s16. Set
+// STREMATO_BENCH_AUDIO to a raw file of that format to measure real audio,
+// e.g. from `ffmpeg -i episode.mkv -t 360 -ac 1 -ar 8000 -f s16le sample.raw`;
+// otherwise a minute of synthetic chords over noise is used.
+static const std::vector<int16_t>& SampleAudio()
+{
+    static const std::vector<int16_t> samples = []() {
+        std::vector<int16_t> audio;
+        if (const char* path = std::getenv("STREMATO_BENCH_AUDIO")) {
+            std::ifstream in(path, std::ios::binary);
+            in.seekg(0, std::ios::end);
+            audio.resize(static_cast<size_t>(in.tellg()) / sizeof(int16_t));
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(audio.data()), static_cast<std::streamsize>(audio.size() * sizeof(int16_t)));
+            if (in && audio.size() >= static_cast<size_t>(AudioFingerprinter::SAMPLE_RATE) * 30) return audio;
+            audio.clear();
+        }
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> note(200, 2000);
+        std::normal_distribution<double> noise(0.0, 1500.0);
+        double frequency[3] = {};
+        for (int n = 0; n < AudioFingerprinter::SAMPLE_RATE * 60; n++) {
+            if (n % (AudioFingerprinter::SAMPLE_RATE / 4) == 0) for (double& f : frequency) f = note(rng);
+            double value = noise(rng);
+            for (double f : frequency) value += 6000.0 * std::sin(2.0 * 3.14159265358979 * f * n / AudioFingerprinter::SAMPLE_RATE);
+            audio.push_back(static_cast<int16_t>((std::max)(-32767.0, (std::min)(32767.0, value))));
+        }
+        return audio;
+    }();
+    return samples;
+}
+
+// IntroDetector's search window and shortest accepted intro. Repeated here so
+// the bench builds without libmpv.
+static constexpr double INTRO_WINDOW_SEC = 360.0;
+static constexpr double MIN_RANGE_SEC = 15.0;
+
+// Two intro windows of INTRO_WINDOW_SEC sharing the sample at different,
+// hop-misaligned offsets, with unrelated noise around it.
+struct EpisodePair {
+    std::vector<uint32_t> a, b;
+};
+
+static const EpisodePair& Episodes()
+{
+    static const EpisodePair pair = []() {
+        const std::vector<int16_t>& shared = SampleAudio();
+        const size_t window = static_cast<size_t>(INTRO_WINDOW_SEC * AudioFingerprinter::SAMPLE_RATE);
+        auto episode = [&](unsigned seed, size_t at) {
+            std::mt19937 rng(seed);
+            std::normal_distribution<double> noise(0.0, 4000.0);
+            std::vector<int16_t> audio(window);
+            for (size_t n = 0; n < window; n++) {
+                double value = noise(rng);
+                if (n >= at && n - at < shared.size()) value = shared[n - at] + value * 0.05;
+                audio[n] = static_cast<int16_t>((std::max)(-32767.0, (std::min)(32767.0, value)));
+            }
+            return audio;
+        };
+        AudioFingerprinter fingerprinter;
+        std::vector<int16_t> first = episode(1, 37 * AudioFingerprinter::SAMPLE_RATE);
+        std::vector<int16_t> second = episode(2, 101 * AudioFingerprinter::SAMPLE_RATE + 301);
+        return EpisodePair{ fingerprinter.Compute(first.data(), first.size()), fingerprinter.Compute(second.data(), second.size()) };
+    }();
+    return pair;
+}
+
+static void BM_FingerprintCompute(benchmark::State& state)
+{
+    const std::vector<int16_t>& samples = SampleAudio();
+    AudioFingerprinter fingerprinter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fingerprinter.Compute(samples.data(), samples.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(samples.size() * sizeof(int16_t)));
+    state.counters["audio_sec_per_sec"] = benchmark::Counter(
+        static_cast<double>(samples.size()) / AudioFingerprinter::SAMPLE_RATE * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_FingerprintCompute)->Unit(benchmark::kMillisecond);
+
+template <size_t (*Count)(const uint32_t*, const uint32_t*, size_t)>
+static void BM_CountMatches(benchmark::State& state)
+{
+    const EpisodePair& episodes = Episodes();
+    const size_t count = (std::min)(episodes.a.size(), episodes.b.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Count(episodes.a.data(), episodes.b.data(), count));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+BENCHMARK_TEMPLATE(BM_CountMatches, AudioFingerprinter::CountMatches);
+BENCHMARK_TEMPLATE(BM_CountMatches, AudioFingerprinter::CountMatchesScalar);
+
+static void BM_FindSharedSegment(benchmark::State& state)
+{
+    const EpisodePair& episodes = Episodes();
+    const int minLength = static_cast<int>(MIN_RANGE_SEC / AudioFingerprinter::HASH_SEC);
+    for (auto _ : state) {
+        auto segment = AudioFingerprinter::FindSharedSegment(episodes.a, episodes.b, minLength);
+        if (!segment) state.SkipWithError("the shared audio was not found");
+        benchmark::DoNotOptimize(segment);
+    }
+}
+BENCHMARK(BM_FindSharedSegment)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "../src/updater/delta_patch.h"
+#include "../src/updater/signature_verifier.h"
+#include "../tests/signature_vectors.h"
+
+namespace fs = std::filesystem;
+
+// An old/new pair the size of a release binary, with the new one made of
+// edited runs of the old interleaved with fresh bytes, and its patch.
+struct PatchFixture {
+    fs::path dir;
+    int64_t newSize = 0;
+};
+
+static void AppendInt64(std::string& out, int64_t value)
+{
+    for (int i = 0; i < 8; i++) out += static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+}
+
+static const PatchFixture& Fixture()
+{
+    static const PatchFixture fixture = []() {
+        constexpr size_t OLD_SIZE = 16 * 1024 * 1024;
+        constexpr int64_t RUN = 256 * 1024;
+        constexpr int64_t FRESH = 4 * 1024;
+        std::mt19937 rng(11);
+        std::string old(OLD_SIZE, '\0');
+        for (char& c : old) c = static_cast<char>(rng());
+
+        PatchFixture result;
+        result.dir = fs::temp_directory_path() / "stremato-bench-delta";
+        fs::create_directories(result.dir);
+
+        std::string records;
+        for (int64_t oldPos = 0; oldPos + RUN <= static_cast<int64_t>(OLD_SIZE); oldPos += RUN) {
+            AppendInt64(records, RUN);
+            AppendInt64(records, FRESH);
+            AppendInt64(records, 0);
+            for (int64_t i = 0; i < RUN; i++) records += static_cast<char>(i % 4099 == 0 ? rng() : 0);
+            for (int64_t i = 0; i < FRESH; i++) records += static_cast<char>(rng());
+            result.newSize += RUN + FRESH;
+        }
+        std::string patch = "STRDIFF1";
+        AppendInt64(patch, result.newSize);
+        patch += records;
+
+        std::ofstream(result.dir / "old", std::ios::binary).write(old.data(), static_cast<std::streamsize>(old.size()));
+        std::ofstream(result.dir / "patch", std::ios::binary).write(patch.data(), static_cast<std::streamsize>(patch.size()));
+        return result;
+    }();
+    return fixture;
+}
+
+static void BM_DeltaPatchApply(benchmark::State& state)
+{
+    const PatchFixture& fixture = Fixture();
+    std::string error;
+    for (auto _ : state) {
+        if (!DeltaPatch::Apply(fixture.dir / "old", fixture.dir / "patch", fixture.dir / "new", error)) {
+            state.SkipWithError(error.c_str());
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * fixture.newSize);
+}
+BENCHMARK(BM_DeltaPatchApply)->Unit(benchmark::kMillisecond);
+
+static void BM_SignatureVerify(benchmark::State& state)
+{
+    SignatureVerifier verifier(SignatureVectors::SIGNER_PUBLIC_KEY);
+    const std::string message = SignatureVectors::MESSAGE;
+    for (auto _ : state) {
+        if (!verifier.Verify(message, SignatureVectors::SIGNATURE)) {
+            state.SkipWithError("the known signature did not verify");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_SignatureVerify);
+
+// What the verifier saves: parsing the PEM key for every verification.
+static void BM_SignatureVerify_ParseKeyEachTime(benchmark::State& state)
+{
+    const std::string message = SignatureVectors::MESSAGE;
+    for (auto _ : state) {
+        SignatureVerifier verifier(SignatureVectors::SIGNER_PUBLIC_KEY);
+        benchmark::DoNotOptimize(verifier.Verify(message, SignatureVectors::SIGNATURE));
+    }
+}
+BENCHMARK(BM_SignatureVerify_ParseKeyEachTime);
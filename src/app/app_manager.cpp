@@ -11,18 +11,33 @@
 #include "../webview_protocol/event_emitter/event_emitter.h"
 #include "../helpers/helpers.h"
 #include "../webview_protocol/transport_constants.h" 
+#include "../tracer/tracer.h"
+#include "../tracer/startup_report.h"
+#include "../webview_protocol/bridge_trace/bridge_trace.h"
+#include "../metrics/metrics.h"
+#include "../platform/platform.h"
+#include <chrono>
 
 AppManager::AppManager() : m_hMutex(nullptr) {}
 
 AppManager::~AppManager() {
+    // Interrupts a server hot swap the updater thread may be blocked in, so
+    // joining that thread below does not wait out the handover.
+    if (m_serverManager) m_serverManager->Shutdown();
+    // Optional startup stages (update check, whitelist) may still be running
+    // and logging; join them while the managers and the logger are alive.
+    m_startupScheduler.reset();
     if (m_settingsManager && m_windowManager) {
         WINDOWPLACEMENT wp = { sizeof(wp) };
         if (GetWindowPlacement(m_windowManager->GetHWND(), &wp)) {
-            GetSettings().windowPlacement = wp;
+            GetSettings().windowPlacement = { (int)wp.showCmd, wp.rcNormalPosition.left, wp.rcNormalPosition.top,
+                                              wp.rcNormalPosition.right, wp.rcNormalPosition.bottom };
             GetSettings().hasSavedWindowPlacement = true;
         }
         m_settingsManager->Save();
     }
+    BridgeRecorder::Stop();
+    Metrics::StopPeriodicDump();
     if (m_hMutex) CloseHandle(m_hMutex);
     Logger::Cleanup();
 }
@@ -30,12 +45,16 @@ AppManager::~AppManager() {
 bool AppManager::InitializeWindow(int nCmdShow) {
     m_hMutex = CreateMutexW(nullptr, TRUE, L"StrematoSingleInstanceMutex");
     if (GetLastError() == ERROR_ALREADY_EXISTS) return false; 
+    m_webviewManager = std::make_unique<WebViewManager>(this);
+    // Let WebView2 spin up its browser processes while we load settings and create the window.
+    m_webviewManager->PrewarmEnvironment();
     m_settingsManager = std::make_unique<SettingsManager>();
     m_settingsManager->Load();
+    if (GetSettings().recordBridgeTrace) StartBridgeRecording();
+    if (GetSettings().metricsDumpIntervalSec > 0) StartMetricsDump();
     m_commandHandler = std::make_unique<WebViewProtocol::CommandHandler>();
     m_windowManager = std::make_unique<WindowManager>(this);
-    m_mpvManager = std::make_unique<MPVManager>(this);
-    m_webviewManager = std::make_unique<WebViewManager>(this);
+    m_mpvManager = std::make_unique<MPVManager>(GetSettings());
     m_serverManager = std::make_unique<ServerManager>();
     m_discordManager = std::make_unique<DiscordManager>(this);
     m_updaterManager = std::make_unique<UpdaterManager>(this);
@@ -45,13 +64,70 @@ bool AppManager::InitializeWindow(int nCmdShow) {
     return true;
 }
 
+void AppManager::StartBridgeRecording() {
+    std::tm now = {};
+    Platform::LocalTime(std::time(nullptr), now);
+    char name[64];
+    std::strftime(name, sizeof(name), "bridge-%Y%m%d-%H%M%S.btrace", &now);
+    std::filesystem::path path = Platform::GetExecutableDirectory() / "portable_config" / "traces" / name;
+    if (BridgeRecorder::Start(path)) {
+        LOG_INFO("AppManager", "Recording bridge traffic to " + WStringToUtf8(path.wstring()));
+    } else {
+        LOG_WARN("AppManager", "Could not open bridge trace " + WStringToUtf8(path.wstring()));
+    }
+}
+
+void AppManager::StartMetricsDump() {
+    std::filesystem::path path = Platform::GetExecutableDirectory() / "portable_config" / "metrics.jsonl";
+    if (Metrics::StartPeriodicDump(path, std::chrono::seconds(GetSettings().metricsDumpIntervalSec))) {
+        LOG_INFO("AppManager", "Dumping metrics every " + std::to_string(GetSettings().metricsDumpIntervalSec) + "s to " + WStringToUtf8(path.wstring()));
+    } else {
+        LOG_WARN("AppManager", "Could not open metrics dump " + WStringToUtf8(path.wstring()));
+    }
+}
+
 bool AppManager::InitializeManagers() {
     HWND hWnd = m_windowManager->GetHWND();
     if (!hWnd) return false;
-    if (!m_mpvManager->Initialize(hWnd) || !m_webviewManager->Initialize(hWnd)) return false;
-    m_discordManager->Initialize();
-    m_serverManager->Start();
-    RegisterCommandHandlers();
+
+    using Affinity = StartupScheduler::Affinity;
+    m_startupScheduler = std::make_unique<StartupScheduler>();
+    auto& scheduler = *m_startupScheduler;
+    scheduler.AddStage("commands", Affinity::UIThread, {}, [this]() {
+        RegisterCommandHandlers();
+        return true;
+    });
+    // WebView2 is STA-bound and must be created on the window's thread.
+    scheduler.AddStage("webview", Affinity::UIThread, { "commands" }, [this, hWnd]() {
+        return m_webviewManager->Initialize(hWnd);
+    });
+    // mpv creates its video window as a child of ours and waits for this thread
+    // to answer, so it cannot initialize on a worker while Run() blocks here.
+    // Listed after the webview, whose controller is created asynchronously, so
+    // the browser process starts while mpv loads.
+    scheduler.AddStage("mpv", Affinity::UIThread, {}, [this, hWnd]() {
+        return m_mpvManager->Initialize(reinterpret_cast<int64_t>(hWnd), [hWnd]() {
+            PostMessage(hWnd, WM_MPV_WAKEUP, 0, 0);
+        });
+    });
+    scheduler.AddStage("server", Affinity::Worker, {}, [this]() {
+        m_serverManager->SetResourceLimits(GetSettings().serverMemoryLimitMB, GetSettings().serverCpuRatePercent);
+        return m_serverManager->Start();
+    }, false);
+    scheduler.AddStage("discord", Affinity::Worker, {}, [this]() {
+        m_discordManager->Initialize();
+        return true;
+    }, false);
+    scheduler.AddStage("whitelist", Affinity::Worker, {}, [this]() {
+        return m_extensionsManager->FetchAndParseWhitelist();
+    }, false);
+    // A partial update may hot swap server.js, so wait for the server to exist.
+    scheduler.AddStage("updates", Affinity::Worker, { "server" }, [this]() {
+        m_updaterManager->CheckForUpdates();
+        return true;
+    }, false);
+
+    if (!scheduler.Run()) return false;
     LOG_INFO("AppManager", "All managers initialized.");
     return true;
 }
@@ -91,17 +167,41 @@ void AppManager::RegisterCommandHandlers() {
         m_mpvManager->LoadSubtitle(payload.get<LoadSubtitlePayload>());
     });
 
+    // Only queues the request; the thumbnail service resolves it from its own thread.
+    m_commandHandler->RegisterRequest(Commands::GET_THUMBNAIL, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetThumbnail(payload.get<GetThumbnailPayload>(), request);
+    });
+
+    m_commandHandler->RegisterRequest(Commands::GET_SPRITE_SHEETS, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetSpriteSheets(request);
+    });
+
+    // Reads and encodes a sheet of a few hundred KB, off the UI thread.
+    m_commandHandler->RegisterRequest(Commands::GET_SPRITE_SHEET, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetSpriteSheet(payload.get<GetSpriteSheetPayload>(), request);
+    }, { CommandAffinity::AnyThread, DEFAULT_REQUEST_TIMEOUT, "" });
+
+    m_commandHandler->RegisterRequest(Commands::GET_CHAPTER_HINTS, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetChapterHints(request);
+    });
+
     m_commandHandler->RegisterCommand(Commands::TOGGLE_FULLSCREEN, [this](const json& payload, const std::optional<std::string>& messageId) {
         m_windowManager->ToggleFullScreen();
     });
 
     m_commandHandler->RegisterCommand(Commands::FRONTEND_READY, [this](const json& payload, const std::optional<std::string>& messageId) {
         m_windowManager->OnFrontendReady();
+        std::wstring reportPath = GetExeDirectory() + L"\\portable_config\\startup-reports.jsonl";
+        if (StartupReport::Complete(payload.is_object() ? payload : json::object(), reportPath)) {
+            LOG_INFO("AppManager", "Startup load report appended to " + WStringToUtf8(reportPath));
+        }
     });
 
+    // Presence updates talk to the Discord IPC pipe; keep them off the UI thread
+    // but in order.
     m_commandHandler->RegisterCommand(Commands::SET_RPC, [this](const json& payload, const std::optional<std::string>& messageId) {
         m_discordManager->SetPresence(payload.get<std::vector<std::string>>());
-    });
+    }, { CommandAffinity::Serialized, "discord" });
 
     m_commandHandler->RegisterCommand(Commands::NAVIGATE, [this](const json& payload, const std::optional<std::string>& messageId) {
         auto url = Utf8ToWstring(payload.get<std::string>());
@@ -112,25 +212,70 @@ void AppManager::RegisterCommandHandlers() {
         m_updaterManager->RunInstallerAndExit();
     });
 
-    m_commandHandler->RegisterCommand(Commands::GET_SETTING, [this](const json& payload, const std::optional<std::string>& messageId) {
-        if (!messageId) return;
+    m_commandHandler->RegisterRequest(Commands::GET_SETTING, [this](const json& payload, const RequestHandle& request) {
+        std::string key = payload.at("key").get<std::string>();
+        if (key == "isAlwaysOnTop") {
+            request->Resolve(m_settingsManager->GetSettings().alwaysOnTop);
+        } else if (key == "isRpcOn") {
+            request->Resolve(m_settingsManager->GetSettings().isRpcOn);
+        } else {
+            request->Reject("Unknown setting key");
+        }
+    });
+
+    // Waits on a pool worker in short slices so cancellation and the RPC
+    // timeout free the worker promptly.
+    m_commandHandler->RegisterRequest(Commands::WAIT_SERVER_READY, [this](const json& payload, const RequestHandle& request) {
+        int timeoutMs = payload.is_object() ? payload.get<WaitServerReadyPayload>().timeoutMs : WaitServerReadyPayload().timeoutMs;
+        // Resolved by the readiness probe or the server manager's timer; no
+        // thread waits for the server in the meantime.
+        m_serverManager->NotifyWhenReady(std::chrono::milliseconds(timeoutMs), [this, request](bool ready) {
+            ServerStatusPayload status = {ready, m_serverManager->GetBaseUrl()};
+            request->Resolve(json(status));
+        });
+    }, { CommandAffinity::UIThread, std::chrono::milliseconds(60000), "" });
+
+    m_commandHandler->RegisterRequest(Commands::GET_SERVER_STATS, [this](const json& payload, const RequestHandle& request) {
+        ServerStats stats = m_serverManager->GetStats();
+        request->Resolve({
+            {"running", stats.running},
+            {"gaveUp", stats.gaveUp},
+            {"restartCount", stats.restartCount},
+            {"crashCount", stats.crashCount},
+            {"uptimeMs", stats.uptimeMs}
+        });
+    });
+
+    m_commandHandler->RegisterRequest(Commands::DUMP_STARTUP_TRACE, [this](const json& payload, const RequestHandle& request) {
+        std::wstring tracePath = GetExeDirectory() + L"\\portable_config\\startup-trace.json";
+        bool ok = Tracer::DumpChromeTrace(tracePath);
+        LOG_INFO("AppManager", (ok ? "Startup trace written to " : "Failed to write startup trace to ") + WStringToUtf8(tracePath));
+        if (ok) {
+            request->Resolve(WStringToUtf8(tracePath));
+        } else {
+            request->Reject("Failed to write startup trace");
+        }
+    }, { CommandAffinity::AnyThread, DEFAULT_REQUEST_TIMEOUT, "" });
+
+    m_commandHandler->RegisterRequest(Commands::GET_COMMAND_STATS, [this](const json& payload, const RequestHandle& request) {
+        request->Resolve(m_commandHandler->GetStats());
+    });
 
-        try {
-            std::string key = payload.at("key").get<std::string>();
-            json resultValue;
+    m_commandHandler->RegisterRequest(Commands::GET_EVENT_STATS, [this](const json& payload, const RequestHandle& request) {
+        request->Resolve(EventEmitter::GetOutboundStats());
+    });
 
-            if (key == "isAlwaysOnTop") {
-                resultValue = m_settingsManager->GetSettings().alwaysOnTop;
-            } else if (key == "isRpcOn") {
-                resultValue = m_settingsManager->GetSettings().isRpcOn;
-            } else {
-                EventEmitter::emitCommandResponse(messageId.value(), std::nullopt, "Unknown setting key");
-                return;
-            }
+    m_commandHandler->RegisterRequest(Commands::GET_METRICS, [this](const json& payload, const RequestHandle& request) {
+        request->Resolve(Metrics::Snapshot());
+    }, { CommandAffinity::AnyThread, DEFAULT_REQUEST_TIMEOUT, "" });
 
-            EventEmitter::emitCommandResponse(messageId.value(), resultValue, std::nullopt);
-        } catch (const std::exception& e) {
-            EventEmitter::emitCommandResponse(messageId.value(), std::nullopt, e.what());
+    m_commandHandler->RegisterRequest(Commands::ATTACH_SHARED_BUFFER, [this](const json& payload, const RequestHandle& request) {
+        std::string error;
+        if (m_webviewManager->AttachSharedBuffer(error)) {
+            request->Resolve(true);
+        } else {
+            LOG_WARN("AppManager", "Shared buffer unavailable, bulk events stay on JSON: " + error);
+            request->Reject(error);
         }
     });
 }
@@ -6,6 +6,7 @@
 #include "../webview_protocol/command_handler/command_handler.h"
 #include "../settings/settings_manager.h" 
 #include "../server/server_manager.h" 
+#include "startup_scheduler.h"
 
 class WindowManager;
 class MPVManager;
@@ -37,6 +38,8 @@ public:
 
 private:
     void RegisterCommandHandlers();
+    void StartBridgeRecording();
+    void StartMetricsDump();
 
     std::unique_ptr<SettingsManager> m_settingsManager;
     std::unique_ptr<WindowManager> m_windowManager;
@@ -48,6 +51,9 @@ private:
     std::unique_ptr<ExtensionsManager> m_extensionsManager;
     std::unique_ptr<WebViewProtocol::CommandHandler> m_commandHandler;
     HANDLE m_hMutex;
+    // Reset first in the destructor so optional startup work is joined before
+    // the managers and the logger go away.
+    std::unique_ptr<StartupScheduler> m_startupScheduler;
 };
 
 #endif // APP_MANAGER_H
\ No newline at end of file
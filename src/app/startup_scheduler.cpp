@@ -0,0 +1,187 @@
+#include "startup_scheduler.h"
+#include "../logger/logger.h"
+#include "../tracer/tracer.h"
+#include <sstream>
+#include <algorithm>
+
+StartupScheduler::~StartupScheduler()
+{
+    // Finishing workers may still dispatch dependents, so drain until empty.
+    while (true) {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            workers.swap(m_workers);
+        }
+        if (workers.empty()) break;
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+}
+
+void StartupScheduler::AddStage(const std::string& name, Affinity affinity, const std::vector<std::string>& dependencies,
+                                StageFunction function, bool required)
+{
+    Stage stage;
+    stage.name = name;
+    stage.affinity = affinity;
+    stage.dependencies = dependencies;
+    stage.function = std::move(function);
+    stage.required = required;
+    m_stages.push_back(std::move(stage));
+}
+
+bool StartupScheduler::ExecuteStage(Stage& stage)
+{
+    TraceScope trace(stage.name.c_str());
+    try {
+        return stage.function();
+    } catch (const std::exception& e) {
+        LOG_ERROR("StartupScheduler", "Stage '" + stage.name + "' threw: " + std::string(e.what()));
+    } catch (...) {
+        LOG_ERROR("StartupScheduler", "Stage '" + stage.name + "' threw an unknown exception.");
+    }
+    return false;
+}
+
+// Done if every dependency is done, Skipped if any failed or is unknown, Pending otherwise.
+StartupScheduler::StageState StartupScheduler::DependencyState(const Stage& stage) const
+{
+    for (const auto& dependency : stage.dependencies) {
+        auto it = std::find_if(m_stages.begin(), m_stages.end(), [&](const Stage& s) { return s.name == dependency; });
+        if (it == m_stages.end() || it->state == StageState::Failed || it->state == StageState::Skipped) return StageState::Skipped;
+        if (it->state != StageState::Done) return StageState::Pending;
+    }
+    return StageState::Done;
+}
+
+long long StartupScheduler::ElapsedMs() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+StartupScheduler::Stage* StartupScheduler::Dispatch(bool onUiThread)
+{
+    Stage* uiStage = nullptr;
+    bool progressed = true;
+    while (progressed) {
+        progressed = false;
+        for (auto& stage : m_stages) {
+            if (stage.state != StageState::Pending) continue;
+            StageState deps = DependencyState(stage);
+            if (deps == StageState::Pending) continue;
+            if (deps == StageState::Skipped) {
+                stage.state = StageState::Skipped;
+                progressed = true;
+                continue;
+            }
+            if (stage.affinity == Affinity::UIThread) {
+                if (m_uiPhaseOver) {
+                    LOG_WARN("StartupScheduler", "UI stage '" + stage.name + "' became ready after startup; skipping.");
+                    stage.state = StageState::Skipped;
+                    progressed = true;
+                    continue;
+                }
+                if (!onUiThread || uiStage) continue;
+                stage.state = StageState::Running;
+                stage.startMs = ElapsedMs();
+                uiStage = &stage;
+                continue;
+            }
+            stage.state = StageState::Running;
+            stage.startMs = ElapsedMs();
+            Stage* target = &stage;
+            m_workers.emplace_back([this, target]() { RunWorker(target); });
+            progressed = true;
+        }
+    }
+    return uiStage;
+}
+
+void StartupScheduler::RunWorker(Stage* stage)
+{
+    bool ok = ExecuteStage(*stage);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FinishStage(*stage, ok);
+    Dispatch(false);
+    if (IsAllDone() && !m_traceLogged) {
+        m_traceLogged = true;
+        LogTrace();
+    }
+    m_cv.notify_all();
+}
+
+void StartupScheduler::FinishStage(Stage& stage, bool ok)
+{
+    stage.durationMs = ElapsedMs() - stage.startMs;
+    stage.state = ok ? StageState::Done : StageState::Failed;
+}
+
+bool StartupScheduler::IsBlockingDone() const
+{
+    for (const auto& stage : m_stages) {
+        bool blocking = stage.required || stage.affinity == Affinity::UIThread;
+        if (blocking && (stage.state == StageState::Pending || stage.state == StageState::Running)) return false;
+    }
+    return true;
+}
+
+bool StartupScheduler::IsAllDone() const
+{
+    for (const auto& stage : m_stages) {
+        if (stage.state == StageState::Pending || stage.state == StageState::Running) return false;
+    }
+    return true;
+}
+
+bool StartupScheduler::Run()
+{
+    m_startTime = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!IsBlockingDone()) {
+        Stage* uiStage = Dispatch(true);
+        if (uiStage) {
+            lock.unlock();
+            bool ok = ExecuteStage(*uiStage);
+            lock.lock();
+            FinishStage(*uiStage, ok);
+            continue;
+        }
+        bool anyRunning = std::any_of(m_stages.begin(), m_stages.end(), [](const Stage& s) { return s.state == StageState::Running; });
+        if (!anyRunning) {
+            // Nothing runnable and nothing in flight: a dependency cycle.
+            for (auto& stage : m_stages) {
+                if (stage.state == StageState::Pending) stage.state = StageState::Skipped;
+            }
+            break;
+        }
+        m_cv.wait(lock);
+    }
+
+    m_uiPhaseOver = true;
+    Dispatch(false);
+    if (IsAllDone() && !m_traceLogged) {
+        m_traceLogged = true;
+        LogTrace();
+    }
+
+    for (const auto& stage : m_stages) {
+        if (stage.required && stage.state != StageState::Done) return false;
+    }
+    return true;
+}
+
+void StartupScheduler::LogTrace() const
+{
+    static const char* stateNames[] = { "pending", "running", "done", "failed", "skipped" };
+    for (const auto& stage : m_stages) {
+        std::stringstream ss;
+        ss << stage.name << (stage.affinity == Affinity::UIThread ? " [ui]" : " [worker]")
+           << " start=" << stage.startMs << "ms duration=" << stage.durationMs << "ms "
+           << stateNames[static_cast<int>(stage.state)];
+        LOG_INFO("StartupTrace", ss.str());
+    }
+    LOG_INFO("StartupTrace", "Startup stages finished after " + std::to_string(ElapsedMs()) + "ms.");
+}
@@ -0,0 +1,69 @@
+#ifndef STARTUP_SCHEDULER_H
+#define STARTUP_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Runs startup stages as soon as their dependencies finish. UI-thread stages
+// run inline on the thread calling Run(), in the order they were added when
+// several are ready; worker stages each get a thread.
+// A stage that fails (returns false or throws) skips everything depending on it.
+class StartupScheduler
+{
+public:
+    enum class Affinity { UIThread, Worker };
+    using StageFunction = std::function<bool()>;
+
+    StartupScheduler() = default;
+    ~StartupScheduler();
+
+    void AddStage(const std::string& name, Affinity affinity, const std::vector<std::string>& dependencies,
+                  StageFunction function, bool required = true);
+
+    // Blocks until every required and every UI-thread stage has finished, so
+    // the message loop is not held up by optional background work. Optional
+    // worker stages keep running and are joined on destruction. Returns false
+    // if a required stage failed or was skipped.
+    bool Run();
+
+private:
+    enum class StageState { Pending, Running, Done, Failed, Skipped };
+
+    struct Stage {
+        std::string name;
+        Affinity affinity;
+        std::vector<std::string> dependencies;
+        StageFunction function;
+        bool required;
+        StageState state = StageState::Pending;
+        long long startMs = 0;
+        long long durationMs = 0;
+    };
+
+    // Called with m_mutex held. Starts every ready worker stage and returns a
+    // ready UI stage if the caller may run one.
+    Stage* Dispatch(bool onUiThread);
+    void RunWorker(Stage* stage);
+    bool ExecuteStage(Stage& stage);
+    void FinishStage(Stage& stage, bool ok);
+    StageState DependencyState(const Stage& stage) const;
+    bool IsBlockingDone() const;
+    bool IsAllDone() const;
+    long long ElapsedMs() const;
+    void LogTrace() const;
+
+    std::vector<Stage> m_stages;
+    std::vector<std::thread> m_workers;
+    std::chrono::steady_clock::time_point m_startTime;
+    bool m_uiPhaseOver = false;
+    bool m_traceLogged = false;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+#endif // STARTUP_SCHEDULER_H
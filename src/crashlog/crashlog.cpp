@@ -3,41 +3,40 @@
 #include <iomanip>
 #include <ctime>
 #include <sstream>
+#include <filesystem>
 #include "../helpers/helpers.h"
+#include "../platform/platform.h"
 
-static std::wstring GetDailyCrashLogPath()
+static std::filesystem::path GetDailyCrashLogPath()
 {
-    std::time_t t = std::time(nullptr);
-    std::tm localTime;
-    localtime_s(&localTime, &t);
+    std::tm localTime = {};
+    Platform::LocalTime(std::time(nullptr), localTime);
 
-    std::wstringstream filename;
-    filename << L"\\errors-"
-             << localTime.tm_mday << L"."
-             << (localTime.tm_mon + 1) << L"."
-             << (localTime.tm_year + 1900) << L".txt";
+    std::stringstream filename;
+    filename << "errors-"
+             << localTime.tm_mday << "."
+             << (localTime.tm_mon + 1) << "."
+             << (localTime.tm_year + 1900) << ".txt";
 
-    std::wstring exeDir = GetExeDirectory();
-    std::wstring pcDir  = exeDir + L"\\portable_config";
-    CreateDirectoryW(pcDir.c_str(), nullptr);
-    return pcDir + filename.str();
+    std::filesystem::path pcDir = Platform::GetExecutableDirectory() / "portable_config";
+    std::error_code ec;
+    std::filesystem::create_directories(pcDir, ec);
+    return pcDir / filename.str();
 }
 
-void AppendToCrashLog(const std::wstring& message)
+void AppendToCrashLog(const std::string& message)
 {
-    std::wofstream logFile;
-    logFile.open(GetDailyCrashLogPath(), std::ios::app);
+    std::ofstream logFile(GetDailyCrashLogPath(), std::ios::app | std::ios::binary);
     if(!logFile.is_open()) {
         return;
     }
-    std::time_t t = std::time(nullptr);
-    std::tm localTime;
-    localtime_s(&localTime, &t);
-    logFile << L"[" << std::put_time(&localTime, L"%H:%M:%S") << L"] "
+    std::tm localTime = {};
+    Platform::LocalTime(std::time(nullptr), localTime);
+    logFile << "[" << std::put_time(&localTime, "%H:%M:%S") << "] "
             << message << std::endl;
 }
 
-void AppendToCrashLog(const std::string& message)
+void AppendToCrashLog(const std::wstring& message)
 {
-    AppendToCrashLog(Utf8ToWstring(message));
-}
\ No newline at end of file
+    AppendToCrashLog(WStringToUtf8(message));
+}
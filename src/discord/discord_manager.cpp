@@ -12,6 +12,10 @@ DiscordManager::~DiscordManager() {
 }
 
 void DiscordManager::Initialize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_initialized = true;
+    std::optional<std::vector<std::string>> pending = std::move(m_pendingPresence);
+    m_pendingPresence.reset();
     if (!m_appManager->GetSettings().isRpcOn) return; 
     
     auto& manager = discord::RPCManager::get();
@@ -28,9 +32,19 @@ void DiscordManager::Initialize() {
 
     manager.setClientID(DISCORD_CLIENT_ID);
     manager.initialize();
+    if (pending) ApplyPresence(*pending);
 }
 
 void DiscordManager::SetPresence(const std::vector<std::string>& args) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized) {
+        m_pendingPresence = args;
+        return;
+    }
+    ApplyPresence(args);
+}
+
+void DiscordManager::ApplyPresence(const std::vector<std::string>& args) {
     if (!m_appManager->GetSettings().isRpcOn || args.empty()) { 
         discord::RPCManager::get().clearPresence();
         return;
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
+#include <optional>
 #include <discord-rpc.hpp>
 
 class AppManager;
@@ -13,15 +15,22 @@ public:
     explicit DiscordManager(AppManager* appManager);
     ~DiscordManager();
 
+    // Runs on a startup worker while SET_RPC may already be arriving; presence
+    // set before it finishes is held and applied once the client is set up.
     void Initialize();
     void SetPresence(const std::vector<std::string>& args);
 
 private:
+    void ApplyPresence(const std::vector<std::string>& args);
     void SetWatchingPresence(const std::vector<std::string>& args);
     void SetViewingPresence(const std::vector<std::string>& args);
     void SetBrowsingPresence(const std::string& details, const std::string& state, const std::string& iconKey);
     
     AppManager* m_appManager; 
+
+    std::mutex m_mutex;
+    bool m_initialized = false;
+    std::optional<std::vector<std::string>> m_pendingPresence;
 };
 
 #endif // DISCORD_MANAGER_H
\ No newline at end of file
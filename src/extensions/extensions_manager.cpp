@@ -4,9 +4,9 @@
 #include "../helpers/helpers.h"
 #include "../webview/webview_manager.h"
 #include "../globals/globals.h"
+#include "../metrics/metrics.h"
 #include "nlohmann/json.hpp"
 #include <curl/curl.h>
-#include <thread>
 
 using json = nlohmann::json;
 
@@ -80,29 +80,29 @@ bool ExtensionsManager::HandleStylusUsoInstall(const std::wstring& uri) {
     return true;
 }
 
-void ExtensionsManager::FetchAndParseWhitelist() {
-    std::thread([this]() {
-        LOG_INFO("ExtensionsManager", "Fetching extension domain whitelist...");
-        std::string responseData;
-        if (DownloadWhitelist(responseData)) {
-            try {
-                json j = json::parse(responseData);
-                if (j.contains("domains") && j["domains"].is_array()) {
-                    m_domainWhitelist.clear();
-                    for (const auto& domain : j["domains"]) {
-                        if (domain.is_string()) {
-                            m_domainWhitelist.push_back(Utf8ToWstring(domain.get<std::string>()));
-                        }
-                    }
-                    LOG_INFO("ExtensionsManager", "Successfully parsed " + std::to_string(m_domainWhitelist.size()) + " domains for whitelist.");
+bool ExtensionsManager::FetchAndParseWhitelist() {
+    LOG_INFO("ExtensionsManager", "Fetching extension domain whitelist...");
+    std::string responseData;
+    if (!DownloadWhitelist(responseData)) {
+        LOG_WARN("ExtensionsManager", "Failed to download domain whitelist.");
+        return false;
+    }
+    try {
+        json j = json::parse(responseData);
+        if (j.contains("domains") && j["domains"].is_array()) {
+            m_domainWhitelist.clear();
+            for (const auto& domain : j["domains"]) {
+                if (domain.is_string()) {
+                    m_domainWhitelist.push_back(Utf8ToWstring(domain.get<std::string>()));
                 }
-            } catch (const json::exception& e) {
-                LOG_WARN("ExtensionsManager", "Failed to parse domain whitelist JSON: " + std::string(e.what()));
             }
-        } else {
-            LOG_WARN("ExtensionsManager", "Failed to download domain whitelist.");
+            LOG_INFO("ExtensionsManager", "Successfully parsed " + std::to_string(m_domainWhitelist.size()) + " domains for whitelist.");
         }
-    }).detach();
+    } catch (const json::exception& e) {
+        LOG_WARN("ExtensionsManager", "Failed to parse domain whitelist JSON: " + std::string(e.what()));
+        return false;
+    }
+    return true;
 }
 
 bool ExtensionsManager::DownloadWhitelist(std::string& outData) const {
@@ -117,7 +117,9 @@ bool ExtensionsManager::DownloadWhitelist(std::string& outData) const {
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "Stremato-ExtensionsManager/1.0");
     curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
 
+    auto start = std::chrono::steady_clock::now();
     CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("whitelist", start, res == CURLE_OK);
     curl_easy_cleanup(curl);
     return res == CURLE_OK;
 }
\ No newline at end of file
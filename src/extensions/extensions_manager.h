@@ -17,7 +17,7 @@ public:
     bool HandleNavigation(const std::wstring& uri);
     const std::vector<std::wstring>& GetScriptQueue() const { return m_scriptQueue; }
     void ClearScriptQueue() { m_scriptQueue.clear(); }
-    void FetchAndParseWhitelist();
+    bool FetchAndParseWhitelist();
 
 private:
     bool HandlePremidLogin(const std::wstring& uri);
@@ -1,6 +1,8 @@
 #include "globals.h"
 
+#ifdef _WIN32
 HINSTANCE g_hInst = nullptr;
+#endif
 
 std::wstring g_webuiUrl;
 std::vector<std::wstring> g_webuiUrls = {
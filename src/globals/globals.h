@@ -1,12 +1,16 @@
 #ifndef GLOBALS_H
 #define GLOBALS_H
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <string>
 #include <vector>
 
 #define APP_VERSION "5.0.20"
 
+#ifdef _WIN32
+
 // Custom Window Messages
 #define WM_TRAYICON           (WM_APP + 1)
 #define WM_MPV_WAKEUP         (WM_APP + 2)
@@ -15,6 +19,7 @@
 #define WM_AUTH_CODE_RECEIVED (WM_APP + 5)
 #define WM_NAVIGATE_READY     (WM_APP + 6)
 #define WM_POST_INITIALIZE    (WM_APP + 7)
+#define WM_POST_WEB_MESSAGE   (WM_APP + 8)
 
 // Tray Menu Item IDs
 #define ID_TRAY_SHOWWINDOW        1001
@@ -36,6 +41,7 @@ struct MenuItem {
 
 // Application-wide instance handle
 extern HINSTANCE g_hInst;
+#endif // _WIN32
 
 // These URLs can be configured via command-line args
 extern std::wstring g_webuiUrl;
@@ -0,0 +1,58 @@
+#include "bridge_replayer.h"
+#include "headless_host.h"
+#include "../webview_protocol/bridge_trace/bridge_trace.h"
+#include "../webview_protocol/transport_constants.h"
+#include <chrono>
+
+BridgeReplayer::BridgeReplayer(HeadlessHost& host) : m_host(host) {}
+
+bool BridgeReplayer::Run(const std::filesystem::path& path, const ReplayOptions& options, std::string& error)
+{
+    BridgeTrace::Reader reader;
+    if (!reader.Open(path, error)) return false;
+
+    m_speed = options.speed;
+    const auto start = std::chrono::steady_clock::now();
+    BridgeTrace::Record record;
+    while (reader.Next(record)) {
+        m_recordedDurationSec = record.timestampUs / 1e6;
+        json message = json::parse(record.data, nullptr, false);
+        if (message.is_discarded()) continue;
+
+        if (record.kind == BridgeTrace::RecordKind::Event) {
+            m_recordedEvents[message.value("event", "")]++;
+            continue;
+        }
+        if (record.kind != BridgeTrace::RecordKind::Command) continue;
+
+        if (options.speed > 0) {
+            auto due = start + std::chrono::microseconds(static_cast<long long>(record.timestampUs / options.speed));
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+            if (wait.count() > 0) m_host.Pump(wait);
+        }
+
+        std::string command = message.value("command", "");
+        if (!m_host.CanHandle(command)) {
+            m_commandsSkipped[command]++;
+            continue;
+        }
+        json payload = message.value("payload", json::object());
+        if (command == WebViewProtocol::Commands::PLAY && !options.playUrlOverride.empty()) {
+            payload["url"] = options.playUrlOverride;
+        }
+        m_host.Send(command, payload);
+        m_commandsReplayed++;
+    }
+    return true;
+}
+
+json BridgeReplayer::GetReport() const
+{
+    return {
+        {"speed", m_speed},
+        {"recordedDurationSec", m_recordedDurationSec},
+        {"commandsReplayed", m_commandsReplayed},
+        {"commandsSkipped", m_commandsSkipped},
+        {"recordedEvents", m_recordedEvents}
+    };
+}
@@ -0,0 +1,42 @@
+#ifndef BRIDGE_REPLAYER_H
+#define BRIDGE_REPLAYER_H
+
+#include <string>
+#include <map>
+#include <filesystem>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+class HeadlessHost;
+
+struct ReplayOptions {
+    // 1 replays at recorded pace, 4 at four times that; 0 or less sends
+    // commands back to back with no waits.
+    double speed = 1.0;
+    // Replaces the url of recorded play commands, since field traces point at
+    // streams that only existed on the recording machine.
+    std::string playUrlOverride;
+};
+
+// Feeds the inbound commands of a bridge trace into a HeadlessHost on the
+// recorded timeline. Recorded outbound events are only counted, so the report
+// can be compared with what the replay produced.
+class BridgeReplayer
+{
+public:
+    explicit BridgeReplayer(HeadlessHost& host);
+
+    bool Run(const std::filesystem::path& path, const ReplayOptions& options, std::string& error);
+    json GetReport() const;
+
+private:
+    HeadlessHost& m_host;
+    double m_speed = 1.0;
+    double m_recordedDurationSec = 0.0;
+    unsigned long long m_commandsReplayed = 0;
+    std::map<std::string, unsigned long long> m_commandsSkipped;
+    std::map<std::string, unsigned long long> m_recordedEvents;
+};
+
+#endif // BRIDGE_REPLAYER_H
@@ -0,0 +1,121 @@
+#include "cache_simulation.h"
+#include "../mpv/cache_policy.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+static constexpr double MIB = 1024.0 * 1024.0;
+static constexpr uint64_t GIB = 1ull << 30;
+
+struct MemoryProfile {
+    const char* name;
+    Platform::MemoryStatus memory;
+};
+
+static const MemoryProfile MEMORY_PROFILES[] = {
+    { "low", { 4 * GIB, GIB + GIB / 4 } },
+    { "mid", { 16 * GIB, 9 * GIB } },
+    { "high", { 64 * GIB, 40 * GIB } },
+};
+
+struct BitrateProfile {
+    const char* name;
+    double bytesPerSecond;
+};
+
+static const BitrateProfile BITRATE_PROFILES[] = {
+    { "unknown", 0.0 },
+    { "web-1080p", 0.6 * MIB },
+    { "remux-1080p", 2.5 * MIB },
+    { "remux-2160p", 10.0 * MIB },
+};
+
+static json DecisionToJson(const CachePolicy::Decision& decision)
+{
+    return {
+        {"maxBytes", decision.maxBytes},
+        {"maxBackBytes", decision.maxBackBytes},
+        {"readaheadSecs", decision.readaheadSecs},
+        {"cacheSecs", decision.cacheSecs}
+    };
+}
+
+static void Check(const CachePolicy::Decision& decision, const Platform::MemoryStatus& memory, bool network,
+                  const std::string& label, json& violations)
+{
+    const double budget = std::clamp((std::min)(memory.availableBytes * CachePolicy::AVAILABLE_MEMORY_SHARE,
+                                                memory.totalBytes * CachePolicy::TOTAL_MEMORY_SHARE),
+                                     static_cast<double>(CachePolicy::MIN_BUDGET_BYTES),
+                                     static_cast<double>(CachePolicy::MAX_BUDGET_BYTES));
+    const double target = network ? CachePolicy::NETWORK_TARGET_SECS : CachePolicy::LOCAL_TARGET_SECS;
+    if (decision.maxBytes + decision.maxBackBytes > budget + CachePolicy::MIN_BACK_BYTES) {
+        violations.push_back(label + ": forward + back exceeds the memory budget");
+    }
+    if (decision.maxBytes < CachePolicy::MIN_FORWARD_BYTES) violations.push_back(label + ": forward below minimum");
+    if (decision.readaheadSecs < CachePolicy::MIN_READAHEAD_SECS || decision.readaheadSecs > target) {
+        violations.push_back(label + ": readahead outside [min, target]");
+    }
+}
+
+json RunCacheSimulation()
+{
+    json violations = json::array();
+
+    json matrix = json::array();
+    for (const auto& memory : MEMORY_PROFILES) {
+        for (const auto& bitrate : BITRATE_PROFILES) {
+            for (bool network : { true, false }) {
+                CachePolicy::Decision decision = CachePolicy::Decide(memory.memory, bitrate.bytesPerSecond, network);
+                std::string label = std::string(memory.name) + "/" + bitrate.name + (network ? "/network" : "/local");
+                Check(decision, memory.memory, network, label, violations);
+                json entry = DecisionToJson(decision);
+                entry["memory"] = memory.name;
+                entry["bitrate"] = bitrate.name;
+                entry["network"] = network;
+                matrix.push_back(entry);
+            }
+        }
+    }
+
+    // A 2160p stream: the container claims 6 MiB/s, a high-motion stretch
+    // peaks at 14 MiB/s, then another application takes most of the memory.
+    struct Step { int atSec; double observedMib; bool lowMemory; };
+    const std::vector<Step> steps = {
+        {10, 6, false}, {20, 6.5, false}, {30, 11, false}, {40, 14, false}, {50, 14, false},
+        {60, 13, false}, {70, 5, false}, {80, 5, false}, {90, 5, true}, {100, 5, true},
+    };
+    const Platform::MemoryStatus normal = MEMORY_PROFILES[1].memory;
+    const Platform::MemoryStatus pressured = { normal.totalBytes, normal.totalBytes / 20 };
+
+    json timeline = json::array();
+    CachePolicy policy;
+    policy.Begin(true);
+    auto record = [&](int atSec, const char* event, const Platform::MemoryStatus& memory) {
+        std::optional<CachePolicy::Decision> decision = policy.Evaluate(memory);
+        json entry = {
+            {"atSec", atSec},
+            {"event", event},
+            {"effectiveBitrate", policy.GetEffectiveBitrate()},
+            {"applied", decision.has_value()}
+        };
+        if (decision) {
+            entry["decision"] = DecisionToJson(*decision);
+            entry["reason"] = policy.GetLastReason();
+            Check(*decision, memory, true, "timeline@" + std::to_string(atSec), violations);
+        }
+        timeline.push_back(entry);
+    };
+    record(0, "start-file", normal);
+    policy.SetContainerBitrate(6 * MIB);
+    record(0, "file-loaded", normal);
+    for (const Step& step : steps) {
+        policy.ObserveBitrate(step.observedMib * MIB);
+        record(step.atSec, "sample", step.lowMemory ? pressured : normal);
+    }
+
+    return {
+        {"matrix", matrix},
+        {"timeline", timeline},
+        {"violations", violations}
+    };
+}
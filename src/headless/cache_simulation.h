@@ -0,0 +1,14 @@
+#ifndef CACHE_SIMULATION_H
+#define CACHE_SIMULATION_H
+
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// Drives CachePolicy with synthetic memory profiles and bitrates, without
+// mpv: a matrix of per-file decisions plus a mid-stream timeline where the
+// bitrate ramps and free memory drops. Every decision is checked against the
+// policy's own limits; violations are listed under "violations".
+json RunCacheSimulation();
+
+#endif // CACHE_SIMULATION_H
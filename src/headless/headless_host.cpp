@@ -0,0 +1,314 @@
+#include "headless_host.h"
+#include "../mpv/mpv_manager.h"
+#include "../webview_protocol/command_handler/command_handler.h"
+#include "../webview_protocol/transport_constants.h"
+#include "../helpers/helpers.h"
+#include "../logger/logger.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace WebViewProtocol;
+
+// Properties MPVManager observes; set-property on anything else has no visible effect.
+static const char* OBSERVED_PROPERTIES[] = { "time-pos", "duration", "pause", "volume", "mute" };
+
+static bool IsObservedProperty(const std::string& property) {
+    return std::any_of(std::begin(OBSERVED_PROPERTIES), std::end(OBSERVED_PROPERTIES),
+        [&](const char* name) { return property == name; });
+}
+
+static bool IsPropertyChange(const std::string& eventName, const json& payload, const char* property) {
+    return eventName == Events::PROPERTY_CHANGE && payload.value("property", "") == property;
+}
+
+static double Percentile(const std::vector<long long>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(std::ceil(p * sorted.size()));
+    index = std::clamp<size_t>(index, 1, sorted.size()) - 1;
+    return sorted[index] / 1000.0;
+}
+
+HeadlessHost::HeadlessHost() = default;
+
+HeadlessHost::~HeadlessHost()
+{
+    EventEmitter::SetTransport(nullptr);
+    m_commandHandler.reset();
+    m_mpvManager.reset();
+}
+
+bool HeadlessHost::Initialize()
+{
+    m_transport = std::make_shared<MemoryEventTransport>([this]() { Wake(false); });
+    m_transport->SetObserver([this](const MemoryEventTransport::Entry& entry) { OnEventPosted(entry); });
+    EventEmitter::SetTransport(m_transport);
+
+    m_mpvManager = std::make_unique<MPVManager>(m_settings);
+    if (!m_mpvManager->Initialize(0, [this]() { Wake(true); })) {
+        return false;
+    }
+
+    m_commandHandler = std::make_unique<CommandHandler>();
+    RegisterCommandHandlers();
+    ResetStats();
+    return true;
+}
+
+// Same bindings as AppManager for the playback commands, so the dispatch path is identical.
+void HeadlessHost::RegisterCommandHandlers()
+{
+    m_commandHandler->RegisterCommand(Commands::PLAY, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->Play(payload.get<PlayPayload>());
+    });
+
+    m_commandHandler->RegisterCommand(Commands::STOP, [this](const json& /*payload*/, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->Stop();
+    });
+
+    m_commandHandler->RegisterCommand(Commands::TOGGLE_PAUSE, [this](const json& /*payload*/, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->TogglePause();
+    });
+
+    m_commandHandler->RegisterCommand(Commands::SEEK, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->Seek(payload.get<SeekPayload>());
+    });
+
+    m_commandHandler->RegisterCommand(Commands::SET_VOLUME, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->SetVolume(payload.get<SetVolumePayload>());
+    });
+
+    m_commandHandler->RegisterCommand(Commands::TOGGLE_MUTE, [this](const json& /*payload*/, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->ToggleMute();
+    });
+
+    m_commandHandler->RegisterCommand(Commands::SET_PROPERTY, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->SetProperty(payload.get<SetPropertyPayload>());
+    });
+
+    m_commandHandler->RegisterCommand(Commands::LOAD_SUBTITLE, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+        m_mpvManager->LoadSubtitle(payload.get<LoadSubtitlePayload>());
+    });
+
+    // Only queues the request; the thumbnail service resolves it from its own thread.
+    m_commandHandler->RegisterRequest(Commands::GET_THUMBNAIL, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetThumbnail(payload.get<GetThumbnailPayload>(), request);
+    });
+
+    m_commandHandler->RegisterRequest(Commands::GET_SPRITE_SHEETS, [this](const json& /*payload*/, const RequestHandle& request) {
+        m_mpvManager->GetSpriteSheets(request);
+    });
+
+    // Reads and encodes a sheet of a few hundred KB, off the UI thread.
+    m_commandHandler->RegisterRequest(Commands::GET_SPRITE_SHEET, [this](const json& payload, const RequestHandle& request) {
+        m_mpvManager->GetSpriteSheet(payload.get<GetSpriteSheetPayload>(), request);
+    }, { CommandAffinity::AnyThread, DEFAULT_REQUEST_TIMEOUT, "" });
+
+    m_commandHandler->RegisterRequest(Commands::GET_CHAPTER_HINTS, [this](const json& /*payload*/, const RequestHandle& request) {
+        m_mpvManager->GetChapterHints(request);
+    });
+}
+
+void HeadlessHost::Send(const std::string& command, const json& payload)
+{
+    PendingEffect effect{command, Clock::now(), nullptr};
+    if (command == Commands::PLAY) {
+        effect.matches = [](const std::string& name, const json& p) {
+            return IsPropertyChange(name, p, "duration") && !p["value"].is_null();
+        };
+    } else if (command == Commands::SEEK) {
+        double target = payload.value("time", 0.0);
+        effect.matches = [target](const std::string& name, const json& p) {
+            return IsPropertyChange(name, p, "time-pos") && p["value"].is_number() && std::abs(p["value"].get<double>() - target) < 1.0;
+        };
+    } else if (command == Commands::SET_VOLUME) {
+        effect.matches = [](const std::string& name, const json& p) { return IsPropertyChange(name, p, "volume"); };
+    } else if (command == Commands::TOGGLE_PAUSE) {
+        effect.matches = [](const std::string& name, const json& p) { return IsPropertyChange(name, p, "pause"); };
+    } else if (command == Commands::TOGGLE_MUTE) {
+        effect.matches = [](const std::string& name, const json& p) { return IsPropertyChange(name, p, "mute"); };
+    } else if (command == Commands::SET_PROPERTY) {
+        std::string property = payload.value("property", "");
+        if (IsObservedProperty(property)) {
+            effect.matches = [property](const std::string& name, const json& p) {
+                return name == Events::PROPERTY_CHANGE && p.value("property", "") == property;
+            };
+        }
+    } else if (command == Commands::STOP) {
+        effect.matches = [](const std::string& name, const json&) { return name == Events::PLAYBACK_ENDED; };
+    }
+
+    std::string message = json{{"command", command}, {"payload", payload}}.dump();
+    m_commandsSent++;
+    m_commandBytes += message.size();
+
+    if (effect.matches) {
+        effect.sentAt = Clock::now();
+        m_pendingEffects.push_back(std::move(effect));
+    }
+    // UI-thread handlers run inline, so effects can already arrive inside this call.
+    m_commandHandler->HandleCommand(Utf8ToWstring(message));
+}
+
+std::string HeadlessHost::SendRequest(const std::string& command, const json& payload)
+{
+    std::string messageId = "headless-" + std::to_string(++m_nextMessageId);
+    std::string message = json{{"command", command}, {"messageId", messageId}, {"payload", payload}}.dump();
+    m_commandsSent++;
+    m_commandBytes += message.size();
+    m_commandHandler->HandleCommand(Utf8ToWstring(message));
+    return messageId;
+}
+
+const HeadlessHost::Response* HeadlessHost::GetResponse(const std::string& messageId) const
+{
+    auto it = m_responses.find(messageId);
+    return it == m_responses.end() ? nullptr : &it->second;
+}
+
+bool HeadlessHost::CanHandle(const std::string& command) const
+{
+    return m_commandHandler->HasHandler(command);
+}
+
+void HeadlessHost::Wake(bool mpv)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (mpv) m_mpvWakeup = true;
+        else m_flushRequested = true;
+    }
+    m_wakeCv.notify_one();
+}
+
+void HeadlessHost::Pump(std::chrono::milliseconds duration)
+{
+    PumpUntil([]() { return false; }, duration);
+}
+
+bool HeadlessHost::PumpUntil(const std::function<bool()>& predicate, std::chrono::milliseconds timeout)
+{
+    const Clock::time_point deadline = Clock::now() + timeout;
+    while (!predicate()) {
+        bool mpvWakeup = false;
+        bool flushRequested = false;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCv.wait_until(lock, deadline, [this]() { return m_mpvWakeup || m_flushRequested; });
+            std::swap(mpvWakeup, m_mpvWakeup);
+            std::swap(flushRequested, m_flushRequested);
+        }
+        if (mpvWakeup) m_mpvManager->HandleEvents();
+        if (flushRequested) EventEmitter::FlushOutbound();
+        ExpireEffects(Clock::now());
+        if (Clock::now() >= deadline) return predicate();
+    }
+    return true;
+}
+
+void HeadlessHost::OnEventPosted(const MemoryEventTransport::Entry& entry)
+{
+    json message = json::parse(entry.message, nullptr, false);
+    if (message.is_discarded()) return;
+    std::string eventName = message.value("event", "");
+    const json& payload = message["payload"];
+    m_eventCounts[eventName]++;
+    m_lastEvents[eventName] = payload;
+
+    if (eventName == Events::PROPERTY_CHANGE && payload.contains("property")) {
+        m_lastProperties[payload["property"].get<std::string>()] = payload.value("value", json());
+    }
+    if (eventName == Events::COMMAND_RESPONSE && payload.contains("messageId")) {
+        m_responses[payload["messageId"].get<std::string>()] = {payload, entry.at};
+    }
+
+    for (auto it = m_pendingEffects.begin(); it != m_pendingEffects.end();) {
+        if (it->matches(eventName, payload)) {
+            long long us = std::chrono::duration_cast<std::chrono::microseconds>(entry.at - it->sentAt).count();
+            m_latencies[it->command].samplesUs.push_back(us);
+            it = m_pendingEffects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void HeadlessHost::ExpireEffects(Clock::time_point now)
+{
+    for (auto it = m_pendingEffects.begin(); it != m_pendingEffects.end();) {
+        if (now - it->sentAt > EFFECT_TIMEOUT) {
+            m_latencies[it->command].missed++;
+            it = m_pendingEffects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+json HeadlessHost::GetLastProperty(const std::string& property) const
+{
+    auto it = m_lastProperties.find(property);
+    return it == m_lastProperties.end() ? json() : it->second;
+}
+
+json HeadlessHost::GetLastEvent(const std::string& eventName) const
+{
+    auto it = m_lastEvents.find(eventName);
+    return it == m_lastEvents.end() ? json() : it->second;
+}
+
+void HeadlessHost::ResetStats()
+{
+    m_statsStart = Clock::now();
+    m_commandsSent = 0;
+    m_commandBytes = 0;
+    m_eventCountBase = m_transport->GetMessageCount();
+    m_eventBytesBase = m_transport->GetByteCount();
+    m_eventCounts.clear();
+    m_pendingEffects.clear();
+    m_latencies.clear();
+}
+
+json HeadlessHost::GetReport() const
+{
+    const double elapsedSec = std::chrono::duration<double>(Clock::now() - m_statsStart).count();
+    const unsigned long long events = m_transport->GetMessageCount() - m_eventCountBase;
+    const unsigned long long eventBytes = m_transport->GetByteCount() - m_eventBytesBase;
+
+    json latency = json::object();
+    for (const auto& [command, stats] : m_latencies) {
+        std::vector<long long> sorted = stats.samplesUs;
+        std::sort(sorted.begin(), sorted.end());
+        double totalUs = 0;
+        for (long long us : sorted) totalUs += us;
+        // Effects still pending at report time never arrived either.
+        unsigned long long pending = std::count_if(m_pendingEffects.begin(), m_pendingEffects.end(),
+            [&](const PendingEffect& e) { return e.command == command; });
+        latency[command] = {
+            {"observed", sorted.size()},
+            {"missed", stats.missed + pending},
+            {"meanMs", sorted.empty() ? 0.0 : totalUs / sorted.size() / 1000.0},
+            {"p50Ms", Percentile(sorted, 0.50)},
+            {"p95Ms", Percentile(sorted, 0.95)},
+            {"maxMs", sorted.empty() ? 0.0 : sorted.back() / 1000.0}
+        };
+    }
+
+    return {
+        {"elapsedSec", elapsedSec},
+        {"commands", {
+            {"sent", m_commandsSent},
+            {"bytes", m_commandBytes},
+            {"perSec", elapsedSec > 0 ? m_commandsSent / elapsedSec : 0.0}
+        }},
+        {"events", {
+            {"posted", events},
+            {"bytes", eventBytes},
+            {"perSec", elapsedSec > 0 ? events / elapsedSec : 0.0},
+            {"bytesPerSec", elapsedSec > 0 ? eventBytes / elapsedSec : 0.0},
+            {"byType", m_eventCounts}
+        }},
+        {"latency", latency},
+        {"commandStats", m_commandHandler->GetStats()},
+        {"outbound", EventEmitter::GetOutboundStats()}
+    };
+}
@@ -0,0 +1,110 @@
+#ifndef HEADLESS_HOST_H
+#define HEADLESS_HOST_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include "memory_event_transport.h"
+#include "../settings/settings_manager.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+class MPVManager;
+
+namespace WebViewProtocol {
+    class CommandHandler;
+}
+
+// Runs the mpv bridge without a window or WebView2: commands go through the
+// real CommandHandler, mpv renders to vo=null/ao=null, and outbound events land
+// in a MemoryEventTransport. Everything runs on the thread that owns the host;
+// Pump() plays the role of the Win32 message loop.
+class HeadlessHost
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Inbound commands without an observed effect within this window count as missed.
+    static constexpr std::chrono::milliseconds EFFECT_TIMEOUT{5000};
+
+    HeadlessHost();
+    ~HeadlessHost();
+
+    // Settings handed to MPVManager; adjust before Initialize().
+    AppSettings& GetSettings() { return m_settings; }
+
+    bool Initialize();
+
+    struct Response {
+        json payload;  // command-response payload: messageId plus result or error
+        Clock::time_point at;
+    };
+
+    // Serializes the command the way the frontend does and feeds it to HandleCommand.
+    void Send(const std::string& command, const json& payload);
+    // Same, with a fresh messageId; the reply shows up in GetResponse().
+    std::string SendRequest(const std::string& command, const json& payload);
+    const Response* GetResponse(const std::string& messageId) const;
+    bool CanHandle(const std::string& command) const;
+
+    // Services mpv wakeups and flush requests for the given duration.
+    void Pump(std::chrono::milliseconds duration);
+    // Pumps until the predicate holds or the timeout expires.
+    bool PumpUntil(const std::function<bool()>& predicate, std::chrono::milliseconds timeout);
+
+    // Latest value seen in a property-change event, or null.
+    json GetLastProperty(const std::string& property) const;
+    // Payload of the latest event with this name, or null.
+    json GetLastEvent(const std::string& eventName) const;
+
+    void ResetStats();
+    json GetReport() const;
+
+private:
+    struct PendingEffect {
+        std::string command;
+        Clock::time_point sentAt;
+        std::function<bool(const std::string& eventName, const json& payload)> matches;
+    };
+
+    struct LatencyStats {
+        std::vector<long long> samplesUs;
+        unsigned long long missed = 0;
+    };
+
+    void RegisterCommandHandlers();
+    void OnEventPosted(const MemoryEventTransport::Entry& entry);
+    void ExpireEffects(Clock::time_point now);
+    void Wake(bool mpv);
+
+    AppSettings m_settings;
+    std::unique_ptr<MPVManager> m_mpvManager;
+    std::unique_ptr<WebViewProtocol::CommandHandler> m_commandHandler;
+    std::shared_ptr<MemoryEventTransport> m_transport;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    bool m_mpvWakeup = false;
+    bool m_flushRequested = false;
+
+    Clock::time_point m_statsStart;
+    unsigned long long m_commandsSent = 0;
+    unsigned long long m_commandBytes = 0;
+    unsigned long long m_eventCountBase = 0;
+    unsigned long long m_eventBytesBase = 0;
+    std::map<std::string, unsigned long long> m_eventCounts;
+    std::map<std::string, json> m_lastProperties;
+    std::map<std::string, json> m_lastEvents;
+    std::vector<PendingEffect> m_pendingEffects;
+    unsigned long long m_nextMessageId = 0;
+    std::map<std::string, Response> m_responses;
+    std::map<std::string, LatencyStats> m_latencies;
+};
+
+#endif // HEADLESS_HOST_H
@@ -0,0 +1,648 @@
+#include "headless_host.h"
+#include "bridge_replayer.h"
+#include "cache_simulation.h"
+#ifndef _WIN32
+#include "throttled_file_server.h"
+#endif
+#include "../webview_protocol/bridge_trace/bridge_trace.h"
+#include "../logger/logger.h"
+#include "../metrics/metrics.h"
+#include "../mpv/hwdec_probe.h"
+#include "../mpv/thumbnail_service.h"
+#include "../platform/platform.h"
+#include "../webview_protocol/transport_constants.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <set>
+
+using namespace WebViewProtocol;
+
+struct HeadlessOptions {
+    std::string media;
+    std::string subtitle;
+    std::string script;
+    std::string replay;
+    std::string record;
+    std::string playUrl;
+    double speed = 1.0;
+    std::string scenario = "all";
+    int seeks = 200;
+    int seekIntervalMs = 5;
+    int settleMs = 2000;
+    int playSeconds = 30;
+    uint64_t throttleKBps = 0;
+    bool qosLive = false;
+    bool cacheSimulation = false;
+    bool hwdecProbe = false;
+    std::string hwdecCandidates;
+    std::vector<std::string> episodes;
+    std::string seriesId;
+    bool jsonOutput = false;
+};
+
+static void PrintUsage()
+{
+    std::cerr <<
+        "usage: stremato_headless <media-file> [options]\n"
+        "  --scenario NAME      play | seek-storm | properties | subtitle | qos | thumbnails | sprites |\n"
+        "                       intros | all (default all)\n"
+        "  --script FILE        JSON lines {\"command\", \"payload\", \"waitMs\"} instead of a scenario\n"
+        "  --replay FILE        replay the commands of a bridge trace instead of a scenario\n"
+        "  --speed X            replay pace relative to the recording; 0 = no waits (default 1)\n"
+        "  --play-url URL       replace the url of replayed play commands (defaults to <media-file>)\n"
+        "  --record FILE        write this session's bridge traffic to a trace\n"
+        "  --subtitle FILE      subtitle loaded by the subtitle scenario\n"
+        "  --seeks N            seeks in the storm (default 200)\n"
+        "  --seek-interval MS   delay between storm seeks (default 5)\n"
+        "  --settle MS          pump time after the last command (default 2000)\n"
+        "  --play-seconds N     how long the qos scenario plays before stopping, and the longest the\n"
+        "                       sprites and intros scenarios wait for their results (default 30)\n"
+#ifndef _WIN32
+        "  --throttle KBPS      serve <media-file> over local HTTP capped at KBPS kilobytes/s\n"
+#endif
+        "  --qos-live           enable periodic playback-qos events\n"
+        "  --cache-sim          run the demuxer cache policy against simulated bitrates and exit\n"
+        "  --hwdec-probe        probe hardware decoders and write the hwdec table; with <media-file>,\n"
+        "                       then play it with the table applied\n"
+        "  --hwdec-candidates L comma-separated hwdec values to probe instead of the platform list\n"
+        "  --episode FILE       another episode of <media-file>'s series for the intros scenario; repeatable\n"
+        "  --series ID          series id sent with play commands (default: guessed from file names)\n"
+        "  --json               print the report as JSON\n";
+}
+
+static bool ParseArgs(int argc, char** argv, HeadlessOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--scenario") options.scenario = next();
+        else if (arg == "--script") options.script = next();
+        else if (arg == "--replay") options.replay = next();
+        else if (arg == "--record") options.record = next();
+        else if (arg == "--play-url") options.playUrl = next();
+        else if (arg == "--speed") options.speed = std::atof(next().c_str());
+        else if (arg == "--subtitle") options.subtitle = next();
+        else if (arg == "--seeks") options.seeks = std::atoi(next().c_str());
+        else if (arg == "--seek-interval") options.seekIntervalMs = std::atoi(next().c_str());
+        else if (arg == "--settle") options.settleMs = std::atoi(next().c_str());
+        else if (arg == "--play-seconds") options.playSeconds = std::atoi(next().c_str());
+#ifndef _WIN32
+        else if (arg == "--throttle") options.throttleKBps = std::strtoull(next().c_str(), nullptr, 10);
+#endif
+        else if (arg == "--qos-live") options.qosLive = true;
+        else if (arg == "--cache-sim") options.cacheSimulation = true;
+        else if (arg == "--hwdec-probe") options.hwdecProbe = true;
+        else if (arg == "--hwdec-candidates") options.hwdecCandidates = next();
+        else if (arg == "--episode") options.episodes.push_back(next());
+        else if (arg == "--series") options.seriesId = next();
+        else if (arg == "--json") options.jsonOutput = true;
+        else if (!arg.empty() && arg[0] != '-' && options.media.empty()) options.media = arg;
+        else return false;
+    }
+    return !options.media.empty() || !options.script.empty() || !options.replay.empty() || options.cacheSimulation || options.hwdecProbe;
+}
+
+// Loads the file and waits until mpv reports its duration.
+static double StartPlayback(HeadlessHost& host, const std::string& media, const std::string& seriesId = "")
+{
+    json play = {{"url", media}, {"startTime", 0.0}};
+    if (!seriesId.empty()) play["seriesId"] = seriesId;
+    host.Send(Commands::PLAY, play);
+    host.PumpUntil([&]() { return host.GetLastProperty("duration").is_number(); }, std::chrono::seconds(10));
+    json duration = host.GetLastProperty("duration");
+    return duration.is_number() ? duration.get<double>() : 0.0;
+}
+
+static void RunSeekStorm(HeadlessHost& host, const HeadlessOptions& options, double duration)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> position(0.0, (std::max)(duration * 0.9, 1.0));
+    for (int i = 0; i < options.seeks; i++) {
+        host.Send(Commands::SEEK, {{"time", position(rng)}});
+        host.Pump(std::chrono::milliseconds(options.seekIntervalMs));
+    }
+}
+
+static void RunProperties(HeadlessHost& host)
+{
+    for (int i = 0; i < 20; i++) {
+        host.Send(Commands::SET_PROPERTY, {{"property", "pause"}, {"value", i % 2 ? "no" : "yes"}});
+        host.Pump(std::chrono::milliseconds(20));
+        host.Send(Commands::SET_VOLUME, {{"volume", 30 + i}});
+        host.Pump(std::chrono::milliseconds(20));
+        host.Send(Commands::TOGGLE_MUTE, json::object());
+        host.Pump(std::chrono::milliseconds(20));
+    }
+    host.Send(Commands::SET_PROPERTY, {{"property", "pause"}, {"value", "no"}});
+}
+
+static void RunSubtitle(HeadlessHost& host, const HeadlessOptions& options)
+{
+    if (options.subtitle.empty()) {
+        std::cerr << "subtitle scenario skipped: no --subtitle given\n";
+        return;
+    }
+    for (int i = 0; i < 10; i++) {
+        host.Send(Commands::LOAD_SUBTITLE, {{"url", options.subtitle}});
+        host.Pump(std::chrono::milliseconds(50));
+    }
+}
+
+// Plays undisturbed so the QoS monitor sees only what the source does.
+static void RunQos(HeadlessHost& host, const HeadlessOptions& options)
+{
+    host.Pump(std::chrono::seconds(options.playSeconds));
+}
+
+static json LatencySummary(std::vector<double> ms)
+{
+    std::sort(ms.begin(), ms.end());
+    auto at = [&](double p) { return ms.empty() ? 0.0 : ms[std::min(ms.size() - 1, static_cast<size_t>(p * ms.size()))]; };
+    return {{"count", ms.size()}, {"p50Ms", at(0.50)}, {"p95Ms", at(0.95)}, {"maxMs", ms.empty() ? 0.0 : ms.back()}};
+}
+
+// Hovers across the first minutes the way a pointer sweeps a seekbar: forward,
+// back over the same spots, then forward again. Each step waits for its reply,
+// so latency is per request. Every bucket after its first request must be
+// served from the cache; repeatMisses above zero fails the scenario.
+static json RunThumbnails(HeadlessHost& host, double duration)
+{
+    const double span = (std::min)(duration, 120.0);
+    std::vector<double> positions;
+    for (double t = 0.0; t < span; t += 1.7) positions.push_back(t);
+    std::vector<double> sweep = positions;
+    sweep.insert(sweep.end(), positions.rbegin(), positions.rend());
+    sweep.insert(sweep.end(), positions.begin(), positions.end());
+
+    std::vector<double> hitMs, missMs;
+    std::set<int64_t> requested;
+    int failed = 0;
+    int repeatMisses = 0;
+    unsigned long long bytes = 0;
+    for (double time : sweep) {
+        const auto sentAt = HeadlessHost::Clock::now();
+        std::string id = host.SendRequest(Commands::GET_THUMBNAIL, {{"time", time}});
+        host.PumpUntil([&]() { return host.GetResponse(id) != nullptr; }, std::chrono::seconds(6));
+        const HeadlessHost::Response* response = host.GetResponse(id);
+        const bool repeated = !requested.insert(ThumbnailService::BucketOf(time)).second;
+        if (!response || !response->payload.contains("result")) {
+            failed++;
+            continue;
+        }
+        const json& result = response->payload["result"];
+        const bool cached = result.value("cached", false);
+        double ms = std::chrono::duration<double, std::milli>(response->at - sentAt).count();
+        (cached ? hitMs : missMs).push_back(ms);
+        if (repeated && !cached) repeatMisses++;
+        bytes += result.value("data", "").size();
+        host.Pump(std::chrono::milliseconds(60));
+    }
+    return {
+        {"requests", sweep.size()},
+        {"hits", LatencySummary(hitMs)},
+        {"misses", LatencySummary(missMs)},
+        {"failed", failed},
+        {"repeatMisses", repeatMisses},
+        {"hitRatio", sweep.empty() ? 0.0 : static_cast<double>(hitMs.size()) / sweep.size()},
+        {"base64Bytes", bytes}
+    };
+}
+
+// Plays until the background job has covered the whole file or --play-seconds
+// runs out, then loads the same file again: its sheets should now come from
+// the disk cache at once, before playback is steady.
+static json RunSprites(HeadlessHost& host, const HeadlessOptions& options)
+{
+    const auto start = HeadlessHost::Clock::now();
+    auto secondsSince = [](HeadlessHost::Clock::time_point from) {
+        return std::chrono::duration<double>(HeadlessHost::Clock::now() - from).count();
+    };
+    double firstSheetSec = -1.0;
+    host.PumpUntil([&]() {
+        json sheets = host.GetLastEvent(Events::SPRITE_SHEETS);
+        if (sheets.is_null()) return false;
+        if (firstSheetSec < 0.0) firstSheetSec = secondsSince(start);
+        return sheets.value("complete", false);
+    }, std::chrono::seconds(options.playSeconds));
+    const double waitedSec = secondsSince(start);
+    json generated = host.GetLastEvent(Events::SPRITE_SHEETS);
+    host.Send(Commands::STOP, json::object());
+    host.Pump(std::chrono::milliseconds(500));
+    json qos = host.GetLastEvent(Events::PLAYBACK_QOS_REPORT);
+
+    const auto reloadAt = HeadlessHost::Clock::now();
+    host.Send(Commands::PLAY, {{"url", options.media}, {"startTime", 0.0}});
+    json cached;
+    while (cached.is_null() && secondsSince(reloadAt) < 10.0) {
+        std::string id = host.SendRequest(Commands::GET_SPRITE_SHEETS, json::object());
+        host.PumpUntil([&]() { return host.GetResponse(id) != nullptr; }, std::chrono::seconds(2));
+        const HeadlessHost::Response* response = host.GetResponse(id);
+        if (response && response->payload.contains("result") && response->payload["result"].value("tiles", 0) > 0) {
+            cached = response->payload["result"];
+        } else {
+            host.Pump(std::chrono::milliseconds(20));
+        }
+    }
+    const double reloadMs = secondsSince(reloadAt) * 1000.0;
+
+    size_t sheetBytes = 0;
+    if (!cached.is_null()) {
+        std::string id = host.SendRequest(Commands::GET_SPRITE_SHEET, {{"hash", cached["hash"]}, {"sheet", 0}});
+        host.PumpUntil([&]() { return host.GetResponse(id) != nullptr; }, std::chrono::seconds(5));
+        const HeadlessHost::Response* response = host.GetResponse(id);
+        if (response && response->payload.contains("result")) sheetBytes = response->payload["result"].value("data", "").size();
+    }
+
+    json report = {
+        {"complete", !generated.is_null() && generated.value("complete", false)},
+        {"tiles", generated.is_null() ? 0 : generated.value("tiles", 0)},
+        {"sheets", generated.is_null() ? 0 : generated.value("sheets", 0)},
+        {"firstSheetSec", firstSheetSec},
+        {"waitedSec", waitedSec},
+        {"reloadCached", !cached.is_null()},
+        {"reloadMs", reloadMs},
+        {"sheet0Base64Bytes", sheetBytes}
+    };
+    if (!qos.is_null()) {
+        report["droppedFrames"] = qos["droppedFrames"].get<long long>() + qos["decoderDroppedFrames"].get<long long>();
+        report["rebuffers"] = qos["rebuffers"];
+        report["stalls"] = qos["stalls"];
+    }
+    return report;
+}
+
+// Plays <media-file> and then every --episode as one series, each until its
+// analysis is done or --play-seconds runs out, then plays <media-file> again:
+// its ranges, found once a later episode matched it, should come from the
+// cache at once.
+static json RunIntros(HeadlessHost& host, const HeadlessOptions& options)
+{
+    static Metrics::Counter& s_analyses = Metrics::GetCounter("intros.analyses");
+    static Metrics::Counter& s_failures = Metrics::GetCounter("intros.failures");
+    auto secondsSince = [](HeadlessHost::Clock::time_point from) {
+        return std::chrono::duration<double>(HeadlessHost::Clock::now() - from).count();
+    };
+
+    std::vector<std::string> episodes = { options.media };
+    for (const std::string& episode : options.episodes) {
+        episodes.push_back(episode.find("://") == std::string::npos ? std::filesystem::absolute(episode).string() : episode);
+    }
+    json results = json::array();
+    for (size_t i = 0; i < episodes.size(); i++) {
+        const auto start = HeadlessHost::Clock::now();
+        const uint64_t attempts = s_analyses.Value() + s_failures.Value();
+        // The first episode is already playing.
+        if (i > 0 && StartPlayback(host, episodes[i], options.seriesId) <= 0.0) {
+            results.push_back({{"episode", episodes[i]}, {"error", "playback did not start"}});
+            continue;
+        }
+        host.PumpUntil([&]() { return s_analyses.Value() + s_failures.Value() > attempts; }, std::chrono::seconds(options.playSeconds));
+        const double analysisSec = secondsSince(start);
+        host.Pump(std::chrono::milliseconds(200));
+        json hints = host.GetLastEvent(Events::CHAPTER_HINTS);
+        results.push_back({
+            {"episode", std::filesystem::path(episodes[i]).filename().string()},
+            {"analysisSec", analysisSec},
+            {"complete", !hints.is_null() && hints.value("complete", false)},
+            {"chapters", hints.is_null() ? json::array() : hints["chapters"]}
+        });
+        host.Send(Commands::STOP, json::object());
+        host.Pump(std::chrono::milliseconds(300));
+    }
+
+    const auto reloadAt = HeadlessHost::Clock::now();
+    host.Send(Commands::PLAY, {{"url", options.media}, {"startTime", 0.0}, {"seriesId", options.seriesId}});
+    json cached;
+    while (cached.is_null() && secondsSince(reloadAt) < 10.0) {
+        std::string id = host.SendRequest(Commands::GET_CHAPTER_HINTS, json::object());
+        host.PumpUntil([&]() { return host.GetResponse(id) != nullptr; }, std::chrono::seconds(2));
+        const HeadlessHost::Response* response = host.GetResponse(id);
+        if (response && response->payload.contains("result") && response->payload["result"].value("complete", false)) {
+            cached = response->payload["result"];
+        } else {
+            host.Pump(std::chrono::milliseconds(20));
+        }
+    }
+    return {
+        {"episodes", results},
+        {"reloadCached", !cached.is_null()},
+        {"reloadMs", secondsSince(reloadAt) * 1000.0},
+        {"reloadChapters", cached.is_null() ? json::array() : cached["chapters"]}
+    };
+}
+
+static bool RunScript(HeadlessHost& host, const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot open script " << path << "\n";
+        return false;
+    }
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        json step = json::parse(line, nullptr, false);
+        if (step.is_discarded() || !step.contains("command")) {
+            std::cerr << path << ":" << lineNo << ": invalid step\n";
+            return false;
+        }
+        host.Send(step["command"].get<std::string>(), step.value("payload", json::object()));
+        host.Pump(std::chrono::milliseconds(step.value("waitMs", 0)));
+    }
+    return true;
+}
+
+static void PrintCacheSimulation(const json& result)
+{
+    const double mib = 1024.0 * 1024.0;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(8) << "memory" << std::setw(13) << "bitrate" << std::setw(9) << "source"
+              << std::right << std::setw(11) << "fwd MiB" << std::setw(10) << "back MiB" << std::setw(11) << "readahead" << "\n";
+    for (const json& entry : result["matrix"]) {
+        std::cout << std::left << std::setw(8) << entry["memory"].get<std::string>()
+                  << std::setw(13) << entry["bitrate"].get<std::string>()
+                  << std::setw(9) << (entry["network"].get<bool>() ? "network" : "local") << std::right
+                  << std::setw(11) << entry["maxBytes"].get<double>() / mib
+                  << std::setw(10) << entry["maxBackBytes"].get<double>() / mib
+                  << std::setw(10) << entry["readaheadSecs"].get<double>() << "s\n";
+    }
+    std::cout << "\nmid-stream timeline\n";
+    for (const json& entry : result["timeline"]) {
+        std::cout << std::right << std::setw(5) << entry["atSec"].get<int>() << "s  " << std::left << std::setw(12)
+                  << entry["event"].get<std::string>() << std::setprecision(1) << std::right << std::setw(6)
+                  << entry["effectiveBitrate"].get<double>() / mib << " MiB/s  " << std::setprecision(0);
+        if (entry["applied"].get<bool>()) {
+            const json& d = entry["decision"];
+            std::cout << "apply fwd " << d["maxBytes"].get<double>() / mib << " MiB, back " << d["maxBackBytes"].get<double>() / mib
+                      << " MiB, readahead " << d["readaheadSecs"].get<double>() << "s\n";
+        } else {
+            std::cout << "keep\n";
+        }
+    }
+    for (const json& violation : result["violations"]) std::cout << "VIOLATION " << violation.get<std::string>() << "\n";
+}
+
+// Probes synchronously with the table path, candidates and fingerprint
+// MPVManager uses, so the session that follows applies the result.
+static json RunHwdecProbe(const HeadlessOptions& options)
+{
+    std::vector<HwdecProbe::Candidate> candidates = HwdecProbe::ParseCandidates(options.hwdecCandidates);
+    mpv_handle* mpv = mpv_create();
+    if (!mpv) return nullptr;
+    mpv_set_option_string(mpv, "vo", "null");
+    mpv_set_option_string(mpv, "ao", "null");
+    std::string fingerprint = mpv_initialize(mpv) >= 0 ? HwdecProbe::Fingerprint(mpv, candidates) : "";
+    mpv_terminate_destroy(mpv);
+    if (fingerprint.empty()) return nullptr;
+
+    const std::filesystem::path cfgDir = Platform::GetExecutableDirectory() / "portable_config";
+    HwdecProbe probe(cfgDir / "hwdec-probe", candidates);
+    HwdecTable table = probe.Run(fingerprint);
+    table.Save(cfgDir / "hwdec-table.json");
+    return table;
+}
+
+static void PrintHwdecTable(const json& table)
+{
+    for (const auto& [codec, result] : table["codecs"].items()) {
+        std::cout << std::left << std::setw(12) << codec << std::setw(14) << result["hwdec"].get<std::string>();
+        for (const auto& [hwdec, outcome] : result["attempts"].items()) std::cout << " " << hwdec << "=" << outcome.get<std::string>();
+        std::cout << "\n";
+    }
+    for (const auto& [codec, reason] : table["skipped"].items()) {
+        std::cout << std::left << std::setw(12) << codec << "skipped: " << reason.get<std::string>() << "\n";
+    }
+}
+
+static void PrintReport(const json& report)
+{
+    const json& events = report["events"];
+    if (report.contains("replay")) {
+        const json& replay = report["replay"];
+        std::cout << "replayed       " << replay["commandsReplayed"] << " commands from a "
+                  << replay["recordedDurationSec"].get<double>() << " s trace\n";
+        for (const auto& [name, count] : replay["commandsSkipped"].items()) {
+            std::cout << "  skipped " << std::left << std::setw(20) << name << count << "\n";
+        }
+        for (const auto& [name, count] : replay["recordedEvents"].items()) {
+            std::cout << "  recorded " << std::left << std::setw(19) << name << count << "\n";
+        }
+    }
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "elapsed        " << report["elapsedSec"].get<double>() << " s\n";
+    std::cout << "commands       " << report["commands"]["sent"] << " (" << report["commands"]["bytes"] << " bytes)\n";
+    std::cout << "events         " << events["posted"] << " (" << events["bytes"] << " bytes)\n";
+    std::cout << "events/sec     " << events["perSec"].get<double>() << "\n";
+    std::cout << "bytes/sec      " << events["bytesPerSec"].get<double>() << "\n";
+    for (const auto& [name, count] : events["byType"].items()) {
+        std::cout << "  " << std::left << std::setw(20) << name << count << "\n";
+    }
+    if (report.contains("qos")) {
+        const json& qos = report["qos"];
+        std::cout << "\nplayback qos (" << qos["endReason"].get<std::string>() << ")\n";
+        std::cout << "  played        " << qos["playedSec"].get<double>() << " s of " << qos["wallSec"].get<double>() << " s\n";
+        std::cout << "  startup       " << qos["startupMs"].get<long long>() << " ms\n";
+        std::cout << "  rebuffers     " << qos["rebuffers"] << " (" << qos["rebufferSec"].get<double>() << " s)\n";
+        std::cout << "  stalls        " << qos["stalls"] << " (" << qos["stallSec"].get<double>() << " s)\n";
+        std::cout << "  dropped       " << qos["droppedFrames"] << " vo, " << qos["decoderDroppedFrames"] << " decoder\n";
+        std::cout << "  cache         mean " << qos["meanCacheSec"].get<double>() << " s, min " << qos["minCacheSec"].get<double>() << " s\n";
+    }
+    if (report.contains("sprites")) {
+        const json& sp = report["sprites"];
+        std::cout << "\nsprite sheets (" << (sp["complete"].get<bool>() ? "complete" : "incomplete") << ")\n";
+        std::cout << "  tiles         " << sp["tiles"] << " in " << sp["sheets"] << " sheets\n";
+        std::cout << "  first sheet   " << sp["firstSheetSec"].get<double>() << " s, waited " << sp["waitedSec"].get<double>() << " s\n";
+        if (sp.contains("droppedFrames")) {
+            std::cout << "  playback      " << sp["droppedFrames"] << " dropped frames, " << sp["rebuffers"] << " rebuffers, "
+                      << sp["stalls"] << " stalls\n";
+        }
+        std::cout << "  reload        " << (sp["reloadCached"].get<bool>() ? "cached" : "not cached") << " after "
+                  << sp["reloadMs"].get<double>() << " ms, sheet 0 " << sp["sheet0Base64Bytes"] << " base64 bytes\n";
+    }
+    if (report.contains("intros")) {
+        const json& in = report["intros"];
+        std::cout << "\nintro detection\n";
+        auto printChapters = [](const json& chapters) {
+            if (chapters.empty()) std::cout << " none";
+            for (const json& c : chapters) {
+                std::cout << " " << c["kind"].get<std::string>() << " " << c["start"].get<double>() << "-" << c["end"].get<double>();
+            }
+            std::cout << "\n";
+        };
+        for (const json& e : in["episodes"]) {
+            std::cout << "  " << e["episode"].get<std::string>();
+            if (e.contains("error")) {
+                std::cout << ": " << e["error"].get<std::string>() << "\n";
+                continue;
+            }
+            std::cout << " (" << e["analysisSec"].get<double>() << " s, " << (e["complete"].get<bool>() ? "complete" : "incomplete") << "):";
+            printChapters(e["chapters"]);
+        }
+        std::cout << "  reload        " << (in["reloadCached"].get<bool>() ? "cached" : "not cached") << " after "
+                  << in["reloadMs"].get<double>() << " ms:";
+        printChapters(in["reloadChapters"]);
+    }
+    if (report.contains("thumbnails")) {
+        const json& t = report["thumbnails"];
+        std::cout << "\nthumbnails (" << t["requests"] << " requests, " << t["failed"] << " failed, "
+                  << t["repeatMisses"] << " repeated misses, hit ratio "
+                  << t["hitRatio"].get<double>() * 100.0 << "%)\n";
+        for (const char* kind : { "hits", "misses" }) {
+            const json& k = t[kind];
+            std::cout << "  " << std::left << std::setw(8) << kind << std::right << std::setw(5) << k["count"]
+                      << "  p50 " << k["p50Ms"].get<double>() << " ms, p95 " << k["p95Ms"].get<double>()
+                      << " ms, max " << k["maxMs"].get<double>() << " ms\n";
+        }
+    }
+    std::cout << "\ncommand-to-effect latency (ms)\n";
+    std::cout << std::left << std::setw(16) << "command" << std::right
+              << std::setw(9) << "observed" << std::setw(8) << "missed"
+              << std::setw(9) << "p50" << std::setw(9) << "p95" << std::setw(9) << "max" << "\n";
+    std::cout << std::setprecision(2);
+    for (const auto& [command, s] : report["latency"].items()) {
+        std::cout << std::left << std::setw(16) << command << std::right
+                  << std::setw(9) << s["observed"].get<unsigned long long>()
+                  << std::setw(8) << s["missed"].get<unsigned long long>()
+                  << std::setw(9) << s["p50Ms"].get<double>()
+                  << std::setw(9) << s["p95Ms"].get<double>()
+                  << std::setw(9) << s["maxMs"].get<double>() << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!ParseArgs(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+    if (options.cacheSimulation) {
+        json result = RunCacheSimulation();
+        if (options.jsonOutput) std::cout << result.dump(2) << "\n";
+        else PrintCacheSimulation(result);
+        return result["violations"].empty() ? 0 : 1;
+    }
+    if (!options.media.empty() && options.media.find("://") == std::string::npos) {
+        options.media = std::filesystem::absolute(options.media).string();
+    }
+
+    Logger::Init((Platform::GetExecutableDirectory() / "portable_config").wstring());
+
+    if (options.hwdecProbe) {
+        json table = RunHwdecProbe(options);
+        if (table.is_null()) {
+            std::cerr << "mpv initialization failed\n";
+            Logger::Cleanup();
+            return 1;
+        }
+        if (options.jsonOutput) std::cout << table.dump(2) << "\n";
+        else PrintHwdecTable(table);
+        if (options.media.empty() && options.script.empty() && options.replay.empty()) {
+            Logger::Cleanup();
+            return 0;
+        }
+    }
+
+#ifndef _WIN32
+    std::unique_ptr<ThrottledFileServer> server;
+    if (options.throttleKBps > 0 && !options.media.empty()) {
+        server = std::make_unique<ThrottledFileServer>(options.media, options.throttleKBps * 1024);
+        std::string error;
+        if (!server->Start(error)) {
+            std::cerr << "cannot serve " << options.media << ": " << error << "\n";
+            Logger::Cleanup();
+            return 1;
+        }
+        options.media = server->GetUrl();
+    }
+#endif
+
+    int exitCode = 0;
+    {
+        HeadlessHost host;
+        host.GetSettings().qosLiveEvents = options.qosLive;
+        // Without --hwdec-probe a session never starts a background probe.
+        host.GetSettings().hwdecProbe = options.hwdecProbe;
+        host.GetSettings().hwdecCandidates = options.hwdecCandidates;
+        // Sprite sheets are opt-in in the app as well.
+        host.GetSettings().spriteSheets = options.scenario == "sprites";
+        host.GetSettings().introDetection = options.scenario == "intros";
+        if (!host.Initialize()) {
+            std::cerr << "mpv initialization failed\n";
+            Logger::Cleanup();
+            return 1;
+        }
+
+        if (!options.record.empty() && !BridgeRecorder::Start(options.record)) {
+            std::cerr << "cannot write trace " << options.record << "\n";
+            Logger::Cleanup();
+            return 1;
+        }
+
+        BridgeReplayer replayer(host);
+        json thumbnails;
+        json sprites;
+        json intros;
+        if (!options.replay.empty()) {
+            ReplayOptions replayOptions;
+            replayOptions.speed = options.speed;
+            replayOptions.playUrlOverride = options.playUrl.empty() ? options.media : options.playUrl;
+            std::string error;
+            if (!replayer.Run(options.replay, replayOptions, error)) {
+                std::cerr << "replay failed: " << error << "\n";
+                exitCode = 1;
+            }
+        } else if (!options.script.empty()) {
+            if (!RunScript(host, options.script)) exitCode = 1;
+        } else {
+            const std::string& s = options.scenario;
+            double duration = StartPlayback(host, options.media, options.seriesId);
+            if (duration <= 0.0) {
+                std::cerr << "playback did not start: " << options.media << "\n";
+                exitCode = 1;
+            } else {
+                if (s == "seek-storm" || s == "all") RunSeekStorm(host, options, duration);
+                if (s == "properties" || s == "all") RunProperties(host);
+                if (s == "subtitle" || s == "all") RunSubtitle(host, options);
+                if (s == "qos") RunQos(host, options);
+                if (s == "thumbnails") {
+                    thumbnails = RunThumbnails(host, duration);
+                    if (thumbnails["failed"].get<int>() > 0 || thumbnails["repeatMisses"].get<int>() > 0) {
+                        std::cerr << "thumbnails: " << thumbnails["failed"] << " requests failed and "
+                                  << thumbnails["repeatMisses"] << " repeated buckets missed the cache\n";
+                        exitCode = 1;
+                    }
+                }
+                if (s == "sprites") sprites = RunSprites(host, options);
+                if (s == "intros") intros = RunIntros(host, options);
+                host.Send(Commands::STOP, json::object());
+            }
+        }
+        host.Pump(std::chrono::milliseconds(options.settleMs));
+
+        BridgeRecorder::Stop();
+
+        json report = host.GetReport();
+        if (!options.replay.empty()) report["replay"] = replayer.GetReport();
+        json qos = host.GetLastEvent(Events::PLAYBACK_QOS_REPORT);
+        if (!qos.is_null()) report["qos"] = qos;
+        if (!thumbnails.is_null()) report["thumbnails"] = thumbnails;
+        if (!sprites.is_null()) report["sprites"] = sprites;
+        if (!intros.is_null()) report["intros"] = intros;
+#ifndef _WIN32
+        if (server) report["throttle"] = {{"bytesPerSec", options.throttleKBps * 1024}, {"bytesSent", server->GetBytesSent()}};
+#endif
+        report["metrics"] = Metrics::Snapshot();
+        if (options.jsonOutput) std::cout << report.dump(2) << "\n";
+        else PrintReport(report);
+    }
+
+    Logger::Cleanup();
+    return exitCode;
+}
@@ -0,0 +1,26 @@
+#include "memory_event_transport.h"
+
+MemoryEventTransport::MemoryEventTransport(std::function<void()> onFlushRequested)
+    : m_dispatchThread(std::this_thread::get_id()), m_onFlushRequested(std::move(onFlushRequested))
+{
+}
+
+bool MemoryEventTransport::IsDispatchThread() const
+{
+    return std::this_thread::get_id() == m_dispatchThread;
+}
+
+void MemoryEventTransport::RequestFlush()
+{
+    m_flushRequests++;
+    if (m_onFlushRequested) m_onFlushRequested();
+}
+
+void MemoryEventTransport::Post(std::string message)
+{
+    Entry entry{Clock::now(), std::move(message)};
+    m_count++;
+    m_bytes += entry.message.size();
+    if (m_observer) m_observer(entry);
+    if (m_retain) m_messages.push_back(std::move(entry));
+}
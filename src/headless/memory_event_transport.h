@@ -0,0 +1,53 @@
+#ifndef MEMORY_EVENT_TRANSPORT_H
+#define MEMORY_EVENT_TRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include "../webview_protocol/event_emitter/event_emitter.h"
+
+// Captures everything the EventEmitter would post to WebView2. The thread
+// that constructs the transport is the dispatch thread; flush requests from
+// other threads are surfaced through the wake callback.
+class MemoryEventTransport : public WebViewProtocol::EventTransport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        Clock::time_point at;
+        std::string message;
+    };
+
+    explicit MemoryEventTransport(std::function<void()> onFlushRequested);
+
+    bool IsDispatchThread() const override;
+    void RequestFlush() override;
+    void Post(std::string message) override;
+
+    // Keep posted messages in memory; off by default so long runs only count.
+    void SetRetainMessages(bool retain) { m_retain = retain; }
+    void SetObserver(std::function<void(const Entry&)> observer) { m_observer = std::move(observer); }
+
+    const std::vector<Entry>& GetMessages() const { return m_messages; }
+    unsigned long long GetMessageCount() const { return m_count; }
+    unsigned long long GetByteCount() const { return m_bytes; }
+    unsigned long long GetFlushRequests() const { return m_flushRequests.load(); }
+
+private:
+    std::thread::id m_dispatchThread;
+    std::function<void()> m_onFlushRequested;
+    std::function<void(const Entry&)> m_observer;
+    std::vector<Entry> m_messages;
+    bool m_retain = false;
+    unsigned long long m_count = 0;
+    unsigned long long m_bytes = 0;
+    std::atomic<unsigned long long> m_flushRequests{0};
+};
+
+#endif // MEMORY_EVENT_TRANSPORT_H
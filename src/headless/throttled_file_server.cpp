@@ -0,0 +1,163 @@
+#include "throttled_file_server.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Bytes written per pacing step; small enough to keep the rate smooth.
+static const size_t CHUNK_SIZE = 16 * 1024;
+
+ThrottledFileServer::ThrottledFileServer(std::filesystem::path file, uint64_t bytesPerSecond)
+    : m_file(std::move(file)), m_bytesPerSecond((std::max)(bytesPerSecond, uint64_t(1))) {}
+
+ThrottledFileServer::~ThrottledFileServer()
+{
+    Stop();
+}
+
+bool ThrottledFileServer::Start(std::string& error)
+{
+    if (!std::filesystem::is_regular_file(m_file)) {
+        error = "not a file: " + m_file.string();
+        return false;
+    }
+    m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t length = sizeof(addr);
+    if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(m_listenFd, 8) < 0 ||
+        getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&addr), &length) < 0) {
+        error = std::string("bind: ") + std::strerror(errno);
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    m_port = ntohs(addr.sin_port);
+    m_acceptThread = std::thread(&ThrottledFileServer::AcceptLoop, this);
+    return true;
+}
+
+void ThrottledFileServer::Stop()
+{
+    if (m_stopping.exchange(true)) return;
+    if (m_listenFd >= 0) shutdown(m_listenFd, SHUT_RDWR);
+    if (m_acceptThread.joinable()) m_acceptThread.join();
+    if (m_listenFd >= 0) close(m_listenFd);
+    m_listenFd = -1;
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        for (int fd : m_connectionFds) shutdown(fd, SHUT_RDWR);
+        threads.swap(m_connectionThreads);
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+std::string ThrottledFileServer::GetUrl() const
+{
+    return "http://127.0.0.1:" + std::to_string(m_port) + "/" + m_file.filename().string();
+}
+
+void ThrottledFileServer::AcceptLoop()
+{
+    while (!m_stopping) {
+        int fd = accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (m_stopping) return;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        m_connectionFds.push_back(fd);
+        m_connectionThreads.emplace_back(&ThrottledFileServer::ServeConnection, this, fd);
+    }
+}
+
+static bool SendAll(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Handles one request per connection; mpv reconnects with a new Range to seek.
+void ThrottledFileServer::ServeConnection(int fd)
+{
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16 * 1024) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    const uint64_t fileSize = std::filesystem::file_size(m_file);
+    uint64_t first = 0;
+    uint64_t last = fileSize ? fileSize - 1 : 0;
+    bool partial = false;
+    std::string lower = request;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    size_t range = lower.find("\r\nrange: bytes=");
+    if (range != std::string::npos) {
+        std::istringstream spec(request.substr(range + 15));
+        char dash = 0;
+        spec >> first >> dash;
+        uint64_t end = 0;
+        if (spec >> end) last = (std::min)(end, last);
+        partial = first < fileSize;
+    }
+    const bool headOnly = request.rfind("HEAD ", 0) == 0;
+
+    std::ostringstream header;
+    if (range != std::string::npos && !partial) {
+        header << "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */" << fileSize << "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        SendAll(fd, header.str().data(), header.str().size());
+    } else {
+        const uint64_t length = fileSize ? last - first + 1 : 0;
+        header << (partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n")
+               << "Content-Type: application/octet-stream\r\nAccept-Ranges: bytes\r\n"
+               << "Content-Length: " << length << "\r\nConnection: close\r\n";
+        if (partial) header << "Content-Range: bytes " << first << "-" << last << "/" << fileSize << "\r\n";
+        header << "\r\n";
+
+        if (SendAll(fd, header.str().data(), header.str().size()) && !headOnly) {
+            std::ifstream in(m_file, std::ios::binary);
+            in.seekg(static_cast<std::streamoff>(first));
+            std::vector<char> chunk(CHUNK_SIZE);
+            const auto start = std::chrono::steady_clock::now();
+            uint64_t sent = 0;
+            while (sent < length && !m_stopping) {
+                size_t want = static_cast<size_t>((std::min<uint64_t>)(CHUNK_SIZE, length - sent));
+                in.read(chunk.data(), static_cast<std::streamsize>(want));
+                size_t got = static_cast<size_t>(in.gcount());
+                if (got == 0 || !SendAll(fd, chunk.data(), got)) break;
+                sent += got;
+                m_bytesSent += got;
+                // Sleep until the bytes sent so far are within the rate budget.
+                auto due = start + std::chrono::microseconds(sent * 1000000 / m_bytesPerSecond);
+                std::this_thread::sleep_until(due);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_connectionsMutex);
+    m_connectionFds.erase(std::remove(m_connectionFds.begin(), m_connectionFds.end(), fd), m_connectionFds.end());
+    close(fd);
+}
@@ -0,0 +1,45 @@
+#ifndef THROTTLED_FILE_SERVER_H
+#define THROTTLED_FILE_SERVER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+// Serves one local file over HTTP on 127.0.0.1 at a capped byte rate, with
+// Range support so mpv can seek. Lets the headless harness reproduce slow
+// streams deterministically. POSIX only.
+class ThrottledFileServer
+{
+public:
+    ThrottledFileServer(std::filesystem::path file, uint64_t bytesPerSecond);
+    ~ThrottledFileServer();
+
+    // Binds an ephemeral port and starts accepting connections.
+    bool Start(std::string& error);
+    void Stop();
+
+    std::string GetUrl() const;
+    uint64_t GetBytesSent() const { return m_bytesSent.load(); }
+
+private:
+    void AcceptLoop();
+    void ServeConnection(int fd);
+
+    std::filesystem::path m_file;
+    uint64_t m_bytesPerSecond;
+    int m_listenFd = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint64_t> m_bytesSent{0};
+    std::thread m_acceptThread;
+
+    std::mutex m_connectionsMutex;
+    std::vector<int> m_connectionFds;
+    std::vector<std::thread> m_connectionThreads;
+};
+
+#endif // THROTTLED_FILE_SERVER_H
@@ -1,49 +1,33 @@
 #include "../helpers/helpers.h"
-#include "../globals/globals.h" 
-#include "logger/logger.h"
+#include "../globals/globals.h"
+#include "../logger/logger.h"
+#include "../platform/platform.h"
+#include "../metrics/metrics.h"
 #include <fstream>
-#include <shellscalingapi.h>
-#include <tlhelp32.h>
-#include <VersionHelpers.h>
+#include <cwctype>
 #include <curl/curl.h>
 #include <sstream>
 #include <algorithm>
 
 std::string WStringToUtf8(const std::wstring &wstr)
 {
-    if (wstr.empty()) return {};
-    int neededSize = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), nullptr, 0, nullptr, nullptr);
-    if (neededSize <= 0) return {};
-    std::string result(neededSize, '\0');
-    WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), &result[0], neededSize, nullptr, nullptr);
-    while(!result.empty() && result.back()=='\0') result.pop_back();
-    return result;
+    return Platform::WideToUtf8(wstr);
 }
 
 std::wstring Utf8ToWstring(const std::string& utf8Str)
 {
-    if (utf8Str.empty()) return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, utf8Str.data(), (int)utf8Str.size(), NULL, 0);
-    if (size_needed == 0) return std::wstring();
-    std::wstring wstr(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, utf8Str.data(), (int)utf8Str.size(), &wstr[0], size_needed);
-    return wstr;
+    return Platform::Utf8ToWide(utf8Str);
 }
 
 bool FileExists(const std::wstring& path)
 {
-    DWORD attributes = GetFileAttributesW(path.c_str());
-    return (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY));
+    std::error_code ec;
+    return std::filesystem::is_regular_file(std::filesystem::path(path), ec);
 }
 
 std::wstring GetExeDirectory()
 {
-    wchar_t buf[MAX_PATH];
-    GetModuleFileNameW(nullptr,buf,MAX_PATH);
-    std::wstring path(buf);
-    size_t pos=path.find_last_of(L"\\/");
-    if(pos!=std::wstring::npos) path.erase(pos);
-    return path;
+    return Platform::GetExecutableDirectory().wstring();
 }
 
 bool isSubtitle(const std::wstring& filePath) {
@@ -71,7 +55,9 @@ bool IsEndpointReachable(const std::wstring& url)
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 3L);
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
 
+    auto start = std::chrono::steady_clock::now();
     CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("reachability", start, res == CURLE_OK);
     curl_easy_cleanup(curl);
     return res == CURLE_OK;
 }
@@ -87,7 +73,7 @@ std::wstring GetFirstReachableUrl() {
 
 bool ReadFileUtf8(const std::wstring& path, std::string& out)
 {
-    std::ifstream f(path, std::ios::binary);
+    std::ifstream f(std::filesystem::path(path), std::ios::binary);
     if (!f) return false;
     f.seekg(0, std::ios::end);
     std::streamsize size = f.tellg();
@@ -1,7 +1,9 @@
 #ifndef HELPERS_H
 #define HELPERS_H
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <string>
 #include <vector> 
 #include <filesystem>
@@ -11,6 +13,7 @@ std::string WStringToUtf8(const std::wstring &wstr);
 std::wstring Utf8ToWstring(const std::string& utf8Str);
 std::wstring GetExeDirectory();
 std::wstring GetFirstReachableUrl();
+std::string Base64Encode(const std::string& in);
 std::wstring MakeInjectCssScript(const std::wstring& idSafe, const std::string& cssUtf8);
 std::wstring MakeInjectJsScript(const std::wstring& idSafe, const std::string& jsUtf8);
 bool FileExists(const std::wstring& path);
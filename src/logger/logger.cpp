@@ -1,4 +1,6 @@
 #include "logger.h"
+#include "../platform/platform.h"
+#include "../metrics/metrics.h"
 #include <chrono>
 #include <filesystem>
 #include <iomanip>
@@ -27,7 +29,7 @@ void Logger::Init(const std::wstring &log_dir_w)
     }
     catch (const std::filesystem::filesystem_error &e)
     {
-        OutputDebugStringA(("Logger Init Failed: " + std::string(e.what()) + "\n").c_str());
+        Platform::DebugOutput("Logger Init Failed: " + std::string(e.what()) + "\n");
     }
 #endif
     m_is_initialized = true;
@@ -57,7 +59,7 @@ std::string Logger::FormatMessage(LogLevel level,
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
     auto in_time_t = std::chrono::system_clock::to_time_t(now);
     std::tm bt = {};
-    localtime_s(&bt, &in_time_t);
+    Platform::LocalTime(in_time_t, bt);
 
     std::stringstream ss;
     ss << std::put_time(&bt, "%M:%S");
@@ -102,18 +104,23 @@ std::string Logger::FormatMessage(LogLevel level,
     return log_stream.str();
 }
 
+static Metrics::Counter &LinesCounter()
+{
+    static Metrics::Counter &counter = Metrics::GetCounter("log.lines");
+    return counter;
+}
+
+static Metrics::Counter &DroppedCounter()
+{
+    static Metrics::Counter &counter = Metrics::GetCounter("log.dropped");
+    return counter;
+}
+
 void Logger::Write(const std::string &full_log_message, bool is_mpv_log)
 {
+    LinesCounter().Add();
 #ifdef _DEBUG
-    if (full_log_message.empty())
-        return;
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &full_log_message[0], (int)full_log_message.size(), NULL, 0);
-    if (size_needed > 0)
-    {
-        std::wstring wstr(size_needed, 0);
-        MultiByteToWideChar(CP_UTF8, 0, &full_log_message[0], (int)full_log_message.size(), &wstr[0], size_needed);
-        OutputDebugStringW(wstr.c_str());
-    }
+    Platform::DebugOutput(full_log_message);
 #else
     if (is_mpv_log)
     {
@@ -121,6 +128,10 @@ void Logger::Write(const std::string &full_log_message, bool is_mpv_log)
         {
             m_mpv_log_file << full_log_message;
         }
+        else
+        {
+            DroppedCounter().Add();
+        }
     }
     else
     {
@@ -128,6 +139,10 @@ void Logger::Write(const std::string &full_log_message, bool is_mpv_log)
         {
             m_log_file << full_log_message;
         }
+        else
+        {
+            DroppedCounter().Add();
+        }
     }
 #endif
 }
@@ -140,24 +155,27 @@ void Logger::Log(LogLevel level,
 {
     if (!m_is_initialized && level != LogLevel::INFO)
     {
+        DroppedCounter().Add();
         return;
     }
     std::string formatted = FormatMessage(level, file, function, context, message);
     Write(formatted, false);
 }
 
-void Logger::LogMpv(const mpv_event_log_message *msg)
+void Logger::LogMpv(const std::string &prefix, const std::string &level, const std::string &text)
 {
     if (!m_is_initialized)
+    {
+        DroppedCounter().Add();
         return;
+    }
 
-    std::string context = msg->prefix;
-    std::string message = msg->text;
+    std::string message = text;
     if (!message.empty() && message.back() == '\n')
     {
         message.pop_back();
     }
 
-    std::string formatted = FormatMessage(LogLevel::MPV, "mpv", context.c_str(), msg->level, message);
+    std::string formatted = FormatMessage(LogLevel::MPV, "mpv", prefix.c_str(), level, message);
     Write(formatted, true);
 }
\ No newline at end of file
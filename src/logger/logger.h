@@ -4,8 +4,6 @@
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <windows.h>
-#include <mpv/client.h>
 
 enum class LogLevel
 {
@@ -28,16 +26,18 @@ public:
                   const std::string &context,
                   const std::string &message);
 
-  static void LogMpv(const mpv_event_log_message *msg);
+  // Fields of an mpv_event_log_message; kept as strings so the logger does not depend on libmpv.
+  static void LogMpv(const std::string &prefix, const std::string &level, const std::string &text);
 
-private:
-  static void Write(const std::string &full_log_message, bool is_mpv_log);
   static std::string FormatMessage(LogLevel level,
                                    const char *file,
                                    const char *function,
                                    const std::string &context,
                                    const std::string &message);
 
+private:
+  static void Write(const std::string &full_log_message, bool is_mpv_log);
+
   static std::ofstream m_log_file;
   static std::ofstream m_mpv_log_file;
   static bool m_is_initialized;
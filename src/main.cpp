@@ -5,15 +5,20 @@
 #include "logger/logger.h"
 #include "helpers/helpers.h"
 #include "window/window_manager.h" 
+#include "tracer/tracer.h"
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+    Tracer::Instant("WinMain");
     Logger::Init(GetExeDirectory() + L"\\portable_config");
     
     g_hInst = hInstance;
 
     AppManager app;
-    if (!app.InitializeWindow(nCmdShow))
+    Tracer::Begin("InitializeWindow");
+    bool windowCreated = app.InitializeWindow(nCmdShow);
+    Tracer::End("InitializeWindow");
+    if (!windowCreated)
     {
         Logger::Cleanup();
         return 1;
@@ -0,0 +1,201 @@
+#include "metrics.h"
+#include <bit>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <condition_variable>
+
+namespace Metrics {
+    static std::atomic<size_t> g_nextShard{0};
+
+    size_t CurrentShard()
+    {
+        thread_local size_t shard = g_nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+        return shard;
+    }
+
+    uint64_t Counter::Value() const
+    {
+        uint64_t total = 0;
+        for (const auto& shard : m_shards) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    size_t Histogram::BucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKET_COUNT) return static_cast<size_t>(value);
+        int msb = 63 - std::countl_zero(value);
+        int shift = msb - (SUB_BUCKET_BITS - 1);
+        uint64_t sub = value >> shift; // in [HALF_SUB_BUCKET_COUNT, SUB_BUCKET_COUNT)
+        return SUB_BUCKET_COUNT + (shift - 1) * HALF_SUB_BUCKET_COUNT + static_cast<size_t>(sub - HALF_SUB_BUCKET_COUNT);
+    }
+
+    uint64_t Histogram::BucketLow(size_t index)
+    {
+        if (index < SUB_BUCKET_COUNT) return index;
+        size_t shift = (index - SUB_BUCKET_COUNT) / HALF_SUB_BUCKET_COUNT + 1;
+        uint64_t sub = (index - SUB_BUCKET_COUNT) % HALF_SUB_BUCKET_COUNT + HALF_SUB_BUCKET_COUNT;
+        return sub << shift;
+    }
+
+    uint64_t Histogram::BucketHigh(size_t index)
+    {
+        if (index < SUB_BUCKET_COUNT) return index;
+        size_t shift = (index - SUB_BUCKET_COUNT) / HALF_SUB_BUCKET_COUNT + 1;
+        return BucketLow(index) + ((uint64_t(1) << shift) - 1);
+    }
+
+    void Histogram::Record(uint64_t value)
+    {
+        m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = m_min.load(std::memory_order_relaxed);
+        while (value < seen && !m_min.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+        seen = m_max.load(std::memory_order_relaxed);
+        while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    }
+
+    json Histogram::Snapshot() const
+    {
+        // Copy first so percentiles are computed over one consistent set of counts.
+        std::array<uint64_t, BUCKET_COUNT> counts;
+        uint64_t count = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+            count += counts[i];
+        }
+        if (count == 0) return {{"count", 0}};
+
+        const uint64_t minValue = m_min.load(std::memory_order_relaxed);
+        const uint64_t maxValue = m_max.load(std::memory_order_relaxed);
+        auto percentile = [&](double p) -> uint64_t {
+            uint64_t rank = static_cast<uint64_t>(p * count);
+            if (rank >= count) rank = count - 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; i++) {
+                seen += counts[i];
+                if (seen > rank) {
+                    uint64_t mid = BucketLow(i) + (BucketHigh(i) - BucketLow(i)) / 2;
+                    return (std::min)((std::max)(mid, minValue), maxValue);
+                }
+            }
+            return maxValue;
+        };
+
+        const uint64_t sum = m_sum.load(std::memory_order_relaxed);
+        return {
+            {"count", count},
+            {"sum", sum},
+            {"min", minValue},
+            {"max", maxValue},
+            {"mean", static_cast<double>(sum) / count},
+            {"p50", percentile(0.50)},
+            {"p90", percentile(0.90)},
+            {"p99", percentile(0.99)},
+            {"p999", percentile(0.999)}
+        };
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start);
+        m_histogram.Record(static_cast<uint64_t>(elapsed.count()));
+    }
+
+    // Leaked on purpose: function-local statics elsewhere hold references, and
+    // threads (or static destructors) may still record after main returns.
+    struct Registry {
+        std::mutex mutex;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    static Registry& GetRegistry()
+    {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    template <typename T>
+    static T& GetOrCreate(std::map<std::string, std::unique_ptr<T>> Registry::* metrics, const std::string& name)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto& slot = (registry.*metrics)[name];
+        if (!slot) slot = std::make_unique<T>();
+        return *slot;
+    }
+
+    Counter& GetCounter(const std::string& name) { return GetOrCreate(&Registry::counters, name); }
+    Gauge& GetGauge(const std::string& name) { return GetOrCreate(&Registry::gauges, name); }
+    Histogram& GetHistogram(const std::string& name) { return GetOrCreate(&Registry::histograms, name); }
+
+    void RecordHttp(const std::string& target, std::chrono::steady_clock::time_point start, bool ok)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        GetHistogram("http." + target + "_us").Record(static_cast<uint64_t>(elapsed.count()));
+        if (!ok) GetCounter("http." + target + ".errors").Add();
+    }
+
+    json Snapshot()
+    {
+        json counters = json::object();
+        json gauges = json::object();
+        json histograms = json::object();
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const auto& [name, counter] : registry.counters) counters[name] = counter->Value();
+            for (const auto& [name, gauge] : registry.gauges) gauges[name] = gauge->Value();
+            for (const auto& [name, histogram] : registry.histograms) histograms[name] = histogram->Snapshot();
+        }
+        return {
+            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()},
+            {"counters", counters},
+            {"gauges", gauges},
+            {"histograms", histograms}
+        };
+    }
+
+    static std::mutex g_dumpMutex;
+    static std::condition_variable g_dumpCv;
+    static std::thread g_dumpThread;
+    static bool g_dumpStopping = false;
+
+    bool StartPeriodicDump(const std::filesystem::path& path, std::chrono::seconds interval)
+    {
+        StopPeriodicDump();
+        if (interval.count() <= 0) return false;
+        {
+            std::ofstream probe(path, std::ios::out | std::ios::app);
+            if (!probe) return false;
+        }
+        std::lock_guard<std::mutex> lock(g_dumpMutex);
+        g_dumpStopping = false;
+        g_dumpThread = std::thread([path, interval]() {
+            std::unique_lock<std::mutex> lock(g_dumpMutex);
+            while (!g_dumpCv.wait_for(lock, interval, []() { return g_dumpStopping; })) {
+                lock.unlock();
+                std::ofstream out(path, std::ios::out | std::ios::app);
+                if (out) out << Snapshot().dump() << '\n';
+                lock.lock();
+            }
+        });
+        return true;
+    }
+
+    void StopPeriodicDump()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(g_dumpMutex);
+            g_dumpStopping = true;
+            thread = std::move(g_dumpThread);
+        }
+        g_dumpCv.notify_all();
+        if (thread.joinable()) thread.join();
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// Process-wide metrics. Looking a metric up by name takes a lock, so hot paths
+// resolve it once (usually into a function-local static) and then only touch
+// atomics:
+//
+//   static Metrics::Counter& s_events = Metrics::GetCounter("bridge.events_out");
+//   s_events.Add();
+//
+// The registry is deliberately leaked, so metrics are never destroyed and
+// references stay valid for the whole process, including static destruction.
+namespace Metrics {
+    constexpr size_t SHARD_COUNT = 8;
+
+    // Index of the calling thread's shard; threads are assigned round-robin.
+    size_t CurrentShard();
+
+    // Monotonic count split across cache-line-sized shards so concurrent
+    // writers do not bounce the same line.
+    class Counter {
+    public:
+        void Add(uint64_t n = 1) { m_shards[CurrentShard()].value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t Value() const;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+        std::array<Shard, SHARD_COUNT> m_shards;
+    };
+
+    // Last-written value, e.g. a queue depth.
+    class Gauge {
+    public:
+        void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        void Add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+        int64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> m_value{0};
+    };
+
+    // Log-linear (HDR-style) histogram of non-negative integers. Values below
+    // 32 are exact; above that every power of two is split into 16 buckets,
+    // which bounds the relative error of a reported percentile to ~3%.
+    class Histogram {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+        static constexpr size_t HALF_SUB_BUCKET_COUNT = SUB_BUCKET_COUNT / 2;
+        static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * HALF_SUB_BUCKET_COUNT;
+
+        void Record(uint64_t value);
+        json Snapshot() const;
+
+        static size_t BucketIndex(uint64_t value);
+        // Smallest and largest value that map to a bucket.
+        static uint64_t BucketLow(size_t index);
+        static uint64_t BucketHigh(size_t index);
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+        std::atomic<uint64_t> m_sum{0};
+        std::atomic<uint64_t> m_min{UINT64_MAX};
+        std::atomic<uint64_t> m_max{0};
+    };
+
+    // Records the lifetime of the scope, in microseconds, into a histogram.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram) : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    Counter& GetCounter(const std::string& name);
+    Gauge& GetGauge(const std::string& name);
+    Histogram& GetHistogram(const std::string& name);
+
+    // Network calls are rare enough to resolve by name: records the time since
+    // start into http.<target>_us and, on failure, bumps http.<target>.errors.
+    void RecordHttp(const std::string& target, std::chrono::steady_clock::time_point start, bool ok);
+
+    // {"timestamp", "counters", "gauges", "histograms"}
+    json Snapshot();
+
+    // Appends a snapshot as one JSON line every interval until stopped.
+    bool StartPeriodicDump(const std::filesystem::path& path, std::chrono::seconds interval);
+    void StopPeriodicDump();
+}
+
+#endif // METRICS_H
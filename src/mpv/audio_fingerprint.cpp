@@ -0,0 +1,223 @@
+#include "audio_fingerprint.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_FINGERPRINT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static constexpr int HALF_SIZE = AudioFingerprinter::FRAME_SIZE / 2;
+static constexpr double PI = 3.14159265358979323846;
+
+static int FrequencyBin(double frequency)
+{
+    return static_cast<int>(std::lround(frequency * AudioFingerprinter::FRAME_SIZE / AudioFingerprinter::SAMPLE_RATE));
+}
+
+AudioFingerprinter::AudioFingerprinter()
+    : m_window(FRAME_SIZE), m_bitReverse(HALF_SIZE), m_re(HALF_SIZE), m_im(HALF_SIZE), m_power(HALF_SIZE + 1)
+{
+    // Hann, with the 16-bit sample scale folded in.
+    for (int i = 0; i < FRAME_SIZE; i++) {
+        m_window[i] = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * PI * i / (FRAME_SIZE - 1))) / 32768.0);
+    }
+
+    int bits = 0;
+    while ((1 << bits) < HALF_SIZE) bits++;
+    for (int i = 0; i < HALF_SIZE; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        m_bitReverse[i] = static_cast<uint16_t>(reversed);
+    }
+
+    // Stage with butterflies half apart uses e^(-i*pi*j/half), j < half, at offset half - 1.
+    for (int half = 1; half < HALF_SIZE; half *= 2) {
+        for (int j = 0; j < half; j++) {
+            m_stageCos.push_back(static_cast<float>(std::cos(PI * j / half)));
+            m_stageSin.push_back(static_cast<float>(-std::sin(PI * j / half)));
+        }
+    }
+    for (int k = 0; k <= HALF_SIZE; k++) {
+        m_splitCos.push_back(static_cast<float>(std::cos(2.0 * PI * k / FRAME_SIZE)));
+        m_splitSin.push_back(static_cast<float>(std::sin(2.0 * PI * k / FRAME_SIZE)));
+    }
+
+    for (int b = 0; b <= BANDS; b++) {
+        const int bin = FrequencyBin(MIN_FREQ * std::pow(MAX_FREQ / MIN_FREQ, static_cast<double>(b) / BANDS));
+        m_bandEdges.push_back(b == 0 ? bin : (std::max)(bin, m_bandEdges.back() + 1));
+    }
+}
+
+// The frame is real, so it is transformed as FRAME_SIZE / 2 complex samples
+// (even samples real, odd imaginary) and the two halves are separated after.
+// Real and imaginary parts live in separate arrays, which keeps every
+// butterfly loop a straight run over contiguous floats the compiler vectorizes.
+void AudioFingerprinter::PowerSpectrum(const int16_t* frame)
+{
+    float* re = m_re.data();
+    float* im = m_im.data();
+    for (int n = 0; n < HALF_SIZE; n++) {
+        const int at = m_bitReverse[n];
+        re[at] = frame[2 * n] * m_window[2 * n];
+        im[at] = frame[2 * n + 1] * m_window[2 * n + 1];
+    }
+
+    for (int half = 1; half < HALF_SIZE; half *= 2) {
+        const float* wr = m_stageCos.data() + half - 1;
+        const float* wi = m_stageSin.data() + half - 1;
+        for (int start = 0; start < HALF_SIZE; start += 2 * half) {
+            float* re0 = re + start;
+            float* im0 = im + start;
+            float* re1 = re0 + half;
+            float* im1 = im0 + half;
+            for (int j = 0; j < half; j++) {
+                const float tr = re1[j] * wr[j] - im1[j] * wi[j];
+                const float ti = re1[j] * wi[j] + im1[j] * wr[j];
+                re1[j] = re0[j] - tr;
+                im1[j] = im0[j] - ti;
+                re0[j] += tr;
+                im0[j] += ti;
+            }
+        }
+    }
+
+    // X[k] = E[k] + e^(-2*pi*i*k/N) * O[k], with E and O the spectra of the
+    // even and odd samples recovered from Z[k] and conj(Z[N/2 - k]).
+    for (int k = m_bandEdges.front(); k < m_bandEdges.back(); k++) {
+        const int mirror = (HALF_SIZE - k) & (HALF_SIZE - 1);
+        const int at = k & (HALF_SIZE - 1);
+        const float evenRe = 0.5f * (re[at] + re[mirror]);
+        const float evenIm = 0.5f * (im[at] - im[mirror]);
+        const float oddRe = 0.5f * (im[at] + im[mirror]);
+        const float oddIm = -0.5f * (re[at] - re[mirror]);
+        const float c = m_splitCos[k];
+        const float s = m_splitSin[k];
+        const float xr = evenRe + c * oddRe + s * oddIm;
+        const float xi = evenIm + c * oddIm - s * oddRe;
+        m_power[k] = xr * xr + xi * xi;
+    }
+}
+
+void AudioFingerprinter::BandEnergies(float* energies) const
+{
+    for (int b = 0; b < BANDS; b++) {
+        float sum = 0.0f;
+        for (int k = m_bandEdges[b]; k < m_bandEdges[b + 1]; k++) sum += m_power[k];
+        energies[b] = sum;
+    }
+}
+
+// Bit b: (E[b] - E[b+1]) - (P[b] - P[b+1]) > 0, for the current and previous frame's bands.
+static uint32_t HashBits(const float* current, const float* previous)
+{
+    uint32_t hash = 0;
+#ifdef AUDIO_FINGERPRINT_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    for (int b = 0; b < 32; b += 4) {
+        const __m128 now = _mm_sub_ps(_mm_loadu_ps(current + b), _mm_loadu_ps(current + b + 1));
+        const __m128 before = _mm_sub_ps(_mm_loadu_ps(previous + b), _mm_loadu_ps(previous + b + 1));
+        hash |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(now, before), zero))) << b;
+    }
+#else
+    for (int b = 0; b < 32; b++) {
+        if ((current[b] - current[b + 1]) - (previous[b] - previous[b + 1]) > 0.0f) hash |= 1u << b;
+    }
+#endif
+    return hash;
+}
+
+std::vector<uint32_t> AudioFingerprinter::Compute(const int16_t* samples, size_t count)
+{
+    static_assert(BANDS == 33, "HashBits derives 32 bits from adjacent band pairs");
+    std::vector<uint32_t> hashes;
+    if (count < static_cast<size_t>(FRAME_SIZE + HOP_SIZE)) return hashes;
+    const size_t frames = 1 + (count - FRAME_SIZE) / HOP_SIZE;
+    hashes.reserve(frames - 1);
+
+    float bands[2][BANDS];
+    for (size_t frame = 0; frame < frames; frame++) {
+        float* current = bands[frame & 1];
+        PowerSpectrum(samples + frame * HOP_SIZE);
+        BandEnergies(current);
+        if (frame > 0) hashes.push_back(HashBits(current, bands[(frame + 1) & 1]));
+    }
+    return hashes;
+}
+
+size_t AudioFingerprinter::CountMatchesScalar(const uint32_t* a, const uint32_t* b, size_t count)
+{
+    size_t matches = 0;
+    for (size_t i = 0; i < count; i++) matches += std::popcount(a[i] ^ b[i]) <= MATCH_BITS;
+    return matches;
+}
+
+// SSE2 has no popcount, so the differing bits are counted with the usual
+// shift-and-mask reduction on four hashes at a time.
+size_t AudioFingerprinter::CountMatches(const uint32_t* a, const uint32_t* b, size_t count)
+{
+#ifdef AUDIO_FINGERPRINT_SSE2
+    const __m128i m1 = _mm_set1_epi32(0x55555555);
+    const __m128i m2 = _mm_set1_epi32(0x33333333);
+    const __m128i m4 = _mm_set1_epi32(0x0f0f0f0f);
+    const __m128i m6 = _mm_set1_epi32(0x3f);
+    const __m128i limit = _mm_set1_epi32(MATCH_BITS + 1);
+    __m128i matches = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        x = _mm_sub_epi32(x, _mm_and_si128(_mm_srli_epi32(x, 1), m1));
+        x = _mm_add_epi32(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi32(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 4)), m4);
+        x = _mm_add_epi32(x, _mm_srli_epi32(x, 8));
+        x = _mm_and_si128(_mm_add_epi32(x, _mm_srli_epi32(x, 16)), m6);
+        // All ones where the hashes match, so subtracting counts them.
+        matches = _mm_sub_epi32(matches, _mm_cmplt_epi32(x, limit));
+    }
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), matches);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + CountMatchesScalar(a + i, b + i, count - i);
+#else
+    return CountMatchesScalar(a, b, count);
+#endif
+}
+
+// Every offset is screened with CountMatches(); only those with enough
+// matches overall are scanned for their best run, scoring +1 per matching
+// hash and -1 per other one, so short dropouts inside a run are bridged.
+std::optional<AudioFingerprinter::Segment> AudioFingerprinter::FindSharedSegment(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int minLength)
+{
+    const int aSize = static_cast<int>(a.size());
+    const int bSize = static_cast<int>(b.size());
+    if (minLength <= 0 || aSize < minLength || bSize < minLength) return std::nullopt;
+
+    std::optional<Segment> best;
+    int bestScore = 0;
+    for (int offset = minLength - bSize; offset <= aSize - minLength; offset++) {
+        const int aStart = (std::max)(offset, 0);
+        const int bStart = aStart - offset;
+        const int count = (std::min)(aSize - aStart, bSize - bStart);
+        const uint32_t* aHashes = a.data() + aStart;
+        const uint32_t* bHashes = b.data() + bStart;
+        if (CountMatches(aHashes, bHashes, count) < static_cast<size_t>(minLength / 2)) continue;
+
+        int score = 0, runStart = 0, runMatches = 0;
+        for (int i = 0; i < count; i++) {
+            const bool match = std::popcount(aHashes[i] ^ bHashes[i]) <= MATCH_BITS;
+            score += match ? 1 : -1;
+            runMatches += match;
+            if (score <= 0) {
+                score = 0;
+                runStart = i + 1;
+                runMatches = 0;
+            } else if (score > bestScore) {
+                bestScore = score;
+                best = Segment{ aStart + runStart, bStart + runStart, i + 1 - runStart, runMatches };
+            }
+        }
+    }
+    if (!best || best->length < minLength) return std::nullopt;
+    return best;
+}
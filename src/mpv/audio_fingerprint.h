@@ -0,0 +1,67 @@
+#ifndef AUDIO_FINGERPRINT_H
+#define AUDIO_FINGERPRINT_H
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+// Chromaprint-style audio fingerprints: one 32-bit hash every HOP_SIZE
+// samples of mono SAMPLE_RATE audio. The spectrum of each FRAME_SIZE window is
+// summed into BANDS log-spaced bands between MIN_FREQ and MAX_FREQ; bit b is
+// set when the energy difference between bands b and b + 1 grew since the
+// previous frame. Hashes of the same audio differ in a few bits at most, so
+// two recordings match where their hashes are within MATCH_BITS of each other.
+//
+// The hot loops use SSE2 where the target has it and portable code otherwise;
+// CountMatchesScalar() is the reference they are benchmarked against.
+class AudioFingerprinter
+{
+public:
+    static constexpr int SAMPLE_RATE = 8000;
+    static constexpr int FRAME_SIZE = 2048;  // 256 ms
+    static constexpr int HOP_SIZE = 512;     // 64 ms per hash
+    static constexpr int BANDS = 33;
+    static constexpr double MIN_FREQ = 300.0;
+    static constexpr double MAX_FREQ = 2000.0;
+    static constexpr int MATCH_BITS = 8;
+    static constexpr double HASH_SEC = static_cast<double>(HOP_SIZE) / SAMPLE_RATE;
+
+    // a[aStart...] and b[bStart...] hold the same audio for length hashes,
+    // matches of which are within MATCH_BITS.
+    struct Segment {
+        int aStart = 0;
+        int bStart = 0;
+        int length = 0;
+        int matches = 0;
+    };
+
+    AudioFingerprinter();
+
+    // One hash per hop after the first full frame; empty for less than two frames.
+    std::vector<uint32_t> Compute(const int16_t* samples, size_t count);
+
+    // The longest stretch, at any relative offset, where a and b mostly match;
+    // nothing when none is minLength hashes or longer.
+    static std::optional<Segment> FindSharedSegment(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int minLength);
+
+    // How many i < count have a[i] and b[i] within MATCH_BITS.
+    static size_t CountMatches(const uint32_t* a, const uint32_t* b, size_t count);
+    static size_t CountMatchesScalar(const uint32_t* a, const uint32_t* b, size_t count);
+
+private:
+    void PowerSpectrum(const int16_t* frame);
+    void BandEnergies(float* energies) const;
+
+    std::vector<float> m_window;
+    std::vector<uint16_t> m_bitReverse;    // of FRAME_SIZE / 2
+    std::vector<float> m_stageCos;         // per FFT stage, concatenated
+    std::vector<float> m_stageSin;
+    std::vector<float> m_splitCos;         // real-FFT post-processing twiddles
+    std::vector<float> m_splitSin;
+    std::vector<int> m_bandEdges;          // BANDS + 1 bin indices
+    std::vector<float> m_re, m_im;         // FRAME_SIZE / 2 complex scratch
+    std::vector<float> m_power;            // FRAME_SIZE / 2 + 1 bins
+};
+
+#endif // AUDIO_FINGERPRINT_H
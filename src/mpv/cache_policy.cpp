@@ -0,0 +1,103 @@
+#include "cache_policy.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static std::string FormatBytes(double bytes)
+{
+    char buf[32];
+    if (bytes >= 1024.0 * 1024 * 1024) std::snprintf(buf, sizeof(buf), "%.1fGiB", bytes / (1024.0 * 1024 * 1024));
+    else std::snprintf(buf, sizeof(buf), "%.1fMiB", bytes / (1024.0 * 1024));
+    return buf;
+}
+
+std::string CachePolicy::Decision::ToString() const
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "forward %s, back %s, readahead %.0fs, cache-secs %.0fs",
+        FormatBytes(static_cast<double>(maxBytes)).c_str(), FormatBytes(static_cast<double>(maxBackBytes)).c_str(),
+        readaheadSecs, cacheSecs);
+    return buf;
+}
+
+CachePolicy::Decision CachePolicy::Decide(const Platform::MemoryStatus& memory, double bitrate, bool network)
+{
+    double budget = static_cast<double>(FALLBACK_BUDGET_BYTES);
+    if (memory.totalBytes > 0 && memory.availableBytes > 0) {
+        budget = (std::min)(memory.availableBytes * AVAILABLE_MEMORY_SHARE, memory.totalBytes * TOTAL_MEMORY_SHARE);
+        budget = std::clamp(budget, static_cast<double>(MIN_BUDGET_BYTES), static_cast<double>(MAX_BUDGET_BYTES));
+    }
+    if (bitrate <= 0.0) bitrate = UNKNOWN_BITRATE;
+    const double targetSecs = network ? NETWORK_TARGET_SECS : LOCAL_TARGET_SECS;
+
+    const double forwardCap = budget * FORWARD_BUDGET_SHARE;
+    const double forward = std::clamp(bitrate * BITRATE_HEADROOM * targetSecs, static_cast<double>(MIN_FORWARD_BYTES), forwardCap);
+    const double back = (std::max)((std::min)(forward / 2.0, budget - forward), static_cast<double>(MIN_BACK_BYTES));
+
+    Decision decision;
+    decision.maxBytes = static_cast<uint64_t>(forward);
+    decision.maxBackBytes = static_cast<uint64_t>(back);
+    // Ask only for as many seconds as the byte limit can hold.
+    decision.readaheadSecs = std::floor(std::clamp(forward / (bitrate * BITRATE_HEADROOM), MIN_READAHEAD_SECS, targetSecs));
+    decision.cacheSecs = decision.readaheadSecs;
+    return decision;
+}
+
+void CachePolicy::Begin(bool network)
+{
+    m_network = network;
+    m_containerBitrate = 0.0;
+    m_observedBitrate = 0.0;
+    m_current.reset();
+    m_lastReason.clear();
+}
+
+void CachePolicy::SetContainerBitrate(double bytesPerSecond)
+{
+    if (bytesPerSecond > 0.0) m_containerBitrate = bytesPerSecond;
+}
+
+void CachePolicy::ObserveBitrate(double bytesPerSecond)
+{
+    if (bytesPerSecond <= 0.0) return;
+    m_observedBitrate = m_observedBitrate > 0.0
+        ? m_observedBitrate + BITRATE_SMOOTHING * (bytesPerSecond - m_observedBitrate)
+        : bytesPerSecond;
+}
+
+// The container average hides peaks and the observed rate lags behind them,
+// so size for whichever is higher.
+double CachePolicy::GetEffectiveBitrate() const
+{
+    return (std::max)(m_containerBitrate, m_observedBitrate);
+}
+
+static bool DiffersBy(double current, double next, double threshold)
+{
+    if (current <= 0.0) return next > 0.0;
+    return std::abs(next - current) / current > threshold;
+}
+
+std::optional<CachePolicy::Decision> CachePolicy::Evaluate(const Platform::MemoryStatus& memory)
+{
+    const double bitrate = GetEffectiveBitrate();
+    Decision next = Decide(memory, bitrate, m_network);
+
+    if (m_current) {
+        const bool lowMemory = memory.totalBytes > 0 && memory.availableBytes < memory.totalBytes * LOW_MEMORY_SHARE;
+        const bool shrinking = next.maxBytes < m_current->maxBytes;
+        const bool changed = DiffersBy(static_cast<double>(m_current->maxBytes), static_cast<double>(next.maxBytes), CHANGE_THRESHOLD) ||
+                             DiffersBy(static_cast<double>(m_current->maxBackBytes), static_cast<double>(next.maxBackBytes), CHANGE_THRESHOLD) ||
+                             DiffersBy(m_current->readaheadSecs, next.readaheadSecs, CHANGE_THRESHOLD);
+        if (!changed && !(lowMemory && shrinking)) return std::nullopt;
+    }
+
+    char reason[160];
+    std::snprintf(reason, sizeof(reason), "%s, bitrate %s/s%s, %s of %s free",
+        m_network ? "network" : "local",
+        FormatBytes(bitrate > 0.0 ? bitrate : UNKNOWN_BITRATE).c_str(), bitrate > 0.0 ? "" : " (assumed)",
+        FormatBytes(static_cast<double>(memory.availableBytes)).c_str(), FormatBytes(static_cast<double>(memory.totalBytes)).c_str());
+    m_lastReason = reason;
+    m_current = next;
+    return next;
+}
@@ -0,0 +1,74 @@
+#ifndef CACHE_POLICY_H
+#define CACHE_POLICY_H
+
+#include <string>
+#include <optional>
+#include <cstdint>
+#include "../platform/platform.h"
+
+// Sizes mpv's demuxer cache for the current file from system memory and the
+// stream bitrate. Pure logic: MPVManager feeds it memory readings and
+// bitrates and applies the decisions it returns.
+//
+// The budget is a share of free memory; forward readahead gets most of it,
+// sized to hold a target duration at the effective bitrate, and the back
+// buffer gets what is left, up to half the forward size.
+class CachePolicy
+{
+public:
+    struct Decision {
+        uint64_t maxBytes = 0;      // demuxer-max-bytes
+        uint64_t maxBackBytes = 0;  // demuxer-max-back-bytes
+        double readaheadSecs = 0.0; // demuxer-readahead-secs
+        double cacheSecs = 0.0;     // cache-secs
+        std::string ToString() const;
+    };
+
+    static constexpr double AVAILABLE_MEMORY_SHARE = 0.25;
+    static constexpr double TOTAL_MEMORY_SHARE = 0.125;
+    static constexpr uint64_t MIN_BUDGET_BYTES = 48ull << 20;
+    static constexpr uint64_t MAX_BUDGET_BYTES = 4ull << 30;
+    // Used when the memory reading fails.
+    static constexpr uint64_t FALLBACK_BUDGET_BYTES = 256ull << 20;
+    static constexpr uint64_t MIN_FORWARD_BYTES = 32ull << 20;
+    static constexpr uint64_t MIN_BACK_BYTES = 8ull << 20;
+    static constexpr double FORWARD_BUDGET_SHARE = 0.75;
+    // Assumed until a bitrate is known: roughly a 1080p remux.
+    static constexpr double UNKNOWN_BITRATE = 2.5 * 1024 * 1024;
+    static constexpr double NETWORK_TARGET_SECS = 300.0;
+    static constexpr double LOCAL_TARGET_SECS = 30.0;
+    static constexpr double MIN_READAHEAD_SECS = 5.0;
+    // Headroom for bitrate peaks above the average.
+    static constexpr double BITRATE_HEADROOM = 1.25;
+    // Relative change in any limit needed before a new decision is applied.
+    static constexpr double CHANGE_THRESHOLD = 0.25;
+    // Weight of each new observed bitrate sample in the moving average.
+    static constexpr double BITRATE_SMOOTHING = 0.3;
+    // Below this share of free memory, shrinking is applied regardless of CHANGE_THRESHOLD.
+    static constexpr double LOW_MEMORY_SHARE = 0.1;
+
+    static Decision Decide(const Platform::MemoryStatus& memory, double bitrate, bool network);
+
+    // Starts a new file; the first Evaluate() always returns a decision.
+    void Begin(bool network);
+    // Average bitrate from file-size / duration.
+    void SetContainerBitrate(double bytesPerSecond);
+    // Demuxed bitrate reported while playing.
+    void ObserveBitrate(double bytesPerSecond);
+    double GetEffectiveBitrate() const;
+
+    // Returns a decision when it differs enough from the one in effect.
+    std::optional<Decision> Evaluate(const Platform::MemoryStatus& memory);
+
+    // Inputs behind the last returned decision, for logging.
+    const std::string& GetLastReason() const { return m_lastReason; }
+
+private:
+    bool m_network = false;
+    double m_containerBitrate = 0.0;
+    double m_observedBitrate = 0.0;
+    std::optional<Decision> m_current;
+    std::string m_lastReason;
+};
+
+#endif // CACHE_POLICY_H
@@ -0,0 +1,278 @@
+#include "hwdec_probe.h"
+#include "../logger/logger.h"
+#include "../platform/platform.h"
+#include <fstream>
+#include <cstring>
+#include <cctype>
+
+bool HwdecTable::Load(const std::filesystem::path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+    try {
+        json::parse(in).get_to(*this);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("HwdecProbe", std::string("Ignoring unreadable hwdec table: ") + e.what());
+        return false;
+    }
+}
+
+bool HwdecTable::Save(const std::filesystem::path& file) const
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out << json(*this).dump(2) << '\n';
+    return static_cast<bool>(out);
+}
+
+std::optional<std::string> HwdecTable::Lookup(const std::string& codecKey) const
+{
+    auto it = codecs.find(codecKey);
+    if (it == codecs.end()) return std::nullopt;
+    return it->second.hwdec;
+}
+
+// nvdec has no zero-copy interop with the d3d11 renderer and dxva2 only has
+// one for OpenGL, so those stay on their copy-back variants.
+std::vector<HwdecProbe::Candidate> HwdecProbe::GetPlatformCandidates()
+{
+#ifdef _WIN32
+    return {
+        { "d3d11va-copy", "d3d11va" },
+        { "nvdec-copy", "nvdec-copy" },
+        { "dxva2-copy", "dxva2-copy" },
+    };
+#else
+    return {
+        { "vaapi-copy", "vaapi" },
+        { "nvdec-copy", "nvdec-copy" },
+        { "vulkan-copy", "vulkan-copy" },
+    };
+#endif
+}
+
+std::vector<HwdecProbe::Candidate> HwdecProbe::ParseCandidates(const std::string& list)
+{
+    std::vector<Candidate> candidates;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string value = list.substr(start, end - start);
+        if (!value.empty()) candidates.push_back({ value, value });
+        start = end + 1;
+    }
+    return candidates.empty() ? GetPlatformCandidates() : candidates;
+}
+
+// 720p: some decoders reject tiny frames. One second at 24fps covers DECODE_FRAMES.
+#define PROBE_SOURCE(FORMAT) "av://lavfi:testsrc2=size=1280x720:rate=24:duration=1,format=" FORMAT
+
+const std::vector<HwdecProbe::Clip>& HwdecProbe::GetClips()
+{
+    static const std::vector<Clip> clips = {
+        { "h264", PROBE_SOURCE("yuv420p"), { { "libx264", "preset=ultrafast" } } },
+        { "hevc", PROBE_SOURCE("yuv420p"), { { "libx265", "preset=ultrafast" } } },
+        { "hevc-10bit", PROBE_SOURCE("yuv420p10le"), { { "libx265", "preset=ultrafast" } } },
+        { "vp9", PROBE_SOURCE("yuv420p"), { { "libvpx-vp9", "deadline=realtime,cpu-used=8" } } },
+        { "av1", PROBE_SOURCE("yuv420p"), {
+            { "libsvtav1", "preset=12" },
+            { "libaom-av1", "cpu-used=8,usage=realtime" },
+            { "librav1e", "speed=10" },
+        } },
+    };
+    return clips;
+}
+
+#undef PROBE_SOURCE
+
+std::string HwdecProbe::CodecKey(const std::string& codec, const std::string& profile)
+{
+    std::string key;
+    for (char c : codec) key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    // "Main 10", "High 10", "Main 4:2:2 10"; VP9 carries high bit depth in profiles 2 and 3.
+    const bool tenBit = profile.find("10") != std::string::npos ||
+                        (key == "vp9" && (profile == "Profile 2" || profile == "Profile 3"));
+    return tenBit ? key + "-10bit" : key;
+}
+
+std::string HwdecProbe::Fingerprint(mpv_handle* mpv, const std::vector<Candidate>& candidates)
+{
+    std::string out = Platform::GetGpuDriverFingerprint();
+    for (const char* name : { "mpv-version", "ffmpeg-version" }) {
+        char* value = mpv ? mpv_get_property_string(mpv, name) : nullptr;
+        out += std::string(name) + " " + (value ? value : "?") + "\n";
+        mpv_free(value);
+    }
+    out += "candidates";
+    for (const auto& candidate : candidates) out += " " + candidate.probe;
+    return out;
+}
+
+HwdecProbe::HwdecProbe(std::filesystem::path clipDir, std::vector<Candidate> candidates)
+    : m_clipDir(std::move(clipDir)), m_candidates(std::move(candidates))
+{
+}
+
+static std::string Elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()) + "ms";
+}
+
+HwdecTable HwdecProbe::Run(const std::string& fingerprint)
+{
+    HwdecTable table;
+    table.fingerprint = fingerprint;
+    table.probedAt = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_clipDir, ec);
+
+    for (const Clip& clip : GetClips()) {
+        if (m_cancelled) break;
+        std::filesystem::path path;
+        std::string error;
+        if (!EnsureClip(clip, path, error)) {
+            LOG_WARN("HwdecProbe", clip.key + " skipped: " + error);
+            table.skipped[clip.key] = error;
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        HwdecCodecResult result;
+        std::string summary;
+        // Every candidate is tried, not just up to the first success, so the
+        // table shows all working paths; the first in preference order is applied.
+        for (const Candidate& candidate : m_candidates) {
+            if (m_cancelled) break;
+            std::string outcome = TryDecode(path, candidate.probe);
+            result.attempts[candidate.probe] = outcome;
+            if (outcome == "ok" && result.hwdec == "no") result.hwdec = candidate.apply;
+            summary += " " + candidate.probe + "=" + outcome;
+        }
+        if (m_cancelled) break;
+        result.probeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("HwdecProbe", clip.key + " -> " + result.hwdec + " (" + Elapsed(start) + "):" + summary);
+        table.codecs[clip.key] = result;
+    }
+    return table;
+}
+
+bool HwdecProbe::EnsureClip(const Clip& clip, std::filesystem::path& path, std::string& error)
+{
+    path = m_clipDir / (clip.key + ".mkv");
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) > 0 && !ec) return true;
+
+    const std::filesystem::path partial = m_clipDir / (clip.key + ".partial.mkv");
+    for (const auto& [encoder, options] : clip.encoders) {
+        if (m_cancelled) break;
+        const auto start = std::chrono::steady_clock::now();
+        std::string encodeError = Encode(clip, encoder, options, partial);
+        if (encodeError.empty() && std::filesystem::file_size(partial, ec) > 0 && !ec) {
+            std::filesystem::rename(partial, path, ec);
+            if (!ec) {
+                LOG_INFO("HwdecProbe", "Encoded " + clip.key + " probe clip with " + encoder + " in " + Elapsed(start));
+                return true;
+            }
+            encodeError = ec.message();
+        }
+        if (encodeError.empty()) encodeError = "no output";
+        error += (error.empty() ? "" : "; ") + encoder + ": " + encodeError;
+        std::filesystem::remove(partial, ec);
+    }
+    if (error.empty()) error = m_cancelled ? "cancelled" : "no encoder";
+    return false;
+}
+
+static void SetOption(mpv_handle* mpv, const char* name, const std::string& value)
+{
+    mpv_set_option_string(mpv, name, value.c_str());
+}
+
+// Waits for the file to end; onEvent sees every other event. Returns an empty
+// string after a clean end, otherwise why it did not end cleanly.
+template <typename OnEvent>
+static std::string WaitForEndFile(mpv_handle* mpv, std::chrono::seconds timeout, const std::atomic<bool>& cancelled, OnEvent onEvent)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!cancelled) {
+        if (std::chrono::steady_clock::now() >= deadline) return "timeout";
+        mpv_event* ev = mpv_wait_event(mpv, 0.1);
+        if (ev->event_id == MPV_EVENT_SHUTDOWN) return "shutdown";
+        if (ev->event_id != MPV_EVENT_END_FILE) {
+            onEvent(ev);
+            continue;
+        }
+        mpv_event_end_file* ef = static_cast<mpv_event_end_file*>(ev->data);
+        if (ef->reason == MPV_END_FILE_REASON_ERROR) return std::string("error: ") + mpv_error_string(ef->error);
+        return {};
+    }
+    return "cancelled";
+}
+
+static std::string LoadFile(mpv_handle* mpv, const std::string& url)
+{
+    const char* args[] = { "loadfile", url.c_str(), nullptr };
+    int rc = mpv_command(mpv, args);
+    return rc < 0 ? std::string("error: ") + mpv_error_string(rc) : std::string();
+}
+
+// mpv's encoding mode writes the container trailer when the instance is
+// destroyed, so the output is only complete after mpv_terminate_destroy.
+std::string HwdecProbe::Encode(const Clip& clip, const std::string& encoder, const std::string& options, const std::filesystem::path& out)
+{
+    mpv_handle* mpv = mpv_create();
+    if (!mpv) return "mpv_create failed";
+    SetOption(mpv, "o", Platform::WideToUtf8(out.wstring()));
+    SetOption(mpv, "of", "matroska");
+    SetOption(mpv, "ovc", encoder);
+    SetOption(mpv, "ovcopts", options);
+    SetOption(mpv, "audio", "no");
+    std::string error;
+    if (mpv_initialize(mpv) < 0) error = "mpv_initialize failed";
+    if (error.empty()) error = LoadFile(mpv, clip.lavfi);
+    if (error.empty()) error = WaitForEndFile(mpv, CLIP_TIMEOUT, m_cancelled, [](mpv_event*) {});
+    mpv_terminate_destroy(mpv);
+    return error;
+}
+
+// hwdec-current names the active hardware decoder and drops to "no" when mpv
+// falls back to software, at init or mid-stream.
+std::string HwdecProbe::TryDecode(const std::filesystem::path& clip, const std::string& hwdec)
+{
+    mpv_handle* mpv = mpv_create();
+    if (!mpv) return "mpv_create failed";
+    SetOption(mpv, "vo", "null");
+    SetOption(mpv, "ao", "null");
+    SetOption(mpv, "audio", "no");
+    SetOption(mpv, "hwdec", hwdec);
+    SetOption(mpv, "hwdec-codecs", "all");
+    SetOption(mpv, "untimed", "yes");
+    SetOption(mpv, "frames", std::to_string(DECODE_FRAMES));
+    if (mpv_initialize(mpv) < 0) {
+        mpv_terminate_destroy(mpv);
+        return "mpv_initialize failed";
+    }
+    mpv_observe_property(mpv, 0, "hwdec-current", MPV_FORMAT_NODE);
+
+    bool active = false;
+    bool fellBack = false;
+    std::string error = LoadFile(mpv, Platform::WideToUtf8(clip.wstring()));
+    if (error.empty()) {
+        error = WaitForEndFile(mpv, DECODE_TIMEOUT, m_cancelled, [&](mpv_event* ev) {
+            if (ev->event_id != MPV_EVENT_PROPERTY_CHANGE) return;
+            mpv_event_property* prop = static_cast<mpv_event_property*>(ev->data);
+            mpv_node* node = static_cast<mpv_node*>(prop->data);
+            if (!node || node->format != MPV_FORMAT_STRING || !node->u.string || !*node->u.string) return;
+            if (std::strcmp(node->u.string, "no") != 0) active = true;
+            else if (active) fellBack = true;
+        });
+    }
+    mpv_terminate_destroy(mpv);
+
+    if (!error.empty()) return error;
+    return active && !fellBack ? "ok" : "fallback";
+}
@@ -0,0 +1,97 @@
+#ifndef HWDEC_PROBE_H
+#define HWDEC_PROBE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <cstdint>
+#include <filesystem>
+#include <mpv/client.h>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+struct HwdecCodecResult {
+    std::string hwdec = "no";                     // value applied to mpv's hwdec option
+    std::map<std::string, std::string> attempts;  // probed backend -> "ok", "fallback" or the failure
+    int64_t probeMs = 0;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(HwdecCodecResult, hwdec, attempts, probeMs)
+
+// Codec -> hwdec decisions for one GPU/driver/mpv combination, persisted as
+// portable_config/hwdec-table.json.
+struct HwdecTable {
+    std::string fingerprint;
+    int64_t probedAt = 0;  // unix seconds
+    std::map<std::string, HwdecCodecResult> codecs;
+    std::map<std::string, std::string> skipped;  // codec -> why it has no result
+
+    bool Load(const std::filesystem::path& file);
+    bool Save(const std::filesystem::path& file) const;
+    // nullopt for codecs that were not probed; mpv's own hwdec setting applies to those.
+    std::optional<std::string> Lookup(const std::string& codecKey) const;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(HwdecTable, fingerprint, probedAt, codecs, skipped)
+
+// Finds the hardware decoders that actually work here, per codec, by decoding
+// a short clip with each candidate in a throwaway vo=null mpv instance and
+// watching hwdec-current for a fallback to software.
+//
+// Clips are read from the clip directory and, when missing, encoded once from
+// a lavfi test source with libmpv's encoding mode. Codecs whose clip cannot be
+// produced (no encoder in the mpv build) are listed as skipped.
+//
+// Candidates are probed in their -copy form, which needs no VO interop; the
+// applied value is the zero-copy variant where the default VO supports it.
+class HwdecProbe
+{
+public:
+    struct Candidate {
+        std::string probe;  // hwdec value tested
+        std::string apply;  // hwdec value used for playback when the probe succeeds
+    };
+
+    struct Clip {
+        std::string key;    // table key, see CodecKey()
+        std::string lavfi;  // test source the clip is encoded from
+        std::vector<std::pair<std::string, std::string>> encoders;  // encoder, ovcopts; first that works wins
+    };
+
+    static constexpr std::chrono::seconds CLIP_TIMEOUT{30};
+    static constexpr std::chrono::seconds DECODE_TIMEOUT{10};
+    // Frames decoded per attempt; enough for a late fallback to show.
+    static constexpr int DECODE_FRAMES = 24;
+
+    // Backends worth trying on this platform, in order of preference.
+    static std::vector<Candidate> GetPlatformCandidates();
+    // Comma-separated hwdec values, each probed and applied as given; empty
+    // yields the platform candidates.
+    static std::vector<Candidate> ParseCandidates(const std::string& list);
+    static const std::vector<Clip>& GetClips();
+    // Table key for a video track: "hevc" with profile "Main 10" -> "hevc-10bit".
+    static std::string CodecKey(const std::string& codec, const std::string& profile);
+    // GPU driver plus the mpv and FFmpeg builds; a table from another fingerprint is re-probed.
+    static std::string Fingerprint(mpv_handle* mpv, const std::vector<Candidate>& candidates);
+
+    HwdecProbe(std::filesystem::path clipDir, std::vector<Candidate> candidates);
+
+    // Blocks for up to a few seconds per codec and candidate.
+    HwdecTable Run(const std::string& fingerprint);
+    // Thread-safe; Run() returns early with what it has.
+    void Cancel() { m_cancelled = true; }
+    bool IsCancelled() const { return m_cancelled; }
+
+private:
+    bool EnsureClip(const Clip& clip, std::filesystem::path& path, std::string& error);
+    std::string Encode(const Clip& clip, const std::string& encoder, const std::string& options, const std::filesystem::path& out);
+    std::string TryDecode(const std::filesystem::path& clip, const std::string& hwdec);
+
+    std::filesystem::path m_clipDir;
+    std::vector<Candidate> m_candidates;
+    std::atomic<bool> m_cancelled{false};
+};
+
+#endif // HWDEC_PROBE_H
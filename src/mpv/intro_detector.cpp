@@ -0,0 +1,547 @@
+#include "intro_detector.h"
+#include "audio_fingerprint.h"
+#include "sprite_generator.h"
+#include "../logger/logger.h"
+#include "../metrics/metrics.h"
+#include "../platform/platform.h"
+#include <fstream>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+static const char* const INTERRUPTED = "interrupted";
+static const char* const KINDS[2] = { "intro", "credits" };
+
+bool IntroSeries::Load(const std::filesystem::path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+    try {
+        json::parse(in).get_to(*this);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("IntroDetector", std::string("Ignoring unreadable series cache: ") + e.what());
+        return false;
+    }
+}
+
+bool IntroSeries::Save(const std::filesystem::path& file) const
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out << json(*this).dump(2) << '\n';
+    return static_cast<bool>(out);
+}
+
+// Fingerprints are stored as raw hashes in native byte order.
+static bool LoadHashes(const std::filesystem::path& file, std::vector<uint32_t>& hashes)
+{
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(file, ec);
+    std::ifstream in(file, std::ios::binary);
+    if (ec || !in || size == 0 || size % sizeof(uint32_t) != 0) return false;
+    hashes.resize(static_cast<size_t>(size / sizeof(uint32_t)));
+    in.read(reinterpret_cast<char*>(hashes.data()), static_cast<std::streamsize>(size));
+    return static_cast<bool>(in);
+}
+
+// Written beside the target and renamed over it, like the sprite sheet files.
+static bool SaveHashes(const std::filesystem::path& file, const std::vector<uint32_t>& hashes)
+{
+    std::filesystem::path partial = file;
+    partial += ".partial";
+    std::error_code ec;
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(hashes.data()), static_cast<std::streamsize>(hashes.size() * sizeof(uint32_t)));
+        if (!out) {
+            out.close();
+            std::filesystem::remove(partial, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(partial, file, ec);
+    return !ec;
+}
+
+static bool SaveSeries(const std::filesystem::path& file, const IntroSeries& series)
+{
+    std::filesystem::path partial = file;
+    partial += ".partial";
+    std::error_code ec;
+    if (!series.Save(partial)) {
+        std::filesystem::remove(partial, ec);
+        return false;
+    }
+    std::filesystem::rename(partial, file, ec);
+    return !ec;
+}
+
+static std::filesystem::path ReferenceFile(const std::filesystem::path& dir, int kind)
+{
+    return dir / (std::string(KINDS[kind]) + ".fp");
+}
+
+static std::filesystem::path PendingFile(const std::filesystem::path& dir, const std::string& hash, int kind)
+{
+    return dir / (hash + "-" + KINDS[kind] + ".fp");
+}
+
+// Lower-case letters and digits, anything else collapsed into single dashes.
+static std::string Slug(const std::string& text)
+{
+    std::string slug;
+    for (unsigned char c : text) {
+        if (std::isalnum(c)) slug += static_cast<char>(std::tolower(c));
+        else if (!slug.empty() && slug.back() != '-') slug += '-';
+    }
+    while (!slug.empty() && slug.back() == '-') slug.pop_back();
+    if (slug.size() > 64) slug.resize(64);
+    return slug;
+}
+
+static std::string PercentDecode(const std::string& text)
+{
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '%' && i + 2 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(text[i + 2]))) {
+            out += static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+std::string IntroDetector::SeriesKey(const std::string& seriesId, const std::string& url)
+{
+    if (!seriesId.empty()) return Slug(seriesId);
+
+    std::string name = url.substr(0, url.find_first_of("?#"));
+    const size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos) name = name.substr(slash + 1);
+    name = PercentDecode(name);
+
+    // "Show.Name.S01E02...", "Show Name - s1e2 - ..."
+    auto digit = [&](size_t i) { return i < name.size() && std::isdigit(static_cast<unsigned char>(name[i])); };
+    for (size_t i = 1; i < name.size(); i++) {
+        if ((name[i] != 'S' && name[i] != 's') || std::isalnum(static_cast<unsigned char>(name[i - 1])) || !digit(i + 1)) continue;
+        size_t at = i + 1;
+        int season = 0;
+        while (digit(at) && at - i <= 2) season = season * 10 + (name[at++] - '0');
+        if (at < name.size() && (name[at] == ' ' || name[at] == '.' || name[at] == '_' || name[at] == '-')) at++;
+        if (at >= name.size() || (name[at] != 'E' && name[at] != 'e') || !digit(at + 1)) continue;
+        const std::string show = Slug(name.substr(0, i));
+        if (show.empty()) return {};
+        return show + "-s" + std::to_string(season);
+    }
+    return {};
+}
+
+IntroDetector::IntroDetector(std::filesystem::path cacheDir, UpdateCallback onUpdate)
+    : m_cacheDir(std::move(cacheDir)), m_onUpdate(std::move(onUpdate))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_cacheDir, ec);
+    m_worker = std::thread(&IntroDetector::WorkerLoop, this);
+}
+
+IntroDetector::~IntroDetector()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void IntroDetector::SetSource(const std::string& url, const std::string& seriesId)
+{
+    const std::string series = url.empty() ? std::string() : SeriesKey(seriesId, url);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (url == m_source && series == m_series) return;
+        m_source = url;
+        m_series = series;
+        m_generation++;
+        m_hints.reset();
+        m_steadySince.reset();
+        m_started = false;
+        m_analyzed = false;
+        m_failures = 0;
+    }
+    m_cv.notify_all();
+}
+
+void IntroDetector::SetPlaybackSteady(bool steady)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!steady) m_steadySince.reset();
+    else if (!m_steadySince) m_steadySince = Clock::now();
+}
+
+std::optional<IntroDetector::Hints> IntroDetector::GetHints()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hints;
+}
+
+bool IntroDetector::ReadyToRun(Clock::time_point now) const
+{
+    if (!m_hints || m_hints->complete || m_analyzed || m_failures >= MAX_FAILURES || !m_steadySince) return false;
+    return now - *m_steadySince >= (m_started ? RESUME_AFTER : STABLE_AFTER);
+}
+
+bool IntroDetector::Interrupted(uint64_t generation) const
+{
+    return m_stopping || generation != m_generation || !m_steadySince;
+}
+
+void IntroDetector::WorkerLoop()
+{
+    static Metrics::Counter& s_analyses = Metrics::GetCounter("intros.analyses");
+    static Metrics::Counter& s_failures = Metrics::GetCounter("intros.failures");
+
+    Platform::SetBackgroundThreadPriority();
+
+    uint64_t prepared = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // Steadiness is a matter of time, so the predicate is re-checked every second.
+        m_cv.wait_for(lock, std::chrono::seconds(1), [&]() {
+            return m_stopping || prepared != m_generation || ReadyToRun(Clock::now());
+        });
+        if (m_stopping) break;
+
+        if (prepared != m_generation) {
+            prepared = m_generation;
+            const std::string url = m_source;
+            const std::string series = m_series;
+            if (url.empty()) continue;
+            lock.unlock();
+            std::optional<Hints> hints = Prepare(url, series);
+            lock.lock();
+            if (prepared != m_generation) continue;
+            m_hints = hints;
+            if (hints && (hints->complete || !hints->ranges.empty())) {
+                lock.unlock();
+                m_onUpdate(*hints);
+                lock.lock();
+            }
+            continue;
+        }
+        if (!ReadyToRun(Clock::now())) continue;
+
+        const uint64_t generation = m_generation;
+        const std::string url = m_source;
+        const std::string series = m_series;
+        Hints hints = *m_hints;
+        m_started = true;
+        lock.unlock();
+
+        std::string error;
+        const bool ok = Analyze(url, series, hints.hash, generation, hints, error);
+
+        lock.lock();
+        if (generation != m_generation) continue;
+        if (ok) {
+            s_analyses.Add();
+            m_analyzed = true;
+            m_hints = hints;
+            lock.unlock();
+            m_onUpdate(hints);
+            lock.lock();
+        } else if (error != INTERRUPTED) {
+            s_failures.Add();
+            if (++m_failures >= MAX_FAILURES) LOG_WARN("IntroDetector", "Giving up on " + url + ": " + error);
+        }
+    }
+}
+
+// Hashes the file and loads what its series already knows about it.
+std::optional<IntroDetector::Hints> IntroDetector::Prepare(const std::string& url, const std::string& series)
+{
+    if (series.empty()) {
+        LOG_INFO("IntroDetector", "No intro detection for " + url + ": no series");
+        return std::nullopt;
+    }
+    std::string error;
+    const std::string hash = SpriteGenerator::ContentHash(url, error);
+    if (hash.empty()) {
+        LOG_INFO("IntroDetector", "No intro detection for " + url + ": " + error);
+        return std::nullopt;
+    }
+
+    Hints hints;
+    hints.series = series;
+    hints.hash = hash;
+    const std::filesystem::path file = m_cacheDir / series / "series.json";
+    IntroSeries cache;
+    if (cache.Load(file)) {
+        // Marks the series as recently used for Prune().
+        std::error_code ec;
+        std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(), ec);
+        auto it = cache.episodes.find(hash);
+        if (it != cache.episodes.end()) {
+            hints.ranges = it->second.ranges;
+            hints.complete = it->second.introChecked && it->second.creditsChecked;
+            LOG_INFO("IntroDetector", "Cached skip ranges for " + url + " (" + series + "): " + std::to_string(hints.ranges.size()));
+        }
+    }
+    return hints;
+}
+
+static void SetOption(mpv_handle* mpv, const char* name, const std::string& value)
+{
+    mpv_set_option_string(mpv, name, value.c_str());
+}
+
+// Decodes one window of audio only, as fast as mpv can: ao=pcm writes to a
+// file instead of a device and so is not paced by a clock.
+bool IntroDetector::Extract(const std::string& url, bool credits, uint64_t generation, Window& window, double& duration, std::string& error)
+{
+    static Metrics::Histogram& s_decodeUs = Metrics::GetHistogram("intros.decode_us");
+    static Metrics::Histogram& s_fingerprintUs = Metrics::GetHistogram("intros.fingerprint_us");
+
+    const std::filesystem::path scratch = m_cacheDir / "window.pcm";
+    const std::string scratchUtf8 = Platform::WideToUtf8(scratch.wstring());
+    {
+        Metrics::ScopedTimer timer(s_decodeUs);
+        mpv_handle* mpv = mpv_create();
+        if (!mpv) {
+            error = "mpv_create failed";
+            return false;
+        }
+        SetOption(mpv, "config", "no");
+        SetOption(mpv, "load-scripts", "no");
+        SetOption(mpv, "osc", "no");
+        SetOption(mpv, "ytdl", "no");
+        SetOption(mpv, "input-default-bindings", "no");
+        SetOption(mpv, "vid", "no");
+        SetOption(mpv, "sid", "no");
+        SetOption(mpv, "vo", "null");
+        SetOption(mpv, "ao", "pcm");
+        SetOption(mpv, "ao-pcm-file", scratchUtf8);
+        SetOption(mpv, "ao-pcm-waveheader", "no");
+        SetOption(mpv, "audio-format", "s16");
+        SetOption(mpv, "audio-samplerate", std::to_string(AudioFingerprinter::SAMPLE_RATE));
+        SetOption(mpv, "audio-channels", "mono");
+        SetOption(mpv, "hr-seek", "yes");
+        SetOption(mpv, "cache", "no");
+        SetOption(mpv, "idle", "yes");
+        // A negative start counts from the end.
+        if (credits) SetOption(mpv, "start", std::to_string(-CREDITS_WINDOW_SEC));
+        else SetOption(mpv, "end", std::to_string(INTRO_WINDOW_SEC));
+
+        if (mpv_initialize(mpv) < 0) error = "mpv_initialize failed";
+        if (error.empty()) {
+            const char* load[] = { "loadfile", url.c_str(), "replace", nullptr };
+            int rc = mpv_command(mpv, load);
+            if (rc < 0) error = mpv_error_string(rc);
+        }
+        if (error.empty()) error = WaitFor(mpv, MPV_EVENT_FILE_LOADED, LOAD_TIMEOUT, generation);
+        if (error.empty() && (mpv_get_property(mpv, "duration", MPV_FORMAT_DOUBLE, &duration) < 0 || duration <= 0.0)) {
+            error = "unknown duration";
+        }
+        if (error.empty()) error = WaitFor(mpv, MPV_EVENT_END_FILE, DECODE_TIMEOUT, generation);
+        mpv_terminate_destroy(mpv);
+    }
+
+    std::vector<int16_t> samples;
+    if (error.empty()) {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(scratch, ec);
+        std::ifstream in(scratch, std::ios::binary);
+        if (!ec && in) {
+            samples.resize(static_cast<size_t>(size / sizeof(int16_t)));
+            in.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(samples.size() * sizeof(int16_t)));
+        }
+        if (ec || !in) error = "cannot read the decoded audio";
+    }
+    std::error_code ec;
+    std::filesystem::remove(scratch, ec);
+    if (!error.empty()) return false;
+
+    {
+        Metrics::ScopedTimer timer(s_fingerprintUs);
+        AudioFingerprinter fingerprinter;
+        window.hashes = fingerprinter.Compute(samples.data(), samples.size());
+    }
+    window.start = credits ? (std::max)(duration - CREDITS_WINDOW_SEC, 0.0) : 0.0;
+    if (window.hashes.size() < MIN_RANGE_SEC / AudioFingerprinter::HASH_SEC) {
+        error = "too little audio";
+        return false;
+    }
+    return true;
+}
+
+// Returns an empty string once the event arrives. END_FILE only counts as
+// failure when it carries an error; it is also the end of a decoded window.
+std::string IntroDetector::WaitFor(mpv_handle* mpv, mpv_event_id id, std::chrono::seconds timeout, uint64_t generation)
+{
+    const auto deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (Interrupted(generation)) return INTERRUPTED;
+        }
+        mpv_event* ev = mpv_wait_event(mpv, 0.1);
+        if (ev->event_id == MPV_EVENT_SHUTDOWN) return "mpv shut down";
+        if (ev->event_id == MPV_EVENT_END_FILE) {
+            mpv_event_end_file* ef = static_cast<mpv_event_end_file*>(ev->data);
+            if (ef->reason == MPV_END_FILE_REASON_ERROR) return mpv_error_string(ef->error);
+        }
+        if (ev->event_id == id) return {};
+    }
+    return "timed out";
+}
+
+static SkipRange ToRange(int kind, double windowStart, const AudioFingerprinter::Segment& segment, double duration)
+{
+    // A hash spans its frame and the one before; the last one ends a frame past its hop.
+    const double tail = static_cast<double>(AudioFingerprinter::FRAME_SIZE - AudioFingerprinter::HOP_SIZE) / AudioFingerprinter::SAMPLE_RATE;
+    SkipRange range;
+    range.kind = KINDS[kind];
+    range.start = windowStart + segment.bStart * AudioFingerprinter::HASH_SEC;
+    range.end = windowStart + (segment.bStart + segment.length) * AudioFingerprinter::HASH_SEC + tail;
+    if (duration > 0.0) range.end = (std::min)(range.end, duration);
+    return range;
+}
+
+static void SetRange(IntroEpisode& episode, int kind, const std::optional<SkipRange>& range)
+{
+    episode.ranges.erase(std::remove_if(episode.ranges.begin(), episode.ranges.end(),
+                                        [&](const SkipRange& r) { return r.kind == KINDS[kind]; }),
+                         episode.ranges.end());
+    if (range) episode.ranges.push_back(*range);
+    std::sort(episode.ranges.begin(), episode.ranges.end(), [](const SkipRange& a, const SkipRange& b) { return a.start < b.start; });
+    (kind == 0 ? episode.introChecked : episode.creditsChecked) = true;
+}
+
+// Fingerprints whichever windows of the episode were not yet compared with
+// a series reference, reusing fingerprints kept from an earlier play, and
+// matches them against the reference, or against the other kept episodes to
+// find one.
+bool IntroDetector::Analyze(const std::string& url, const std::string& series, const std::string& hash, uint64_t generation, Hints& hints, std::string& error)
+{
+    static Metrics::Histogram& s_alignUs = Metrics::GetHistogram("intros.align_us");
+
+    const std::filesystem::path dir = m_cacheDir / series;
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    IntroSeries cache;
+    if (!cache.Load(dir / "series.json")) cache = IntroSeries();
+    cache.series = series;
+    const int minLength = static_cast<int>(std::ceil(MIN_RANGE_SEC / AudioFingerprinter::HASH_SEC));
+
+    for (int kind = 0; kind < 2; kind++) {
+        IntroEpisode& episode = cache.episodes[hash];
+        if (kind == 0 ? episode.introChecked : episode.creditsChecked) continue;
+
+        Window window;
+        if (LoadHashes(PendingFile(dir, hash, kind), window.hashes)) {
+            window.start = kind == 1 ? episode.creditsFrom : 0.0;
+        } else {
+            double duration = 0.0;
+            if (!Extract(url, kind == 1, generation, window, duration, error)) return false;
+            episode.duration = duration;
+            if (kind == 1) episode.creditsFrom = window.start;
+        }
+
+        Metrics::ScopedTimer timer(s_alignUs);
+        std::vector<uint32_t> reference;
+        if (!LoadHashes(ReferenceFile(dir, kind), reference)) {
+            // The longest stretch this episode shares with any kept one.
+            std::optional<AudioFingerprinter::Segment> best;
+            std::vector<uint32_t> bestHashes;
+            for (const auto& [other, entry] : cache.episodes) {
+                std::vector<uint32_t> theirs;
+                if (other == hash || !LoadHashes(PendingFile(dir, other, kind), theirs)) continue;
+                std::optional<AudioFingerprinter::Segment> segment = AudioFingerprinter::FindSharedSegment(theirs, window.hashes, minLength);
+                if (segment && (!best || segment->length > best->length)) {
+                    best = segment;
+                    bestHashes = std::move(theirs);
+                }
+            }
+            if (best) {
+                reference.assign(bestHashes.begin() + best->aStart, bestHashes.begin() + best->aStart + best->length);
+                if (!SaveHashes(ReferenceFile(dir, kind), reference)) {
+                    error = "cannot write to " + Platform::WideToUtf8(dir.wstring());
+                    return false;
+                }
+                LOG_INFO("IntroDetector", std::string("Found the ") + KINDS[kind] + " of " + series + ": " +
+                         std::to_string(reference.size() * AudioFingerprinter::HASH_SEC) + "s");
+                // Every kept episode is placed against the new reference and released.
+                for (auto& [other, entry] : cache.episodes) {
+                    std::vector<uint32_t> theirs;
+                    if (other == hash || !LoadHashes(PendingFile(dir, other, kind), theirs)) continue;
+                    std::optional<AudioFingerprinter::Segment> segment = AudioFingerprinter::FindSharedSegment(reference, theirs, minLength);
+                    const double start = kind == 1 ? entry.creditsFrom : 0.0;
+                    SetRange(entry, kind, segment ? std::optional<SkipRange>(ToRange(kind, start, *segment, entry.duration)) : std::nullopt);
+                    std::filesystem::remove(PendingFile(dir, other, kind), ec);
+                }
+            }
+        }
+
+        IntroEpisode& current = cache.episodes[hash];
+        if (reference.empty()) {
+            // Nothing to match yet; kept for the next episode of the series.
+            if (!SaveHashes(PendingFile(dir, hash, kind), window.hashes)) {
+                error = "cannot write to " + Platform::WideToUtf8(dir.wstring());
+                return false;
+            }
+            continue;
+        }
+        std::optional<AudioFingerprinter::Segment> segment = AudioFingerprinter::FindSharedSegment(reference, window.hashes, minLength);
+        SetRange(current, kind, segment ? std::optional<SkipRange>(ToRange(kind, window.start, *segment, current.duration)) : std::nullopt);
+        std::filesystem::remove(PendingFile(dir, hash, kind), ec);
+    }
+
+    if (!SaveSeries(dir / "series.json", cache)) {
+        error = "cannot write to " + Platform::WideToUtf8(dir.wstring());
+        return false;
+    }
+    Prune(series);
+
+    const IntroEpisode& episode = cache.episodes[hash];
+    hints.ranges = episode.ranges;
+    hints.complete = episode.introChecked && episode.creditsChecked;
+    std::string found;
+    for (const SkipRange& range : hints.ranges) {
+        found += " " + range.kind + " " + std::to_string(range.start) + "-" + std::to_string(range.end);
+    }
+    LOG_INFO("IntroDetector", "Analyzed " + url + " (" + series + "):" + (found.empty() ? std::string(" no ranges yet") : found));
+    return true;
+}
+
+// Keeps the MAX_PENDING most recent fingerprints of each window of a series,
+// and the MAX_SERIES most recently played series.
+void IntroDetector::Prune(const std::string& keep)
+{
+    std::error_code ec;
+    for (int kind = 0; kind < 2; kind++) {
+        const std::string suffix = std::string("-") + KINDS[kind] + ".fp";
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> pending;
+        for (const auto& entry : std::filesystem::directory_iterator(m_cacheDir / keep, ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                pending.emplace_back(entry.last_write_time(ec), entry.path());
+            }
+        }
+        if (pending.size() <= MAX_PENDING) continue;
+        std::sort(pending.begin(), pending.end());
+        for (size_t i = 0; i + MAX_PENDING < pending.size(); i++) std::filesystem::remove(pending[i].second, ec);
+    }
+
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> series;
+    for (const auto& entry : std::filesystem::directory_iterator(m_cacheDir, ec)) {
+        if (!entry.is_directory(ec) || entry.path().filename() == keep) continue;
+        series.emplace_back(std::filesystem::last_write_time(entry.path() / "series.json", ec), entry.path());
+    }
+    if (series.size() < MAX_SERIES) return;
+    std::sort(series.begin(), series.end());
+    for (size_t i = 0; i + MAX_SERIES <= series.size(); i++) std::filesystem::remove_all(series[i].second, ec);
+}
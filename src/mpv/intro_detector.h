@@ -0,0 +1,138 @@
+#ifndef INTRO_DETECTOR_H
+#define INTRO_DETECTOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mpv/client.h>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// A stretch of an episode shared with the other episodes of its series.
+struct SkipRange {
+    std::string kind;  // "intro" or "credits"
+    double start = 0.0;
+    double end = 0.0;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SkipRange, kind, start, end)
+
+// What is known about one episode, keyed by its content hash in IntroSeries.
+struct IntroEpisode {
+    double duration = 0.0;
+    double creditsFrom = 0.0;     // where its credits window starts
+    bool introChecked = false;    // compared against the series' intro reference
+    bool creditsChecked = false;
+    std::vector<SkipRange> ranges;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(IntroEpisode, duration, creditsFrom, introChecked, creditsChecked, ranges)
+
+// series.json of one series directory.
+struct IntroSeries {
+    std::string series;
+    std::map<std::string, IntroEpisode> episodes;
+
+    bool Load(const std::filesystem::path& file);
+    bool Save(const std::filesystem::path& file) const;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(IntroSeries, series, episodes)
+
+// Finds the intro and end credits of episodes from the audio they share with
+// other episodes of the same series, replacing the in-player skip-intro script.
+//
+// A second mpv instance decodes the first INTRO_WINDOW_SEC and last
+// CREDITS_WINDOW_SEC of the episode as 8 kHz mono PCM, untimed, and each
+// window is fingerprinted (see AudioFingerprinter). Until a series has a
+// reference for a window, episodes' fingerprints are kept on disk and each
+// new one is aligned against them; the longest shared stretch becomes the
+// reference, cut out of the older episode. Later episodes are aligned against
+// the reference only. Ranges are cached per series under the episode's
+// content hash, so an episode seen before needs no decoding at all.
+//
+// Like SpriteGenerator, analysis only starts once the main playback has been
+// steady for STABLE_AFTER, is abandoned when it stops being steady, and runs
+// at background priority.
+class IntroDetector
+{
+public:
+    struct Hints {
+        std::string series;
+        std::string hash;
+        bool complete = false;  // both windows were compared with a series reference
+        std::vector<SkipRange> ranges;
+    };
+    // Runs on the detector thread when an episode's ranges are known or change.
+    using UpdateCallback = std::function<void(const Hints& hints)>;
+
+    static constexpr double INTRO_WINDOW_SEC = 360.0;
+    static constexpr double CREDITS_WINDOW_SEC = 300.0;
+    static constexpr double MIN_RANGE_SEC = 15.0;
+    static constexpr size_t MAX_PENDING = 4;        // fingerprinted episodes kept per series
+    static constexpr size_t MAX_SERIES = 200;
+    static constexpr int MAX_FAILURES = 2;
+    static constexpr std::chrono::seconds STABLE_AFTER{30};
+    static constexpr std::chrono::seconds RESUME_AFTER{30};
+    static constexpr std::chrono::seconds LOAD_TIMEOUT{15};
+    static constexpr std::chrono::seconds DECODE_TIMEOUT{300};
+
+    IntroDetector(std::filesystem::path cacheDir, UpdateCallback onUpdate);
+    ~IntroDetector();
+
+    // The file being played and the id of its series, from the play command;
+    // empty when nothing is. Without an id the series is guessed from an
+    // "S01E02" style file name. Files with neither are left alone.
+    void SetSource(const std::string& url, const std::string& seriesId);
+    // Fed with every QoS sample of the main playback.
+    void SetPlaybackSteady(bool steady);
+
+    std::optional<Hints> GetHints();
+
+    // Directory name for a series; empty when there is none.
+    static std::string SeriesKey(const std::string& seriesId, const std::string& url);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Window {
+        double start = 0.0;  // in the episode
+        std::vector<uint32_t> hashes;
+    };
+
+    void WorkerLoop();
+    std::optional<Hints> Prepare(const std::string& url, const std::string& series);
+    bool Analyze(const std::string& url, const std::string& series, const std::string& hash, uint64_t generation, Hints& hints, std::string& error);
+    bool Extract(const std::string& url, bool credits, uint64_t generation, Window& window, double& duration, std::string& error);
+    std::string WaitFor(mpv_handle* mpv, mpv_event_id id, std::chrono::seconds timeout, uint64_t generation);
+    void Prune(const std::string& keep);
+
+    // Callers hold m_mutex.
+    bool ReadyToRun(Clock::time_point now) const;
+    bool Interrupted(uint64_t generation) const;
+
+    std::filesystem::path m_cacheDir;
+    UpdateCallback m_onUpdate;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+    std::string m_source;
+    std::string m_series;
+    uint64_t m_generation = 0;        // bumped by every SetSource()
+    std::optional<Hints> m_hints;     // of m_source, once hashed
+    std::optional<Clock::time_point> m_steadySince;
+    bool m_started = false;           // analysis was attempted for m_source
+    bool m_analyzed = false;          // and got through
+    int m_failures = 0;
+
+    std::thread m_worker;
+};
+
+#endif // INTRO_DETECTOR_H
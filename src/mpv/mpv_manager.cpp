@@ -1,9 +1,13 @@
 #include "mpv_manager.h"
-#include "../app/app_manager.h"
+#include "../settings/settings_manager.h"
 #include "../logger/logger.h"
 #include "../webview_protocol/event_emitter/event_emitter.h"
+#include "../platform/platform.h"
+#include "../metrics/metrics.h"
 #include "../helpers/helpers.h"
-#include "../globals/globals.h"
+#include "../webview_protocol/command_handler/command_handler.h"
+#include <cstring>
+#include <array>
 
 json MPVManager::MpvNodeToJson(const mpv_node* node)
 {
@@ -29,32 +33,78 @@ json MPVManager::MpvNodeToJson(const mpv_node* node)
     }
 }
 
-MPVManager::MPVManager(AppManager* appManager) : m_appManager(appManager), m_mpv(nullptr), m_hwnd(nullptr) {}
+static WebViewProtocol::SpriteSheetsEventPayload ToSpriteSheetsPayload(const SpriteSheetIndex& index)
+{
+    WebViewProtocol::SpriteSheetsEventPayload payload;
+    payload.hash = index.hash;
+    payload.duration = index.duration;
+    payload.intervalSec = index.intervalSec;
+    payload.tileWidth = index.tileWidth;
+    payload.tileHeight = index.tileHeight;
+    payload.columns = index.columns;
+    payload.rows = index.rows;
+    payload.tiles = index.tiles;
+    payload.sheets = index.Sheets();
+    payload.complete = index.complete;
+    payload.vtt = index.ToVtt();
+    return payload;
+}
+
+static WebViewProtocol::ChapterHintsEventPayload ToChapterHintsPayload(const IntroDetector::Hints& hints)
+{
+    WebViewProtocol::ChapterHintsEventPayload payload;
+    payload.series = hints.series;
+    payload.hash = hints.hash;
+    payload.complete = hints.complete;
+    for (const SkipRange& range : hints.ranges) {
+        payload.chapters.push_back({ range.kind, range.kind == "intro" ? "Intro" : "Credits", range.start, range.end });
+    }
+    return payload;
+}
+
+MPVManager::MPVManager(AppSettings& settings) : m_settings(settings), m_mpv(nullptr) {}
 
 MPVManager::~MPVManager()
 {
+    m_thumbnails.reset();
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        m_samplerStopping = true;
+    }
+    m_samplerCv.notify_all();
+    if (m_samplerThread.joinable()) m_samplerThread.join();
+    // After the sampler, which feeds them.
+    m_sprites.reset();
+    m_intros.reset();
+    if (m_hwdecProbe) m_hwdecProbe->Cancel();
+    if (m_hwdecProbeThread.joinable()) m_hwdecProbeThread.join();
     if (m_mpv)
     {
         mpv_terminate_destroy(m_mpv);
     }
 }
 
-bool MPVManager::Initialize(HWND videoHostWindow)
+bool MPVManager::Initialize(int64_t windowId, WakeupCallback onWakeup)
 {
-    m_hwnd = videoHostWindow;
+    m_onWakeup = std::move(onWakeup);
     m_mpv = mpv_create();
     if (!m_mpv) { LOG_ERROR("MPVManager", "mpv_create failed"); return false; }
     
-    const auto& settings = m_appManager->GetSettings();
+    const auto& settings = m_settings;
 
-    int64_t wid = (int64_t)m_hwnd;
-    mpv_set_option(m_mpv, "wid", MPV_FORMAT_INT64, &wid);
-    mpv_set_option_string(m_mpv, "vo", settings.initialVO.c_str());
+    if (windowId) {
+        mpv_set_option(m_mpv, "wid", MPV_FORMAT_INT64, &windowId);
+        mpv_set_option_string(m_mpv, "vo", settings.initialVO.c_str());
+    } else {
+        mpv_set_option_string(m_mpv, "vo", "null");
+        mpv_set_option_string(m_mpv, "ao", "null");
+    }
     mpv_set_option_string(m_mpv, "config", "yes");
     
-    std::wstring cfgDir = GetExeDirectory() + L"\\portable_config";
-    CreateDirectoryW(cfgDir.c_str(), nullptr);
-    mpv_set_option_string(m_mpv, "config-dir", WStringToUtf8(cfgDir).c_str());
+    std::filesystem::path cfgDir = Platform::GetExecutableDirectory() / "portable_config";
+    std::error_code ec;
+    std::filesystem::create_directories(cfgDir, ec);
+    mpv_set_option_string(m_mpv, "config-dir", Platform::WideToUtf8(cfgDir.wstring()).c_str());
     
     mpv_set_wakeup_callback(m_mpv, MPVManager::MpvWakeupCallback, this);
 
@@ -69,6 +119,28 @@ bool MPVManager::Initialize(HWND videoHostWindow)
     mpv_observe_property(m_mpv, 0, "volume", MPV_FORMAT_NODE);
     mpv_observe_property(m_mpv, 0, "mute", MPV_FORMAT_NODE);
 
+    m_qosLiveEvents = settings.qosLiveEvents;
+    m_adaptiveCache = settings.adaptiveCache;
+    m_samplerThread = std::thread(&MPVManager::SampleLoop, this, m_mpv);
+
+    if (settings.thumbnails) m_thumbnails = std::make_unique<ThumbnailService>(cfgDir / "thumbnails");
+    if (settings.spriteSheets) {
+        m_sprites = std::make_unique<SpriteGenerator>(cfgDir / "sprites", [](const SpriteSheetIndex& index) {
+            WebViewProtocol::EventEmitter::emitSpriteSheets(ToSpriteSheetsPayload(index));
+        });
+    }
+    if (settings.introDetection) {
+        m_intros = std::make_unique<IntroDetector>(cfgDir / "intros", [](const IntroDetector::Hints& hints) {
+            WebViewProtocol::EventEmitter::emitChapterHints(ToChapterHintsPayload(hints));
+        });
+    }
+
+    if (settings.hwdecProbe) {
+        // on_preloaded runs after the demuxer opened and before decoders are created.
+        mpv_hook_add(m_mpv, 0, "on_preloaded", 0);
+        StartHwdecProbe(cfgDir);
+    }
+
     LOG_INFO("MPVManager", "MPV initialized successfully.");
     return true;
 }
@@ -76,16 +148,42 @@ bool MPVManager::Initialize(HWND videoHostWindow)
 void MPVManager::MpvWakeupCallback(void* ctx)
 {
     MPVManager* self = static_cast<MPVManager*>(ctx);
-    if (self && self->m_hwnd) PostMessage(self->m_hwnd, WM_MPV_WAKEUP, 0, 0);
+    if (self && self->m_onWakeup) self->m_onWakeup();
 }
 
 
+static const char* EndFileReasonName(int reason)
+{
+    switch (reason) {
+        case MPV_END_FILE_REASON_EOF: return "eof";
+        case MPV_END_FILE_REASON_STOP: return "stop";
+        case MPV_END_FILE_REASON_QUIT: return "quit";
+        case MPV_END_FILE_REASON_ERROR: return "error";
+        case MPV_END_FILE_REASON_REDIRECT: return "redirect";
+        default: return "unknown";
+    }
+}
+
+// Per-type event counters, resolved on first use. Only touched from the thread running HandleEvents.
+static Metrics::Counter* EventCounter(mpv_event_id id)
+{
+    static std::array<Metrics::Counter*, 64> counters{};
+    size_t index = static_cast<size_t>(id);
+    if (index >= counters.size()) index = 0;
+    if (!counters[index]) {
+        const char* name = mpv_event_name(static_cast<mpv_event_id>(index));
+        counters[index] = &Metrics::GetCounter(std::string("mpv.events.") + (name ? name : "unknown"));
+    }
+    return counters[index];
+}
+
 void MPVManager::HandleEvents()
 {
     if (!m_mpv) return;
     while (true) {
         mpv_event* ev = mpv_wait_event(m_mpv, 0);
         if (!ev || ev->event_id == MPV_EVENT_NONE) break;
+        EventCounter(ev->event_id)->Add();
 
         switch(ev->event_id) {
             case MPV_EVENT_PROPERTY_CHANGE: {
@@ -94,13 +192,41 @@ void MPVManager::HandleEvents()
                     json value = MpvNodeToJson((mpv_node*)prop->data);
                     WebViewProtocol::EventEmitter::emitPropertyChange(prop->name, value);
                     if (strcmp(prop->name, "volume") == 0 && value.is_number()) {
-                        m_appManager->GetSettings().initialVolume = value.get<int>();
+                        m_settings.initialVolume = value.get<int>();
                     }
                 }
                 break;
             }
+            case MPV_EVENT_START_FILE: {
+                // loadfile runs asynchronously and the frontend can also switch
+                // files through raw commands or the playlist, so the file that
+                // is starting is whatever mpv says it is, not the last Play().
+                char* path = mpv_get_property_string(m_mpv, "path");
+                const std::string url = path ? path : m_loadingUrl;
+                mpv_free(path);
+                const std::string seriesId = url == m_loadingUrl ? m_loadingSeriesId : std::string();
+                BeginQosSession(url);
+                BeginCachePolicy(url);
+                if (m_thumbnails) m_thumbnails->SetSource(url);
+                if (m_sprites) m_sprites->SetSource(url);
+                if (m_intros) m_intros->SetSource(url, seriesId);
+                break;
+            }
+            case MPV_EVENT_FILE_LOADED:
+                UpdateContainerBitrate();
+                break;
+            case MPV_EVENT_HOOK: {
+                mpv_event_hook* hook = (mpv_event_hook*)ev->data;
+                if (strcmp(hook->name, "on_preloaded") == 0) ApplyHwdecTable();
+                mpv_hook_continue(m_mpv, hook->id);
+                break;
+            }
             case MPV_EVENT_END_FILE: {
                 mpv_event_end_file* ef = (mpv_event_end_file*)ev->data;
+                EndQosSession(EndFileReasonName(ef->reason));
+                if (m_thumbnails) m_thumbnails->SetSource("");
+                if (m_sprites) m_sprites->SetSource("");
+                if (m_intros) m_intros->SetSource("", "");
                 if (ef->reason == MPV_END_FILE_REASON_ERROR) {
                     WebViewProtocol::EventEmitter::emitPlaybackError(mpv_error_string(ef->error));
                 } else {
@@ -110,6 +236,7 @@ void MPVManager::HandleEvents()
             }
             case MPV_EVENT_SHUTDOWN: {
                 LOG_INFO("MPVManager", "MPV shutdown event received.");
+                EndQosSession("shutdown");
                 m_mpv = nullptr;
                 break;
             }
@@ -117,7 +244,7 @@ void MPVManager::HandleEvents()
         }
     }
 }
-void MPVManager::Play(const WebViewProtocol::PlayPayload& p) { HandleMpvCommand({"loadfile", p.url, "replace"}); HandleMpvCommand({"set", "start", std::to_string(p.startTime)}); }
+void MPVManager::Play(const WebViewProtocol::PlayPayload& p) { m_loadingUrl = p.url; m_loadingSeriesId = p.seriesId; HandleMpvCommand({"loadfile", p.url, "replace"}); HandleMpvCommand({"set", "start", std::to_string(p.startTime)}); }
 void MPVManager::Stop() { HandleMpvCommand({"stop"}); }
 void MPVManager::TogglePause() { HandleMpvCommand({"cycle", "pause"}); }
 void MPVManager::Pause() { HandleMpvCommand({"set", "pause", "yes"}); }
@@ -127,6 +254,75 @@ void MPVManager::ToggleMute() { HandleMpvCommand({"cycle", "mute"}); }
 void MPVManager::SetProperty(const WebViewProtocol::SetPropertyPayload& p) { HandleMpvCommand({"set", p.property, p.value}); }
 void MPVManager::LoadSubtitle(const WebViewProtocol::LoadSubtitlePayload& p) { HandleMpvCommand({"sub-add", p.url, "select", p.url}); }
 
+void MPVManager::GetThumbnail(const WebViewProtocol::GetThumbnailPayload& payload, const std::shared_ptr<WebViewProtocol::Request>& request)
+{
+    if (!m_thumbnails) {
+        request->Reject("thumbnails are disabled");
+        return;
+    }
+    m_thumbnails->Request(payload.time, [request](std::shared_ptr<const ThumbnailService::Thumbnail> thumbnail, bool cached, const std::string& error) {
+        if (!thumbnail) {
+            request->Reject(error);
+            return;
+        }
+        WebViewProtocol::ThumbnailPayload result;
+        result.time = thumbnail->time;
+        result.bucketStart = thumbnail->bucket * ThumbnailService::BUCKET_SEC;
+        result.bucketSec = ThumbnailService::BUCKET_SEC;
+        result.width = thumbnail->width;
+        result.height = thumbnail->height;
+        result.mime = "image/jpeg";
+        result.data = Base64Encode(thumbnail->jpeg);
+        result.cached = cached;
+        request->Resolve(json(result));
+    });
+}
+
+void MPVManager::GetSpriteSheets(const std::shared_ptr<WebViewProtocol::Request>& request)
+{
+    if (!m_sprites) {
+        request->Reject("sprite sheets are disabled");
+        return;
+    }
+    std::optional<SpriteSheetIndex> index = m_sprites->GetIndex();
+    if (!index) {
+        request->Reject("no sprite sheets for this file");
+        return;
+    }
+    request->Resolve(json(ToSpriteSheetsPayload(*index)));
+}
+
+void MPVManager::GetSpriteSheet(const WebViewProtocol::GetSpriteSheetPayload& payload, const std::shared_ptr<WebViewProtocol::Request>& request)
+{
+    std::string jpeg, error;
+    if (!m_sprites) {
+        request->Reject("sprite sheets are disabled");
+    } else if (!m_sprites->ReadSheet(payload.hash, payload.sheet, jpeg, error)) {
+        request->Reject(error);
+    } else {
+        WebViewProtocol::SpriteSheetPayload result;
+        result.hash = payload.hash;
+        result.sheet = payload.sheet;
+        result.mime = "image/jpeg";
+        result.data = Base64Encode(jpeg);
+        request->Resolve(json(result));
+    }
+}
+
+void MPVManager::GetChapterHints(const std::shared_ptr<WebViewProtocol::Request>& request)
+{
+    if (!m_intros) {
+        request->Reject("intro detection is disabled");
+        return;
+    }
+    std::optional<IntroDetector::Hints> hints = m_intros->GetHints();
+    if (!hints) {
+        request->Reject("no chapter hints for this file");
+        return;
+    }
+    request->Resolve(json(ToChapterHintsPayload(*hints)));
+}
+
 void MPVManager::HandleMpvCommand(const std::vector<std::string>& args)
 {
     if (!m_mpv || args.empty()) return;
@@ -135,4 +331,229 @@ void MPVManager::HandleMpvCommand(const std::vector<std::string>& args)
     for (const auto& s : args) cargs.push_back(s.c_str());
     cargs.push_back(nullptr);
     mpv_command_async(m_mpv, 0, cargs.data());
-}
\ No newline at end of file
+}
+
+static std::optional<double> GetDoubleProperty(mpv_handle* mpv, const char* name)
+{
+    double value = 0.0;
+    if (mpv_get_property(mpv, name, MPV_FORMAT_DOUBLE, &value) < 0) return std::nullopt;
+    return value;
+}
+
+static std::optional<int64_t> GetIntProperty(mpv_handle* mpv, const char* name)
+{
+    int64_t value = 0;
+    if (mpv_get_property(mpv, name, MPV_FORMAT_INT64, &value) < 0) return std::nullopt;
+    return value;
+}
+
+static bool GetFlagProperty(mpv_handle* mpv, const char* name)
+{
+    int value = 0;
+    return mpv_get_property(mpv, name, MPV_FORMAT_FLAG, &value) >= 0 && value;
+}
+
+// Polls instead of observing: a stall is exactly the case where mpv stops
+// sending property changes. mpv_get_property is safe from any thread.
+void MPVManager::SampleLoop(mpv_handle* mpv)
+{
+    std::unique_lock<std::mutex> lock(m_samplerMutex);
+    while (!m_samplerCv.wait_for(lock, QOS_SAMPLE_INTERVAL, [this]() { return m_samplerStopping; })) {
+        if (!m_qos.IsActive()) continue;
+        lock.unlock();
+        PlaybackQosSample sample;
+        sample.timePos = GetDoubleProperty(mpv, "time-pos");
+        sample.paused = GetFlagProperty(mpv, "pause");
+        sample.pausedForCache = GetFlagProperty(mpv, "paused-for-cache");
+        sample.seeking = GetFlagProperty(mpv, "seeking");
+        sample.frameDrops = GetIntProperty(mpv, "frame-drop-count");
+        sample.decoderFrameDrops = GetIntProperty(mpv, "decoder-frame-drop-count");
+        sample.cacheDuration = GetDoubleProperty(mpv, "demuxer-cache-duration");
+        sample.cacheSpeed = GetIntProperty(mpv, "cache-speed");
+        sample.avsync = GetDoubleProperty(mpv, "avsync");
+        sample.at = PlaybackQos::Clock::now();
+        lock.lock();
+        // The file may have ended while the properties were read.
+        if (!m_qos.IsActive()) continue;
+
+        PlaybackQos::State previous = m_qos.GetState();
+        PlaybackQos::State state = m_qos.AddSample(sample);
+        if (state != previous && (state == PlaybackQos::State::Rebuffering || state == PlaybackQos::State::Stalled)) {
+            LOG_WARN("MPVManager", std::string("Playback ") + PlaybackQos::StateName(state) + " at " +
+                     std::to_string(sample.timePos.value_or(0.0)) + "s, cache " + std::to_string(sample.cacheDuration.value_or(0.0)) + "s");
+        }
+        if (m_qosLiveEvents) WebViewProtocol::EventEmitter::emitPlaybackQos(m_qos.GetLiveStatus());
+        if (m_sprites || m_intros) {
+            const bool steady = m_qos.IsSteady(m_steadyMinCacheSec);
+            if (m_sprites) m_sprites->SetPlaybackSteady(steady);
+            if (m_intros) m_intros->SetPlaybackSteady(steady);
+        }
+
+        if (!m_adaptiveCache || sample.at - m_lastCacheEvaluation < CACHE_POLICY_INTERVAL) continue;
+        m_lastCacheEvaluation = sample.at;
+        lock.unlock();
+        // Demuxed packet bitrates, in bits/s.
+        double bitrate = GetDoubleProperty(mpv, "video-bitrate").value_or(0.0) + GetDoubleProperty(mpv, "audio-bitrate").value_or(0.0);
+        Platform::MemoryStatus memory;
+        Platform::GetMemoryStatus(memory);
+        lock.lock();
+        if (!m_qos.IsActive()) continue;
+        m_cachePolicy.ObserveBitrate(bitrate / 8.0);
+        std::optional<CachePolicy::Decision> decision = m_cachePolicy.Evaluate(memory);
+        if (!decision) continue;
+        std::string reason = "mid-stream, " + m_cachePolicy.GetLastReason();
+        lock.unlock();
+        ApplyCacheDecision(mpv, *decision, reason);
+        lock.lock();
+    }
+}
+
+static bool IsNetworkUrl(const std::string& url)
+{
+    return url.find("://") != std::string::npos && url.rfind("file://", 0) != 0;
+}
+
+// Runs on START_FILE, before the demuxer opens, so the first limits apply from the first byte.
+void MPVManager::BeginCachePolicy(const std::string& url)
+{
+    if (!m_adaptiveCache || !m_mpv) return;
+    Platform::MemoryStatus memory;
+    Platform::GetMemoryStatus(memory);
+    std::optional<CachePolicy::Decision> decision;
+    std::string reason;
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        m_cachePolicy.Begin(IsNetworkUrl(url));
+        m_lastCacheEvaluation = std::chrono::steady_clock::now();
+        decision = m_cachePolicy.Evaluate(memory);
+        reason = "new file, " + m_cachePolicy.GetLastReason();
+    }
+    if (decision) ApplyCacheDecision(m_mpv, *decision, reason);
+}
+
+// Once the container is open its average bitrate is a better guess than the default.
+void MPVManager::UpdateContainerBitrate()
+{
+    if (!m_adaptiveCache || !m_mpv) return;
+    std::optional<int64_t> fileSize = GetIntProperty(m_mpv, "file-size");
+    std::optional<double> duration = GetDoubleProperty(m_mpv, "duration");
+    if (!fileSize || !duration || *duration <= 0.0) return;
+
+    Platform::MemoryStatus memory;
+    Platform::GetMemoryStatus(memory);
+    std::optional<CachePolicy::Decision> decision;
+    std::string reason;
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        m_cachePolicy.SetContainerBitrate(static_cast<double>(*fileSize) / *duration);
+        decision = m_cachePolicy.Evaluate(memory);
+        reason = "file loaded, " + m_cachePolicy.GetLastReason();
+    }
+    if (decision) ApplyCacheDecision(m_mpv, *decision, reason);
+}
+
+void MPVManager::ApplyCacheDecision(mpv_handle* mpv, const CachePolicy::Decision& decision, const std::string& reason)
+{
+    mpv_set_property_string(mpv, "demuxer-max-bytes", std::to_string(decision.maxBytes).c_str());
+    mpv_set_property_string(mpv, "demuxer-max-back-bytes", std::to_string(decision.maxBackBytes).c_str());
+    mpv_set_property_string(mpv, "demuxer-readahead-secs", std::to_string(decision.readaheadSecs).c_str());
+    mpv_set_property_string(mpv, "cache-secs", std::to_string(decision.cacheSecs).c_str());
+
+    static Metrics::Counter& s_changes = Metrics::GetCounter("cache.policy_changes");
+    static Metrics::Gauge& s_maxBytes = Metrics::GetGauge("cache.max_bytes");
+    static Metrics::Gauge& s_maxBackBytes = Metrics::GetGauge("cache.max_back_bytes");
+    static Metrics::Gauge& s_readaheadSecs = Metrics::GetGauge("cache.readahead_secs");
+    s_changes.Add();
+    s_maxBytes.Set(static_cast<int64_t>(decision.maxBytes));
+    s_maxBackBytes.Set(static_cast<int64_t>(decision.maxBackBytes));
+    s_readaheadSecs.Set(static_cast<int64_t>(decision.readaheadSecs));
+    LOG_INFO("MPVManager", "Cache policy (" + reason + "): " + decision.ToString());
+}
+
+// Re-probes only when no table exists or the GPU, driver or mpv build changed.
+// Playback is not held up meanwhile: files fall back to mpv's hwdec setting.
+void MPVManager::StartHwdecProbe(const std::filesystem::path& cfgDir)
+{
+    const std::filesystem::path tablePath = cfgDir / "hwdec-table.json";
+    std::vector<HwdecProbe::Candidate> candidates = HwdecProbe::ParseCandidates(m_settings.hwdecCandidates);
+    std::string fingerprint = HwdecProbe::Fingerprint(m_mpv, candidates);
+
+    HwdecTable table;
+    if (table.Load(tablePath) && table.fingerprint == fingerprint) {
+        LOG_INFO("MPVManager", "Using hwdec table for " + std::to_string(table.codecs.size()) + " codecs");
+        std::lock_guard<std::mutex> lock(m_hwdecMutex);
+        m_hwdecTable = std::move(table);
+        return;
+    }
+
+    LOG_INFO("MPVManager", "Probing hardware decoders (no table or driver changed)");
+    m_hwdecProbe = std::make_unique<HwdecProbe>(cfgDir / "hwdec-probe", std::move(candidates));
+    m_hwdecProbeThread = std::thread([this, tablePath, fingerprint]() {
+        HwdecTable probed = m_hwdecProbe->Run(fingerprint);
+        if (m_hwdecProbe->IsCancelled()) return;
+        if (!probed.Save(tablePath)) LOG_WARN("MPVManager", "Could not write " + Platform::WideToUtf8(tablePath.wstring()));
+        std::lock_guard<std::mutex> lock(m_hwdecMutex);
+        m_hwdecTable = std::move(probed);
+    });
+}
+
+// Codec names come from the demuxer's track list; bit depth from the codec
+// profile where mpv reports one. Codecs missing from the table keep mpv's own
+// hwdec setting, and file-local-options keeps the choice to this file.
+void MPVManager::ApplyHwdecTable()
+{
+    mpv_node tracks;
+    if (mpv_get_property(m_mpv, "track-list", MPV_FORMAT_NODE, &tracks) < 0) return;
+    json list = MpvNodeToJson(&tracks);
+    mpv_free_node_contents(&tracks);
+
+    for (const auto& track : list) {
+        if (!track.is_object() || track.value("type", "") != "video" || track.value("albumart", false)) continue;
+        const std::string key = HwdecProbe::CodecKey(track.value("codec", ""), track.value("codec-profile", ""));
+        std::optional<std::string> hwdec;
+        {
+            std::lock_guard<std::mutex> lock(m_hwdecMutex);
+            hwdec = m_hwdecTable.Lookup(key);
+        }
+        if (!hwdec) return;
+        mpv_set_property_string(m_mpv, "file-local-options/hwdec", hwdec->c_str());
+        LOG_INFO("MPVManager", "hwdec " + *hwdec + " for " + key + " (probed)");
+        return;
+    }
+}
+
+void MPVManager::BeginQosSession(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(m_samplerMutex);
+    // A START_FILE without a preceding END_FILE only happens if mpv skipped one; close it anyway.
+    if (m_qos.IsActive()) m_qos.End("replaced", PlaybackQos::Clock::now());
+    m_qos.Begin(url, PlaybackQos::Clock::now());
+    m_steadyMinCacheSec = IsNetworkUrl(url) ? SpriteGenerator::MIN_CACHE_SEC : 0.0;
+}
+
+void MPVManager::EndQosSession(const char* reason)
+{
+    std::optional<WebViewProtocol::PlaybackQosReportEventPayload> report;
+    {
+        std::lock_guard<std::mutex> lock(m_samplerMutex);
+        report = m_qos.End(reason, PlaybackQos::Clock::now());
+    }
+    if (!report) return;
+
+    static Metrics::Histogram& s_startupMs = Metrics::GetHistogram("qos.startup_ms");
+    static Metrics::Counter& s_rebuffers = Metrics::GetCounter("qos.rebuffers");
+    static Metrics::Counter& s_stalls = Metrics::GetCounter("qos.stalls");
+    static Metrics::Counter& s_droppedFrames = Metrics::GetCounter("qos.dropped_frames");
+    if (report->startupMs >= 0) s_startupMs.Record(static_cast<uint64_t>(report->startupMs));
+    s_rebuffers.Add(report->rebuffers);
+    s_stalls.Add(report->stalls);
+    s_droppedFrames.Add(report->droppedFrames + report->decoderDroppedFrames);
+
+    char summary[256];
+    std::snprintf(summary, sizeof(summary),
+        "Session ended (%s): %.1fs played, startup %lldms, %d rebuffers (%.1fs), %d stalls (%.1fs), %lld+%lld dropped frames",
+        reason, report->playedSec, report->startupMs, report->rebuffers, report->rebufferSec,
+        report->stalls, report->stallSec, report->droppedFrames, report->decoderDroppedFrames);
+    LOG_INFO("MPVManager", summary);
+    WebViewProtocol::EventEmitter::emitPlaybackQosReport(*report);
+}
@@ -1,24 +1,44 @@
 #ifndef MPV_MANAGER_H
 #define MPV_MANAGER_H
 
-#include <windows.h>
 #include <string>
 #include <vector>
+#include <functional>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 #include <mpv/client.h>
+#include "playback_qos.h"
+#include "cache_policy.h"
+#include "hwdec_probe.h"
+#include "thumbnail_service.h"
+#include "sprite_generator.h"
+#include "intro_detector.h"
 #include "../webview_protocol/types.h"
 #include "nlohmann/json.hpp"
 
 using json = nlohmann::json;
 
-class AppManager;
+struct AppSettings;
+
+namespace WebViewProtocol {
+    class Request;
+}
 
 class MPVManager
 {
 public:
-    explicit MPVManager(AppManager* appManager);
+    // Invoked from an mpv thread; must schedule HandleEvents() on the owning thread.
+    using WakeupCallback = std::function<void()>;
+
+    explicit MPVManager(AppSettings& settings);
     ~MPVManager();
 
-    bool Initialize(HWND videoHostWindow);
+    // windowId is the native window to render into (an HWND on Windows); 0
+    // runs mpv with vo=null and ao=null, e.g. for headless hosts.
+    bool Initialize(int64_t windowId, WakeupCallback onWakeup);
     void HandleEvents();
 
     void Play(const WebViewProtocol::PlayPayload& payload);
@@ -30,15 +50,61 @@ public:
     void ToggleMute();
     void SetProperty(const WebViewProtocol::SetPropertyPayload& payload);
     void LoadSubtitle(const WebViewProtocol::LoadSubtitlePayload& payload);
+    // Resolves with a ThumbnailPayload for the file being played; safe from any thread.
+    void GetThumbnail(const WebViewProtocol::GetThumbnailPayload& payload, const std::shared_ptr<WebViewProtocol::Request>& request);
+    // Resolves with the SpriteSheetsEventPayload of the file being played.
+    void GetSpriteSheets(const std::shared_ptr<WebViewProtocol::Request>& request);
+    // Resolves with a SpriteSheetPayload; safe from any thread.
+    void GetSpriteSheet(const WebViewProtocol::GetSpriteSheetPayload& payload, const std::shared_ptr<WebViewProtocol::Request>& request);
+    // Resolves with the ChapterHintsEventPayload of the file being played.
+    void GetChapterHints(const std::shared_ptr<WebViewProtocol::Request>& request);
+
+    static json MpvNodeToJson(const mpv_node* node);
+
+    // QoS sampling rate while a file is loaded.
+    static constexpr std::chrono::milliseconds QOS_SAMPLE_INTERVAL{500};
+    // How often the demuxer cache is re-sized mid-stream.
+    static constexpr std::chrono::seconds CACHE_POLICY_INTERVAL{10};
 
 private:
     static void MpvWakeupCallback(void* ctx);
     void HandleMpvCommand(const std::vector<std::string>& args);
-    static json MpvNodeToJson(const mpv_node* node);
 
-    AppManager* m_appManager;
+    void SampleLoop(mpv_handle* mpv);
+    void BeginQosSession(const std::string& url);
+    void EndQosSession(const char* reason);
+    void BeginCachePolicy(const std::string& url);
+    void UpdateContainerBitrate();
+    void ApplyCacheDecision(mpv_handle* mpv, const CachePolicy::Decision& decision, const std::string& reason);
+    void StartHwdecProbe(const std::filesystem::path& cfgDir);
+    void ApplyHwdecTable();
+
+    AppSettings& m_settings;
     mpv_handle* m_mpv;
-    HWND m_hwnd;
+    WakeupCallback m_onWakeup;
+    // From the last Play(); the series id only applies while that file plays.
+    std::string m_loadingUrl;
+    std::string m_loadingSeriesId;
+
+    std::mutex m_samplerMutex;
+    std::condition_variable m_samplerCv;
+    std::thread m_samplerThread;
+    bool m_samplerStopping = false;
+    bool m_qosLiveEvents = false;
+    PlaybackQos m_qos;
+    double m_steadyMinCacheSec = 0.0;  // for background work, per file
+    bool m_adaptiveCache = true;
+    CachePolicy m_cachePolicy;
+    std::chrono::steady_clock::time_point m_lastCacheEvaluation;
+
+    std::mutex m_hwdecMutex;
+    HwdecTable m_hwdecTable;
+    std::unique_ptr<HwdecProbe> m_hwdecProbe;
+    std::thread m_hwdecProbeThread;
+
+    std::unique_ptr<ThumbnailService> m_thumbnails;
+    std::unique_ptr<SpriteGenerator> m_sprites;
+    std::unique_ptr<IntroDetector> m_intros;
 };
 
 #endif // MPV_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "playback_qos.h"
+#include <algorithm>
+#include <cmath>
+
+static double Seconds(PlaybackQos::Clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+void PlaybackQos::Begin(const std::string& url, Clock::time_point now)
+{
+    *this = PlaybackQos();
+    m_active = true;
+    m_url = url;
+    m_begin = now;
+    m_state = State::Startup;
+}
+
+PlaybackQos::State PlaybackQos::AddSample(const PlaybackQosSample& sample)
+{
+    if (!m_active) return State::Idle;
+    m_samples++;
+
+    const Clock::time_point previousAt = m_lastAt.value_or(sample.at);
+    const double dt = (std::max)(Seconds(sample.at - previousAt), 0.0);
+    bool progressed = false;
+    double progress = 0.0;
+    if (sample.timePos && m_lastTimePos && dt > 0.0) {
+        const double delta = *sample.timePos - *m_lastTimePos;
+        if (delta < -0.5 || delta > dt * 2.0 + 1.0) {
+            // The position jumped: a seek happened between two samples.
+            m_lastSeekAt = sample.at;
+        } else if (delta > 0.0 && delta >= dt * STALL_PROGRESS_RATIO) {
+            progressed = true;
+            progress = delta;
+            m_playedSec += delta;
+        }
+    }
+    if (sample.seeking) m_lastSeekAt = sample.at;
+    m_lastAt = sample.at;
+    if (sample.timePos) m_lastTimePos = sample.timePos;
+
+    if (progressed && !m_startupMs) {
+        // Playback began roughly `progress` seconds before this sample, not at it.
+        const double startupSec = Seconds(sample.at - m_begin) - progress;
+        m_startupMs = static_cast<long long>((std::max)(startupSec, 0.0) * 1000.0);
+    }
+    const bool afterSeek = m_lastSeekAt && sample.at - *m_lastSeekAt < SEEK_GRACE;
+
+    State state;
+    if (sample.paused && !sample.pausedForCache) {
+        state = State::Paused;
+    } else if (!m_startupMs) {
+        state = State::Startup;
+    } else if (sample.seeking || (afterSeek && !progressed)) {
+        state = State::Seeking;
+    } else if (sample.pausedForCache) {
+        state = State::Rebuffering;
+    } else if (!progressed) {
+        // The position last moved at the previous sample.
+        if (!m_stuckSince) m_stuckSince = previousAt;
+        state = sample.at - *m_stuckSince >= STALL_THRESHOLD ? State::Stalled : State::Playing;
+    } else {
+        state = State::Playing;
+    }
+    if (progressed || (state != State::Playing && state != State::Stalled)) m_stuckSince.reset();
+
+    switch (state) {
+        case State::Seeking:
+            m_seekWaitSec += dt;
+            break;
+        case State::Rebuffering:
+            if (m_state != State::Rebuffering) {
+                m_rebuffers++;
+                m_currentRebufferSec = 0.0;
+            }
+            m_rebufferSec += dt;
+            m_currentRebufferSec += dt;
+            m_longestRebufferSec = (std::max)(m_longestRebufferSec, m_currentRebufferSec);
+            break;
+        case State::Stalled:
+            if (m_state != State::Stalled) {
+                m_stalls++;
+                // The time spent reaching the threshold was already part of the stall.
+                m_stallSec += Seconds(sample.at - *m_stuckSince);
+            } else {
+                m_stallSec += dt;
+            }
+            break;
+        default:
+            break;
+    }
+    m_state = state;
+
+    m_droppedSinceLastSample = (sample.frameDrops && m_lastFrameDrops && *sample.frameDrops > *m_lastFrameDrops) ||
+                               (sample.decoderFrameDrops && m_lastDecoderDrops && *sample.decoderFrameDrops > *m_lastDecoderDrops);
+    if (sample.frameDrops) {
+        if (!m_firstFrameDrops) m_firstFrameDrops = sample.frameDrops;
+        m_lastFrameDrops = sample.frameDrops;
+    }
+    if (sample.decoderFrameDrops) {
+        if (!m_firstDecoderDrops) m_firstDecoderDrops = sample.decoderFrameDrops;
+        m_lastDecoderDrops = sample.decoderFrameDrops;
+    }
+    if (sample.cacheDuration && m_startupMs) {
+        m_lastCache = *sample.cacheDuration;
+        m_cacheMin = m_cacheSamples == 0 ? m_lastCache : (std::min)(m_cacheMin, m_lastCache);
+        m_cacheSum += m_lastCache;
+        m_cacheSamples++;
+        if (m_lastCache < LOW_CACHE_SEC && state != State::Paused) m_lowCacheSamples++;
+    }
+    if (sample.cacheSpeed) {
+        m_lastCacheSpeed = *sample.cacheSpeed;
+        m_cacheSpeedSum += static_cast<double>(m_lastCacheSpeed);
+        m_cacheSpeedSamples++;
+    }
+    if (sample.avsync && state == State::Playing) {
+        m_lastAvsync = std::abs(*sample.avsync);
+        m_avsyncSum += m_lastAvsync;
+        m_avsyncMax = (std::max)(m_avsyncMax, m_lastAvsync);
+        m_avsyncSamples++;
+    }
+    return state;
+}
+
+static long long DropDelta(const std::optional<int64_t>& first, const std::optional<int64_t>& last)
+{
+    // The counters restart with every file, so anything below the first reading is a reset.
+    if (!first || !last) return 0;
+    return (std::max)(*last - *first, int64_t(0));
+}
+
+std::optional<WebViewProtocol::PlaybackQosReportEventPayload> PlaybackQos::End(const std::string& reason, Clock::time_point now)
+{
+    if (!m_active) return std::nullopt;
+
+    WebViewProtocol::PlaybackQosReportEventPayload report;
+    report.url = m_url;
+    report.endReason = reason;
+    report.wallSec = Seconds(now - m_begin);
+    report.playedSec = m_playedSec;
+    report.startupMs = m_startupMs.value_or(-1);
+    report.rebuffers = m_rebuffers;
+    report.rebufferSec = m_rebufferSec;
+    report.longestRebufferSec = m_longestRebufferSec;
+    report.stalls = m_stalls;
+    report.stallSec = m_stallSec;
+    report.seekWaitSec = m_seekWaitSec;
+    const double interrupted = m_rebufferSec + m_stallSec;
+    report.rebufferRatio = interrupted > 0.0 ? interrupted / (m_playedSec + interrupted) : 0.0;
+    report.droppedFrames = DropDelta(m_firstFrameDrops, m_lastFrameDrops);
+    report.decoderDroppedFrames = DropDelta(m_firstDecoderDrops, m_lastDecoderDrops);
+    report.meanCacheSec = m_cacheSamples ? m_cacheSum / m_cacheSamples : 0.0;
+    report.minCacheSec = m_cacheMin;
+    report.lowCacheSamples = m_lowCacheSamples;
+    report.meanCacheSpeed = m_cacheSpeedSamples ? m_cacheSpeedSum / m_cacheSpeedSamples : 0.0;
+    report.meanAvsyncMs = m_avsyncSamples ? m_avsyncSum / m_avsyncSamples * 1000.0 : 0.0;
+    report.maxAvsyncMs = m_avsyncMax * 1000.0;
+    report.samples = m_samples;
+
+    m_active = false;
+    m_state = State::Idle;
+    return report;
+}
+
+WebViewProtocol::PlaybackQosEventPayload PlaybackQos::GetLiveStatus() const
+{
+    WebViewProtocol::PlaybackQosEventPayload status;
+    status.state = StateName(m_state);
+    status.timePos = m_lastTimePos.value_or(0.0);
+    status.cacheSec = m_lastCache;
+    status.cacheSpeed = m_lastCacheSpeed;
+    status.droppedFrames = DropDelta(m_firstFrameDrops, m_lastFrameDrops);
+    status.decoderDroppedFrames = DropDelta(m_firstDecoderDrops, m_lastDecoderDrops);
+    status.avsyncMs = m_lastAvsync * 1000.0;
+    status.rebuffers = m_rebuffers;
+    status.stalls = m_stalls;
+    return status;
+}
+
+bool PlaybackQos::IsSteady(double minCacheSec) const
+{
+    if (!m_active || !m_startupMs || m_droppedSinceLastSample) return false;
+    if (m_state == State::Paused) return true;
+    return m_state == State::Playing && m_lastCache >= minCacheSec;
+}
+
+const char* PlaybackQos::StateName(State state)
+{
+    switch (state) {
+        case State::Idle: return "idle";
+        case State::Startup: return "startup";
+        case State::Playing: return "playing";
+        case State::Paused: return "paused";
+        case State::Seeking: return "seeking";
+        case State::Rebuffering: return "rebuffering";
+        case State::Stalled: return "stalled";
+    }
+    return "unknown";
+}
@@ -0,0 +1,102 @@
+#ifndef PLAYBACK_QOS_H
+#define PLAYBACK_QOS_H
+
+#include <string>
+#include <chrono>
+#include <optional>
+#include <cstdint>
+#include "../webview_protocol/types.h"
+
+// One reading of the mpv properties the QoS monitor samples. Properties mpv
+// could not report (no video track, nothing demuxed yet) are left empty.
+struct PlaybackQosSample {
+    std::chrono::steady_clock::time_point at;
+    std::optional<double> timePos;
+    bool paused = false;
+    bool pausedForCache = false;
+    bool seeking = false;
+    std::optional<int64_t> frameDrops;
+    std::optional<int64_t> decoderFrameDrops;
+    std::optional<double> cacheDuration;  // demuxer-cache-duration, seconds
+    std::optional<int64_t> cacheSpeed;    // bytes/s
+    std::optional<double> avsync;         // seconds
+};
+
+// Turns periodic samples of one loaded file into stall/rebuffer counts and a
+// session summary. Knows nothing about mpv, so it can be fed synthetic samples.
+//
+// A rebuffer is mpv pausing for cache once playback is under way. A stall is
+// playback that is neither paused nor buffering but whose position stops
+// advancing for STALL_THRESHOLD. Waiting right after a seek counts as neither.
+class PlaybackQos
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { Idle, Startup, Playing, Paused, Seeking, Rebuffering, Stalled };
+
+    // Position advancing by less than this share of wall time counts as stuck.
+    static constexpr double STALL_PROGRESS_RATIO = 0.2;
+    static constexpr std::chrono::milliseconds STALL_THRESHOLD{1000};
+    static constexpr std::chrono::milliseconds SEEK_GRACE{2000};
+    static constexpr double LOW_CACHE_SEC = 2.0;
+
+    void Begin(const std::string& url, Clock::time_point now);
+    bool IsActive() const { return m_active; }
+
+    State AddSample(const PlaybackQosSample& sample);
+    State GetState() const { return m_state; }
+
+    // Summarizes and closes the session; nullopt if none was active.
+    std::optional<WebViewProtocol::PlaybackQosReportEventPayload> End(const std::string& reason, Clock::time_point now);
+
+    WebViewProtocol::PlaybackQosEventPayload GetLiveStatus() const;
+
+    // Whether background work may run beside playback: started and now playing
+    // or paused, no frames dropped since the previous sample and, while
+    // playing, at least minCacheSec buffered.
+    bool IsSteady(double minCacheSec) const;
+
+    static const char* StateName(State state);
+
+private:
+    bool m_active = false;
+    std::string m_url;
+    Clock::time_point m_begin;
+    State m_state = State::Idle;
+
+    std::optional<Clock::time_point> m_lastAt;
+    std::optional<double> m_lastTimePos;
+    std::optional<Clock::time_point> m_lastSeekAt;
+    std::optional<Clock::time_point> m_stuckSince;
+    std::optional<long long> m_startupMs;
+
+    int m_samples = 0;
+    double m_playedSec = 0.0;
+    int m_rebuffers = 0;
+    double m_rebufferSec = 0.0;
+    double m_currentRebufferSec = 0.0;
+    double m_longestRebufferSec = 0.0;
+    int m_stalls = 0;
+    double m_stallSec = 0.0;
+    double m_seekWaitSec = 0.0;
+
+    std::optional<int64_t> m_firstFrameDrops, m_lastFrameDrops;
+    std::optional<int64_t> m_firstDecoderDrops, m_lastDecoderDrops;
+    bool m_droppedSinceLastSample = false;
+
+    double m_cacheSum = 0.0;
+    double m_cacheMin = 0.0;
+    double m_lastCache = 0.0;
+    int m_cacheSamples = 0;
+    int m_lowCacheSamples = 0;
+    double m_cacheSpeedSum = 0.0;
+    int64_t m_lastCacheSpeed = 0;
+    int m_cacheSpeedSamples = 0;
+    double m_avsyncSum = 0.0;
+    double m_avsyncMax = 0.0;
+    double m_lastAvsync = 0.0;
+    int m_avsyncSamples = 0;
+};
+
+#endif // PLAYBACK_QOS_H
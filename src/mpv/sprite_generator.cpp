@@ -0,0 +1,685 @@
+#include "sprite_generator.h"
+#include "../logger/logger.h"
+#include "../metrics/metrics.h"
+#include "../platform/platform.h"
+#include <curl/curl.h>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+
+int SpriteSheetIndex::Sheets() const
+{
+    const int perSheet = TilesPerSheet();
+    return perSheet > 0 ? (tiles + perSheet - 1) / perSheet : 0;
+}
+
+std::string SpriteSheetIndex::SheetName(int sheet)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "sheet-%03d.jpg", sheet);
+    return name;
+}
+
+static std::string VttTime(double seconds)
+{
+    const long long ms = std::llround((std::max)(seconds, 0.0) * 1000.0);
+    char out[32];
+    std::snprintf(out, sizeof(out), "%02lld:%02lld:%02lld.%03lld", ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+    return out;
+}
+
+std::string SpriteSheetIndex::ToVtt() const
+{
+    std::string out = "WEBVTT\n";
+    const int perSheet = TilesPerSheet();
+    for (int tile = 0; tile < tiles && perSheet > 0; tile++) {
+        const int slot = tile % perSheet;
+        const double start = tile * intervalSec;
+        double end = start + intervalSec;
+        if (duration > 0.0) end = (std::min)(end, duration);
+        char cue[160];
+        std::snprintf(cue, sizeof(cue), "\n%s --> %s\n%s#xywh=%d,%d,%d,%d\n",
+                      VttTime(start).c_str(), VttTime(end).c_str(), SheetName(tile / perSheet).c_str(),
+                      slot % columns * tileWidth, slot / columns * tileHeight, tileWidth, tileHeight);
+        out += cue;
+    }
+    return out;
+}
+
+bool SpriteSheetIndex::Load(const std::filesystem::path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+    try {
+        json::parse(in).get_to(*this);
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("SpriteGenerator", std::string("Ignoring unreadable sprite index: ") + e.what());
+        return false;
+    }
+}
+
+bool SpriteSheetIndex::Save(const std::filesystem::path& file) const
+{
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out << json(*this).dump(2) << '\n';
+    return static_cast<bool>(out);
+}
+
+// Readers only ever see a complete file: it is written beside the target and renamed over it.
+static bool ReplaceFile(const std::filesystem::path& target, const std::function<bool(const std::filesystem::path&)>& write)
+{
+    std::filesystem::path partial = target;
+    partial += ".partial";
+    std::error_code ec;
+    if (!write(partial)) {
+        std::filesystem::remove(partial, ec);
+        return false;
+    }
+    std::filesystem::rename(partial, target, ec);
+    return !ec;
+}
+
+static constexpr size_t HASH_CHUNK = 64 * 1024;
+
+static uint64_t SumWords(const std::string& data)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i + 8 <= data.size(); i += 8) {
+        uint64_t word = 0;
+        for (int b = 7; b >= 0; b--) word = (word << 8) | static_cast<uint8_t>(data[i + b]);
+        sum += word;
+    }
+    return sum;
+}
+
+struct RangeResponse {
+    std::string body;
+    size_t limit = 0;
+    uint64_t total = 0;  // from Content-Range
+};
+
+static size_t OnRangeData(char* data, size_t size, size_t count, void* user)
+{
+    RangeResponse* response = static_cast<RangeResponse*>(user);
+    const size_t bytes = size * count;
+    // More than asked for means the server ignored the range; stop the transfer.
+    if (response->body.size() + bytes > response->limit) return 0;
+    response->body.append(data, bytes);
+    return bytes;
+}
+
+// "Content-Range: bytes 0-65535/734003200"
+static size_t OnRangeHeader(char* data, size_t size, size_t count, void* user)
+{
+    const size_t bytes = size * count;
+    static const char prefix[] = "content-range:";
+    const size_t prefixLength = sizeof(prefix) - 1;
+    if (bytes > prefixLength) {
+        bool match = true;
+        for (size_t i = 0; i < prefixLength && match; i++) {
+            match = std::tolower(static_cast<unsigned char>(data[i])) == prefix[i];
+        }
+        const char* slash = match ? static_cast<const char*>(std::memchr(data, '/', bytes)) : nullptr;
+        if (slash) static_cast<RangeResponse*>(user)->total = std::strtoull(std::string(slash + 1, static_cast<const char*>(data) + bytes).c_str(), nullptr, 10);
+    }
+    return bytes;
+}
+
+static bool ReadHttpRange(const std::string& url, uint64_t offset, size_t length, RangeResponse& response, std::string& error)
+{
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        error = "curl_easy_init failed";
+        return false;
+    }
+    const std::string range = std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+    response.limit = length;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, OnRangeData);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, OnRangeHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    auto start = std::chrono::steady_clock::now();
+    CURLcode res = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    const bool ok = res == CURLE_OK && status == 206 && response.total > 0;
+    Metrics::RecordHttp("sprite-hash", start, ok);
+    curl_easy_cleanup(curl);
+    if (!ok) error = res != CURLE_OK ? curl_easy_strerror(res) : "HTTP " + std::to_string(status) + " without a usable range";
+    return ok;
+}
+
+std::string SpriteGenerator::ContentHash(const std::string& url, std::string& error)
+{
+    uint64_t size = 0;
+    std::string head, tail;
+    if (url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0) {
+        RangeResponse first;
+        if (!ReadHttpRange(url, 0, HASH_CHUNK, first, error)) return {};
+        size = first.total;
+        head = std::move(first.body);
+        if (size <= HASH_CHUNK) {
+            tail = head;
+        } else {
+            RangeResponse last;
+            if (!ReadHttpRange(url, size - HASH_CHUNK, HASH_CHUNK, last, error)) return {};
+            tail = std::move(last.body);
+        }
+    } else if (url.find("://") == std::string::npos || url.rfind("file://", 0) == 0) {
+        const std::filesystem::path path = Platform::Utf8ToWide(url.rfind("file://", 0) == 0 ? url.substr(7) : url);
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        std::ifstream in(path, std::ios::binary);
+        if (ec || !in) {
+            error = "cannot read the file";
+            return {};
+        }
+        const size_t chunk = static_cast<size_t>((std::min)(size, static_cast<uint64_t>(HASH_CHUNK)));
+        head.resize(chunk);
+        tail.resize(chunk);
+        in.read(&head[0], chunk);
+        in.seekg(static_cast<std::streamoff>(size - chunk));
+        in.read(&tail[0], chunk);
+        if (!in) {
+            error = "short read";
+            return {};
+        }
+    } else {
+        error = "not a file or http(s) url";
+        return {};
+    }
+    if (size == 0) {
+        error = "empty file";
+        return {};
+    }
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(size + SumWords(head) + SumWords(tail)));
+    return hex;
+}
+
+SpriteGenerator::SpriteGenerator(std::filesystem::path cacheDir, UpdateCallback onUpdate)
+    : m_cacheDir(std::move(cacheDir)), m_onUpdate(std::move(onUpdate))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_cacheDir, ec);
+    m_worker = std::thread(&SpriteGenerator::WorkerLoop, this);
+}
+
+SpriteGenerator::~SpriteGenerator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+    if (m_mpv) mpv_terminate_destroy(m_mpv);
+}
+
+void SpriteGenerator::SetSource(const std::string& url)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (url == m_source) return;
+        m_source = url;
+        m_generation++;
+        m_index.reset();
+        m_steadySince.reset();
+        m_started = false;
+        m_failures = 0;
+    }
+    m_cv.notify_all();
+}
+
+void SpriteGenerator::SetPlaybackSteady(bool steady)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!steady) m_steadySince.reset();
+    else if (!m_steadySince) m_steadySince = Clock::now();
+}
+
+std::optional<SpriteSheetIndex> SpriteGenerator::GetIndex()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index;
+}
+
+static bool IsHash(const std::string& hash)
+{
+    return hash.size() == 16 && std::all_of(hash.begin(), hash.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; });
+}
+
+bool SpriteGenerator::ReadSheet(const std::string& hash, int sheet, std::string& jpeg, std::string& error) const
+{
+    if (!IsHash(hash) || sheet < 0) {
+        error = "invalid sheet";
+        return false;
+    }
+    std::ifstream in(m_cacheDir / hash / SpriteSheetIndex::SheetName(sheet), std::ios::binary);
+    if (!in) {
+        error = "no such sheet";
+        return false;
+    }
+    std::ostringstream data;
+    data << in.rdbuf();
+    jpeg = data.str();
+    return true;
+}
+
+bool SpriteGenerator::ReadyToRun(Clock::time_point now) const
+{
+    if (!m_index || m_index->complete || m_failures >= MAX_TILE_FAILURES || !m_steadySince) return false;
+    return now - *m_steadySince >= (m_started ? RESUME_AFTER : STABLE_AFTER);
+}
+
+void SpriteGenerator::WorkerLoop()
+{
+    static Metrics::Counter& s_tiles = Metrics::GetCounter("sprites.tiles");
+    static Metrics::Counter& s_failures = Metrics::GetCounter("sprites.failures");
+
+    Platform::SetBackgroundThreadPriority();
+
+    uint64_t prepared = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // Steadiness is a matter of time, so the predicate is re-checked every second.
+        m_cv.wait_for(lock, std::chrono::seconds(1), [&]() {
+            return m_stopping || prepared != m_generation || (m_source.empty() && !m_openUrl.empty()) || ReadyToRun(Clock::now());
+        });
+        if (m_stopping) break;
+
+        if (prepared != m_generation) {
+            prepared = m_generation;
+            const std::string url = m_source;
+            if (url.empty()) continue;
+            lock.unlock();
+            std::optional<SpriteSheetIndex> index = Prepare(url);
+            lock.lock();
+            if (prepared != m_generation) continue;
+            m_index = index;
+            if (index && index->tiles > 0) {
+                lock.unlock();
+                m_onUpdate(*index);
+                lock.lock();
+            }
+            continue;
+        }
+
+        if (m_source.empty()) {
+            if (m_openUrl.empty()) continue;
+            // Release the file, and with it any network connection.
+            lock.unlock();
+            const char* stop[] = { "stop", nullptr };
+            mpv_command(m_mpv, stop);
+            m_openUrl.clear();
+            lock.lock();
+            continue;
+        }
+        if (!ReadyToRun(Clock::now())) continue;
+
+        const uint64_t generation = m_generation;
+        const std::string url = m_source;
+        SpriteSheetIndex index = *m_index;
+        m_started = true;
+        lock.unlock();
+
+        std::string error;
+        bool ok = (url == m_openUrl || Open(url, index, error)) && CaptureTile(index, error);
+        bool flushed = false;
+        if (ok) {
+            s_tiles.Add();
+            index.tiles++;
+            index.complete = index.tiles >= index.totalTiles;
+            if (index.complete || index.tiles % index.TilesPerSheet() == 0 || index.tiles % FLUSH_TILES == 0) {
+                ok = flushed = Flush(index, error);
+            }
+        }
+
+        lock.lock();
+        if (generation != m_generation) continue;
+        if (ok) {
+            m_failures = 0;
+            m_index = index;
+        } else {
+            // The tile is retried; what Open() learned about the file is kept.
+            s_failures.Add();
+            m_index->duration = index.duration;
+            m_index->totalTiles = index.totalTiles;
+            if (++m_failures >= MAX_TILE_FAILURES) {
+                LOG_WARN("SpriteGenerator", "Giving up on " + url + " at tile " + std::to_string(index.tiles) + ": " + error);
+            }
+        }
+        lock.unlock();
+        if (flushed) m_onUpdate(index);
+        if (index.complete && ok) {
+            LOG_INFO("SpriteGenerator", "Sprite sheets complete for " + url + ": " + std::to_string(index.tiles) + " tiles");
+            const char* stop[] = { "stop", nullptr };
+            mpv_command(m_mpv, stop);
+            m_openUrl.clear();
+        }
+        lock.lock();
+        m_cv.wait_for(lock, TILE_PACING, [&]() { return m_stopping || generation != m_generation; });
+    }
+}
+
+// Loads what is cached for the file, or starts an empty index for it. Only
+// full sheets of an unfinished file are kept: the partial one is rebuilt
+// since its pixels are gone.
+std::optional<SpriteSheetIndex> SpriteGenerator::Prepare(const std::string& url)
+{
+    std::string error;
+    const std::string hash = ContentHash(url, error);
+    if (hash.empty()) {
+        LOG_INFO("SpriteGenerator", "No sprite sheets for " + url + ": " + error);
+        return std::nullopt;
+    }
+
+    const std::filesystem::path dir = m_cacheDir / hash;
+    SpriteSheetIndex index;
+    if (index.Load(dir / "meta.json") && index.hash == hash && index.intervalSec == INTERVAL_SEC &&
+        index.tileWidth == TILE_WIDTH && index.tileHeight == TILE_HEIGHT && index.columns == COLUMNS && index.rows == ROWS) {
+        if (!index.complete) index.tiles -= index.tiles % index.TilesPerSheet();
+        // Marks the title as recently used for Prune().
+        std::error_code ec;
+        std::filesystem::last_write_time(dir / "meta.json", std::filesystem::file_time_type::clock::now(), ec);
+        if (index.tiles > 0) {
+            LOG_INFO("SpriteGenerator", "Sprite sheets for " + url + " (" + hash + "): " + std::to_string(index.tiles) + "/" +
+                     std::to_string(index.totalTiles) + " tiles cached");
+        }
+        return index;
+    }
+
+    index = SpriteSheetIndex();
+    index.hash = hash;
+    index.intervalSec = INTERVAL_SEC;
+    index.tileWidth = TILE_WIDTH;
+    index.tileHeight = TILE_HEIGHT;
+    index.columns = COLUMNS;
+    index.rows = ROWS;
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (!index.Save(dir / "meta.json")) {
+        LOG_WARN("SpriteGenerator", "Cannot write to " + Platform::WideToUtf8(dir.wstring()));
+        return std::nullopt;
+    }
+    Prune(hash);
+    return index;
+}
+
+// Keeps the MAX_TITLES most recently played titles.
+void SpriteGenerator::Prune(const std::string& keep)
+{
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> titles;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_cacheDir, ec)) {
+        if (!entry.is_directory(ec) || entry.path().filename() == keep) continue;
+        titles.emplace_back(std::filesystem::last_write_time(entry.path() / "meta.json", ec), entry.path());
+    }
+    if (titles.size() < MAX_TITLES) return;
+    std::sort(titles.begin(), titles.end());
+    for (size_t i = 0; i + MAX_TITLES <= titles.size(); i++) std::filesystem::remove_all(titles[i].second, ec);
+}
+
+static void SetOption(mpv_handle* mpv, const char* name, const std::string& value)
+{
+    mpv_set_option_string(mpv, name, value.c_str());
+}
+
+// Like the thumbnail instance, minus exact seeking: only keyframes are
+// decoded, on one thread, and frames are scaled and letterboxed to the tile.
+bool SpriteGenerator::Open(const std::string& url, SpriteSheetIndex& index, std::string& error)
+{
+    if (!m_mpv) {
+        m_mpv = mpv_create();
+        if (!m_mpv) {
+            error = "mpv_create failed";
+            return false;
+        }
+        const std::string tile = std::to_string(TILE_WIDTH) + ":" + std::to_string(TILE_HEIGHT);
+        SetOption(m_mpv, "config", "no");
+        SetOption(m_mpv, "load-scripts", "no");
+        SetOption(m_mpv, "osc", "no");
+        SetOption(m_mpv, "ytdl", "no");
+        SetOption(m_mpv, "input-default-bindings", "no");
+        SetOption(m_mpv, "vo", "null");
+        SetOption(m_mpv, "ao", "null");
+        SetOption(m_mpv, "audio", "no");
+        SetOption(m_mpv, "sid", "no");
+        SetOption(m_mpv, "idle", "yes");
+        SetOption(m_mpv, "pause", "yes");
+        SetOption(m_mpv, "keep-open", "always");
+        SetOption(m_mpv, "hr-seek", "no");
+        SetOption(m_mpv, "cache", "no");
+        SetOption(m_mpv, "demuxer-readahead-secs", "0");
+        SetOption(m_mpv, "demuxer-max-bytes", "512KiB");
+        SetOption(m_mpv, "hwdec", "no");
+        SetOption(m_mpv, "vd-lavc-skipframe", "nonkey");
+        SetOption(m_mpv, "vd-lavc-skiploopfilter", "all");
+        SetOption(m_mpv, "vd-lavc-fast", "yes");
+        SetOption(m_mpv, "vd-lavc-threads", "1");
+        SetOption(m_mpv, "sws-scaler", "fast-bilinear");
+        SetOption(m_mpv, "vf", "lavfi=[scale=" + tile + ":force_original_aspect_ratio=decrease,pad=" + tile + ":-1:-1]");
+        if (mpv_initialize(m_mpv) < 0) {
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            error = "mpv_initialize failed";
+            return false;
+        }
+    }
+
+    m_openUrl.clear();
+    const char* load[] = { "loadfile", url.c_str(), "replace", nullptr };
+    int rc = mpv_command(m_mpv, load);
+    if (rc < 0) {
+        error = mpv_error_string(rc);
+        return false;
+    }
+    error = WaitFor(m_mpv, MPV_EVENT_FILE_LOADED, LOAD_TIMEOUT);
+    if (!error.empty()) return false;
+
+    double duration = 0.0;
+    if (mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &duration) < 0 || duration <= 0.0) {
+        error = "unknown duration";
+        return false;
+    }
+    if (index.totalTiles == 0) {
+        index.duration = duration;
+        index.totalTiles = (std::max)(static_cast<int>(std::ceil(duration / INTERVAL_SEC)), 1);
+    }
+    m_openUrl = url;
+    return true;
+}
+
+// Returns an empty string once the event arrives. END_FILE only counts as
+// failure when it carries an error: a replaced file ends with reason "stop".
+std::string SpriteGenerator::WaitFor(mpv_handle* mpv, mpv_event_id id, std::chrono::seconds timeout)
+{
+    const auto deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) return "shutting down";
+        }
+        mpv_event* ev = mpv_wait_event(mpv, 0.1);
+        if (ev->event_id == id) return {};
+        if (ev->event_id == MPV_EVENT_SHUTDOWN) return "mpv shut down";
+        if (ev->event_id == MPV_EVENT_END_FILE) {
+            mpv_event_end_file* ef = static_cast<mpv_event_end_file*>(ev->data);
+            if (ef->reason == MPV_END_FILE_REASON_ERROR) return mpv_error_string(ef->error);
+        }
+    }
+    return "timed out";
+}
+
+static const mpv_node* MapValue(const mpv_node& map, const char* key)
+{
+    if (map.format != MPV_FORMAT_NODE_MAP) return nullptr;
+    for (int i = 0; i < map.u.list->num; i++) {
+        if (std::strcmp(map.u.list->keys[i], key) == 0) return &map.u.list->values[i];
+    }
+    return nullptr;
+}
+
+static int64_t MapInt(const mpv_node& map, const char* key)
+{
+    const mpv_node* value = MapValue(map, key);
+    return value && value->format == MPV_FORMAT_INT64 ? value->u.int64 : 0;
+}
+
+// Seeks to the keyframe nearest the middle of the tile's interval and copies
+// the frame, as bgr0 from screenshot-raw, into its cell of m_sheet.
+bool SpriteGenerator::CaptureTile(const SpriteSheetIndex& index, std::string& error)
+{
+    static Metrics::Histogram& s_captureUs = Metrics::GetHistogram("sprites.capture_us");
+    Metrics::ScopedTimer timer(s_captureUs);
+
+    const int tile = index.tiles;
+    double time = tile * INTERVAL_SEC + INTERVAL_SEC / 2.0;
+    time = (std::min)(time, (std::max)(index.duration - 0.5, tile * INTERVAL_SEC));
+
+    while (mpv_wait_event(m_mpv, 0)->event_id != MPV_EVENT_NONE) {}
+    const std::string position = std::to_string(time);
+    const char* seek[] = { "seek", position.c_str(), "absolute+keyframes", nullptr };
+    int rc = mpv_command(m_mpv, seek);
+    if (rc < 0) {
+        error = std::string("seek failed: ") + mpv_error_string(rc);
+        return false;
+    }
+    error = WaitFor(m_mpv, MPV_EVENT_PLAYBACK_RESTART, SEEK_TIMEOUT);
+    if (!error.empty()) return false;
+
+    mpv_node result;
+    const char* screenshot[] = { "screenshot-raw", "video", nullptr };
+    rc = mpv_command_ret(m_mpv, screenshot, &result);
+    if (rc < 0) {
+        error = std::string("screenshot failed: ") + mpv_error_string(rc);
+        return false;
+    }
+    const int64_t width = MapInt(result, "w");
+    const int64_t height = MapInt(result, "h");
+    const int64_t stride = MapInt(result, "stride");
+    const mpv_node* format = MapValue(result, "format");
+    const mpv_node* data = MapValue(result, "data");
+    if (width <= 0 || height <= 0 || stride < width * 4 || !format || format->format != MPV_FORMAT_STRING ||
+        std::strcmp(format->u.string, "bgr0") != 0 || !data || data->format != MPV_FORMAT_BYTE_ARRAY ||
+        data->u.ba->size < static_cast<size_t>(stride * (height - 1) + width * 4)) {
+        mpv_free_node_contents(&result);
+        error = "unexpected screenshot-raw result";
+        return false;
+    }
+
+    const size_t sheetStride = static_cast<size_t>(COLUMNS) * TILE_WIDTH * 4;
+    const int slot = tile % index.TilesPerSheet();
+    if (slot == 0 || m_sheet.empty()) m_sheet.assign(sheetStride * ROWS * TILE_HEIGHT, 0);
+    const int copyWidth = static_cast<int>((std::min)(width, static_cast<int64_t>(TILE_WIDTH)));
+    const int copyHeight = static_cast<int>((std::min)(height, static_cast<int64_t>(TILE_HEIGHT)));
+    const size_t x = static_cast<size_t>(slot % COLUMNS * TILE_WIDTH + (TILE_WIDTH - copyWidth) / 2);
+    const size_t y = static_cast<size_t>(slot / COLUMNS * TILE_HEIGHT + (TILE_HEIGHT - copyHeight) / 2);
+    const uint8_t* pixels = static_cast<const uint8_t*>(data->u.ba->data);
+    for (int row = 0; row < copyHeight; row++) {
+        std::memcpy(&m_sheet[(y + row) * sheetStride + x * 4], pixels + row * stride, static_cast<size_t>(copyWidth) * 4);
+    }
+    mpv_free_node_contents(&result);
+    return true;
+}
+
+// Writes the sheet holding the newest tile, cropped to the rows in use, then
+// the index that references it.
+bool SpriteGenerator::Flush(const SpriteSheetIndex& index, std::string& error)
+{
+    const std::filesystem::path dir = m_cacheDir / index.hash;
+    const int last = index.tiles - 1;
+    const int perSheet = index.TilesPerSheet();
+    const int rows = last % perSheet / COLUMNS + 1;
+    if (!EncodeSheet(dir / SpriteSheetIndex::SheetName(last / perSheet), rows, error)) return false;
+
+    const std::string vtt = index.ToVtt();
+    const bool written =
+        ReplaceFile(dir / "index.vtt", [&](const std::filesystem::path& file) {
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            out << vtt;
+            return static_cast<bool>(out);
+        }) &&
+        ReplaceFile(dir / "meta.json", [&](const std::filesystem::path& file) { return index.Save(file); });
+    if (!written) error = "cannot write the index";
+    return written;
+}
+
+// mpv already carries a JPEG encoder for screenshots, so the composed sheet is
+// handed back to a throwaway instance as one rawvideo frame and screenshotted.
+// screenshot-to-file picks the format from the file extension.
+bool SpriteGenerator::EncodeSheet(const std::filesystem::path& out, int rows, std::string& error)
+{
+    static Metrics::Histogram& s_encodeUs = Metrics::GetHistogram("sprites.encode_us");
+    Metrics::ScopedTimer timer(s_encodeUs);
+
+    const int width = COLUMNS * TILE_WIDTH;
+    const int height = rows * TILE_HEIGHT;
+    const std::filesystem::path raw = out.parent_path() / "sheet.raw";
+    {
+        std::ofstream file(raw, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(m_sheet.data()), static_cast<std::streamsize>(width) * height * 4);
+        if (!file) {
+            error = "cannot write " + Platform::WideToUtf8(raw.wstring());
+            return false;
+        }
+    }
+
+    mpv_handle* mpv = mpv_create();
+    if (!mpv) {
+        error = "mpv_create failed";
+        return false;
+    }
+    SetOption(mpv, "config", "no");
+    SetOption(mpv, "load-scripts", "no");
+    SetOption(mpv, "vo", "null");
+    SetOption(mpv, "ao", "null");
+    SetOption(mpv, "audio", "no");
+    SetOption(mpv, "pause", "yes");
+    SetOption(mpv, "keep-open", "always");
+    SetOption(mpv, "demuxer", "rawvideo");
+    SetOption(mpv, "demuxer-rawvideo-w", std::to_string(width));
+    SetOption(mpv, "demuxer-rawvideo-h", std::to_string(height));
+    SetOption(mpv, "demuxer-rawvideo-mp-format", "bgr0");
+    SetOption(mpv, "screenshot-jpeg-quality", "80");
+
+    std::filesystem::path partial = out;
+    partial.replace_extension(".partial.jpg");
+    const std::string rawUtf8 = Platform::WideToUtf8(raw.wstring());
+    const std::string partialUtf8 = Platform::WideToUtf8(partial.wstring());
+    if (mpv_initialize(mpv) < 0) error = "mpv_initialize failed";
+    if (error.empty()) {
+        const char* load[] = { "loadfile", rawUtf8.c_str(), nullptr };
+        int rc = mpv_command(mpv, load);
+        if (rc < 0) error = mpv_error_string(rc);
+    }
+    if (error.empty()) error = WaitFor(mpv, MPV_EVENT_PLAYBACK_RESTART, LOAD_TIMEOUT);
+    if (error.empty()) {
+        const char* screenshot[] = { "screenshot-to-file", partialUtf8.c_str(), "video", nullptr };
+        int rc = mpv_command(mpv, screenshot);
+        if (rc < 0) error = std::string("screenshot failed: ") + mpv_error_string(rc);
+    }
+    mpv_terminate_destroy(mpv);
+
+    std::error_code ec;
+    std::filesystem::remove(raw, ec);
+    if (error.empty()) {
+        std::filesystem::rename(partial, out, ec);
+        if (ec) error = ec.message();
+    }
+    if (!error.empty()) std::filesystem::remove(partial, ec);
+    return error.empty();
+}
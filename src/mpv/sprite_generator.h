@@ -0,0 +1,137 @@
+#ifndef SPRITE_GENERATOR_H
+#define SPRITE_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mpv/client.h>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+// How far one file's sprite sheets got, persisted as meta.json beside them.
+// Tile n covers [n * intervalSec, (n + 1) * intervalSec) and sits in sheet
+// n / (columns * rows), row-major.
+struct SpriteSheetIndex {
+    std::string hash;
+    double duration = 0.0;
+    double intervalSec = 0.0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    int columns = 0;
+    int rows = 0;
+    int tiles = 0;       // written so far, from the start of the file
+    int totalTiles = 0;  // 0 until the file was opened
+    bool complete = false;
+
+    int TilesPerSheet() const { return columns * rows; }
+    int Sheets() const;
+    // WEBVTT with one cue per tile: "sheet-000.jpg#xywh=x,y,w,h".
+    std::string ToVtt() const;
+    static std::string SheetName(int sheet);
+
+    bool Load(const std::filesystem::path& file);
+    bool Save(const std::filesystem::path& file) const;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SpriteSheetIndex, hash, duration, intervalSec, tileWidth, tileHeight,
+    columns, rows, tiles, totalTiles, complete)
+
+// Builds seekbar sprite sheets for the whole file being played, in the
+// background, so scrubbing a title seen before needs no decoding at all.
+//
+// A second mpv instance seeks to keyframes every INTERVAL_SEC, decoding
+// nothing else, and hands each frame over as raw pixels. Tiles are packed
+// into sheets of COLUMNS x ROWS, which are encoded by feeding them back to mpv
+// as rawvideo and taking a JPEG screenshot. Sheets, index.vtt and meta.json are
+// cached under the file's content hash; an interrupted job resumes at its last
+// full sheet.
+//
+// The job only runs while the main playback is steady (see
+// SetPlaybackSteady): it waits STABLE_AFTER before its first tile, stops between
+// tiles as soon as playback is not steady and resumes RESUME_AFTER later. Its
+// thread and the mpv threads started from it run at background priority.
+class SpriteGenerator
+{
+public:
+    // Runs on the generator thread whenever more of a file is available,
+    // including right away for a file that was already cached.
+    using UpdateCallback = std::function<void(const SpriteSheetIndex& index)>;
+
+    static constexpr double INTERVAL_SEC = 10.0;
+    static constexpr int TILE_WIDTH = 160;
+    static constexpr int TILE_HEIGHT = 90;
+    static constexpr int COLUMNS = 10;
+    static constexpr int ROWS = 10;
+    // A partial sheet is written every this many tiles.
+    static constexpr int FLUSH_TILES = 20;
+    // Buffered seconds a network stream needs before the job may run.
+    static constexpr double MIN_CACHE_SEC = 10.0;
+    static constexpr std::chrono::seconds STABLE_AFTER{30};
+    static constexpr std::chrono::seconds RESUME_AFTER{10};
+    static constexpr std::chrono::milliseconds TILE_PACING{250};
+    static constexpr int MAX_TILE_FAILURES = 3;  // in a row, before giving up on a file
+    static constexpr size_t MAX_TITLES = 100;    // cached files kept on disk
+    static constexpr std::chrono::seconds LOAD_TIMEOUT{15};
+    static constexpr std::chrono::seconds SEEK_TIMEOUT{10};
+
+    SpriteGenerator(std::filesystem::path cacheDir, UpdateCallback onUpdate);
+    ~SpriteGenerator();
+
+    // The file being played; empty when nothing is.
+    void SetSource(const std::string& url);
+    // Fed with every QoS sample of the main playback.
+    void SetPlaybackSteady(bool steady);
+
+    // The current file's index once its hash is known; tiles may still be 0.
+    std::optional<SpriteSheetIndex> GetIndex();
+    bool ReadSheet(const std::string& hash, int sheet, std::string& jpeg, std::string& error) const;
+
+    // OpenSubtitles-style hash: the size plus the first and last 64 KiB summed
+    // as 64-bit words. Reads local files directly and http(s) with range
+    // requests. Empty, with error set, for anything else.
+    static std::string ContentHash(const std::string& url, std::string& error);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void WorkerLoop();
+    std::optional<SpriteSheetIndex> Prepare(const std::string& url);
+    bool Open(const std::string& url, SpriteSheetIndex& index, std::string& error);
+    bool CaptureTile(const SpriteSheetIndex& index, std::string& error);
+    bool Flush(const SpriteSheetIndex& index, std::string& error);
+    bool EncodeSheet(const std::filesystem::path& out, int rows, std::string& error);
+    std::string WaitFor(mpv_handle* mpv, mpv_event_id id, std::chrono::seconds timeout);
+    void Prune(const std::string& keep);
+
+    // Callers hold m_mutex.
+    bool ReadyToRun(Clock::time_point now) const;
+
+    std::filesystem::path m_cacheDir;
+    UpdateCallback m_onUpdate;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+    std::string m_source;
+    uint64_t m_generation = 0;                 // bumped by every SetSource()
+    std::optional<SpriteSheetIndex> m_index;   // of m_source, once hashed
+    std::optional<Clock::time_point> m_steadySince;
+    bool m_started = false;                    // a tile was taken for m_source
+    int m_failures = 0;
+
+    // Worker thread only.
+    mpv_handle* m_mpv = nullptr;
+    std::string m_openUrl;
+    std::vector<uint8_t> m_sheet;  // bgr0, COLUMNS * TILE_WIDTH by ROWS * TILE_HEIGHT
+
+    std::thread m_worker;
+};
+
+#endif // SPRITE_GENERATOR_H
@@ -0,0 +1,382 @@
+#include "thumbnail_service.h"
+#include "../logger/logger.h"
+#include "../metrics/metrics.h"
+#include "../platform/platform.h"
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+ThumbnailService::ThumbnailService(std::filesystem::path scratchDir)
+    : m_scratchDir(std::move(scratchDir))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_scratchDir, ec);
+    m_worker = std::thread(&ThumbnailService::WorkerLoop, this);
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+    if (m_mpv) mpv_terminate_destroy(m_mpv);
+
+    std::vector<Pending> pending(std::make_move_iterator(m_pending.begin()), std::make_move_iterator(m_pending.end()));
+    m_pending.clear();
+    FailAll(pending, "shutting down");
+}
+
+int64_t ThumbnailService::BucketOf(double time)
+{
+    return static_cast<int64_t>(std::floor((std::max)(time, 0.0) / BUCKET_SEC));
+}
+
+void ThumbnailService::SetSource(const std::string& url)
+{
+    std::vector<Pending> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (url == m_source) return;
+        m_source = url;
+        m_duration = 0.0;
+        m_failedUrl.clear();
+        dropped.assign(std::make_move_iterator(m_pending.begin()), std::make_move_iterator(m_pending.end()));
+        m_pending.clear();
+        m_prefetch.clear();
+    }
+    m_cv.notify_all();
+    FailAll(dropped, "source changed");
+}
+
+void ThumbnailService::Request(double time, Callback callback)
+{
+    static Metrics::Counter& s_hits = Metrics::GetCounter("thumbnails.hits");
+    static Metrics::Counter& s_misses = Metrics::GetCounter("thumbnails.misses");
+    static Metrics::Counter& s_superseded = Metrics::GetCounter("thumbnails.superseded");
+
+    const int64_t bucket = BucketOf(time);
+    std::shared_ptr<const Thumbnail> cached;
+    std::string error;
+    std::vector<Pending> superseded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_source.empty()) {
+            error = "nothing playing";
+        } else if (m_source == m_failedUrl) {
+            error = "source could not be opened";
+        } else if ((cached = m_cache.Get(m_source, bucket))) {
+            s_hits.Add();
+            QueuePrefetch(bucket);
+        } else {
+            s_misses.Add();
+            auto it = std::find_if(m_pending.begin(), m_pending.end(), [bucket](const Pending& p) { return p.bucket == bucket; });
+            Pending entry;
+            if (it != m_pending.end()) {
+                entry = std::move(*it);
+                m_pending.erase(it);
+            }
+            entry.bucket = bucket;
+            entry.callbacks.push_back(std::move(callback));
+            m_pending.push_front(std::move(entry));
+            while (m_pending.size() > MAX_PENDING) {
+                superseded.push_back(std::move(m_pending.back()));
+                m_pending.pop_back();
+            }
+        }
+    }
+
+    if (cached) {
+        callback(cached, true, "");
+        m_cv.notify_all();
+        return;
+    }
+    if (!error.empty()) {
+        callback(nullptr, false, error);
+        return;
+    }
+    m_cv.notify_all();
+    s_superseded.Add(superseded.size());
+    FailAll(superseded, "superseded");
+}
+
+void ThumbnailService::FailAll(std::vector<Pending>& pending, const std::string& error)
+{
+    for (Pending& entry : pending) {
+        for (Callback& callback : entry.callbacks) callback(nullptr, false, error);
+    }
+    pending.clear();
+}
+
+std::shared_ptr<const ThumbnailService::Thumbnail> ThumbnailService::Cache::Get(const std::string& url, int64_t bucket)
+{
+    auto it = m_index.find({ url, bucket });
+    if (it == m_index.end()) return nullptr;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+}
+
+size_t ThumbnailService::Cache::Put(const std::string& url, std::shared_ptr<const Thumbnail> thumbnail)
+{
+    Key key{ url, thumbnail->bucket };
+    if (m_index.count(key)) return 0;
+    m_bytes += thumbnail->jpeg.size();
+    m_lru.emplace_front(key, std::move(thumbnail));
+    m_index[key] = m_lru.begin();
+    size_t evicted = 0;
+    while (m_bytes > m_maxBytes && m_lru.size() > 1) {
+        m_bytes -= m_lru.back().second->jpeg.size();
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+        evicted++;
+    }
+    return evicted;
+}
+
+void ThumbnailService::CachePut(const std::string& url, std::shared_ptr<const Thumbnail> thumbnail)
+{
+    static Metrics::Counter& s_evictions = Metrics::GetCounter("thumbnails.evictions");
+    static Metrics::Gauge& s_cacheBytes = Metrics::GetGauge("thumbnails.cache_bytes");
+
+    s_evictions.Add(m_cache.Put(url, std::move(thumbnail)));
+    s_cacheBytes.Set(static_cast<int64_t>(m_cache.GetBytes()));
+}
+
+// Nearest buckets first, forward before backward: a hover sweep usually keeps its direction.
+void ThumbnailService::QueuePrefetch(int64_t bucket)
+{
+    const int64_t last = m_duration > 0.0 ? BucketOf(m_duration) : INT64_MAX;
+    m_prefetch.clear();
+    for (int64_t d = 1; d <= PREFETCH_BUCKETS; d++) {
+        for (int64_t neighbour : { bucket + d, bucket - d }) {
+            if (neighbour < 0 || neighbour > last || m_cache.Contains(m_source, neighbour)) continue;
+            m_prefetch.push_back(neighbour);
+        }
+    }
+}
+
+void ThumbnailService::WorkerLoop()
+{
+    static Metrics::Counter& s_prefetched = Metrics::GetCounter("thumbnails.prefetched");
+    static Metrics::Counter& s_failures = Metrics::GetCounter("thumbnails.failures");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this]() {
+            return m_stopping || !m_pending.empty() || !m_prefetch.empty() || (m_source.empty() && !m_openUrl.empty());
+        });
+        if (m_stopping) break;
+
+        if (m_source.empty()) {
+            // Release the file, and with it any network connection.
+            lock.unlock();
+            const char* stop[] = { "stop", nullptr };
+            mpv_command(m_mpv, stop);
+            m_openUrl.clear();
+            lock.lock();
+            continue;
+        }
+
+        const std::string url = m_source;
+        Pending job;
+        const bool prefetch = m_pending.empty();
+        if (prefetch) {
+            job.bucket = m_prefetch.front();
+            m_prefetch.pop_front();
+        } else {
+            job = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+
+        std::shared_ptr<const Thumbnail> thumbnail = m_cache.Get(url, job.bucket);
+        std::string error;
+        bool cached = thumbnail != nullptr;
+        if (!cached) {
+            lock.unlock();
+            if (url != m_openUrl && !Open(url, error)) {
+                LOG_WARN("ThumbnailService", "Cannot open " + url + ": " + error);
+            } else {
+                thumbnail = Capture(job.bucket, error);
+            }
+            lock.lock();
+            if (thumbnail && url == m_source) {
+                CachePut(url, thumbnail);
+                if (prefetch) s_prefetched.Add();
+                else QueuePrefetch(job.bucket);
+            }
+        }
+
+        // Without an open file every queued request would retry and fail the same way.
+        std::vector<Pending> failed;
+        if (!thumbnail) {
+            s_failures.Add();
+            if (url != m_openUrl && url == m_source) {
+                m_failedUrl = url;
+                failed.assign(std::make_move_iterator(m_pending.begin()), std::make_move_iterator(m_pending.end()));
+                m_pending.clear();
+                m_prefetch.clear();
+            }
+        }
+
+        lock.unlock();
+        for (Callback& callback : job.callbacks) callback(thumbnail, cached, error);
+        FailAll(failed, error);
+        lock.lock();
+    }
+}
+
+static void SetOption(mpv_handle* mpv, const char* name, const char* value)
+{
+    mpv_set_option_string(mpv, name, value);
+}
+
+// Mirrors what thumbfast.lua passes to its mpv process: no scripts or audio,
+// a tiny demuxer cache, and the cheapest decode and scale settings.
+bool ThumbnailService::Open(const std::string& url, std::string& error)
+{
+    if (!m_mpv) {
+        m_mpv = mpv_create();
+        if (!m_mpv) {
+            error = "mpv_create failed";
+            return false;
+        }
+        SetOption(m_mpv, "config", "no");
+        SetOption(m_mpv, "load-scripts", "no");
+        SetOption(m_mpv, "osc", "no");
+        SetOption(m_mpv, "ytdl", "no");
+        SetOption(m_mpv, "input-default-bindings", "no");
+        SetOption(m_mpv, "vo", "null");
+        SetOption(m_mpv, "ao", "null");
+        SetOption(m_mpv, "audio", "no");
+        SetOption(m_mpv, "sid", "no");
+        SetOption(m_mpv, "idle", "yes");
+        SetOption(m_mpv, "pause", "yes");
+        SetOption(m_mpv, "keep-open", "always");
+        SetOption(m_mpv, "hr-seek", "yes");
+        SetOption(m_mpv, "demuxer-readahead-secs", "0");
+        SetOption(m_mpv, "demuxer-max-bytes", "128KiB");
+        SetOption(m_mpv, "hwdec", "no");
+        SetOption(m_mpv, "vd-lavc-skiploopfilter", "all");
+        SetOption(m_mpv, "vd-lavc-software-fallback", "1");
+        SetOption(m_mpv, "vd-lavc-fast", "yes");
+        SetOption(m_mpv, "vd-lavc-threads", "2");
+        SetOption(m_mpv, "sws-scaler", "fast-bilinear");
+        SetOption(m_mpv, "vf", ("scale=" + std::to_string(WIDTH) + ":-2").c_str());
+        SetOption(m_mpv, "screenshot-format", "jpg");
+        SetOption(m_mpv, "screenshot-jpeg-quality", "75");
+        SetOption(m_mpv, "screenshot-high-bit-depth", "no");
+        if (mpv_initialize(m_mpv) < 0) {
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            error = "mpv_initialize failed";
+            return false;
+        }
+    }
+
+    m_openUrl.clear();
+    const char* load[] = { "loadfile", url.c_str(), "replace", nullptr };
+    int rc = mpv_command(m_mpv, load);
+    if (rc < 0) {
+        error = mpv_error_string(rc);
+        return false;
+    }
+    error = WaitFor(MPV_EVENT_FILE_LOADED, LOAD_TIMEOUT);
+    if (!error.empty()) return false;
+
+    double duration = 0.0;
+    mpv_get_property(m_mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (url == m_source) m_duration = duration;
+    }
+    m_openUrl = url;
+    return true;
+}
+
+// Returns an empty string once the event arrives. END_FILE only counts as
+// failure when it carries an error: a replaced file ends with reason "stop".
+std::string ThumbnailService::WaitFor(mpv_event_id id, std::chrono::seconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) return "shutting down";
+        }
+        mpv_event* ev = mpv_wait_event(m_mpv, 0.1);
+        if (ev->event_id == id) return {};
+        if (ev->event_id == MPV_EVENT_SHUTDOWN) return "mpv shut down";
+        if (ev->event_id == MPV_EVENT_END_FILE) {
+            mpv_event_end_file* ef = static_cast<mpv_event_end_file*>(ev->data);
+            if (ef->reason == MPV_END_FILE_REASON_ERROR) return mpv_error_string(ef->error);
+        }
+    }
+    return "timed out";
+}
+
+static int64_t GetInt(mpv_handle* mpv, const char* name)
+{
+    int64_t value = 0;
+    mpv_get_property(mpv, name, MPV_FORMAT_INT64, &value);
+    return value;
+}
+
+std::shared_ptr<const ThumbnailService::Thumbnail> ThumbnailService::Capture(int64_t bucket, std::string& error)
+{
+    static Metrics::Histogram& s_captureUs = Metrics::GetHistogram("thumbnails.capture_us");
+    Metrics::ScopedTimer timer(s_captureUs);
+
+    double duration;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        duration = m_duration;
+    }
+    // The middle of the bucket represents it best; the last one may be short.
+    double time = bucket * BUCKET_SEC + BUCKET_SEC / 2.0;
+    if (duration > 0.0) time = (std::min)(time, (std::max)(duration - 0.5, bucket * BUCKET_SEC));
+
+    // Drop stale events so an earlier PLAYBACK_RESTART cannot satisfy this seek.
+    while (mpv_wait_event(m_mpv, 0)->event_id != MPV_EVENT_NONE) {}
+
+    const std::string position = std::to_string(time);
+    const char* seek[] = { "seek", position.c_str(), "absolute+exact", nullptr };
+    int rc = mpv_command(m_mpv, seek);
+    if (rc < 0) {
+        error = std::string("seek failed: ") + mpv_error_string(rc);
+        return nullptr;
+    }
+    error = WaitFor(MPV_EVENT_PLAYBACK_RESTART, SEEK_TIMEOUT);
+    if (!error.empty()) return nullptr;
+
+    // Synchronous: the file is complete when mpv_command returns.
+    const std::filesystem::path file = m_scratchDir / "capture.jpg";
+    const std::string fileUtf8 = Platform::WideToUtf8(file.wstring());
+    const char* screenshot[] = { "screenshot-to-file", fileUtf8.c_str(), "video", nullptr };
+    rc = mpv_command(m_mpv, screenshot);
+    if (rc < 0) {
+        error = std::string("screenshot failed: ") + mpv_error_string(rc);
+        return nullptr;
+    }
+
+    auto thumbnail = std::make_shared<Thumbnail>();
+    {
+        std::ifstream in(file, std::ios::binary);
+        std::ostringstream data;
+        data << in.rdbuf();
+        thumbnail->jpeg = data.str();
+    }
+    std::error_code ec;
+    std::filesystem::remove(file, ec);
+    if (thumbnail->jpeg.empty()) {
+        error = "screenshot produced no data";
+        return nullptr;
+    }
+    thumbnail->time = time;
+    thumbnail->bucket = bucket;
+    thumbnail->width = static_cast<int>(GetInt(m_mpv, "video-out-params/dw"));
+    thumbnail->height = static_cast<int>(GetInt(m_mpv, "video-out-params/dh"));
+    return thumbnail;
+}
@@ -0,0 +1,121 @@
+#ifndef THUMBNAIL_SERVICE_H
+#define THUMBNAIL_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mpv/client.h>
+
+// Seekbar previews from a second, headless mpv instance that keeps the
+// current file open, paused, and seeks it on demand. Frames are scaled by mpv
+// and written as JPEG with screenshot-to-file, then kept in memory.
+//
+// Times are grouped into buckets of BUCKET_SEC; one image serves a whole
+// bucket. Images are cached per (file, bucket) in a byte-bounded LRU, and
+// every miss prefetches the neighbouring buckets so a hover sweep mostly
+// hits. The newest request is served first; older ones waiting behind it are
+// dropped once more than MAX_PENDING are queued.
+class ThumbnailService
+{
+public:
+    struct Thumbnail {
+        double time = 0.0;
+        int64_t bucket = 0;
+        int width = 0;
+        int height = 0;
+        std::string jpeg;
+    };
+    // Byte-bounded LRU of images per (file, bucket). Not thread-safe; the
+    // service only touches it under m_mutex. The newest image is always kept,
+    // even when it alone is over the limit.
+    class Cache
+    {
+    public:
+        explicit Cache(size_t maxBytes) : m_maxBytes(maxBytes) {}
+
+        // Marks the image most recently used.
+        std::shared_ptr<const Thumbnail> Get(const std::string& url, int64_t bucket);
+        bool Contains(const std::string& url, int64_t bucket) const { return m_index.count({ url, bucket }) != 0; }
+        // Keeps an image already cached for the bucket. Returns how many
+        // older images were evicted to make room.
+        size_t Put(const std::string& url, std::shared_ptr<const Thumbnail> thumbnail);
+
+        size_t GetBytes() const { return m_bytes; }
+        size_t GetCount() const { return m_lru.size(); }
+
+    private:
+        using Key = std::pair<std::string, int64_t>;
+        size_t m_maxBytes;
+        std::list<std::pair<Key, std::shared_ptr<const Thumbnail>>> m_lru;  // most recent first
+        std::map<Key, decltype(m_lru)::iterator> m_index;
+        size_t m_bytes = 0;
+    };
+
+    // Runs on the service thread, or inline for cache hits and immediate failures.
+    using Callback = std::function<void(std::shared_ptr<const Thumbnail> thumbnail, bool cached, const std::string& error)>;
+
+    static constexpr double BUCKET_SEC = 5.0;
+    static constexpr int WIDTH = 320;
+    static constexpr int PREFETCH_BUCKETS = 2;  // on each side of a miss
+    static constexpr size_t MAX_PENDING = 4;
+    static constexpr size_t CACHE_BYTES = 24u << 20;
+    static constexpr std::chrono::seconds LOAD_TIMEOUT{15};
+    static constexpr std::chrono::seconds SEEK_TIMEOUT{5};
+
+    // scratchDir receives the screenshot file between capture and read-back.
+    explicit ThumbnailService(std::filesystem::path scratchDir);
+    ~ThumbnailService();
+
+    // The file being played; empty when nothing is. Pending requests for the
+    // previous file fail. The file is only opened once a thumbnail is requested.
+    void SetSource(const std::string& url);
+    void Request(double time, Callback callback);
+
+    static int64_t BucketOf(double time);
+
+private:
+    struct Pending {
+        int64_t bucket = 0;
+        std::vector<Callback> callbacks;
+    };
+
+    void WorkerLoop();
+    bool Open(const std::string& url, std::string& error);
+    std::shared_ptr<const Thumbnail> Capture(int64_t bucket, std::string& error);
+    std::string WaitFor(mpv_event_id id, std::chrono::seconds timeout);
+    void FailAll(std::vector<Pending>& pending, const std::string& error);
+
+    // Callers hold m_mutex.
+    void CachePut(const std::string& url, std::shared_ptr<const Thumbnail> thumbnail);
+    void QueuePrefetch(int64_t bucket);
+
+    std::filesystem::path m_scratchDir;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+    std::string m_source;
+    std::string m_failedUrl;            // m_source, once opening it failed
+    double m_duration = 0.0;            // of m_source once opened; 0 = unknown
+    std::deque<Pending> m_pending;      // newest first
+    std::deque<int64_t> m_prefetch;
+    Cache m_cache{ CACHE_BYTES };
+
+    // Worker thread only.
+    mpv_handle* m_mpv = nullptr;
+    std::string m_openUrl;
+
+    std::thread m_worker;
+};
+
+#endif // THUMBNAIL_SERVICE_H
@@ -0,0 +1,46 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <string>
+#include <ctime>
+#include <cstdint>
+#include <filesystem>
+
+// Thin OS layer for the portable core (stremato_core). Everything in here has
+// a Win32 implementation (platform_win32.cpp) used by the app and a POSIX one
+// (platform_posix.cpp) used by headless and benchmark hosts. Window, WebView2
+// and process management stay in the Windows app and are not abstracted.
+namespace Platform {
+    std::string WideToUtf8(const std::wstring& wide);
+    std::wstring Utf8ToWide(const std::string& utf8);
+
+    std::filesystem::path GetExecutableDirectory();
+
+    bool LocalTime(std::time_t time, std::tm& out);
+
+    // Debugger output on Windows, stderr elsewhere.
+    void DebugOutput(const std::string& utf8);
+
+    struct MemoryStatus {
+        uint64_t totalBytes = 0;
+        uint64_t availableBytes = 0;  // usable without swapping
+    };
+    bool GetMemoryStatus(MemoryStatus& out);
+
+    // Display adapters and their driver versions, one per line. Changes when a
+    // GPU or driver is swapped; empty when nothing can be read.
+    std::string GetGpuDriverFingerprint();
+
+    // Lowest scheduling priority for the calling thread, for background jobs
+    // that must not compete with playback. On Linux threads started from it
+    // afterwards inherit the priority; on Windows they do not.
+    void SetBackgroundThreadPriority();
+
+    // INI files with GetPrivateProfile* semantics: missing files, sections or
+    // keys yield the default and writes create them.
+    int ReadIniInt(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, int defaultValue);
+    std::wstring ReadIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue);
+    bool WriteIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& value);
+}
+
+#endif // PLATFORM_H
@@ -0,0 +1,245 @@
+#include "platform.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cwctype>
+#include <cstdlib>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace Platform {
+    // wchar_t is UTF-32 here.
+    std::string WideToUtf8(const std::wstring& wide)
+    {
+        std::string out;
+        out.reserve(wide.size());
+        for (wchar_t wc : wide) {
+            uint32_t cp = static_cast<uint32_t>(wc);
+            if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) cp = 0xFFFD;
+            if (cp < 0x80) {
+                out.push_back(static_cast<char>(cp));
+            } else if (cp < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+        return out;
+    }
+
+    std::wstring Utf8ToWide(const std::string& utf8)
+    {
+        std::wstring out;
+        out.reserve(utf8.size());
+        size_t i = 0;
+        while (i < utf8.size()) {
+            unsigned char c = static_cast<unsigned char>(utf8[i]);
+            uint32_t cp;
+            size_t extra;
+            if (c < 0x80) { cp = c; extra = 0; }
+            else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; extra = 1; }
+            else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; extra = 2; }
+            else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; extra = 3; }
+            else { out.push_back(0xFFFD); i++; continue; }
+
+            bool valid = true;
+            for (size_t k = 1; k <= extra; k++) {
+                if (i + k >= utf8.size() || (static_cast<unsigned char>(utf8[i + k]) & 0xC0) != 0x80) { valid = false; break; }
+                cp = (cp << 6) | (static_cast<unsigned char>(utf8[i + k]) & 0x3F);
+            }
+            if (!valid) { out.push_back(0xFFFD); i++; continue; }
+            out.push_back(static_cast<wchar_t>(cp));
+            i += extra + 1;
+        }
+        return out;
+    }
+
+    std::filesystem::path GetExecutableDirectory()
+    {
+        char buf[PATH_MAX];
+        ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+        if (len <= 0) return std::filesystem::current_path();
+        buf[len] = '\0';
+        return std::filesystem::path(buf).parent_path();
+    }
+
+    bool LocalTime(std::time_t time, std::tm& out)
+    {
+        return localtime_r(&time, &out) != nullptr;
+    }
+
+    void DebugOutput(const std::string& utf8)
+    {
+        std::cerr << utf8;
+    }
+
+    // MemAvailable is Linux-specific; elsewhere fall back to free pages.
+    bool GetMemoryStatus(MemoryStatus& out)
+    {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        if (pageSize <= 0 || pages <= 0) return false;
+        out.totalBytes = static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize);
+        out.availableBytes = 0;
+
+        std::ifstream meminfo("/proc/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            if (line.rfind("MemAvailable:", 0) == 0) {
+                out.availableBytes = std::strtoull(line.c_str() + 13, nullptr, 10) * 1024;
+                break;
+            }
+        }
+#ifdef _SC_AVPHYS_PAGES
+        if (out.availableBytes == 0) {
+            const long freePages = sysconf(_SC_AVPHYS_PAGES);
+            if (freePages > 0) out.availableBytes = static_cast<uint64_t>(freePages) * static_cast<uint64_t>(pageSize);
+        }
+#endif
+        return true;
+    }
+
+    static std::string ReadFirstLine(const std::filesystem::path& file)
+    {
+        std::ifstream in(file);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // DRM devices with their PCI ids and kernel driver; the proprietary NVIDIA
+    // driver reports its version separately.
+    std::string GetGpuDriverFingerprint()
+    {
+        std::vector<std::string> lines;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/class/drm", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("card", 0) != 0 || name.find('-') != std::string::npos) continue;
+            const std::filesystem::path device = entry.path() / "device";
+            std::string driver = std::filesystem::read_symlink(device / "driver", ec).filename().string();
+            std::string line = ReadFirstLine(device / "vendor") + ":" + ReadFirstLine(device / "device") + " " + driver;
+            std::string version = ReadFirstLine(std::filesystem::path("/sys/module") / driver / "version");
+            if (!version.empty()) line += " " + version;
+            lines.push_back(line);
+        }
+        std::string nvidia = ReadFirstLine("/proc/driver/nvidia/version");
+        if (!nvidia.empty()) lines.push_back(nvidia);
+        std::sort(lines.begin(), lines.end());
+
+        std::string out;
+        for (const auto& line : lines) out += line + "\n";
+        return out;
+    }
+
+    // Linux keeps a nice value per thread; elsewhere setpriority would renice
+    // the whole process, so it is left alone.
+    void SetBackgroundThreadPriority()
+    {
+#ifdef __linux__
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    }
+
+    static std::wstring Trim(const std::wstring& s)
+    {
+        size_t begin = 0, end = s.size();
+        while (begin < end && std::iswspace(s[begin])) begin++;
+        while (end > begin && std::iswspace(s[end - 1])) end--;
+        return s.substr(begin, end - begin);
+    }
+
+    static bool EqualsNoCase(const std::wstring& a, const std::wstring& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+            [](wchar_t x, wchar_t y) { return std::towlower(x) == std::towlower(y); });
+    }
+
+    static std::vector<std::wstring> ReadLines(const std::filesystem::path& file)
+    {
+        std::vector<std::wstring> lines;
+        std::ifstream in(file, std::ios::binary);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            lines.push_back(Utf8ToWide(line));
+        }
+        return lines;
+    }
+
+    // Finds key in section; returns the line index or -1. sectionEnd receives the
+    // index to insert new keys at (or -1 when the section does not exist).
+    static long FindKey(const std::vector<std::wstring>& lines, const std::wstring& section, const std::wstring& key, long& sectionEnd)
+    {
+        bool inSection = false;
+        sectionEnd = -1;
+        for (size_t i = 0; i < lines.size(); i++) {
+            std::wstring line = Trim(lines[i]);
+            if (line.size() >= 2 && line.front() == L'[' && line.back() == L']') {
+                inSection = EqualsNoCase(Trim(line.substr(1, line.size() - 2)), section);
+                if (inSection) sectionEnd = static_cast<long>(i) + 1;
+                continue;
+            }
+            if (!inSection) continue;
+            if (!line.empty() && line[0] != L';') sectionEnd = static_cast<long>(i) + 1;
+            size_t eq = line.find(L'=');
+            if (eq != std::wstring::npos && EqualsNoCase(Trim(line.substr(0, eq)), key)) return static_cast<long>(i);
+        }
+        return -1;
+    }
+
+    std::wstring ReadIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue)
+    {
+        std::vector<std::wstring> lines = ReadLines(file);
+        long sectionEnd;
+        long index = FindKey(lines, section, key, sectionEnd);
+        if (index < 0) return defaultValue;
+        const std::wstring& line = lines[index];
+        return Trim(line.substr(line.find(L'=') + 1));
+    }
+
+    int ReadIniInt(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, int defaultValue)
+    {
+        std::wstring value = ReadIniString(file, section, key, L"");
+        if (value.empty()) return defaultValue;
+        try {
+            return std::stoi(value);
+        } catch (...) {
+            return 0; // GetPrivateProfileInt returns 0 for non-numeric values
+        }
+    }
+
+    bool WriteIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& value)
+    {
+        std::vector<std::wstring> lines = ReadLines(file);
+        long sectionEnd;
+        long index = FindKey(lines, section, key, sectionEnd);
+        std::wstring entry = key + L"=" + value;
+        if (index >= 0) {
+            lines[index] = entry;
+        } else if (sectionEnd >= 0) {
+            lines.insert(lines.begin() + sectionEnd, entry);
+        } else {
+            lines.push_back(L"[" + section + L"]");
+            lines.push_back(entry);
+        }
+
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        for (const auto& line : lines) out << WideToUtf8(line) << '\n';
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,106 @@
+#include "platform.h"
+#include <windows.h>
+#include <vector>
+#include <algorithm>
+
+namespace Platform {
+    std::string WideToUtf8(const std::wstring& wide)
+    {
+        if (wide.empty()) return {};
+        int neededSize = WideCharToMultiByte(CP_UTF8, 0, wide.data(), (int)wide.size(), nullptr, 0, nullptr, nullptr);
+        if (neededSize <= 0) return {};
+        std::string result(neededSize, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, wide.data(), (int)wide.size(), &result[0], neededSize, nullptr, nullptr);
+        while (!result.empty() && result.back() == '\0') result.pop_back();
+        return result;
+    }
+
+    std::wstring Utf8ToWide(const std::string& utf8)
+    {
+        if (utf8.empty()) return std::wstring();
+        int sizeNeeded = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), NULL, 0);
+        if (sizeNeeded == 0) return std::wstring();
+        std::wstring wide(sizeNeeded, 0);
+        MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), &wide[0], sizeNeeded);
+        return wide;
+    }
+
+    std::filesystem::path GetExecutableDirectory()
+    {
+        wchar_t buf[MAX_PATH];
+        GetModuleFileNameW(nullptr, buf, MAX_PATH);
+        std::wstring path(buf);
+        size_t pos = path.find_last_of(L"\\/");
+        if (pos != std::wstring::npos) path.erase(pos);
+        return path;
+    }
+
+    bool LocalTime(std::time_t time, std::tm& out)
+    {
+        return localtime_s(&out, &time) == 0;
+    }
+
+    void DebugOutput(const std::string& utf8)
+    {
+        if (utf8.empty()) return;
+        OutputDebugStringW(Utf8ToWide(utf8).c_str());
+    }
+
+    bool GetMemoryStatus(MemoryStatus& out)
+    {
+        MEMORYSTATUSEX status = { sizeof(status) };
+        if (!GlobalMemoryStatusEx(&status)) return false;
+        out.totalBytes = status.ullTotalPhys;
+        out.availableBytes = status.ullAvailPhys;
+        return true;
+    }
+
+    // DriverVersion lives under the adapter's registry key, which
+    // EnumDisplayDevices reports in kernel form (\Registry\Machine\...).
+    std::string GetGpuDriverFingerprint()
+    {
+        std::string out;
+        DISPLAY_DEVICEW device = { sizeof(device) };
+        std::vector<std::wstring> seen;
+        for (DWORD i = 0; EnumDisplayDevicesW(nullptr, i, &device, 0); i++, device.cb = sizeof(device)) {
+            std::wstring key = device.DeviceKey;
+            if (key.empty() || std::find(seen.begin(), seen.end(), key) != seen.end()) continue;
+            seen.push_back(key);
+
+            std::wstring version;
+            const std::wstring prefix = L"\\Registry\\Machine\\";
+            if (key.size() > prefix.size() && _wcsnicmp(key.c_str(), prefix.c_str(), prefix.size()) == 0) {
+                wchar_t buf[128] = {};
+                DWORD size = sizeof(buf);
+                if (RegGetValueW(HKEY_LOCAL_MACHINE, key.c_str() + prefix.size(), L"DriverVersion", RRF_RT_REG_SZ, nullptr, buf, &size) == ERROR_SUCCESS) {
+                    version = buf;
+                }
+            }
+            out += WideToUtf8(std::wstring(device.DeviceString) + L" " + version) + "\n";
+        }
+        return out;
+    }
+
+    // Background mode also lowers the thread's I/O and memory priority.
+    void SetBackgroundThreadPriority()
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+    }
+
+    int ReadIniInt(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, int defaultValue)
+    {
+        return GetPrivateProfileIntW(section.c_str(), key.c_str(), defaultValue, file.c_str());
+    }
+
+    std::wstring ReadIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue)
+    {
+        std::vector<wchar_t> buffer(256);
+        GetPrivateProfileStringW(section.c_str(), key.c_str(), defaultValue.c_str(), buffer.data(), (DWORD)buffer.size(), file.c_str());
+        return buffer.data();
+    }
+
+    bool WriteIniString(const std::filesystem::path& file, const std::wstring& section, const std::wstring& key, const std::wstring& value)
+    {
+        return WritePrivateProfileStringW(section.c_str(), key.c_str(), value.c_str(), file.c_str()) != FALSE;
+    }
+}
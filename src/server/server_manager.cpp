@@ -1,20 +1,69 @@
 #include "server_manager.h"
 #include "../helpers/helpers.h"
 #include "../logger/logger.h"
+#include "../webview_protocol/event_emitter/event_emitter.h"
+#include "../crashlog/crashlog.h"
+#include "../metrics/metrics.h"
 #include <shlobj.h> 
+#include <chrono>
+#include <vector>
 
-ServerManager::ServerManager() : m_serverJob(nullptr), m_nodeProcess(nullptr) {}
+static const int SERVER_PRIMARY_PORT = 11470;
+static const int SERVER_HANDOVER_PORT = 11471;
+static const wchar_t* SERVER_PORT_ENV = L"HTTP_PORT";
+static const DWORD SERVER_READY_TIMEOUT_MS = 20000;
+static const DWORD SERVER_DRAIN_MS = 30000;
+static const DWORD SERVER_METRICS_INTERVAL_MS = 5000;
+static const std::chrono::milliseconds SERVER_OUTPUT_DRAIN_TIMEOUT{2000};
+
+// Copies the current environment block and appends the port override.
+static std::wstring BuildEnvironmentBlock(int port)
+{
+    std::wstring block;
+    LPWCH env = GetEnvironmentStringsW();
+    if (env) {
+        for (LPWCH var = env; *var; var += wcslen(var) + 1) {
+            if (_wcsnicmp(var, SERVER_PORT_ENV, wcslen(SERVER_PORT_ENV)) == 0 && var[wcslen(SERVER_PORT_ENV)] == L'=') continue;
+            block.append(var);
+            block.push_back(L'\0');
+        }
+        FreeEnvironmentStringsW(env);
+    }
+    block.append(std::wstring(SERVER_PORT_ENV) + L"=" + std::to_wstring(port));
+    block.push_back(L'\0');
+    block.push_back(L'\0');
+    return block;
+}
+
+ServerManager::ServerManager()
+    : m_generation(0), m_ready(false), m_wakeEvent(CreateEventW(nullptr, FALSE, FALSE, nullptr)), m_watcherRunning(false),
+      m_stopping(false), m_stopEvent(CreateEventW(nullptr, TRUE, FALSE, nullptr)), m_shutdown(false),
+      m_readyTimer(CreateThreadpoolTimer(&ServerManager::OnReadyTimer, this, nullptr)) {}
 
 ServerManager::~ServerManager()
 {
-    Stop();
+    Shutdown();
+    if (m_readyTimer) {
+        SetThreadpoolTimer(m_readyTimer, nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(m_readyTimer, TRUE);
+        CloseThreadpoolTimer(m_readyTimer);
+    }
+    if (m_wakeEvent) CloseHandle(m_wakeEvent);
+    if (m_stopEvent) CloseHandle(m_stopEvent);
 }
 
-bool ServerManager::Start()
+void ServerManager::SetResourceLimits(int memoryLimitMB, int cpuRatePercent)
 {
-    std::wstring exeDir = GetExeDirectory();
-    std::wstring exePath = exeDir + L"\\stremio-runtime.exe";
-    std::wstring scriptPath = exeDir + L"\\server.js";
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limits.memoryLimitMB = memoryLimitMB;
+    m_limits.cpuRatePercent = cpuRatePercent;
+}
+
+bool ServerManager::ResolvePaths(std::wstring& exeDir, std::wstring& exePath, std::wstring& scriptPath) const
+{
+    exeDir = GetExeDirectory();
+    exePath = exeDir + L"\\stremio-runtime.exe";
+    scriptPath = exeDir + L"\\server.js";
 
     if (!FileExists(exePath) || !FileExists(scriptPath)) {
         LOG_WARN("ServerManager", "stremio-runtime.exe not found in app directory, checking %localappdata%.");
@@ -30,45 +79,502 @@ bool ServerManager::Start()
         LOG_ERROR("ServerManager", "Could not find stremio-runtime.exe and server.js.");
         return false;
     }
+    return true;
+}
 
-    m_serverJob = CreateJobObject(nullptr, nullptr);
-    if (m_serverJob) {
+bool ServerManager::Launch(int port, const ResourceLimits& limits, ServerInstance& instance) const
+{
+    std::wstring exeDir, exePath, scriptPath;
+    if (!ResolvePaths(exeDir, exePath, scriptPath)) return false;
+
+    instance.job = CreateJobObject(nullptr, nullptr);
+    if (instance.job) {
         JOBOBJECT_EXTENDED_LIMIT_INFORMATION jobInfo = {0};
         jobInfo.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
-        SetInformationJobObject(m_serverJob, JobObjectExtendedLimitInformation, &jobInfo, sizeof(jobInfo));
+        if (limits.memoryLimitMB > 0) {
+            jobInfo.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_JOB_MEMORY;
+            jobInfo.JobMemoryLimit = static_cast<SIZE_T>(limits.memoryLimitMB) * 1024 * 1024;
+        }
+        SetInformationJobObject(instance.job, JobObjectExtendedLimitInformation, &jobInfo, sizeof(jobInfo));
+
+        if (limits.cpuRatePercent > 0 && limits.cpuRatePercent < 100) {
+            JOBOBJECT_CPU_RATE_CONTROL_INFORMATION cpuInfo = {0};
+            cpuInfo.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP;
+            cpuInfo.CpuRate = static_cast<DWORD>(limits.cpuRatePercent) * 100;
+            if (!SetInformationJobObject(instance.job, JobObjectCpuRateControlInformation, &cpuInfo, sizeof(cpuInfo))) {
+                LOG_WARN("ServerManager", "Failed to apply CPU rate limit. Error: " + std::to_string(GetLastError()));
+            }
+        }
     } else {
         LOG_ERROR("ServerManager", "Failed to create Job Object.");
         return false;
     }
 
-    STARTUPINFOW si = { sizeof(si) };
+    STARTUPINFOEXW si = {};
+    si.StartupInfo.cb = sizeof(si);
     PROCESS_INFORMATION pi = {0};
     std::wstring cmdLine = L"\"" + exePath + L"\" \"" + scriptPath + L"\"";
+    std::wstring envBlock = BuildEnvironmentBlock(port);
+
+    // The child inherits its own pipe end and nothing else: a hot swap can
+    // launch while a relaunch holds another inheritable write end, and a child
+    // holding that would keep the other instance's pipe from ever reaching EOF.
+    auto output = std::make_shared<ServerOutputCapture>();
+    HANDLE childOutput = output->CreateChildHandle();
+    std::vector<char> attributeBuffer;
+    LPPROC_THREAD_ATTRIBUTE_LIST attributes = nullptr;
+    if (childOutput) {
+        SIZE_T attributeSize = 0;
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+        attributeBuffer.resize(attributeSize);
+        attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeBuffer.data());
+        const bool initialized = InitializeProcThreadAttributeList(attributes, 1, 0, &attributeSize);
+        if (!initialized || !UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &childOutput, sizeof(childOutput), nullptr, nullptr)) {
+            LOG_WARN("ServerManager", "Failed to restrict inherited handles, server output will not be captured. Error: " + std::to_string(GetLastError()));
+            if (initialized) DeleteProcThreadAttributeList(attributes);
+            attributes = nullptr;
+            output->CloseChildHandle();
+            childOutput = nullptr;
+        }
+    }
+    if (childOutput) {
+        si.StartupInfo.dwFlags |= STARTF_USESTDHANDLES;
+        si.StartupInfo.hStdInput = nullptr;
+        si.StartupInfo.hStdOutput = childOutput;
+        si.StartupInfo.hStdError = childOutput;
+        si.lpAttributeList = attributes;
+    }
 
     BOOL success = CreateProcessW(
-        nullptr, &cmdLine[0], nullptr, nullptr, FALSE,
-        CREATE_NO_WINDOW, nullptr, exeDir.c_str(), &si, &pi
+        nullptr, &cmdLine[0], nullptr, nullptr, childOutput ? TRUE : FALSE,
+        CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT | (childOutput ? EXTENDED_STARTUPINFO_PRESENT : 0),
+        envBlock.data(), exeDir.c_str(), &si.StartupInfo, &pi
     );
+    const DWORD launchError = success ? ERROR_SUCCESS : GetLastError();
+    if (attributes) DeleteProcThreadAttributeList(attributes);
+    output->CloseChildHandle();
 
     if (!success) {
-        LOG_ERROR("ServerManager", "Failed to launch stremio-runtime.exe. Error: " + std::to_string(GetLastError()));
+        LOG_ERROR("ServerManager", "Failed to launch stremio-runtime.exe. Error: " + std::to_string(launchError));
+        CloseHandle(instance.job);
+        instance.job = nullptr;
         return false;
     }
 
-    AssignProcessToJobObject(m_serverJob, pi.hProcess);
-    m_nodeProcess = pi.hProcess;
+    output->StartReading();
+    instance.output = output;
+
+    AssignProcessToJobObject(instance.job, pi.hProcess);
+    instance.process = pi.hProcess;
+    instance.port = port;
     CloseHandle(pi.hThread);
+    return true;
+}
+
+bool ServerManager::Start()
+{
+    StopReadinessProbe();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_shutdown) return false;
+        if (m_current.job) return true;
 
-    LOG_INFO("ServerManager", "Node server process launched successfully.");
+        m_ready = false;
+        m_stopping = false;
+        if (m_stopEvent) ResetEvent(m_stopEvent);
+        if (!Launch(SERVER_PRIMARY_PORT, m_limits, m_current)) return false;
+        m_generation++;
+        m_policy.OnStarted(ServerSupervisorPolicy::Clock::now());
+        LOG_INFO("ServerManager", "Node server process launched successfully on port " + std::to_string(m_current.port) + ".");
+        StartReadinessProbe();
+        if (m_watcherRunning) {
+            SetEvent(m_wakeEvent);
+            return true;
+        }
+        m_watcherRunning = true;
+    }
+    if (m_watchThread.joinable()) m_watchThread.join();
+    m_watchThread = std::thread(&ServerManager::WatchThread, this);
     return true;
 }
 
 void ServerManager::Stop()
 {
-    if (m_serverJob) {
-        CloseHandle(m_serverJob);
-        m_serverJob = nullptr;
-        m_nodeProcess = nullptr; 
+    std::shared_ptr<ServerReadinessProbe> handoverProbe;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        handoverProbe = m_handoverProbe;
+    }
+    if (handoverProbe) handoverProbe->Cancel();
+    if (m_stopEvent) SetEvent(m_stopEvent);
+    if (m_wakeEvent) SetEvent(m_wakeEvent);
+    if (m_watchThread.joinable()) m_watchThread.join();
+    StopReadinessProbe();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = false;
+    m_policy.OnStopped();
+    PublishMetrics();
+    if (m_current.job) {
+        Terminate(m_current);
         LOG_INFO("ServerManager", "Node server stopped via Job Object.");
     }
-}
\ No newline at end of file
+}
+
+void ServerManager::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    Stop();
+    CompleteReadyWaiters(false);
+}
+
+// Waits on the current server process and restarts it with backoff when it
+// exits on its own. Woken through m_wakeEvent on Stop() and on hot swaps, and
+// every SERVER_METRICS_INTERVAL_MS to refresh the uptime gauge.
+void ServerManager::WatchThread()
+{
+    while (true) {
+        HANDLE process;
+        int port;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) break;
+            process = m_current.process;
+            port = m_current.port;
+            PublishMetrics();
+        }
+
+        HANDLE handles[2] = { m_wakeEvent, process };
+        DWORD waitResult = WaitForMultipleObjects(process ? 2 : 1, handles, FALSE, SERVER_METRICS_INTERVAL_MS);
+        if (waitResult != WAIT_OBJECT_0 + 1) continue;
+
+        DWORD exitCode = 0;
+        GetExitCodeProcess(process, &exitCode);
+
+        // The lines explaining a crash are usually the last ones written, so
+        // let the reader drain the pipe before taking the tail.
+        std::shared_ptr<ServerOutputCapture> output;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_current.process == process) output = m_current.output;
+        }
+        if (output && !output->WaitForEnd(SERVER_OUTPUT_DRAIN_TIMEOUT)) {
+            LOG_WARN("ServerManager", "Server output did not end after the process exited; the crash log may be missing its last lines.");
+        }
+
+        std::optional<std::chrono::milliseconds> delay;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) break;
+            if (m_current.process != process) continue;
+            delay = m_policy.OnExited(ServerSupervisorPolicy::Clock::now());
+            m_ready = false;
+            if (output) {
+                AppendToCrashLog("[SERVER]: Node server exited with code " + std::to_string(exitCode) +
+                    ". Last output:\n" + output->GetRecentOutput());
+            }
+            Terminate(m_current);
+        }
+
+        if (!RestartWithBackoff(port, delay, "exited with code " + std::to_string(exitCode))) break;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    PublishMetrics();
+    m_watcherRunning = false;
+}
+
+// Sleeps for the policy's delay and relaunches, treating a launch that fails
+// like another exit. Returns false once supervision ends: on Stop() or when
+// the policy gives up.
+bool ServerManager::RestartWithBackoff(int port, std::optional<std::chrono::milliseconds> delay, std::string reason)
+{
+    while (true) {
+        if (!delay) {
+            LOG_ERROR("ServerManager", "Node server " + reason + " too many times in a row. Giving up.");
+            return false;
+        }
+        LOG_WARN("ServerManager", "Node server " + reason + ". Restarting in " + std::to_string(delay->count()) + "ms.");
+
+        if (WaitForSingleObject(m_wakeEvent, static_cast<DWORD>(delay->count())) == WAIT_OBJECT_0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) return false;
+        }
+        if (Relaunch(port)) return true;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) return false;
+        // Someone else (Start() or a hot swap) brought a server up meanwhile.
+        if (m_current.job) return true;
+        delay = m_policy.OnLaunchFailed();
+        reason = "could not be restarted";
+        PublishMetrics();
+    }
+}
+
+bool ServerManager::Relaunch(int port)
+{
+    StopReadinessProbe();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping || m_current.job) return false;
+    if (!Launch(port, m_limits, m_current)) return false;
+    m_generation++;
+    m_policy.OnStarted(ServerSupervisorPolicy::Clock::now());
+    LOG_INFO("ServerManager", "Node server restarted on port " + std::to_string(port) + " (restart #" + std::to_string(m_policy.GetRestartCount()) + ").");
+    StartReadinessProbe();
+    return true;
+}
+
+// Called with m_mutex held, right after the current instance was spawned and
+// after any previous probe was stopped.
+void ServerManager::StartReadinessProbe()
+{
+    ServerInstance instance = m_current;
+    auto probe = std::make_shared<ServerReadinessProbe>(BaseUrlForPort(instance.port));
+    m_probe = probe;
+    m_probeThread = std::thread([this, probe, instance]() {
+        if (WaitForInstance(instance, *probe, SERVER_READY_TIMEOUT_MS)) {
+            OnServerReady(*probe);
+        } else {
+            LOG_WARN("ServerManager", "Streaming server did not become ready after " + std::to_string(probe->GetTimeline().attempts) + " probes.");
+        }
+    });
+}
+
+void ServerManager::StopReadinessProbe()
+{
+    std::shared_ptr<ServerReadinessProbe> probe;
+    std::thread probeThread;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        probe = std::move(m_probe);
+        probeThread = std::move(m_probeThread);
+    }
+    if (probe) probe->Cancel();
+    if (probeThread.joinable()) probeThread.join();
+}
+
+void ServerManager::OnServerReady(const ServerReadinessProbe& probe)
+{
+    const auto& timeline = probe.GetTimeline();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready = true;
+    }
+    m_readyCv.notify_all();
+    CompleteReadyWaiters(true);
+    LOG_INFO("ServerManager", "Streaming server ready: listening after " + std::to_string(timeline.listeningMs) +
+        "ms, first response after " + std::to_string(timeline.firstResponseMs) + "ms (" + std::to_string(timeline.attempts) + " probes).");
+    WebViewProtocol::ServerReadyEventPayload payload = { probe.GetUrl(), timeline.listeningMs, timeline.firstResponseMs, timeline.attempts };
+    WebViewProtocol::EventEmitter::emitServerReady(payload);
+}
+
+bool ServerManager::HotSwap()
+{
+    StopReadinessProbe();
+
+    int oldPort;
+    uint64_t generation;
+    ResourceLimits limits;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || !m_current.job) return false;
+        oldPort = m_current.port;
+        generation = m_generation;
+        limits = m_limits;
+    }
+    int newPort = (oldPort == SERVER_PRIMARY_PORT) ? SERVER_HANDOVER_PORT : SERVER_PRIMARY_PORT;
+
+    ServerInstance next;
+    if (!Launch(newPort, limits, next)) return false;
+    LOG_INFO("ServerManager", "Handover instance launched on port " + std::to_string(newPort) + ", waiting for it to answer.");
+
+    // Registered so Stop() can cancel the wait instead of leaving the caller
+    // (the updater thread, joined on exit) blocked for the full timeout.
+    auto probe = std::make_shared<ServerReadinessProbe>(BaseUrlForPort(newPort));
+    bool registered = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_stopping) {
+            m_handoverProbe = probe;
+            registered = true;
+        }
+    }
+    if (!registered || !WaitForInstance(next, *probe, SERVER_READY_TIMEOUT_MS)) {
+        LOG_WARN("ServerManager", "Handover instance never became ready or the server is stopping. Keeping the current server.");
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_handoverProbe.reset();
+        }
+        Terminate(next);
+        return false;
+    }
+
+    ServerInstance old;
+    bool superseded = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_handoverProbe.reset();
+        // The current server crashed, was relaunched or stopped while the
+        // handover instance warmed up; whatever runs now is not ours to replace.
+        superseded = m_stopping || !m_current.job || m_generation != generation;
+        if (!superseded) {
+            old = m_current;
+            m_current = next;
+            m_generation++;
+            m_ready = true;
+            m_policy.OnStarted(ServerSupervisorPolicy::Clock::now());
+        }
+    }
+    if (superseded) {
+        LOG_WARN("ServerManager", "Current server changed during the handover. Keeping it.");
+        Terminate(next);
+        return false;
+    }
+    m_readyCv.notify_all();
+    CompleteReadyWaiters(true);
+    // Let the watcher pick up the new process before the old one goes away.
+    SetEvent(m_wakeEvent);
+    WebViewProtocol::EventEmitter::emitServerUrlChanged(BaseUrlForPort(newPort));
+    LOG_INFO("ServerManager", "Switched streaming server to port " + std::to_string(newPort) + ". Draining old instance.");
+
+    // Give in-flight streams on the old instance time to finish before killing
+    // it, unless Stop() wants everything gone now.
+    HANDLE drainHandles[2] = { old.process, m_stopEvent };
+    WaitForMultipleObjects(m_stopEvent ? 2 : 1, drainHandles, FALSE, SERVER_DRAIN_MS);
+    Terminate(old);
+    LOG_INFO("ServerManager", "Old server instance on port " + std::to_string(oldPort) + " stopped.");
+    return true;
+}
+
+bool ServerManager::IsReady() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ready;
+}
+
+bool ServerManager::WaitUntilReady(DWORD timeoutMs) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_readyCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_ready; });
+}
+
+void ServerManager::NotifyWhenReady(std::chrono::milliseconds timeout, ReadyCallback callback)
+{
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ready = m_ready;
+        if (!ready && !m_shutdown && m_readyTimer) {
+            m_readyWaiters.push_back({ std::chrono::steady_clock::now() + timeout, std::move(callback) });
+            ArmReadyTimer();
+            return;
+        }
+    }
+    callback(ready);
+}
+
+void ServerManager::CompleteReadyWaiters(bool ready)
+{
+    std::vector<ReadyWaiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        waiters.swap(m_readyWaiters);
+        ArmReadyTimer();
+    }
+    for (auto& waiter : waiters) waiter.callback(ready);
+}
+
+void ServerManager::ExpireReadyWaiters()
+{
+    std::vector<ReadyCallback> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = m_readyWaiters.begin(); it != m_readyWaiters.end();) {
+            if (it->deadline <= now) {
+                expired.push_back(std::move(it->callback));
+                it = m_readyWaiters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        ArmReadyTimer();
+    }
+    for (auto& callback : expired) callback(false);
+}
+
+// Called with m_mutex held. Points the timer at the earliest deadline, or
+// cancels it when nobody is waiting.
+void ServerManager::ArmReadyTimer()
+{
+    if (!m_readyTimer) return;
+    if (m_readyWaiters.empty()) {
+        SetThreadpoolTimer(m_readyTimer, nullptr, 0, 0);
+        return;
+    }
+    auto next = m_readyWaiters.front().deadline;
+    for (const auto& waiter : m_readyWaiters) next = (std::min)(next, waiter.deadline);
+    long long delayMs = std::chrono::duration_cast<std::chrono::milliseconds>(next - std::chrono::steady_clock::now()).count();
+    // Negative due times are relative, in 100ns units.
+    ULARGE_INTEGER due;
+    due.QuadPart = static_cast<ULONGLONG>(-((std::max)(delayMs, 1LL) * 10000LL));
+    FILETIME dueTime = { due.LowPart, due.HighPart };
+    SetThreadpoolTimer(m_readyTimer, &dueTime, 0, 0);
+}
+
+void CALLBACK ServerManager::OnReadyTimer(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_TIMER /*timer*/)
+{
+    static_cast<ServerManager*>(context)->ExpireReadyWaiters();
+}
+
+std::string ServerManager::GetBaseUrl() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current.job ? BaseUrlForPort(m_current.port) : "";
+}
+
+// Called with m_mutex held.
+void ServerManager::PublishMetrics() const
+{
+    static Metrics::Gauge& s_restarts = Metrics::GetGauge("server.restarts");
+    static Metrics::Gauge& s_uptimeSec = Metrics::GetGauge("server.uptime_s");
+    s_restarts.Set(m_policy.GetRestartCount());
+    s_uptimeSec.Set(std::chrono::duration_cast<std::chrono::seconds>(m_policy.GetUptime(ServerSupervisorPolicy::Clock::now())).count());
+}
+
+ServerStats ServerManager::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ServerStats stats;
+    stats.restartCount = m_policy.GetRestartCount();
+    stats.crashCount = m_policy.GetCrashCount();
+    stats.uptimeMs = m_policy.GetUptime(ServerSupervisorPolicy::Clock::now()).count();
+    stats.running = m_current.job != nullptr;
+    stats.gaveUp = m_policy.GetState() == ServerSupervisorPolicy::State::GaveUp;
+    return stats;
+}
+
+bool ServerManager::WaitForInstance(const ServerInstance& instance, ServerReadinessProbe& probe, DWORD timeoutMs)
+{
+    HANDLE process = instance.process;
+    return probe.Run(std::chrono::milliseconds(timeoutMs), [process]() {
+        return WaitForSingleObject(process, 0) != WAIT_OBJECT_0;
+    });
+}
+
+void ServerManager::Terminate(ServerInstance& instance)
+{
+    if (instance.job) CloseHandle(instance.job);
+    if (instance.process) CloseHandle(instance.process);
+    instance = ServerInstance();
+}
+
+std::string ServerManager::BaseUrlForPort(int port)
+{
+    return "http://127.0.0.1:" + std::to_string(port) + "/";
+}
@@ -3,6 +3,26 @@
 
 #include <windows.h>
 #include <string>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "server_readiness.h"
+#include "server_supervisor.h"
+#include "server_output.h"
+
+struct ServerStats {
+    int restartCount = 0;
+    int crashCount = 0;
+    long long uptimeMs = 0;
+    bool running = false;
+    bool gaveUp = false;
+};
 
 class ServerManager
 {
@@ -11,11 +31,86 @@ public:
     ~ServerManager();
 
     bool Start();
+    // Also interrupts a HotSwap() in progress, which then gives up (while
+    // warming up) or kills the old instance without waiting for its drain.
     void Stop();
+    // Stop() for good: Start() refuses afterwards. Called before the app
+    // joins the updater thread, so a handover cannot hold up exit.
+    void Shutdown();
+
+    // Starts a second instance on the spare port, waits for it to answer,
+    // switches the advertised URL over and drains the old instance.
+    bool HotSwap();
+
+    // Applied through the job object on the next launch. 0 means unlimited.
+    void SetResourceLimits(int memoryLimitMB, int cpuRatePercent);
+
+    bool IsReady() const;
+    bool WaitUntilReady(DWORD timeoutMs) const;
+    // Calls back once: with true when the server is (or becomes) ready, with
+    // false after timeout or on Shutdown(). Nothing blocks in the meantime; the
+    // callback runs on the readiness probe thread, a thread-pool timer or the
+    // caller's thread, without m_mutex held.
+    using ReadyCallback = std::function<void(bool ready)>;
+    void NotifyWhenReady(std::chrono::milliseconds timeout, ReadyCallback callback);
+    std::string GetBaseUrl() const;
+    ServerStats GetStats() const;
 
 private:
-    HANDLE m_serverJob;
-    HANDLE m_nodeProcess;
+    struct ResourceLimits {
+        int memoryLimitMB = 0;
+        int cpuRatePercent = 0;
+    };
+
+    struct ReadyWaiter {
+        std::chrono::steady_clock::time_point deadline;
+        ReadyCallback callback;
+    };
+
+    struct ServerInstance {
+        HANDLE job = nullptr;
+        HANDLE process = nullptr;
+        int port = 0;
+        std::shared_ptr<ServerOutputCapture> output;
+    };
+
+    void WatchThread();
+    bool RestartWithBackoff(int port, std::optional<std::chrono::milliseconds> delay, std::string reason);
+    bool Relaunch(int port);
+    void PublishMetrics() const;
+    void StartReadinessProbe();
+    void StopReadinessProbe();
+    void OnServerReady(const ServerReadinessProbe& probe);
+    void CompleteReadyWaiters(bool ready);
+    void ExpireReadyWaiters();
+    void ArmReadyTimer();
+    static void CALLBACK OnReadyTimer(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
+    bool ResolvePaths(std::wstring& exeDir, std::wstring& exePath, std::wstring& scriptPath) const;
+    // Safe to call without m_mutex: everything it needs is passed in.
+    bool Launch(int port, const ResourceLimits& limits, ServerInstance& instance) const;
+    static bool WaitForInstance(const ServerInstance& instance, ServerReadinessProbe& probe, DWORD timeoutMs);
+    static void Terminate(ServerInstance& instance);
+    static std::string BaseUrlForPort(int port);
+
+    mutable std::mutex m_mutex;
+    ServerInstance m_current;
+    uint64_t m_generation;      // bumped whenever m_current is launched or replaced
+    bool m_ready;
+    mutable std::condition_variable m_readyCv;
+    std::shared_ptr<ServerReadinessProbe> m_probe;
+    std::thread m_probeThread;
+
+    ServerSupervisorPolicy m_policy;
+    HANDLE m_wakeEvent;
+    std::thread m_watchThread;
+    bool m_watcherRunning;
+    bool m_stopping;
+    ResourceLimits m_limits;
+    HANDLE m_stopEvent;         // manual reset; set by Stop(), cleared by Start()
+    std::shared_ptr<ServerReadinessProbe> m_handoverProbe;
+    bool m_shutdown;
+    std::vector<ReadyWaiter> m_readyWaiters;
+    PTP_TIMER m_readyTimer;     // fires at the earliest waiter deadline
 };
 
-#endif // SERVER_MANAGER_H
\ No newline at end of file
+#endif // SERVER_MANAGER_H
@@ -0,0 +1,133 @@
+#include "server_output.h"
+#include "../logger/logger.h"
+#include <algorithm>
+
+static const DWORD SERVER_PIPE_BUFFER_SIZE = 1024 * 1024;
+static const size_t SERVER_READ_CHUNK_SIZE = 64 * 1024;
+static const size_t SERVER_RECENT_LINES = 200;
+static const size_t SERVER_MAX_LINE_LENGTH = 4096;
+static const double SERVER_LOG_LINES_PER_SEC = 100.0;
+static const double SERVER_LOG_BURST = 200.0;
+
+ServerOutputCapture::ServerOutputCapture()
+    : m_readPipe(nullptr), m_writePipe(nullptr), m_ended(false), m_tokens(SERVER_LOG_BURST),
+      m_lastRefill(std::chrono::steady_clock::now()), m_droppedLines(0) {}
+
+ServerOutputCapture::~ServerOutputCapture()
+{
+    CloseChildHandle();
+    if (m_thread.joinable()) {
+        // The read normally ends with ERROR_BROKEN_PIPE once the job is closed;
+        // cancel it in case something else still holds the write end.
+        CancelSynchronousIo(m_thread.native_handle());
+        m_thread.join();
+    }
+    if (m_readPipe) CloseHandle(m_readPipe);
+}
+
+HANDLE ServerOutputCapture::CreateChildHandle()
+{
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), nullptr, TRUE };
+    if (!CreatePipe(&m_readPipe, &m_writePipe, &sa, SERVER_PIPE_BUFFER_SIZE)) {
+        LOG_WARN("ServerManager", "Failed to create server output pipe. Error: " + std::to_string(GetLastError()));
+        m_readPipe = m_writePipe = nullptr;
+        return nullptr;
+    }
+    SetHandleInformation(m_readPipe, HANDLE_FLAG_INHERIT, 0);
+    return m_writePipe;
+}
+
+void ServerOutputCapture::CloseChildHandle()
+{
+    if (m_writePipe) {
+        CloseHandle(m_writePipe);
+        m_writePipe = nullptr;
+    }
+}
+
+void ServerOutputCapture::StartReading()
+{
+    if (!m_readPipe || m_thread.joinable()) return;
+    m_thread = std::thread(&ServerOutputCapture::ReaderThread, this);
+}
+
+bool ServerOutputCapture::WaitForEnd(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_thread.joinable()) return true;
+    return m_endCv.wait_for(lock, timeout, [this] { return m_ended; });
+}
+
+std::string ServerOutputCapture::GetRecentOutput() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string out;
+    for (const auto& line : m_recentLines) {
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+void ServerOutputCapture::ReaderThread()
+{
+    std::string buffer(SERVER_READ_CHUNK_SIZE, '\0');
+    std::string pending;
+    DWORD bytesRead = 0;
+
+    while (ReadFile(m_readPipe, &buffer[0], (DWORD)buffer.size(), &bytesRead, nullptr) && bytesRead > 0) {
+        size_t start = 0;
+        for (size_t i = 0; i < bytesRead; i++) {
+            if (buffer[i] != '\n') continue;
+            pending.append(buffer, start, i - start);
+            HandleLine(std::move(pending));
+            pending.clear();
+            start = i + 1;
+        }
+        pending.append(buffer, start, bytesRead - start);
+        if (pending.size() > SERVER_MAX_LINE_LENGTH) {
+            HandleLine(std::move(pending));
+            pending.clear();
+        }
+    }
+    if (!pending.empty()) HandleLine(std::move(pending));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ended = true;
+    }
+    m_endCv.notify_all();
+}
+
+void ServerOutputCapture::HandleLine(std::string line)
+{
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_recentLines.push_back(line);
+        if (m_recentLines.size() > SERVER_RECENT_LINES) m_recentLines.pop_front();
+    }
+
+    if (!TakeRateToken()) {
+        m_droppedLines++;
+        return;
+    }
+    if (m_droppedLines > 0) {
+        Logger::Log(LogLevel::WARN, "server", "output", "server", std::to_string(m_droppedLines) + " lines dropped by rate limit.");
+        m_droppedLines = 0;
+    }
+    Logger::Log(LogLevel::INFO, "server", "output", "server", line);
+}
+
+bool ServerOutputCapture::TakeRateToken()
+{
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+    m_lastRefill = now;
+    m_tokens = (std::min)(SERVER_LOG_BURST, m_tokens + elapsed * SERVER_LOG_LINES_PER_SEC);
+    if (m_tokens < 1.0) return false;
+    m_tokens -= 1.0;
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef SERVER_OUTPUT_H
+#define SERVER_OUTPUT_H
+
+#include <windows.h>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+// Drains the streaming server's stdout/stderr pipe on a background thread and
+// forwards complete lines to the logger. Lines beyond the rate limit are not
+// logged but still land in the tail buffer used for crash reports, so the
+// child never blocks on a full pipe.
+class ServerOutputCapture
+{
+public:
+    ServerOutputCapture();
+    ~ServerOutputCapture();
+
+    ServerOutputCapture(const ServerOutputCapture&) = delete;
+    ServerOutputCapture& operator=(const ServerOutputCapture&) = delete;
+
+    // Creates the pipe. The returned handle is inheritable and must be passed
+    // as the child's stdout/stderr, then released with CloseChildHandle().
+    HANDLE CreateChildHandle();
+    void CloseChildHandle();
+    void StartReading();
+
+    // Waits for the reader to reach the end of the pipe, which happens once
+    // the child and anything it spawned have exited. False on timeout.
+    bool WaitForEnd(std::chrono::milliseconds timeout);
+    std::string GetRecentOutput() const;
+
+private:
+    void ReaderThread();
+    void HandleLine(std::string line);
+    bool TakeRateToken();
+
+    HANDLE m_readPipe;
+    HANDLE m_writePipe;
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;
+    std::deque<std::string> m_recentLines;
+    std::condition_variable m_endCv;
+    bool m_ended;
+
+    double m_tokens;
+    std::chrono::steady_clock::time_point m_lastRefill;
+    size_t m_droppedLines;
+};
+
+#endif // SERVER_OUTPUT_H
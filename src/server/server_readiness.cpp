@@ -0,0 +1,78 @@
+#include "server_readiness.h"
+#include "../metrics/metrics.h"
+#include <curl/curl.h>
+#include <algorithm>
+
+static const std::chrono::milliseconds PROBE_INITIAL_DELAY(50);
+static const std::chrono::milliseconds PROBE_MAX_DELAY(1000);
+static const long PROBE_REQUEST_TIMEOUT_MS = 1000;
+
+static size_t DiscardCallback(void*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+ServerReadinessProbe::ServerReadinessProbe(std::string url)
+    : m_url(std::move(url)), m_cancelled(false)
+{
+    m_timeline.spawnTime = std::chrono::steady_clock::now();
+}
+
+ServerReadinessProbe::ProbeResult ServerReadinessProbe::Probe() const
+{
+    CURL* curl = curl_easy_init();
+    if (!curl) return ProbeResult::Refused;
+
+    curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, DiscardCallback);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, PROBE_REQUEST_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, PROBE_REQUEST_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOPROXY, "*");
+
+    auto start = std::chrono::steady_clock::now();
+    CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("server_probe", start, res == CURLE_OK);
+    curl_easy_cleanup(curl);
+
+    if (res == CURLE_OK) return ProbeResult::Responded;
+    if (res == CURLE_COULDNT_CONNECT || res == CURLE_COULDNT_RESOLVE_HOST) return ProbeResult::Refused;
+    // Connected but no (complete) response yet: the socket is bound, server.js is still booting.
+    return ProbeResult::Listening;
+}
+
+bool ServerReadinessProbe::Run(std::chrono::milliseconds timeout, const std::function<bool()>& isAlive)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto delay = PROBE_INITIAL_DELAY;
+
+    while (true) {
+        if (isAlive && !isAlive()) return false;
+
+        ProbeResult result = Probe();
+        m_timeline.attempts++;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_timeline.spawnTime).count();
+        if (result != ProbeResult::Refused && m_timeline.listeningMs < 0) {
+            m_timeline.listeningMs = elapsed;
+        }
+        if (result == ProbeResult::Responded) {
+            m_timeline.firstResponseMs = elapsed;
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+        auto wait = std::min<std::chrono::steady_clock::duration>(delay, deadline - now);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_cv.wait_for(lock, wait, [this] { return m_cancelled; })) return false;
+        delay = std::min(delay * 2, PROBE_MAX_DELAY);
+    }
+}
+
+void ServerReadinessProbe::Cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+    }
+    m_cv.notify_all();
+}
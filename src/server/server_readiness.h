@@ -0,0 +1,45 @@
+#ifndef SERVER_READINESS_H
+#define SERVER_READINESS_H
+
+#include <string>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+struct ServerStartupTimeline {
+    std::chrono::steady_clock::time_point spawnTime;
+    long long listeningMs = -1;      // first attempt that got past TCP connect
+    long long firstResponseMs = -1;  // first attempt that got an HTTP response
+    int attempts = 0;
+};
+
+// Polls the local streaming server with exponential backoff until it answers
+// an HTTP request. Only depends on libcurl so it can be driven against any
+// local endpoint.
+class ServerReadinessProbe
+{
+public:
+    explicit ServerReadinessProbe(std::string url);
+
+    // Blocks until the endpoint responds, the timeout expires, Cancel() is
+    // called or isAlive() reports that the server process is gone.
+    bool Run(std::chrono::milliseconds timeout, const std::function<bool()>& isAlive);
+    void Cancel();
+
+    void MarkSpawned() { m_timeline.spawnTime = std::chrono::steady_clock::now(); }
+    const ServerStartupTimeline& GetTimeline() const { return m_timeline; }
+    const std::string& GetUrl() const { return m_url; }
+
+private:
+    enum class ProbeResult { Refused, Listening, Responded };
+    ProbeResult Probe() const;
+
+    std::string m_url;
+    ServerStartupTimeline m_timeline;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_cancelled;
+};
+
+#endif // SERVER_READINESS_H
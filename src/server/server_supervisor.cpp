@@ -0,0 +1,59 @@
+#include "server_supervisor.h"
+#include <algorithm>
+
+ServerSupervisorPolicy::ServerSupervisorPolicy() : ServerSupervisorPolicy(Config()) {}
+
+ServerSupervisorPolicy::ServerSupervisorPolicy(const Config& config)
+    : m_config(config), m_state(State::Stopped), m_hasStarted(false),
+      m_restartCount(0), m_crashCount(0), m_consecutiveFailures(0)
+{}
+
+void ServerSupervisorPolicy::OnStarted(Clock::time_point now)
+{
+    if (m_hasStarted && m_state == State::BackingOff) m_restartCount++;
+    m_hasStarted = true;
+    m_startedAt = now;
+    m_state = State::Running;
+}
+
+std::optional<std::chrono::milliseconds> ServerSupervisorPolicy::OnExited(Clock::time_point now)
+{
+    if (m_state != State::Running) return std::nullopt;
+    m_crashCount++;
+
+    if (now - m_startedAt >= m_config.stableUptime) m_consecutiveFailures = 0;
+    return NextBackoff();
+}
+
+std::optional<std::chrono::milliseconds> ServerSupervisorPolicy::OnLaunchFailed()
+{
+    if (m_state != State::BackingOff) return std::nullopt;
+    return NextBackoff();
+}
+
+std::optional<std::chrono::milliseconds> ServerSupervisorPolicy::NextBackoff()
+{
+    m_consecutiveFailures++;
+
+    if (m_consecutiveFailures > m_config.maxConsecutiveFailures) {
+        m_state = State::GaveUp;
+        return std::nullopt;
+    }
+
+    auto delay = m_config.initialBackoff;
+    for (int i = 1; i < m_consecutiveFailures && delay < m_config.maxBackoff; i++) delay *= 2;
+    m_state = State::BackingOff;
+    return std::min(delay, m_config.maxBackoff);
+}
+
+void ServerSupervisorPolicy::OnStopped()
+{
+    m_state = State::Stopped;
+    m_consecutiveFailures = 0;
+}
+
+std::chrono::milliseconds ServerSupervisorPolicy::GetUptime(Clock::time_point now) const
+{
+    if (m_state != State::Running) return std::chrono::milliseconds(0);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - m_startedAt);
+}
@@ -0,0 +1,53 @@
+#ifndef SERVER_SUPERVISOR_H
+#define SERVER_SUPERVISOR_H
+
+#include <chrono>
+#include <optional>
+
+// Restart bookkeeping for the streaming server process. Holds no OS handles:
+// ServerManager reports starts and exits and asks how long to back off.
+class ServerSupervisorPolicy
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        int maxConsecutiveFailures = 5;
+        std::chrono::milliseconds initialBackoff{1000};
+        std::chrono::milliseconds maxBackoff{60000};
+        // A run at least this long resets the consecutive failure count.
+        std::chrono::milliseconds stableUptime{60000};
+    };
+
+    enum class State { Stopped, Running, BackingOff, GaveUp };
+
+    ServerSupervisorPolicy();
+    explicit ServerSupervisorPolicy(const Config& config);
+
+    void OnStarted(Clock::time_point now);
+    // Returns the delay before the next restart, or nullopt once we give up.
+    std::optional<std::chrono::milliseconds> OnExited(Clock::time_point now);
+    // A restart after OnExited() could not be launched. Counts as another
+    // failure: returns the next delay, or nullopt once we give up.
+    std::optional<std::chrono::milliseconds> OnLaunchFailed();
+    void OnStopped();
+
+    State GetState() const { return m_state; }
+    int GetRestartCount() const { return m_restartCount; }
+    int GetCrashCount() const { return m_crashCount; }
+    int GetConsecutiveFailures() const { return m_consecutiveFailures; }
+    std::chrono::milliseconds GetUptime(Clock::time_point now) const;
+
+private:
+    std::optional<std::chrono::milliseconds> NextBackoff();
+
+    Config m_config;
+    State m_state;
+    Clock::time_point m_startedAt;
+    bool m_hasStarted;
+    int m_restartCount;
+    int m_crashCount;
+    int m_consecutiveFailures;
+};
+
+#endif // SERVER_SUPERVISOR_H
@@ -1,67 +1,87 @@
 #include "settings_manager.h"
 #include "../helpers/helpers.h"
+#include "../platform/platform.h"
 #include <sstream>
 
-SettingsManager::SettingsManager()
+std::filesystem::path SettingsManager::GetIniPath() const
 {
-    m_settings.windowPlacement.length = sizeof(WINDOWPLACEMENT);
-}
-
-std::wstring SettingsManager::GetIniPath() const
-{
-    std::wstring exeDir = GetExeDirectory();
-    std::wstring pcDir = exeDir + L"\\portable_config";
-    CreateDirectoryW(pcDir.c_str(), nullptr);
-    return pcDir + L"\\Stremato-settings.ini";
+    std::filesystem::path pcDir = Platform::GetExecutableDirectory() / "portable_config";
+    std::error_code ec;
+    std::filesystem::create_directories(pcDir, ec);
+    return pcDir / "Stremato-settings.ini";
 }
 
 void SettingsManager::Load()
 {
-    std::wstring iniPath = GetIniPath();
-    wchar_t buffer[32];
+    std::filesystem::path iniPath = GetIniPath();
 
-    m_settings.closeOnExit = (GetPrivateProfileIntW(L"General", L"CloseOnExit", 0, iniPath.c_str()) == 1);
-    m_settings.useDarkTheme = (GetPrivateProfileIntW(L"General", L"UseDarkTheme", 1, iniPath.c_str()) == 1);
-    m_settings.pauseOnMinimize = (GetPrivateProfileIntW(L"General", L"PauseOnMinimize", 1, iniPath.c_str()) == 1);
-    m_settings.pauseOnLostFocus = (GetPrivateProfileIntW(L"General", L"PauseOnLostFocus", 0, iniPath.c_str()) == 1);
-    m_settings.allowZoom = (GetPrivateProfileIntW(L"General", L"AllowZoom", 0, iniPath.c_str()) == 1);
-    m_settings.isRpcOn = (GetPrivateProfileIntW(L"General", L"DiscordRPC", 1, iniPath.c_str()) == 1);
-    m_settings.alwaysOnTop = (GetPrivateProfileIntW(L"General", L"AlwaysOnTop", 0, iniPath.c_str()) == 1);
+    m_settings.closeOnExit = (Platform::ReadIniInt(iniPath, L"General", L"CloseOnExit", 0) == 1);
+    m_settings.useDarkTheme = (Platform::ReadIniInt(iniPath, L"General", L"UseDarkTheme", 1) == 1);
+    m_settings.pauseOnMinimize = (Platform::ReadIniInt(iniPath, L"General", L"PauseOnMinimize", 1) == 1);
+    m_settings.pauseOnLostFocus = (Platform::ReadIniInt(iniPath, L"General", L"PauseOnLostFocus", 0) == 1);
+    m_settings.allowZoom = (Platform::ReadIniInt(iniPath, L"General", L"AllowZoom", 0) == 1);
+    m_settings.isRpcOn = (Platform::ReadIniInt(iniPath, L"General", L"DiscordRPC", 1) == 1);
+    m_settings.alwaysOnTop = (Platform::ReadIniInt(iniPath, L"General", L"AlwaysOnTop", 0) == 1);
     
-    m_settings.initialVolume = GetPrivateProfileIntW(L"MPV", L"InitialVolume", 50, iniPath.c_str());
-    GetPrivateProfileStringW(L"MPV", L"VideoOutput", L"gpu-next", buffer, _countof(buffer), iniPath.c_str());
-    m_settings.initialVO = WStringToUtf8(buffer);
+    m_settings.initialVolume = Platform::ReadIniInt(iniPath, L"MPV", L"InitialVolume", 50);
+    m_settings.initialVO = WStringToUtf8(Platform::ReadIniString(iniPath, L"MPV", L"VideoOutput", L"gpu-next"));
+    m_settings.qosLiveEvents = (Platform::ReadIniInt(iniPath, L"MPV", L"QosLiveEvents", 0) == 1);
+    m_settings.adaptiveCache = (Platform::ReadIniInt(iniPath, L"MPV", L"AdaptiveCache", 1) == 1);
+    m_settings.hwdecProbe = (Platform::ReadIniInt(iniPath, L"MPV", L"HwdecProbe", 1) == 1);
+    m_settings.hwdecCandidates = WStringToUtf8(Platform::ReadIniString(iniPath, L"MPV", L"HwdecCandidates", L""));
+    m_settings.thumbnails = (Platform::ReadIniInt(iniPath, L"MPV", L"Thumbnails", 1) == 1);
+    m_settings.spriteSheets = (Platform::ReadIniInt(iniPath, L"MPV", L"SpriteSheets", 0) == 1);
+    m_settings.introDetection = (Platform::ReadIniInt(iniPath, L"MPV", L"IntroDetection", 0) == 1);
+
+    m_settings.serverMemoryLimitMB = Platform::ReadIniInt(iniPath, L"Server", L"MemoryLimitMB", 0);
+    m_settings.serverCpuRatePercent = Platform::ReadIniInt(iniPath, L"Server", L"CpuRatePercent", 0);
+
+    m_settings.recordBridgeTrace = (Platform::ReadIniInt(iniPath, L"Debug", L"RecordBridgeTrace", 0) == 1);
+    m_settings.metricsDumpIntervalSec = Platform::ReadIniInt(iniPath, L"Debug", L"MetricsDumpIntervalSec", 0);
 
     LoadWindowPlacement();
 }
 
 void SettingsManager::Save()
 {
-    std::wstring iniPath = GetIniPath();
+    std::filesystem::path iniPath = GetIniPath();
+
+    Platform::WriteIniString(iniPath, L"General", L"CloseOnExit", m_settings.closeOnExit ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"UseDarkTheme", m_settings.useDarkTheme ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"PauseOnMinimize", m_settings.pauseOnMinimize ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"PauseOnLostFocus", m_settings.pauseOnLostFocus ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"AllowZoom", m_settings.allowZoom ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"DiscordRPC", m_settings.isRpcOn ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"General", L"AlwaysOnTop", m_settings.alwaysOnTop ? L"1" : L"0");
 
-    WritePrivateProfileStringW(L"General", L"CloseOnExit", m_settings.closeOnExit ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"UseDarkTheme", m_settings.useDarkTheme ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"PauseOnMinimize", m_settings.pauseOnMinimize ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"PauseOnLostFocus", m_settings.pauseOnLostFocus ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"AllowZoom", m_settings.allowZoom ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"DiscordRPC", m_settings.isRpcOn ? L"1" : L"0", iniPath.c_str());
-    WritePrivateProfileStringW(L"General", L"AlwaysOnTop", m_settings.alwaysOnTop ? L"1" : L"0", iniPath.c_str());
+    Platform::WriteIniString(iniPath, L"MPV", L"InitialVolume", std::to_wstring(m_settings.initialVolume));
+    Platform::WriteIniString(iniPath, L"MPV", L"QosLiveEvents", m_settings.qosLiveEvents ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"MPV", L"AdaptiveCache", m_settings.adaptiveCache ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"MPV", L"HwdecProbe", m_settings.hwdecProbe ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"MPV", L"Thumbnails", m_settings.thumbnails ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"MPV", L"SpriteSheets", m_settings.spriteSheets ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"MPV", L"IntroDetection", m_settings.introDetection ? L"1" : L"0");
 
-    WritePrivateProfileStringW(L"MPV", L"InitialVolume", std::to_wstring(m_settings.initialVolume).c_str(), iniPath.c_str());
+    Platform::WriteIniString(iniPath, L"Server", L"MemoryLimitMB", std::to_wstring(m_settings.serverMemoryLimitMB));
+    Platform::WriteIniString(iniPath, L"Server", L"CpuRatePercent", std::to_wstring(m_settings.serverCpuRatePercent));
+
+    Platform::WriteIniString(iniPath, L"Debug", L"RecordBridgeTrace", m_settings.recordBridgeTrace ? L"1" : L"0");
+    Platform::WriteIniString(iniPath, L"Debug", L"MetricsDumpIntervalSec", std::to_wstring(m_settings.metricsDumpIntervalSec));
 
     SaveWindowPlacement();
 }
 
 void SettingsManager::LoadWindowPlacement()
 {
-    std::wstring iniPath = GetIniPath();
-    m_settings.windowPlacement.showCmd = GetPrivateProfileIntW(L"Window", L"ShowCmd", SW_SHOWNORMAL, iniPath.c_str());
-    m_settings.windowPlacement.rcNormalPosition.left = GetPrivateProfileIntW(L"Window", L"Left", 0, iniPath.c_str());
-    m_settings.windowPlacement.rcNormalPosition.top = GetPrivateProfileIntW(L"Window", L"Top", 0, iniPath.c_str());
-    m_settings.windowPlacement.rcNormalPosition.right = GetPrivateProfileIntW(L"Window", L"Right", 0, iniPath.c_str());
-    m_settings.windowPlacement.rcNormalPosition.bottom = GetPrivateProfileIntW(L"Window", L"Bottom", 0, iniPath.c_str());
+    std::filesystem::path iniPath = GetIniPath();
+    auto& wp = m_settings.windowPlacement;
+    wp.showCmd = Platform::ReadIniInt(iniPath, L"Window", L"ShowCmd", 1);
+    wp.left = Platform::ReadIniInt(iniPath, L"Window", L"Left", 0);
+    wp.top = Platform::ReadIniInt(iniPath, L"Window", L"Top", 0);
+    wp.right = Platform::ReadIniInt(iniPath, L"Window", L"Right", 0);
+    wp.bottom = Platform::ReadIniInt(iniPath, L"Window", L"Bottom", 0);
 
-    if (m_settings.windowPlacement.rcNormalPosition.right > 0 && m_settings.windowPlacement.rcNormalPosition.bottom > 0) {
+    if (wp.right > 0 && wp.bottom > 0) {
         m_settings.hasSavedWindowPlacement = true;
     }
 }
@@ -69,11 +89,11 @@ void SettingsManager::LoadWindowPlacement()
 void SettingsManager::SaveWindowPlacement() const
 {
     if (!m_settings.hasSavedWindowPlacement) return;
-    std::wstring iniPath = GetIniPath();
+    std::filesystem::path iniPath = GetIniPath();
     const auto& wp = m_settings.windowPlacement;
-    WritePrivateProfileStringW(L"Window", L"ShowCmd", std::to_wstring(wp.showCmd).c_str(), iniPath.c_str());
-    WritePrivateProfileStringW(L"Window", L"Left", std::to_wstring(wp.rcNormalPosition.left).c_str(), iniPath.c_str());
-    WritePrivateProfileStringW(L"Window", L"Top", std::to_wstring(wp.rcNormalPosition.top).c_str(), iniPath.c_str());
-    WritePrivateProfileStringW(L"Window", L"Right", std::to_wstring(wp.rcNormalPosition.right).c_str(), iniPath.c_str());
-    WritePrivateProfileStringW(L"Window", L"Bottom", std::to_wstring(wp.rcNormalPosition.bottom).c_str(), iniPath.c_str());
-}
\ No newline at end of file
+    Platform::WriteIniString(iniPath, L"Window", L"ShowCmd", std::to_wstring(wp.showCmd));
+    Platform::WriteIniString(iniPath, L"Window", L"Left", std::to_wstring(wp.left));
+    Platform::WriteIniString(iniPath, L"Window", L"Top", std::to_wstring(wp.top));
+    Platform::WriteIniString(iniPath, L"Window", L"Right", std::to_wstring(wp.right));
+    Platform::WriteIniString(iniPath, L"Window", L"Bottom", std::to_wstring(wp.bottom));
+}
@@ -1,9 +1,19 @@
 #ifndef SETTINGS_MANAGER_H
 #define SETTINGS_MANAGER_H
 
-#include <windows.h>
 #include <string>
 #include <vector>
+#include <filesystem>
+
+// Mirrors the parts of WINDOWPLACEMENT that are persisted, so settings stay
+// independent of Win32 types.
+struct WindowPlacement {
+    int showCmd = 1; // SW_SHOWNORMAL
+    int left = 0;
+    int top = 0;
+    int right = 0;
+    int bottom = 0;
+};
 
 struct AppSettings {
     // General
@@ -18,16 +28,31 @@ struct AppSettings {
     // MPV
     std::string initialVO = "gpu-next";
     int initialVolume = 50;
+    bool qosLiveEvents = false;  // periodic playback-qos events to the frontend
+    bool adaptiveCache = true;   // size the demuxer cache per file instead of using mpv.conf
+    bool hwdecProbe = true;      // probe hardware decoders per codec and pick one per file
+    std::string hwdecCandidates; // comma-separated backends to probe; empty = platform default
+    bool thumbnails = true;      // native seekbar thumbnails from a second mpv instance
+    bool spriteSheets = false;   // background sprite sheets of the whole file, cached on disk
+    bool introDetection = false; // intro/credits ranges from audio shared between episodes
+
+    // Streaming server (0 = unlimited)
+    int serverMemoryLimitMB = 0;
+    int serverCpuRatePercent = 0;
     
+    // Debug
+    bool recordBridgeTrace = false;
+    int metricsDumpIntervalSec = 0; // 0 = off
+
     // Window
-    WINDOWPLACEMENT windowPlacement;
+    WindowPlacement windowPlacement;
     bool hasSavedWindowPlacement = false;
 };
 
 class SettingsManager
 {
 public:
-    SettingsManager();
+    SettingsManager() = default;
     ~SettingsManager() = default;
 
     void Load();
@@ -37,7 +62,7 @@ public:
     AppSettings& GetSettings() { return m_settings; }
 
 private:
-    std::wstring GetIniPath() const;
+    std::filesystem::path GetIniPath() const;
     void LoadWindowPlacement();
     void SaveWindowPlacement() const;
 
@@ -0,0 +1,83 @@
+#include "startup_report.h"
+#include "tracer.h"
+#include "../globals/globals.h"
+#include <fstream>
+#include <chrono>
+
+using json = nlohmann::json;
+
+std::mutex StartupReport::s_mutex;
+std::map<std::string, long long> StartupReport::s_marksUs;
+std::map<uint64_t, long long> StartupReport::s_navigationStartsUs;
+std::optional<long long> StartupReport::s_documentStartUs;
+bool StartupReport::s_completed = false;
+
+void StartupReport::Mark(const std::string& milestone)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_marksUs.count(milestone)) return;
+        s_marksUs[milestone] = Tracer::NowUs();
+    }
+    Tracer::Instant(milestone.c_str());
+}
+
+bool StartupReport::HasMark(const std::string& milestone)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_marksUs.count(milestone) > 0;
+}
+
+void StartupReport::MarkNavigationStarting(uint64_t navigationId)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_navigationStartsUs.emplace(navigationId, Tracer::NowUs());
+    }
+    Mark("NavigationStarting");
+}
+
+void StartupReport::MarkNavigationCompleted(uint64_t navigationId, bool success)
+{
+    if (success) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto start = s_navigationStartsUs.find(navigationId);
+        if (start != s_navigationStartsUs.end()) s_documentStartUs = start->second;
+    }
+    Mark("NavigationCompleted");
+}
+
+bool StartupReport::Complete(const json& frontendMetrics, const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_completed) return false;
+    s_completed = true;
+
+    json native = json::object();
+    for (const auto& [name, us] : s_marksUs) native[name] = us / 1000.0;
+
+    // Translate frontend offsets (ms since its navigationStart) onto the native timeline.
+    json derived = json::object();
+    if (s_documentStartUs && frontendMetrics.is_object()) {
+        double anchorMs = *s_documentStartUs / 1000.0;
+        derived["navigationStart"] = anchorMs;
+        for (const char* key : { "firstPaint", "firstContentfulPaint", "domInteractive", "domContentLoadedEventEnd", "loadEventEnd" }) {
+            if (frontendMetrics.contains(key) && frontendMetrics[key].is_number() && frontendMetrics[key].get<double>() >= 0) {
+                derived[key] = anchorMs + frontendMetrics[key].get<double>();
+            }
+        }
+    }
+
+    json report = {
+        {"version", APP_VERSION},
+        {"timestamp", std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()},
+        {"native", native},
+        {"frontend", frontendMetrics},
+        {"derived", derived}
+    };
+
+    std::ofstream out(path, std::ios::out | std::ios::app);
+    if (!out) return false;
+    out << report.dump() << '\n';
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,43 @@
+#ifndef STARTUP_REPORT_H
+#define STARTUP_REPORT_H
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <cstdint>
+#include <filesystem>
+#include "nlohmann/json.hpp"
+
+// Per-launch end-to-end load report. Native milestones are stamped on the
+// tracer's clock (microseconds since process start); the frontend reports its
+// Navigation Timing / paint metrics relative to its own navigationStart, which
+// is anchored to the NavigationStarting of the navigation that produced the
+// document: the latest one to complete successfully, matched by navigation id,
+// so redirects and failed attempts before it do not skew the numbers. Each
+// launch appends one JSON line so regressions show up across versions.
+class StartupReport
+{
+public:
+    // Records the first occurrence of a milestone and mirrors it to the tracer.
+    static void Mark(const std::string& milestone);
+    static bool HasMark(const std::string& milestone);
+
+    // WebView2 navigation events, keyed by their navigation id. Also mark the
+    // first NavigationStarting and NavigationCompleted milestones.
+    static void MarkNavigationStarting(uint64_t navigationId);
+    static void MarkNavigationCompleted(uint64_t navigationId, bool success);
+
+    // Completes the report with the frontend's metrics and appends it to path.
+    // Only the first call per launch writes anything.
+    static bool Complete(const nlohmann::json& frontendMetrics, const std::filesystem::path& path);
+
+private:
+    static std::mutex s_mutex;
+    static std::map<std::string, long long> s_marksUs;
+    static std::map<uint64_t, long long> s_navigationStartsUs;
+    static std::optional<long long> s_documentStartUs;  // of the last successful navigation
+    static bool s_completed;
+};
+
+#endif // STARTUP_REPORT_H
@@ -0,0 +1,95 @@
+#include "tracer.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+static const size_t TRACE_CAPACITY = 4096;
+static const size_t TRACE_NAME_LENGTH = 48;
+
+struct TraceEvent {
+    char name[TRACE_NAME_LENGTH];
+    char phase;
+    uint32_t threadId;
+    long long timestampUs;
+    std::atomic<bool> ready;
+};
+
+static TraceEvent g_events[TRACE_CAPACITY];
+static std::atomic<size_t> g_nextEvent{0};
+static std::atomic<size_t> g_droppedEvents{0};
+static std::atomic<uint32_t> g_nextThreadId{1};
+static const std::chrono::steady_clock::time_point g_traceEpoch = std::chrono::steady_clock::now();
+
+static uint32_t CurrentTraceThreadId()
+{
+    thread_local uint32_t id = g_nextThreadId.fetch_add(1);
+    return id;
+}
+
+long long Tracer::NowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_traceEpoch).count();
+}
+
+static void Record(const char* name, char phase)
+{
+    size_t index = g_nextEvent.fetch_add(1, std::memory_order_relaxed);
+    if (index >= TRACE_CAPACITY) {
+        g_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TraceEvent& ev = g_events[index];
+    size_t length = 0;
+    for (; name && name[length] && length < TRACE_NAME_LENGTH - 1; length++) ev.name[length] = name[length];
+    ev.name[length] = '\0';
+    ev.phase = phase;
+    ev.threadId = CurrentTraceThreadId();
+    ev.timestampUs = Tracer::NowUs();
+    ev.ready.store(true, std::memory_order_release);
+}
+
+static void AppendJsonString(std::ostream& out, const char* s)
+{
+    out << '"';
+    for (; *s; s++) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') out << '\\' << *s;
+        else if (c < 0x20) out << ' ';
+        else out << *s;
+    }
+    out << '"';
+}
+
+void Tracer::Begin(const char* name) { Record(name, 'B'); }
+void Tracer::End(const char* name) { Record(name, 'E'); }
+void Tracer::Instant(const char* name) { Record(name, 'i'); }
+
+size_t Tracer::GetDroppedCount()
+{
+    return g_droppedEvents.load(std::memory_order_relaxed);
+}
+
+bool Tracer::DumpChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) return false;
+
+    size_t count = (std::min)(g_nextEvent.load(std::memory_order_acquire), TRACE_CAPACITY);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t i = 0; i < count; i++) {
+        const TraceEvent& ev = g_events[i];
+        if (!ev.ready.load(std::memory_order_acquire)) continue;
+        if (!first) out << ',';
+        first = false;
+        out << "{\"name\":";
+        AppendJsonString(out, ev.name);
+        out << ",\"cat\":\"startup\",\"ph\":\"" << ev.phase << "\",\"ts\":" << ev.timestampUs
+            << ",\"pid\":1,\"tid\":" << ev.threadId;
+        if (ev.phase == 'i') out << ",\"s\":\"t\"";
+        out << '}';
+    }
+    out << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << GetDroppedCount() << "}}";
+    return static_cast<bool>(out);
+}
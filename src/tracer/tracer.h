@@ -0,0 +1,39 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <filesystem>
+
+// Lightweight span tracer for startup profiling. Events go into a fixed-size
+// lock-free buffer; once it is full further events are dropped. The buffer
+// can be written out in chrome://tracing (Trace Event) JSON format.
+class Tracer
+{
+public:
+    static void Begin(const char* name);
+    static void End(const char* name);
+    static void Instant(const char* name);
+    static long long NowUs();
+
+    static bool DumpChromeTrace(const std::filesystem::path& path);
+    static size_t GetDroppedCount();
+};
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name) : m_name(name) { Tracer::Begin(m_name); }
+    ~TraceScope() { Tracer::End(m_name); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#endif // TRACER_H
@@ -0,0 +1,92 @@
+#include "delta_patch.h"
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+static const char PATCH_MAGIC[8] = { 'S', 'T', 'R', 'D', 'I', 'F', 'F', '1' };
+static const size_t PATCH_CHUNK_SIZE = 64 * 1024;
+
+static bool ReadInt64(std::ifstream& in, int64_t& out) {
+    unsigned char buf[8];
+    if (!in.read(reinterpret_cast<char*>(buf), sizeof(buf))) return false;
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | buf[i];
+    out = static_cast<int64_t>(v);
+    return true;
+}
+
+namespace DeltaPatch {
+    bool Apply(const std::filesystem::path& basePath, const std::filesystem::path& patchPath, const std::filesystem::path& outPath, std::string& error)
+    {
+        std::ifstream base(basePath, std::ios::binary);
+        if (!base) { error = "cannot open base file"; return false; }
+        std::vector<char> oldData((std::istreambuf_iterator<char>(base)), std::istreambuf_iterator<char>());
+        const int64_t oldSize = static_cast<int64_t>(oldData.size());
+
+        std::ifstream patch(patchPath, std::ios::binary);
+        if (!patch) { error = "cannot open patch file"; return false; }
+
+        char magic[sizeof(PATCH_MAGIC)];
+        if (!patch.read(magic, sizeof(magic)) || memcmp(magic, PATCH_MAGIC, sizeof(magic)) != 0) {
+            error = "bad patch header";
+            return false;
+        }
+        int64_t newSize = 0;
+        if (!ReadInt64(patch, newSize) || newSize < 0) { error = "bad patch size"; return false; }
+
+        std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+        if (!out) { error = "cannot open output file"; return false; }
+
+        std::vector<char> chunk(PATCH_CHUNK_SIZE);
+        int64_t oldPos = 0;
+        int64_t newPos = 0;
+
+        while (newPos < newSize) {
+            int64_t addLen = 0, extraLen = 0, seek = 0;
+            if (!ReadInt64(patch, addLen) || !ReadInt64(patch, extraLen) || !ReadInt64(patch, seek)) {
+                error = "truncated control block";
+                return false;
+            }
+            // Compared by subtraction: the lengths come straight from the file
+            // and summing them could overflow.
+            if (addLen < 0 || extraLen < 0 || addLen > newSize - newPos || extraLen > newSize - newPos - addLen) {
+                error = "corrupt control block";
+                return false;
+            }
+
+            // Diff section: new = old + diff, treating bytes past the old file as zero.
+            int64_t remaining = addLen;
+            while (remaining > 0) {
+                size_t n = static_cast<size_t>(std::min<int64_t>(remaining, PATCH_CHUNK_SIZE));
+                if (!patch.read(chunk.data(), n)) { error = "truncated diff block"; return false; }
+                for (size_t i = 0; i < n; i++) {
+                    int64_t src = oldPos + static_cast<int64_t>(i);
+                    if (src >= 0 && src < oldSize) chunk[i] = static_cast<char>(chunk[i] + oldData[static_cast<size_t>(src)]);
+                }
+                out.write(chunk.data(), n);
+                oldPos += n;
+                remaining -= n;
+            }
+
+            // Extra section: copied verbatim.
+            remaining = extraLen;
+            while (remaining > 0) {
+                size_t n = static_cast<size_t>(std::min<int64_t>(remaining, PATCH_CHUNK_SIZE));
+                if (!patch.read(chunk.data(), n)) { error = "truncated extra block"; return false; }
+                out.write(chunk.data(), n);
+                remaining -= n;
+            }
+
+            newPos += addLen + extraLen;
+            if (seek < -oldPos || seek > oldSize - oldPos) {
+                error = "corrupt seek";
+                return false;
+            }
+            oldPos += seek;
+        }
+
+        if (!out) { error = "write failed"; return false; }
+        return true;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <string>
+#include <filesystem>
+
+// Binary delta patches advertised by version-details.json.
+//
+// Layout (all integers little-endian int64):
+//   "STRDIFF1" | newSize | { addLen | extraLen | seek | diff[addLen] | extra[extraLen] }*
+//
+// Each record is a bsdiff-style control triple: addLen bytes are produced by
+// adding diff bytes to the old file at the current position, extraLen bytes
+// are copied verbatim, then the old position moves by addLen + seek and must
+// land within the old file.
+namespace DeltaPatch {
+    bool Apply(const std::filesystem::path& basePath, const std::filesystem::path& patchPath, const std::filesystem::path& outPath, std::string& error);
+}
+
+#endif // DELTA_PATCH_H
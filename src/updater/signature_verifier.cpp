@@ -0,0 +1,93 @@
+#include "signature_verifier.h"
+#include "../logger/logger.h"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <cctype>
+
+SignatureVerifier::SignatureVerifier(const char* publicKeyPem)
+    : m_pubKey(nullptr), m_ctx(nullptr), m_inProgress(false)
+{
+    BIO* bio = BIO_new_mem_buf(publicKeyPem, -1);
+    if (bio) {
+        m_pubKey = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+        BIO_free(bio);
+    }
+    if (!m_pubKey) {
+        LOG_ERROR("SignatureVerifier", "Failed to parse embedded public key.");
+        return;
+    }
+    m_ctx = EVP_MD_CTX_new();
+}
+
+SignatureVerifier::~SignatureVerifier()
+{
+    if (m_ctx) EVP_MD_CTX_free(m_ctx);
+    if (m_pubKey) EVP_PKEY_free(m_pubKey);
+}
+
+bool SignatureVerifier::Verify(const std::string& data, const std::string& signatureBase64)
+{
+    return Begin() && Update(data.data(), data.size()) && Finish(signatureBase64);
+}
+
+bool SignatureVerifier::Begin()
+{
+    if (!m_pubKey || !m_ctx) return false;
+    EVP_MD_CTX_reset(m_ctx);
+    m_inProgress = (EVP_DigestVerifyInit(m_ctx, nullptr, EVP_sha256(), nullptr, m_pubKey) == 1);
+    return m_inProgress;
+}
+
+bool SignatureVerifier::Update(const void* data, size_t size)
+{
+    if (!m_inProgress) return false;
+    if (size == 0) return true;
+    if (EVP_DigestVerifyUpdate(m_ctx, data, size) != 1) {
+        m_inProgress = false;
+        return false;
+    }
+    return true;
+}
+
+bool SignatureVerifier::Finish(const std::string& signatureBase64)
+{
+    if (!m_inProgress) return false;
+    m_inProgress = false;
+    std::vector<unsigned char> signature;
+    if (!DecodeSignature(signatureBase64, signature)) return false;
+    return EVP_DigestVerifyFinal(m_ctx, signature.data(), signature.size()) == 1;
+}
+
+std::vector<bool> SignatureVerifier::VerifyBatch(const std::vector<std::pair<std::string, std::string>>& manifests)
+{
+    std::vector<bool> results;
+    results.reserve(manifests.size());
+    for (const auto& [data, signature] : manifests) {
+        results.push_back(Verify(data, signature));
+    }
+    return results;
+}
+
+bool SignatureVerifier::DecodeSignature(const std::string& signatureBase64, std::vector<unsigned char>& out) const
+{
+    std::string cleanedSig;
+    cleanedSig.reserve(signatureBase64.size());
+    for (char c : signatureBase64) if (!isspace((unsigned char)c)) cleanedSig.push_back(c);
+    if (cleanedSig.empty() || cleanedSig.size() % 4 != 0) return false;
+    // Padding only at the very end: "xx==" or "xxx=".
+    const size_t padding = cleanedSig.find('=');
+    if (padding != std::string::npos &&
+        (padding < cleanedSig.size() - 2 || cleanedSig.find_first_not_of('=', padding) != std::string::npos)) {
+        return false;
+    }
+
+    out.resize(cleanedSig.size() / 4 * 3);
+    int len = EVP_DecodeBlock(out.data(), reinterpret_cast<const unsigned char*>(cleanedSig.data()), (int)cleanedSig.size());
+    if (len <= 0) return false;
+    // EVP_DecodeBlock does not account for padding.
+    if (cleanedSig.back() == '=') len--;
+    if (cleanedSig[cleanedSig.size() - 2] == '=') len--;
+    out.resize(len);
+    return true;
+}
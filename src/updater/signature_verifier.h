@@ -0,0 +1,47 @@
+#ifndef SIGNATURE_VERIFIER_H
+#define SIGNATURE_VERIFIER_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+typedef struct evp_pkey_st EVP_PKEY;
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+// RSA/SHA-256 verifier for the updater. The PEM key is parsed once and the
+// digest context is reused between verifications, so an instance is cheap to
+// call repeatedly but must not be shared between threads.
+class SignatureVerifier
+{
+public:
+    explicit SignatureVerifier(const char* publicKeyPem);
+    ~SignatureVerifier();
+
+    SignatureVerifier(const SignatureVerifier&) = delete;
+    SignatureVerifier& operator=(const SignatureVerifier&) = delete;
+
+    bool IsValid() const { return m_pubKey != nullptr; }
+
+    // Verifies a base64 signature, with standard padding, over the whole of data.
+    bool Verify(const std::string& data, const std::string& signatureBase64);
+
+    // Incremental verification, fed from download write callbacks. Begin()
+    // discards any verification in progress; Update() and Finish() fail
+    // without a successful Begin().
+    bool Begin();
+    bool Update(const void* data, size_t size);
+    bool Finish(const std::string& signatureBase64);
+
+    // Verifies several (data, signature) pairs against the same key.
+    std::vector<bool> VerifyBatch(const std::vector<std::pair<std::string, std::string>>& manifests);
+
+private:
+    bool DecodeSignature(const std::string& signatureBase64, std::vector<unsigned char>& out) const;
+
+    EVP_PKEY* m_pubKey;
+    EVP_MD_CTX* m_ctx;
+    bool m_inProgress;
+};
+
+#endif // SIGNATURE_VERIFIER_H
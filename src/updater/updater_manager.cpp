@@ -7,10 +7,11 @@
 #include "../crashlog/crashlog.h"
 #include "../globals/globals.h"
 #include "../webview_protocol/event_emitter/event_emitter.h"
+#include "../metrics/metrics.h"
+#include "delta_patch.h"
+#include "signature_verifier.h"
 #include "nlohmann/json.hpp"
 
-#include <openssl/evp.h>
-#include <openssl/pem.h>
 #include <openssl/sha.h>
 #include <curl/curl.h>
 #include <fstream>
@@ -26,10 +27,25 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
     return size * nmemb;
 }
 
+struct SignedDownload {
+    std::string* out;
+    SignatureVerifier* verifier;
+};
+
+// Hashes each chunk as it arrives, so the signature check does not need a
+// second pass over the document once the transfer ends.
+static size_t SignedWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    auto* download = static_cast<SignedDownload*>(userp);
+    if (!download->verifier->Update(contents, size * nmemb)) return 0;
+    download->out->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
 UpdaterManager::UpdaterManager(AppManager* appManager) 
     : m_appManager(appManager), 
       m_updateUrl("https://raw.githubusercontent.com/Ali-Kabbadj/Stremato/refs/heads/webview-windows/versioning/version.json"),
-      m_forceFullUpdate(false) 
+      m_forceFullUpdate(false),
+      m_verifier(std::make_unique<SignatureVerifier>(public_key_pem))
 {}
 
 UpdaterManager::~UpdaterManager() {
@@ -74,11 +90,11 @@ void UpdaterManager::UpdaterThread()
     std::string signatureBase64 = versionJson["signature"].get<std::string>();
 
     std::string detailsContent;
-    if(!DownloadString(versionDescUrl, detailsContent)) {
+    if(!DownloadSigned(versionDescUrl, detailsContent)) {
         AppendToCrashLog("[UPDATER]: Failed to download version details");
         return;
     }
-    if(!VerifySignature(detailsContent, signatureBase64)) {
+    if(!m_verifier->Finish(signatureBase64)) {
         AppendToCrashLog("[UPDATER]: Signature verification failed");
         return;
     }
@@ -110,11 +126,23 @@ void UpdaterManager::UpdaterThread()
             std::filesystem::path installerPath = tempDir / std::wstring(filename.begin(), filename.end());
 
             if (!std::filesystem::exists(installerPath) || FileChecksum(installerPath) != expectedChecksum) {
-                LOG_INFO("UpdaterManager", "Downloading new installer: " + filename);
-                if (DownloadFile(url, installerPath) && FileChecksum(installerPath) == expectedChecksum) {
+                std::vector<std::filesystem::path> previousInstallers;
+                std::error_code ec;
+                for (const auto& entry : std::filesystem::directory_iterator(tempDir, ec)) {
+                    if (entry.is_regular_file() && entry.path().extension() == L".exe" && entry.path() != installerPath) {
+                        previousInstallers.push_back(entry.path());
+                    }
+                }
+                if (TryDeltaUpdate(files[key], previousInstallers, installerPath, expectedChecksum, tempDir)) {
+                    LOG_INFO("UpdaterManager", "Installer rebuilt from delta patch: " + filename);
                     downloadOk = true;
                 } else {
-                    AppendToCrashLog("[UPDATER]: Installer download or checksum verification failed.");
+                    LOG_INFO("UpdaterManager", "Downloading new installer: " + filename);
+                    if (DownloadFile(url, installerPath) && FileChecksum(installerPath) == expectedChecksum) {
+                        downloadOk = true;
+                    } else {
+                        AppendToCrashLog("[UPDATER]: Installer download or checksum verification failed.");
+                    }
                 }
             } else {
                 downloadOk = true;
@@ -146,9 +174,11 @@ void UpdaterManager::UpdaterThread()
                     continue;
                 }
                 
-                if(DownloadFile(url, localFilePath) && FileChecksum(localFilePath) == expectedChecksum) {
+                bool patched = TryDeltaUpdate(files[key], { localFilePath }, localFilePath, expectedChecksum, tempDir);
+                if(patched || (DownloadFile(url, localFilePath) && FileChecksum(localFilePath) == expectedChecksum)) {
                     LOG_INFO("UpdaterManager", "Partial update applied for: " + key);
-                    if(key=="server.js") {
+                    if(key=="server.js" && !m_appManager->GetServerManager()->HotSwap()) {
+                        LOG_WARN("UpdaterManager", "Server hot swap failed, falling back to a cold restart.");
                         m_appManager->GetServerManager()->Stop();
                         m_appManager->GetServerManager()->Start();
                     }
@@ -161,6 +191,63 @@ void UpdaterManager::UpdaterThread()
     LOG_INFO("UpdaterManager", "Update check finished.");
 }
 
+bool UpdaterManager::TryDeltaUpdate(const json& entry, const std::vector<std::filesystem::path>& basePaths,
+                                    const std::filesystem::path& dest, const std::string& expectedChecksum,
+                                    const std::filesystem::path& tempDir) const {
+    if (!entry.contains("patches") || !entry["patches"].is_array()) return false;
+
+    // Pick the smallest advertised patch whose source matches a file we already
+    // have. Malformed entries are skipped; with none left the caller falls back
+    // to the full download.
+    const json* bestPatch = nullptr;
+    std::filesystem::path bestBase;
+    int64_t bestSize = INT64_MAX;
+    for (const auto& basePath : basePaths) {
+        if (!std::filesystem::exists(basePath)) continue;
+        std::string baseChecksum = FileChecksum(basePath);
+        for (const auto& patch : entry["patches"]) {
+            if (!patch.is_object()) continue;
+            auto from = patch.find("from");
+            auto url = patch.find("url");
+            if (from == patch.end() || !from->is_string() || url == patch.end() || !url->is_string()) continue;
+            if (from->get_ref<const std::string&>() != baseChecksum) continue;
+            auto sizeField = patch.find("size");
+            if (sizeField != patch.end() && !sizeField->is_number_integer()) continue;
+            int64_t size = sizeField != patch.end() ? sizeField->get<int64_t>() : INT64_MAX;
+            if (size < 0) continue;
+            if (!bestPatch || size < bestSize) {
+                bestPatch = &patch;
+                bestBase = basePath;
+                bestSize = size;
+            }
+        }
+    }
+    if (!bestPatch) return false;
+
+    std::filesystem::path patchPath = tempDir / (dest.filename().wstring() + L".patch");
+    std::filesystem::path rebuiltPath = tempDir / (dest.filename().wstring() + L".rebuilt");
+    std::error_code ec;
+    bool ok = false;
+
+    LOG_INFO("UpdaterManager", "Downloading delta patch for " + dest.filename().string() + " (" + std::to_string(bestSize) + " bytes).");
+    std::string error;
+    if (!DownloadFile(bestPatch->at("url").get<std::string>(), patchPath)) {
+        LOG_WARN("UpdaterManager", "Delta patch download failed, falling back to full download.");
+    } else if (!DeltaPatch::Apply(bestBase, patchPath, rebuiltPath, error)) {
+        LOG_WARN("UpdaterManager", "Delta patch apply failed (" + error + "), falling back to full download.");
+    } else if (FileChecksum(rebuiltPath) != expectedChecksum) {
+        LOG_WARN("UpdaterManager", "Delta patch result checksum mismatch, falling back to full download.");
+    } else {
+        std::filesystem::copy_file(rebuiltPath, dest, std::filesystem::copy_options::overwrite_existing, ec);
+        ok = !ec;
+        if (ec) LOG_WARN("UpdaterManager", "Failed to move patched file into place: " + ec.message());
+    }
+
+    std::filesystem::remove(patchPath, ec);
+    std::filesystem::remove(rebuiltPath, ec);
+    return ok;
+}
+
 bool UpdaterManager::DownloadString(const std::string& url, std::string& outData) const {
     CURL* curl = curl_easy_init();
     if (!curl) return false;
@@ -170,7 +257,27 @@ bool UpdaterManager::DownloadString(const std::string& url, std::string& outData
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "Stremato-Updater/1.0");
     curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    auto start = std::chrono::steady_clock::now();
+    CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("update_manifest", start, res == CURLE_OK);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK;
+}
+
+bool UpdaterManager::DownloadSigned(const std::string& url, std::string& outData) const {
+    if (!m_verifier->Begin()) return false;
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+    SignedDownload download = { &outData, m_verifier.get() };
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, SignedWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Stremato-Updater/1.0");
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    auto start = std::chrono::steady_clock::now();
     CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("update_manifest", start, res == CURLE_OK);
     curl_easy_cleanup(curl);
     return res == CURLE_OK;
 }
@@ -183,7 +290,11 @@ bool UpdaterManager::DownloadFile(const std::string& url, const std::filesystem:
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
+    // An error page must not be saved as the file, or applied as a patch.
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    auto start = std::chrono::steady_clock::now();
     CURLcode res = curl_easy_perform(curl);
+    Metrics::RecordHttp("update_download", start, res == CURLE_OK);
     fclose(fp);
     curl_easy_cleanup(curl);
     return (res == CURLE_OK);
@@ -203,31 +314,3 @@ std::string UpdaterManager::FileChecksum(const std::filesystem::path& filepath)
     for(int i = 0; i < SHA256_DIGEST_LENGTH; i++) { ss << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i]; }
     return ss.str();
 }
-
-bool UpdaterManager::VerifySignature(const std::string& data, const std::string& signatureBase64) const { 
-    BIO* bio = BIO_new_mem_buf(public_key_pem, -1);
-    EVP_PKEY* pubKey = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
-    BIO_free(bio);
-    if(!pubKey) return false;
-    std::string cleanedSig;
-    for(char c : signatureBase64) if(!isspace((unsigned char)c)) cleanedSig.push_back(c);
-    BIO* b64 = BIO_new(BIO_f_base64());
-    BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-    BIO* bmem = BIO_new_mem_buf(cleanedSig.data(), (int)cleanedSig.size());
-    bmem = BIO_push(b64, bmem);
-    std::vector<unsigned char> signature(EVP_PKEY_size(pubKey));
-    int sig_len = BIO_read(bmem, signature.data(), (int)signature.size());
-    BIO_free_all(bmem);
-    if(sig_len <= 0) { EVP_PKEY_free(pubKey); return false; }
-    signature.resize(sig_len);
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    bool result = false;
-    if(EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, pubKey) == 1){
-        if(EVP_DigestVerifyUpdate(ctx, data.data(), data.size()) == 1){
-            result = (EVP_DigestVerifyFinal(ctx, signature.data(), signature.size()) == 1);
-        }
-    }
-    EVP_MD_CTX_free(ctx);
-    EVP_PKEY_free(pubKey);
-    return result;
-}
\ No newline at end of file
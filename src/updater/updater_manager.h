@@ -4,9 +4,12 @@
 #include <string>
 #include <filesystem>
 #include <thread>
+#include <vector>
+#include <memory>
 #include "nlohmann/json.hpp"
 
 class AppManager;
+class SignatureVerifier;
 
 class UpdaterManager
 {
@@ -22,16 +25,21 @@ public:
 
 private:
     void UpdaterThread();
+    bool TryDeltaUpdate(const nlohmann::json& entry, const std::vector<std::filesystem::path>& basePaths,
+                        const std::filesystem::path& dest, const std::string& expectedChecksum,
+                        const std::filesystem::path& tempDir) const;
     bool DownloadString(const std::string& url, std::string& outData) const;
+    // Downloads into outData while feeding m_verifier; finish with m_verifier->Finish().
+    bool DownloadSigned(const std::string& url, std::string& outData) const;
     bool DownloadFile(const std::string& url, const std::filesystem::path& dest) const;
     std::string FileChecksum(const std::filesystem::path& filepath) const;
-    bool VerifySignature(const std::string& data, const std::string& signatureBase64) const;
 
     AppManager* m_appManager;
     std::filesystem::path m_installerPath;
     std::thread m_thread;
         std::string m_updateUrl;
     bool m_forceFullUpdate;
+    std::unique_ptr<SignatureVerifier> m_verifier;
 };
 
 #endif // UPDATER_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "webview_event_transport.h"
+#include "../globals/globals.h"
+#include "../helpers/helpers.h"
+#include "../webview_protocol/transport_constants.h"
+#include "../webview_protocol/shared_channel/shared_buffer_channel.h"
+
+WebViewEventTransport::WebViewEventTransport(ICoreWebView2* webview, HWND dispatchHwnd)
+    : m_webview(webview), m_dispatchHwnd(dispatchHwnd), m_uiThreadId(GetCurrentThreadId()) {}
+
+bool WebViewEventTransport::IsDispatchThread() const
+{
+    return GetCurrentThreadId() == m_uiThreadId;
+}
+
+void WebViewEventTransport::RequestFlush()
+{
+    if (m_dispatchHwnd) PostMessage(m_dispatchHwnd, WM_POST_WEB_MESSAGE, 0, 0);
+}
+
+void WebViewEventTransport::Post(std::string message)
+{
+    // Frames are written at post time so a merged or dropped event never
+    // leaves an orphaned frame in the ring.
+    SharedBufferChannel* channel = m_sharedChannel.load();
+    if (channel && message.size() >= SHARED_FRAME_THRESHOLD) {
+        auto descriptor = channel->Write(SharedRing::FRAME_JSON_EVENT, message);
+        if (descriptor) {
+            WebViewProtocol::SharedFrameEventPayload frame = { descriptor->generation, descriptor->offset, descriptor->length, descriptor->seq };
+            message = json{ {"event", WebViewProtocol::Events::SHARED_FRAME}, {"payload", frame} }.dump();
+        }
+    }
+    m_webview->PostWebMessageAsJson(Utf8ToWstring(message).c_str());
+}
@@ -0,0 +1,37 @@
+#ifndef WEBVIEW_EVENT_TRANSPORT_H
+#define WEBVIEW_EVENT_TRANSPORT_H
+
+#include <windows.h>
+#include <atomic>
+#include <wil/com.h>
+#include <WebView2.h>
+#include "../webview_protocol/event_emitter/event_emitter.h"
+
+class SharedBufferChannel;
+
+// Posts outbound protocol events with PostWebMessageAsJson on the window's
+// thread. Flushes requested from other threads arrive as WM_POST_WEB_MESSAGE.
+// Large messages go through the shared-buffer channel when the frontend has
+// attached it.
+class WebViewEventTransport : public WebViewProtocol::EventTransport
+{
+public:
+    WebViewEventTransport(ICoreWebView2* webview, HWND dispatchHwnd);
+
+    void SetSharedChannel(SharedBufferChannel* channel) { m_sharedChannel = channel; }
+
+    bool IsDispatchThread() const override;
+    void RequestFlush() override;
+    void Post(std::string message) override;
+
+    // Messages at least this large go through the shared buffer when attached.
+    static constexpr size_t SHARED_FRAME_THRESHOLD = 16 * 1024;
+
+private:
+    wil::com_ptr<ICoreWebView2> m_webview;
+    HWND m_dispatchHwnd;
+    DWORD m_uiThreadId;
+    std::atomic<SharedBufferChannel*> m_sharedChannel{nullptr};
+};
+
+#endif // WEBVIEW_EVENT_TRANSPORT_H
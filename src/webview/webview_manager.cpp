@@ -5,6 +5,10 @@
 #include "../window/window_manager.h"
 #include "../webview_protocol/event_emitter/event_emitter.h"
 #include "../extensions/extensions_manager.h"
+#include "../tracer/tracer.h"
+#include "../tracer/startup_report.h"
+#include "../webview_protocol/shared_channel/shared_buffer_channel.h"
+#include "webview_event_transport.h"
 
 #include <thread>
 #include <sstream>
@@ -20,37 +24,74 @@ static const wchar_t* COMMUNICATION_BRIDGE_SCRIPT = LR"JS(
 )JS";
 
 WebViewManager::WebViewManager(AppManager* appManager)
-    : m_appManager(appManager), m_parentHWnd(nullptr) {}
+    : m_appManager(appManager), m_parentHWnd(nullptr), m_environmentRequested(false), m_environmentFailed(false) {}
 
-bool WebViewManager::Initialize(HWND parentHWnd) {
-    m_parentHWnd = parentHWnd;
-    LOG_INFO("WebViewManager", "Starting WebView2 initialization...");
+WebViewManager::~WebViewManager() {
+    WebViewProtocol::EventEmitter::SetTransport(nullptr);
+    // Emits already in flight keep the transport alive; keep them off the channel.
+    if (m_eventTransport) m_eventTransport->SetSharedChannel(nullptr);
+}
+
+// Kicks off browser process startup and user-data-folder I/O before the main
+// window exists. Must be called on the UI thread; the completion callback is
+// delivered once that thread pumps messages.
+bool WebViewManager::PrewarmEnvironment() {
+    if (m_environmentRequested) return !m_environmentFailed;
+    m_environmentRequested = true;
+    LOG_INFO("WebViewManager", "Starting WebView2 environment creation...");
 
     auto options = Microsoft::WRL::Make<CoreWebView2EnvironmentOptions>();
     options->put_AdditionalBrowserArguments(L"--autoplay-policy=no-user-gesture-required --disable-features=msWebOOUI,msPdfOOUI,msSmartScreenProtection");
     std::wstring userDataFolder = GetExeDirectory() + L"\\portable_config\\WebView2_Data";
 
+    Tracer::Begin("WebView2 environment");
     HRESULT hr = CreateCoreWebView2EnvironmentWithOptions(nullptr, userDataFolder.c_str(), options.Get(),
         Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(this, &WebViewManager::OnEnvironmentCreated).Get());
 
     if (FAILED(hr)) {
+        Tracer::End("WebView2 environment");
         LOG_ERROR("WebViewManager", "Top-level CreateCoreWebView2EnvironmentWithOptions call failed. HRESULT: " + std::to_string(hr));
+        m_environmentFailed = true;
         return false;
     }
     return true;
 }
 
+bool WebViewManager::Initialize(HWND parentHWnd) {
+    m_parentHWnd = parentHWnd;
+    LOG_INFO("WebViewManager", "Starting WebView2 initialization...");
+    if (!PrewarmEnvironment()) return false;
+
+    // The prewarmed environment may already be waiting for a window.
+    if (m_webviewEnv) {
+        return SUCCEEDED(CreateController());
+    }
+    return true;
+}
+
 HRESULT WebViewManager::OnEnvironmentCreated(HRESULT result, ICoreWebView2Environment* env) {
+    Tracer::End("WebView2 environment");
     if (FAILED(result) || !env) {
         LOG_ERROR("WebViewManager", "Failed to create WebView2 Environment. HRESULT: " + std::to_string(result));
+        m_environmentFailed = true;
         return E_FAIL;
     }
     m_webviewEnv = env;
+    if (!m_parentHWnd) {
+        LOG_INFO("WebViewManager", "WebView2 environment ready before the host window; deferring controller creation.");
+        return S_OK;
+    }
+    return CreateController();
+}
+
+HRESULT WebViewManager::CreateController() {
+    Tracer::Begin("WebView2 controller");
     return m_webviewEnv->CreateCoreWebView2Controller(m_parentHWnd,
         Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(this, &WebViewManager::OnControllerCreated).Get());
 }
 
 HRESULT WebViewManager::OnControllerCreated(HRESULT result, ICoreWebView2Controller* controller) {
+    Tracer::End("WebView2 controller");
     if (FAILED(result) || !controller) {
         LOG_ERROR("WebViewManager", "Failed to create WebView2 Controller. HRESULT: " + std::to_string(result));
         return E_FAIL;
@@ -99,9 +140,9 @@ HRESULT WebViewManager::OnControllerCreated(HRESULT result, ICoreWebView2Control
 
     Resize();
     m_webview21->AddScriptToExecuteOnDocumentCreated(COMMUNICATION_BRIDGE_SCRIPT, nullptr);
-    WebViewProtocol::EventEmitter::SetWebViewInstance(m_webview21.get());
+    m_eventTransport = std::make_shared<WebViewEventTransport>(m_webview21.get(), m_parentHWnd);
+    WebViewProtocol::EventEmitter::SetTransport(m_eventTransport);
     RegisterEventHandlers();
-    m_appManager->GetExtensionsManager()->FetchAndParseWhitelist();
 
     StartInitialNavigation();
 
@@ -118,6 +159,15 @@ void WebViewManager::StartInitialNavigation() {
     }).detach();
 }
 
+// Called on the UI thread when the frontend asks for the bulk channel.
+bool WebViewManager::AttachSharedBuffer(std::string& error) {
+    if (!m_sharedChannel) {
+        m_sharedChannel = std::make_unique<SharedBufferChannel>();
+    }
+    if (m_eventTransport) m_eventTransport->SetSharedChannel(m_sharedChannel.get());
+    return m_sharedChannel->Attach(m_webviewEnv.get(), m_webview21.get(), error);
+}
+
 void WebViewManager::Navigate(const std::wstring& url) {
     if (m_webview21) {
         m_webview21->Navigate(url.c_str());
@@ -136,6 +186,24 @@ void WebViewManager::RegisterEventHandlers() {
                 return S_OK;
             }).Get(), nullptr);
 
+    m_webview21->add_NavigationStarting(
+        Microsoft::WRL::Callback<ICoreWebView2NavigationStartingEventHandler>(
+            [this](ICoreWebView2* sender, ICoreWebView2NavigationStartingEventArgs* args) -> HRESULT {
+                UINT64 navigationId = 0;
+                args->get_NavigationId(&navigationId);
+                StartupReport::MarkNavigationStarting(navigationId);
+                // The next document has not received the buffer yet.
+                if (m_sharedChannel) m_sharedChannel->Detach();
+                return S_OK;
+            }).Get(), nullptr);
+
+    m_webview21->add_DOMContentLoaded(
+        Microsoft::WRL::Callback<ICoreWebView2DOMContentLoadedEventHandler>(
+            [this](ICoreWebView2* sender, ICoreWebView2DOMContentLoadedEventArgs* args) -> HRESULT {
+                StartupReport::Mark("DOMContentLoaded");
+                return S_OK;
+            }).Get(), nullptr);
+
     m_webview21->add_NavigationCompleted(
         Microsoft::WRL::Callback<ICoreWebView2NavigationCompletedEventHandler>(
             [this](ICoreWebView2* sender, ICoreWebView2NavigationCompletedEventArgs* args) -> HRESULT {
@@ -148,6 +216,9 @@ void WebViewManager::RegisterEventHandlers() {
                 } else {
                     LOG_INFO("WebViewManager", "Navigation successful.");
                 }
+                UINT64 navigationId = 0;
+                args->get_NavigationId(&navigationId);
+                StartupReport::MarkNavigationCompleted(navigationId, isSuccess);
                 return S_OK;
             }).Get(), nullptr);
 
@@ -7,6 +7,10 @@
 #include <wil/com.h>
 #include <WebView2.h>
 #include <WebView2EnvironmentOptions.h>
+#include <memory>
+
+class SharedBufferChannel;
+class WebViewEventTransport;
 
 class AppManager;
 
@@ -14,29 +18,37 @@ class WebViewManager
 {
 public:
     explicit WebViewManager(AppManager* appManager);
-    ~WebViewManager() = default;
+    ~WebViewManager();
 
+    bool PrewarmEnvironment();
     bool Initialize(HWND parentHWnd);
     void StartInitialNavigation();
     void Resize();
     void Refresh(bool hardRefresh);
     void Navigate(const std::wstring& url);
     ICoreWebView2_21* GetWebView() const { return m_webview21.get(); }
+    bool AttachSharedBuffer(std::string& error);
 
 private:
     HRESULT OnEnvironmentCreated(HRESULT result, ICoreWebView2Environment* env);
     HRESULT OnControllerCreated(HRESULT result, ICoreWebView2Controller* controller);
+    HRESULT CreateController();
 
     void RegisterEventHandlers();
 
     AppManager* m_appManager;
     HWND m_parentHWnd;
+    bool m_environmentRequested;
+    bool m_environmentFailed;
 
     wil::com_ptr<ICoreWebView2Environment> m_webviewEnv;
     wil::com_ptr<ICoreWebView2Controller> m_webviewController;
     
     wil::com_ptr<ICoreWebView2_21> m_webview21;
     wil::com_ptr<ICoreWebView2Profile8> m_webviewProfile;
+
+    std::unique_ptr<SharedBufferChannel> m_sharedChannel;
+    std::shared_ptr<WebViewEventTransport> m_eventTransport;
 };
 
 #endif // WEBVIEW_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "bridge_trace.h"
+#include "../../tracer/tracer.h"
+#include <chrono>
+#include <cstring>
+
+static void WriteVarint(std::ostream& out, uint64_t value)
+{
+    char buf[10];
+    int n = 0;
+    do {
+        unsigned char byte = value & 0x7F;
+        value >>= 7;
+        buf[n++] = static_cast<char>(value ? byte | 0x80 : byte);
+    } while (value);
+    out.write(buf, n);
+}
+
+static bool ReadVarint(std::istream& in, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == EOF) return false;
+        value |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static void WriteLE(std::ostream& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static bool ReadLE(std::istream& in, uint64_t& value, int bytes)
+{
+    value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = in.get();
+        if (c == EOF) return false;
+        value |= static_cast<uint64_t>(c & 0xFF) << (8 * i);
+    }
+    return true;
+}
+
+namespace BridgeTrace {
+    bool Writer::Open(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), ec);
+        m_out.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_out) return false;
+        long long nowUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        m_out.write(MAGIC, sizeof(MAGIC));
+        WriteLE(m_out, VERSION, 4);
+        WriteLE(m_out, static_cast<uint64_t>(nowUs), 8);
+        m_lastUs = 0;
+        return static_cast<bool>(m_out);
+    }
+
+    void Writer::Append(RecordKind kind, long long timestampUs, std::string_view data)
+    {
+        if (!m_out.is_open()) return;
+        // Timestamps from different threads can arrive slightly out of order; clamp to keep deltas unsigned.
+        if (timestampUs < m_lastUs) timestampUs = m_lastUs;
+        m_out.put(static_cast<char>(kind));
+        WriteVarint(m_out, static_cast<uint64_t>(timestampUs - m_lastUs));
+        WriteVarint(m_out, data.size());
+        m_out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        m_lastUs = timestampUs;
+    }
+
+    void Writer::Close()
+    {
+        if (m_out.is_open()) m_out.close();
+    }
+
+    bool Reader::Open(const std::filesystem::path& path, std::string& error)
+    {
+        m_in.open(path, std::ios::binary);
+        if (!m_in) { error = "cannot open trace file"; return false; }
+        char magic[sizeof(MAGIC)];
+        uint64_t version = 0, startUs = 0;
+        if (!m_in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+            error = "not a bridge trace";
+            return false;
+        }
+        if (!ReadLE(m_in, version, 4) || version != VERSION) { error = "unsupported trace version"; return false; }
+        if (!ReadLE(m_in, startUs, 8)) { error = "truncated trace header"; return false; }
+        m_startUnixUs = static_cast<long long>(startUs);
+        m_lastUs = 0;
+        return true;
+    }
+
+    bool Reader::Next(Record& record)
+    {
+        int kind = m_in.get();
+        if (kind == EOF) return false;
+        uint64_t delta = 0, length = 0;
+        if (!ReadVarint(m_in, delta) || !ReadVarint(m_in, length) || length > MAX_RECORD_LENGTH) return false;
+        record.kind = static_cast<RecordKind>(kind);
+        record.data.resize(static_cast<size_t>(length));
+        if (length && !m_in.read(record.data.data(), static_cast<std::streamsize>(length))) return false;
+        m_lastUs += static_cast<long long>(delta);
+        record.timestampUs = m_lastUs;
+        return true;
+    }
+}
+
+std::atomic<bool> BridgeRecorder::s_recording{false};
+std::mutex BridgeRecorder::s_mutex;
+BridgeTrace::Writer BridgeRecorder::s_writer;
+long long BridgeRecorder::s_startUs = 0;
+unsigned long long BridgeRecorder::s_records = 0;
+
+bool BridgeRecorder::Start(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_writer.Close();
+    if (!s_writer.Open(path)) return false;
+    s_startUs = Tracer::NowUs();
+    s_records = 0;
+    s_recording = true;
+    return true;
+}
+
+void BridgeRecorder::Stop()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_recording = false;
+    s_writer.Close();
+}
+
+void BridgeRecorder::RecordCommand(std::string_view message)
+{
+    if (IsRecording()) Record(BridgeTrace::RecordKind::Command, message);
+}
+
+void BridgeRecorder::RecordEvent(std::string_view message)
+{
+    if (IsRecording()) Record(BridgeTrace::RecordKind::Event, message);
+}
+
+unsigned long long BridgeRecorder::GetRecordCount()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_records;
+}
+
+void BridgeRecorder::Record(BridgeTrace::RecordKind kind, std::string_view message)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_writer.IsOpen()) return;
+    // Taken under the lock so records land in timestamp order.
+    s_writer.Append(kind, Tracer::NowUs() - s_startUs, message);
+    s_records++;
+}
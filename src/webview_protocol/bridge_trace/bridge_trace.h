@@ -0,0 +1,87 @@
+#ifndef BRIDGE_TRACE_H
+#define BRIDGE_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+
+// Binary trace of bridge traffic: every inbound command and outbound event in
+// the order it crossed the bridge, so field sessions can be replayed headlessly.
+//
+// Layout (integers little-endian):
+//   header: "STRBTRC1" | version u32 | start time (unix us) i64
+//   record: kind u8 | delta us (varint) | length (varint) | UTF-8 JSON[length]
+//
+// The delta is measured from the previous record (the first one from the
+// start of the trace), which keeps typical records at 3-4 bytes of overhead.
+namespace BridgeTrace {
+    constexpr char MAGIC[8] = { 'S', 'T', 'R', 'B', 'T', 'R', 'C', '1' };
+    constexpr uint32_t VERSION = 1;
+    // Sanity bound for a single message when reading untrusted files.
+    constexpr uint64_t MAX_RECORD_LENGTH = 64ull * 1024 * 1024;
+
+    enum class RecordKind : uint8_t {
+        Command = 1, // {"command","payload","messageId"} as received from the frontend
+        Event = 2    // {"event","payload"} as emitted, before outbound queueing
+    };
+
+    struct Record {
+        RecordKind kind;
+        long long timestampUs; // since the start of the trace
+        std::string data;
+    };
+
+    class Writer {
+    public:
+        bool Open(const std::filesystem::path& path);
+        void Append(RecordKind kind, long long timestampUs, std::string_view data);
+        void Close();
+        bool IsOpen() const { return m_out.is_open(); }
+
+    private:
+        std::ofstream m_out;
+        long long m_lastUs = 0;
+    };
+
+    class Reader {
+    public:
+        bool Open(const std::filesystem::path& path, std::string& error);
+        // False at end of file or on a truncated record.
+        bool Next(Record& record);
+        long long GetStartUnixUs() const { return m_startUnixUs; }
+
+    private:
+        std::ifstream m_in;
+        long long m_startUnixUs = 0;
+        long long m_lastUs = 0;
+    };
+}
+
+// Process-wide opt-in recorder fed by CommandHandler and EventEmitter. When
+// not recording the hooks cost one relaxed atomic load.
+class BridgeRecorder
+{
+public:
+    static bool Start(const std::filesystem::path& path);
+    static void Stop();
+    static bool IsRecording() { return s_recording.load(std::memory_order_relaxed); }
+
+    static void RecordCommand(std::string_view message);
+    static void RecordEvent(std::string_view message);
+    static unsigned long long GetRecordCount();
+
+private:
+    static void Record(BridgeTrace::RecordKind kind, std::string_view message);
+
+    static std::atomic<bool> s_recording;
+    static std::mutex s_mutex;
+    static BridgeTrace::Writer s_writer;
+    static long long s_startUs;
+    static unsigned long long s_records;
+};
+
+#endif // BRIDGE_TRACE_H
@@ -1,19 +1,155 @@
 #include "command_handler.h"
 #include "../../helpers/helpers.h"
 #include "../../logger/logger.h"
+#include "../transport_constants.h"
+#include "../event_emitter/event_emitter.h"
+#include "../bridge_trace/bridge_trace.h"
+#include "../../metrics/metrics.h"
+#include <vector>
 
 namespace WebViewProtocol
 {
-    void CommandHandler::RegisterCommand(const std::string& commandName, CommandFunction handler)
+    // In-flight requests keyed by messageId. Shared with every Request so a
+    // late completion from a detached thread never touches a dead handler.
+    class PendingRequests
     {
-        m_commands[commandName] = handler;
+    public:
+        enum class AddResult { Added, Duplicate, Full };
+
+        AddResult Add(const RequestHandle& request)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_requests.count(request->GetId())) return AddResult::Duplicate;
+            if (m_requests.size() >= CommandHandler::MAX_IN_FLIGHT) return AddResult::Full;
+            m_requests[request->GetId()] = request;
+            return AddResult::Added;
+        }
+
+        void Remove(const std::string& id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.erase(id);
+        }
+
+        RequestHandle Find(const std::string& id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_requests.find(id);
+            return it != m_requests.end() ? it->second : nullptr;
+        }
+
+        std::vector<RequestHandle> TakeAll()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<RequestHandle> all;
+            for (const auto& [id, request] : m_requests) all.push_back(request);
+            return all;
+        }
+
+        // Returns expired requests and the earliest remaining deadline.
+        std::vector<RequestHandle> CollectExpired(Request::Clock::time_point now, std::optional<Request::Clock::time_point>& next)
+        {
+            std::vector<RequestHandle> expired;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            next.reset();
+            for (const auto& [id, request] : m_requests) {
+                if (request->GetDeadline() <= now) {
+                    expired.push_back(request);
+                } else if (!next || request->GetDeadline() < *next) {
+                    next = request->GetDeadline();
+                }
+            }
+            return expired;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::map<std::string, RequestHandle> m_requests;
+    };
+
+    Request::Request(std::string id, std::string command, Clock::time_point deadline, std::weak_ptr<PendingRequests> owner)
+        : m_id(std::move(id)), m_command(std::move(command)), m_received(Clock::now()), m_deadline(deadline), m_owner(std::move(owner)) {}
+
+    bool Request::Complete(const std::optional<json>& result, const std::optional<std::string>& error)
+    {
+        if (m_completed.exchange(true)) return false;
+        static Metrics::Histogram& s_latencyUs = Metrics::GetHistogram("requests.latency_us");
+        s_latencyUs.Record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_received).count());
+        if (auto owner = m_owner.lock()) owner->Remove(m_id);
+        if (!m_id.empty()) EventEmitter::emitCommandResponse(m_id, result, error);
+        return true;
+    }
+
+    void Request::Resolve(const json& result)
+    {
+        Complete(result, std::nullopt);
+    }
+
+    void Request::Reject(const std::string& error)
+    {
+        Complete(std::nullopt, error);
+    }
+
+    void Request::Cancel(const std::string& reason)
+    {
+        m_cancelled = true;
+        if (Complete(std::nullopt, reason)) {
+            LOG_INFO("CommandHandler", "Request " + m_command + " (" + m_id + ") " + reason + ".");
+        }
+    }
+
+    CommandHandler::CommandHandler()
+        : m_pending(std::make_shared<PendingRequests>())
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        m_workers = std::make_unique<TaskPool>(cores > 4 ? 4 : (cores < 2 ? 2 : cores));
+        m_timerThread = std::thread(&CommandHandler::TimeoutLoop, this);
+
+        RegisterCommand(Commands::CANCEL_REQUEST, [this](const json& payload, const std::optional<std::string>& /*messageId*/) {
+            std::string target = payload.at("messageId").get<std::string>();
+            if (auto request = m_pending->Find(target)) request->Cancel("cancelled");
+        });
+    }
+
+    CommandHandler::~CommandHandler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_timerMutex);
+            m_stopping = true;
+        }
+        m_timerCv.notify_all();
+        if (m_timerThread.joinable()) m_timerThread.join();
+        // Cancelling first lets long-running worker handlers notice and return.
+        for (const auto& request : m_pending->TakeAll()) request->Cancel("cancelled (shutting down)");
+        m_workers.reset();
+    }
+
+    void CommandHandler::RegisterCommand(const std::string& commandName, CommandFunction handler, CommandOptions options)
+    {
+        m_commands[commandName] = { std::move(handler), std::move(options) };
+    }
+
+    void CommandHandler::RegisterRequest(const std::string& commandName, RequestFunction handler, RequestOptions options)
+    {
+        m_requests[commandName] = { std::move(handler), options };
+    }
+
+    bool CommandHandler::HasHandler(const std::string& commandName) const
+    {
+        return m_commands.count(commandName) > 0 || m_requests.count(commandName) > 0;
     }
 
     void CommandHandler::HandleCommand(const std::wstring& message)
     {
         try
         {
-            auto commandJson = json::parse(WStringToUtf8(message));
+            std::string utf8 = WStringToUtf8(message);
+            static Metrics::Counter& s_commandsIn = Metrics::GetCounter("bridge.commands_in");
+            static Metrics::Counter& s_bytesIn = Metrics::GetCounter("bridge.bytes_in");
+            s_commandsIn.Add();
+            s_bytesIn.Add(utf8.size());
+            BridgeRecorder::RecordCommand(utf8);
+            auto commandJson = json::parse(utf8);
             std::string commandName = commandJson.at("command").get<std::string>();
             const auto& payload = commandJson.at("payload");
 
@@ -24,11 +160,24 @@ namespace WebViewProtocol
 
             if (m_commands.count(commandName))
             {
-                m_commands[commandName](payload, messageId);
+                const CommandRoute& route = m_commands[commandName];
+                Dispatch(commandName, route.options.affinity, route.options.serialKey,
+                    [handler = route.handler, payload, messageId, commandName]() {
+                        try {
+                            handler(payload, messageId);
+                        } catch (const std::exception& e) {
+                            LOG_ERROR("CommandHandler", "Error handling " + commandName + ": " + std::string(e.what()));
+                        }
+                    });
+            }
+            else if (m_requests.count(commandName))
+            {
+                HandleRequest(commandName, m_requests[commandName], payload, messageId.value_or(""));
             }
             else
             {
                 LOG_WARN("CommandHandler", "Unknown command received: " + commandName);
+                if (messageId) EventEmitter::emitCommandResponse(messageId.value(), std::nullopt, "Unknown command");
             }
         }
         catch (const json::exception& e)
@@ -40,4 +189,122 @@ namespace WebViewProtocol
             LOG_ERROR("CommandHandler", "Error handling command: " + std::string(e.what()));
         }
     }
-}
\ No newline at end of file
+
+    void CommandHandler::HandleRequest(const std::string& commandName, const RequestRoute& route, const json& payload, const std::string& messageId)
+    {
+        // Without a messageId nobody is waiting: run the handler but track nothing.
+        std::weak_ptr<PendingRequests> owner;
+        if (!messageId.empty()) owner = m_pending;
+        auto request = std::make_shared<Request>(messageId, commandName, Request::Clock::now() + route.options.timeout, owner);
+
+        switch (messageId.empty() ? PendingRequests::AddResult::Added : m_pending->Add(request)) {
+            case PendingRequests::AddResult::Duplicate:
+                LOG_WARN("CommandHandler", "Duplicate messageId for " + commandName + ": " + messageId);
+                return;
+            case PendingRequests::AddResult::Full:
+                LOG_WARN("CommandHandler", "Too many requests in flight; rejecting " + commandName);
+                EventEmitter::emitCommandResponse(messageId, std::nullopt, "Too many requests in flight");
+                return;
+            case PendingRequests::AddResult::Added:
+                break;
+        }
+        {
+            // Wake the timer under its lock so the new deadline cannot slip past it.
+            std::lock_guard<std::mutex> lock(m_timerMutex);
+        }
+        m_timerCv.notify_one();
+
+        auto invoke = [handler = route.handler, payload, request]() {
+            if (request->IsCompleted()) return; // timed out or cancelled while queued
+            try {
+                handler(payload, request);
+            } catch (const std::exception& e) {
+                request->Reject(e.what());
+            }
+        };
+
+        if (!Dispatch(commandName, route.options.affinity, route.options.serialKey, std::move(invoke))) {
+            request->Reject("Shutting down");
+        }
+    }
+
+    bool CommandHandler::Dispatch(const std::string& commandName, CommandAffinity affinity, const std::string& serialKey, std::function<void()> task)
+    {
+        const bool onUiThread = affinity == CommandAffinity::UIThread;
+        auto timed = [this, commandName, onUiThread, task = std::move(task)]() {
+            auto start = std::chrono::steady_clock::now();
+            task();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            RecordExecution(commandName, elapsed, onUiThread);
+        };
+
+        switch (affinity) {
+            case CommandAffinity::AnyThread:
+                return m_workers->Submit(std::move(timed));
+            case CommandAffinity::Serialized:
+                return m_workers->SubmitSerialized(serialKey.empty() ? commandName : serialKey, std::move(timed));
+            case CommandAffinity::UIThread:
+            default:
+                timed();
+                return true;
+        }
+    }
+
+    void CommandHandler::RecordExecution(const std::string& commandName, long long durationUs, bool onUiThread)
+    {
+        static Metrics::Histogram& s_execUs = Metrics::GetHistogram("commands.exec_us");
+        static Metrics::Histogram& s_uiThreadUs = Metrics::GetHistogram("commands.ui_thread_us");
+        s_execUs.Record(durationUs);
+        if (onUiThread) s_uiThreadUs.Record(durationUs);
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            CommandStats& stats = m_stats[commandName];
+            stats.count++;
+            stats.totalUs += durationUs;
+            if (durationUs > stats.maxUs) stats.maxUs = durationUs;
+            if (onUiThread) {
+                m_uiThreadStats.count++;
+                m_uiThreadStats.totalUs += durationUs;
+                if (durationUs > m_uiThreadStats.maxUs) m_uiThreadStats.maxUs = durationUs;
+            }
+        }
+        if (onUiThread && durationUs > UI_BUDGET_US) {
+            LOG_WARN("CommandHandler", commandName + " blocked the UI thread for " + std::to_string(durationUs / 1000) + "ms.");
+        }
+    }
+
+    json CommandHandler::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        json commands = json::object();
+        for (const auto& [name, stats] : m_stats) {
+            commands[name] = { {"count", stats.count}, {"totalUs", stats.totalUs}, {"maxUs", stats.maxUs} };
+        }
+        return {
+            {"uiThread", { {"count", m_uiThreadStats.count}, {"totalUs", m_uiThreadStats.totalUs}, {"maxUs", m_uiThreadStats.maxUs} }},
+            {"workers", m_workers->GetThreadCount()},
+            {"steals", m_workers->GetStealCount()},
+            {"commands", commands}
+        };
+    }
+
+    void CommandHandler::TimeoutLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_timerMutex);
+        while (!m_stopping) {
+            std::optional<Request::Clock::time_point> next;
+            auto expired = m_pending->CollectExpired(Request::Clock::now(), next);
+            if (!expired.empty()) {
+                lock.unlock();
+                for (const auto& request : expired) request->Cancel("timed out");
+                lock.lock();
+                continue;
+            }
+            if (next) {
+                m_timerCv.wait_until(lock, *next);
+            } else {
+                m_timerCv.wait(lock);
+            }
+        }
+    }
+}
@@ -4,23 +4,139 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional> 
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
 #include "../types.h"
+#include "task_pool.h"
 
 namespace WebViewProtocol
 {
+    class PendingRequests;
+
+    // One in-flight request/response exchange. Exactly one of Resolve/Reject
+    // takes effect; later calls, and calls after a timeout or cancellation, are
+    // ignored. Safe to complete from any thread.
+    class Request
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        Request(std::string id, std::string command, Clock::time_point deadline, std::weak_ptr<PendingRequests> owner);
+
+        const std::string& GetId() const { return m_id; }
+        const std::string& GetCommand() const { return m_command; }
+        Clock::time_point GetDeadline() const { return m_deadline; }
+        bool IsCancelled() const { return m_cancelled.load(); }
+        bool IsCompleted() const { return m_completed.load(); }
+
+        void Resolve(const json& result);
+        void Reject(const std::string& error);
+        void Cancel(const std::string& reason);
+
+    private:
+        bool Complete(const std::optional<json>& result, const std::optional<std::string>& error);
+
+        std::string m_id;
+        std::string m_command;
+        Clock::time_point m_received;
+        Clock::time_point m_deadline;
+        std::weak_ptr<PendingRequests> m_owner;
+        std::atomic<bool> m_completed{false};
+        std::atomic<bool> m_cancelled{false};
+    };
+
+    using RequestHandle = std::shared_ptr<Request>;
+
+    // Where a handler runs. UIThread handlers run inline in WebMessageReceived
+    // and may touch WebView2 and window state. AnyThread handlers run on the
+    // task pool. Serialized handlers also run on the pool, but one at a time per
+    // key (the command name when no key is given). Pool handlers must not touch
+    // WebView2; their responses are marshalled by the EventEmitter.
+    enum class CommandAffinity { UIThread, AnyThread, Serialized };
+
+    struct CommandOptions {
+        CommandAffinity affinity = CommandAffinity::UIThread;
+        std::string serialKey;
+    };
+
+    constexpr std::chrono::milliseconds DEFAULT_REQUEST_TIMEOUT{10000};
+
+    // Registrations spell out every field, e.g.
+    // { CommandAffinity::AnyThread, DEFAULT_REQUEST_TIMEOUT, "" }, so the
+    // tree stays clean under -Wmissing-field-initializers.
+    struct RequestOptions {
+        CommandAffinity affinity = CommandAffinity::UIThread;
+        std::chrono::milliseconds timeout = DEFAULT_REQUEST_TIMEOUT;
+        std::string serialKey;
+    };
+
+    struct CommandStats {
+        unsigned long long count = 0;
+        long long totalUs = 0;
+        long long maxUs = 0;
+    };
+
     class CommandHandler
     {
     public:
         using CommandFunction = std::function<void(const json& payload, const std::optional<std::string>& messageId)>;
+        // Completes the request now or later through the handle. Throwing rejects it.
+        using RequestFunction = std::function<void(const json& payload, const RequestHandle& request)>;
+
+        static constexpr size_t MAX_IN_FLIGHT = 64;
+        // UI-thread handlers slower than this are logged; one frame at 60Hz is ~16ms.
+        static constexpr long long UI_BUDGET_US = 8000;
+
+        CommandHandler();
+        ~CommandHandler();
 
-        CommandHandler() = default;
-        void RegisterCommand(const std::string& commandName, CommandFunction handler);
+        // Fire-and-forget commands.
+        void RegisterCommand(const std::string& commandName, CommandFunction handler, CommandOptions options = {});
+        // Request/response commands. Without a messageId the result is discarded.
+        void RegisterRequest(const std::string& commandName, RequestFunction handler, RequestOptions options = {});
         void HandleCommand(const std::wstring& message);
+        bool HasHandler(const std::string& commandName) const;
+
+        // Per-command execution time plus the total spent inline on the UI thread.
+        json GetStats() const;
 
     private:
-        std::map<std::string, CommandFunction> m_commands;
+        struct CommandRoute {
+            CommandFunction handler;
+            CommandOptions options;
+        };
+
+        struct RequestRoute {
+            RequestFunction handler;
+            RequestOptions options;
+        };
+
+        void HandleRequest(const std::string& commandName, const RequestRoute& route, const json& payload, const std::string& messageId);
+        bool Dispatch(const std::string& commandName, CommandAffinity affinity, const std::string& serialKey, std::function<void()> task);
+        void RecordExecution(const std::string& commandName, long long durationUs, bool onUiThread);
+        void TimeoutLoop();
+
+        std::map<std::string, CommandRoute> m_commands;
+        std::map<std::string, RequestRoute> m_requests;
+        std::shared_ptr<PendingRequests> m_pending;
+
+        std::mutex m_timerMutex;
+        std::condition_variable m_timerCv;
+        bool m_stopping = false;
+        std::thread m_timerThread;
+
+        mutable std::mutex m_statsMutex;
+        std::map<std::string, CommandStats> m_stats;
+        CommandStats m_uiThreadStats;
+
+        // Declared last so workers are joined before the rest of the handler goes away.
+        std::unique_ptr<TaskPool> m_workers;
     };
 }
 
-#endif // COMMAND_HANDLER_H
\ No newline at end of file
+#endif // COMMAND_HANDLER_H
@@ -0,0 +1,160 @@
+#include "task_pool.h"
+#include "../../logger/logger.h"
+#include "../../metrics/metrics.h"
+
+namespace WebViewProtocol
+{
+    // The pool this thread works for and its index there, or null and -1
+    // elsewhere. Several pools can exist (every CommandHandler owns one), so an
+    // index only counts when it belongs to the pool being submitted to.
+    static thread_local const TaskPool* t_workerPool = nullptr;
+    static thread_local int t_workerIndex = -1;
+
+    TaskPool::TaskPool(size_t threadCount)
+    {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; i++) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < threadCount; i++) {
+            m_threads.emplace_back(&TaskPool::WorkerLoop, this, i);
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_sleepCv.notify_all();
+        for (auto& thread : m_threads) {
+            if (thread.joinable()) thread.join();
+        }
+    }
+
+    bool TaskPool::Submit(Task task)
+    {
+        if (m_stopping) return false;
+
+        // Tasks spawned by a worker stay on its own deque for locality.
+        size_t index = t_workerPool == this ? static_cast<size_t>(t_workerIndex)
+                                          : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        // Counted before it is visible: a worker may steal and finish the task
+        // before this thread runs again, and its decrement must not wrap.
+        m_queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleepCv.notify_one();
+        return true;
+    }
+
+    bool TaskPool::SubmitSerialized(const std::string& key, Task task)
+    {
+        if (m_stopping) return false;
+        std::lock_guard<std::mutex> lock(m_strandMutex);
+        Strand& strand = m_strands[key];
+        strand.tasks.push_back(std::move(task));
+        PublishStrandDepth(key, strand.tasks.size());
+        if (strand.scheduled) return true;
+        strand.scheduled = true;
+        return Submit([this, key]() { RunStrand(key); });
+    }
+
+    // Runs one task from the strand and re-queues the strand if more are
+    // waiting, so a busy key cannot monopolise a worker.
+    void TaskPool::RunStrand(const std::string& key)
+    {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(m_strandMutex);
+            auto it = m_strands.find(key);
+            if (it == m_strands.end() || it->second.tasks.empty()) {
+                if (it != m_strands.end()) m_strands.erase(it);
+                return;
+            }
+            task = std::move(it->second.tasks.front());
+            it->second.tasks.pop_front();
+            PublishStrandDepth(key, it->second.tasks.size());
+        }
+
+        RunGuarded(task);
+
+        std::lock_guard<std::mutex> lock(m_strandMutex);
+        auto it = m_strands.find(key);
+        if (it == m_strands.end()) return;
+        if (it->second.tasks.empty()) {
+            m_strands.erase(it);
+        } else if (!Submit([this, key]() { RunStrand(key); })) {
+            m_strands.erase(it);
+        }
+    }
+
+    void TaskPool::PublishStrandDepth(const std::string& key, size_t depth)
+    {
+        Metrics::Gauge*& gauge = m_strandDepthGauges[key];
+        if (!gauge) gauge = &Metrics::GetGauge("tasks.strand_depth." + key);
+        gauge->Set(static_cast<int64_t>(depth));
+    }
+
+    bool TaskPool::TryPop(size_t index, Task& task)
+    {
+        {
+            WorkerQueue& own = *m_queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < m_queues.size(); offset++) {
+            WorkerQueue& victim = *m_queues[(index + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TaskPool::RunGuarded(Task& task)
+    {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("TaskPool", "Task threw: " + std::string(e.what()));
+        } catch (...) {
+            LOG_ERROR("TaskPool", "Task threw an unknown exception.");
+        }
+    }
+
+    void TaskPool::WorkerLoop(size_t index)
+    {
+        t_workerPool = this;
+        t_workerIndex = static_cast<int>(index);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                m_sleepCv.wait(lock, [this] { return m_stopping || m_queued.load() > 0; });
+                if (m_stopping) return;
+            }
+            Task task;
+            if (!TryPop(index, task)) {
+                // Another worker took it between the wake-up and the pop.
+                std::this_thread::yield();
+                continue;
+            }
+            m_queued.fetch_sub(1);
+            RunGuarded(task);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <functional>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+namespace Metrics {
+    class Gauge;
+}
+
+namespace WebViewProtocol
+{
+    // Work-stealing pool for command handlers. Every worker owns a deque: it
+    // pops its own newest task, and when empty steals the oldest task from a
+    // sibling. Tasks submitted with a key run one at a time in submission order
+    // (a strand), while different keys still run in parallel. Tasks still queued
+    // at destruction are dropped; running ones are joined.
+    class TaskPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        explicit TaskPool(size_t threadCount);
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        bool Submit(Task task);
+        bool SubmitSerialized(const std::string& key, Task task);
+
+        size_t GetThreadCount() const { return m_threads.size(); }
+        unsigned long long GetStealCount() const { return m_steals.load(); }
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        struct Strand {
+            std::deque<Task> tasks;
+            bool scheduled = false;
+        };
+
+        void WorkerLoop(size_t index);
+        bool TryPop(size_t index, Task& task);
+        void RunStrand(const std::string& key);
+        // Publishes tasks.strand_depth.<key>; caller holds m_strandMutex.
+        void PublishStrandDepth(const std::string& key, size_t depth);
+        static void RunGuarded(Task& task);
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<size_t> m_nextQueue{0};
+        std::atomic<size_t> m_queued{0};
+        std::atomic<unsigned long long> m_steals{0};
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCv;
+        std::atomic<bool> m_stopping{false};
+
+        std::mutex m_strandMutex;
+        std::unordered_map<std::string, Strand> m_strands;
+        std::unordered_map<std::string, Metrics::Gauge*> m_strandDepthGauges;
+    };
+}
+
+#endif // TASK_POOL_H
@@ -1,7 +1,10 @@
 #include "event_emitter.h"
-#include "../../helpers/helpers.h"
 #include "../transport_constants.h"
-#include <wil/com.h>
+#include "outbound_queue.h"
+#include "../bridge_trace/bridge_trace.h"
+#include "../../metrics/metrics.h"
+#include <unordered_set>
+#include <atomic>
 #include "nlohmann/json.hpp"
 
 using json = nlohmann::json;
@@ -9,23 +12,84 @@ using json = nlohmann::json;
 
 namespace WebViewProtocol {
     namespace EventEmitter {
-        static wil::com_ptr<ICoreWebView2> g_webview;
-        static void emitEvent(const std::string& eventName, const json& payload) {
-            if (!g_webview) return;
+        static std::atomic<std::shared_ptr<EventTransport>> g_transport;
+
+        static OutboundQueue g_outbound;
+
+        // Messages posted per flush before yielding back to the message loop.
+        static const size_t FLUSH_BATCH_SIZE = 32;
+
+        // High-frequency playback properties; only the latest value matters.
+        static const std::unordered_set<std::string> TELEMETRY_PROPERTIES = {
+            "time-pos", "percent-pos", "demuxer-cache-time", "demuxer-cache-state", "cache-speed", "estimated-vf-fps"
+        };
+
+        static EventPriority PriorityFor(const std::string& eventName) {
+            if (eventName == Events::COMMAND_RESPONSE || eventName == Events::PLAYBACK_ERROR || eventName == Events::AUTH_RESULT) {
+                return EventPriority::Critical;
+            }
+            return EventPriority::State;
+        }
+
+        static void emitEvent(const std::string& eventName, const json& payload, EventPriority priority, const std::string& mergeKey = "") {
+            std::shared_ptr<EventTransport> transport = g_transport.load();
+            if (!transport) return;
             json eventMessage = {
                 {"event", eventName},
                 {"payload", payload}
             };
-            g_webview->PostWebMessageAsJson(Utf8ToWstring(eventMessage.dump()).c_str());
+            std::string body = eventMessage.dump();
+            static Metrics::Counter& s_emitted = Metrics::GetCounter("bridge.events_emitted");
+            s_emitted.Add();
+            BridgeRecorder::RecordEvent(body);
+            bool scheduleFlush = g_outbound.Push(priority, mergeKey, std::move(body));
+            // Only the dispatch thread may post; everything else is marshalled there.
+            if (!transport->IsDispatchThread()) {
+                if (scheduleFlush) transport->RequestFlush();
+                return;
+            }
+            FlushOutbound();
+        }
+
+        static void emitEvent(const std::string& eventName, const json& payload) {
+            emitEvent(eventName, payload, PriorityFor(eventName));
+        }
+
+        void SetTransport(std::shared_ptr<EventTransport> transport) {
+            g_transport.store(transport);
+            // Messages queued before the previous transport went away are sent
+            // through the new one.
+            if (transport && g_outbound.ScheduleIfPending()) transport->RequestFlush();
+        }
+
+        void FlushOutbound() {
+            std::shared_ptr<EventTransport> transport = g_transport.load();
+            if (!transport) {
+                // Keep the messages for the next transport, but let it schedule again.
+                g_outbound.CancelFlush();
+                return;
+            }
+            bool more = false;
+            std::vector<std::string> batch = g_outbound.PopBatch(FLUSH_BATCH_SIZE, more);
+            static Metrics::Counter& s_eventsOut = Metrics::GetCounter("bridge.events_out");
+            static Metrics::Counter& s_bytesOut = Metrics::GetCounter("bridge.bytes_out");
+            for (auto& message : batch) {
+                s_eventsOut.Add();
+                s_bytesOut.Add(message.size());
+                transport->Post(std::move(message));
+            }
+            // Yield to input and rendering between batches instead of draining a burst at once.
+            if (more) transport->RequestFlush();
         }
 
-        void SetWebViewInstance(ICoreWebView2* webview) {
-            g_webview = webview;
+        json GetOutboundStats() {
+            return g_outbound.GetStats();
         }
 
         void emitPropertyChange(const std::string &property, const json &value) {
             PropertyChangeEventPayload payload = {property, value};
-            emitEvent(Events::PROPERTY_CHANGE, json(payload));
+            EventPriority priority = TELEMETRY_PROPERTIES.count(property) ? EventPriority::Telemetry : EventPriority::State;
+            emitEvent(Events::PROPERTY_CHANGE, json(payload), priority, std::string(Events::PROPERTY_CHANGE) + ":" + property);
         }
 
         void emitPlaybackEnded() {
@@ -45,6 +109,33 @@ namespace WebViewProtocol {
             emitEvent(Events::UPDATE_AVAILABLE, {});
         }
 
+        void emitServerUrlChanged(const std::string& url) {
+            ServerStatusPayload payload = {true, url};
+            emitEvent(Events::SERVER_URL_CHANGED, json(payload));
+        }
+
+        void emitServerReady(const ServerReadyEventPayload& payload) {
+            emitEvent(Events::SERVER_READY, json(payload));
+        }
+
+        void emitPlaybackQos(const PlaybackQosEventPayload& payload) {
+            // Only the latest sample matters; an undelivered one is replaced, not queued.
+            emitEvent(Events::PLAYBACK_QOS, json(payload), EventPriority::Telemetry, Events::PLAYBACK_QOS);
+        }
+
+        void emitPlaybackQosReport(const PlaybackQosReportEventPayload& payload) {
+            emitEvent(Events::PLAYBACK_QOS_REPORT, json(payload));
+        }
+
+        void emitSpriteSheets(const SpriteSheetsEventPayload& payload) {
+            // Each update carries the whole index, so an undelivered one is replaced.
+            emitEvent(Events::SPRITE_SHEETS, json(payload), EventPriority::State, Events::SPRITE_SHEETS);
+        }
+
+        void emitChapterHints(const ChapterHintsEventPayload& payload) {
+            emitEvent(Events::CHAPTER_HINTS, json(payload), EventPriority::State, Events::CHAPTER_HINTS);
+        }
+
         void emitCommandResponse(const std::string& messageId, const std::optional<json>& result, const std::optional<std::string>& error) {
             json payload = {{"messageId", messageId}};
             if (result.has_value()) {
@@ -2,21 +2,47 @@
 #define EVENT_EMITTER_H
 
 #include <string>
-#include <WebView2.h>
+#include <memory>
 #include <optional>
 #include "../types.h"
 
 namespace WebViewProtocol {
+    // Delivers serialized events to the frontend. The app posts them through
+    // WebView2; headless hosts can record or discard them.
+    class EventTransport {
+    public:
+        virtual ~EventTransport() = default;
+        // True on the thread allowed to call Post().
+        virtual bool IsDispatchThread() const = 0;
+        // Called from any thread when events are queued; must arrange for
+        // EventEmitter::FlushOutbound() to run on the dispatch thread.
+        virtual void RequestFlush() = 0;
+        virtual void Post(std::string message) = 0;
+    };
+
     namespace EventEmitter {
-        void SetWebViewInstance(ICoreWebView2* webview); 
+        // Events emitted while no transport is set are dropped; ones already
+        // queued are kept and flushed through the next transport. Every emit
+        // holds its own reference, so clearing the transport while another
+        // thread is emitting cannot free it under that thread.
+        void SetTransport(std::shared_ptr<EventTransport> transport);
+        // Posts queued events; must run on the transport's dispatch thread.
+        void FlushOutbound();
+        json GetOutboundStats();
 
         void emitPropertyChange(const std::string &property, const json &value);
         void emitPlaybackEnded();
         void emitPlaybackError(const std::string &message);
         void emitAuthResult(const AuthResult& result);
         void emitUpdateAvailable();
+        void emitServerUrlChanged(const std::string& url);
+        void emitServerReady(const ServerReadyEventPayload& payload);
+        void emitPlaybackQos(const PlaybackQosEventPayload& payload);
+        void emitPlaybackQosReport(const PlaybackQosReportEventPayload& payload);
+        void emitSpriteSheets(const SpriteSheetsEventPayload& payload);
+        void emitChapterHints(const ChapterHintsEventPayload& payload);
         void emitCommandResponse(const std::string& messageId, const std::optional<json>& result, const std::optional<std::string>& error);
     }
 }
 
-#endif // EVENT_EMITTER_H
\ No newline at end of file
+#endif // EVENT_EMITTER_H
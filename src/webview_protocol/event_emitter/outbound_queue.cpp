@@ -0,0 +1,109 @@
+#include "outbound_queue.h"
+
+namespace WebViewProtocol
+{
+    bool OutboundQueue::Push(EventPriority priority, const std::string& mergeKey, std::string body)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t level = static_cast<size_t>(priority);
+        auto& queue = m_queues[level];
+        auto& counters = m_counters[level];
+        counters.enqueued++;
+
+        // A merged message moves to the tail, so it never overtakes events queued
+        // after the update it replaces. It keeps the original timestamp so latency
+        // reflects the oldest data.
+        if (priority != EventPriority::Critical && !mergeKey.empty()) {
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (it->mergeKey == mergeKey) {
+                    const Clock::time_point enqueued = it->enqueued;
+                    queue.erase(it);
+                    queue.push_back({ mergeKey, std::move(body), enqueued });
+                    counters.merged++;
+                    return false;
+                }
+            }
+        }
+
+        const size_t limit = priority == EventPriority::Telemetry ? MAX_TELEMETRY_DEPTH
+                           : priority == EventPriority::State ? MAX_STATE_DEPTH : 0;
+        if (limit && queue.size() >= limit) {
+            queue.pop_front();
+            counters.dropped++;
+        }
+
+        queue.push_back({ mergeKey, std::move(body), Clock::now() });
+        if (queue.size() > counters.peakDepth) counters.peakDepth = queue.size();
+
+        if (m_flushScheduled) return false;
+        m_flushScheduled = true;
+        return true;
+    }
+
+    std::vector<std::string> OutboundQueue::PopBatch(size_t maxMessages, bool& more)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> batch;
+        const auto now = Clock::now();
+
+        for (size_t level = 0; level < PRIORITY_COUNT && batch.size() < maxMessages; level++) {
+            auto& queue = m_queues[level];
+            auto& counters = m_counters[level];
+            while (!queue.empty() && batch.size() < maxMessages) {
+                long long latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(now - queue.front().enqueued).count();
+                counters.posted++;
+                counters.totalLatencyUs += latencyUs;
+                if (latencyUs > counters.maxLatencyUs) counters.maxLatencyUs = latencyUs;
+                batch.push_back(std::move(queue.front().body));
+                queue.pop_front();
+            }
+        }
+
+        more = false;
+        for (const auto& queue : m_queues) {
+            if (!queue.empty()) more = true;
+        }
+        m_flushScheduled = more;
+        return batch;
+    }
+
+    void OutboundQueue::CancelFlush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushScheduled = false;
+    }
+
+    bool OutboundQueue::ScheduleIfPending()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_flushScheduled) return false;
+        for (const auto& queue : m_queues) {
+            if (!queue.empty()) {
+                m_flushScheduled = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    nlohmann::json OutboundQueue::GetStats() const
+    {
+        static const char* names[PRIORITY_COUNT] = { "critical", "state", "telemetry" };
+        std::lock_guard<std::mutex> lock(m_mutex);
+        nlohmann::json stats = nlohmann::json::object();
+        for (size_t level = 0; level < PRIORITY_COUNT; level++) {
+            const auto& c = m_counters[level];
+            stats[names[level]] = {
+                {"depth", m_queues[level].size()},
+                {"peakDepth", c.peakDepth},
+                {"enqueued", c.enqueued},
+                {"merged", c.merged},
+                {"dropped", c.dropped},
+                {"posted", c.posted},
+                {"avgLatencyUs", c.posted ? c.totalLatencyUs / static_cast<long long>(c.posted) : 0},
+                {"maxLatencyUs", c.maxLatencyUs}
+            };
+        }
+        return stats;
+    }
+}
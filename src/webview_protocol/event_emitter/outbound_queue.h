@@ -0,0 +1,70 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include "nlohmann/json.hpp"
+
+namespace WebViewProtocol
+{
+    // Outbound events leave in this order. Critical messages (command responses,
+    // errors) are never merged or dropped. State messages carrying a merge key
+    // replace a queued message with the same key, taking the newest position in
+    // their level. Telemetry (progress ticks) is
+    // merged the same way and, when the renderer still falls behind, the oldest
+    // ticks are dropped.
+    enum class EventPriority { Critical = 0, State = 1, Telemetry = 2 };
+
+    class OutboundQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t PRIORITY_COUNT = 3;
+        static constexpr size_t MAX_STATE_DEPTH = 1024;
+        static constexpr size_t MAX_TELEMETRY_DEPTH = 64;
+
+        // Returns true when the queue was idle and the caller must schedule a flush.
+        bool Push(EventPriority priority, const std::string& mergeKey, std::string body);
+
+        // Pops up to maxMessages, highest priority first. Sets more when messages
+        // remain; otherwise the queue goes idle and the next Push schedules again.
+        std::vector<std::string> PopBatch(size_t maxMessages, bool& more);
+
+        // Marks the queue idle without popping, for a flush with nowhere to
+        // post; queued messages stay and the next Push schedules again.
+        void CancelFlush();
+        // Returns true when messages are waiting and no flush is scheduled; the
+        // caller must then schedule one.
+        bool ScheduleIfPending();
+
+        nlohmann::json GetStats() const;
+
+    private:
+        struct Entry {
+            std::string mergeKey;
+            std::string body;
+            Clock::time_point enqueued;
+        };
+
+        struct Counters {
+            unsigned long long enqueued = 0;
+            unsigned long long merged = 0;
+            unsigned long long dropped = 0;
+            unsigned long long posted = 0;
+            size_t peakDepth = 0;
+            long long totalLatencyUs = 0;
+            long long maxLatencyUs = 0;
+        };
+
+        mutable std::mutex m_mutex;
+        std::deque<Entry> m_queues[PRIORITY_COUNT];
+        Counters m_counters[PRIORITY_COUNT];
+        bool m_flushScheduled = false;
+    };
+}
+
+#endif // OUTBOUND_QUEUE_H
@@ -0,0 +1,76 @@
+#include "shared_buffer_channel.h"
+#include "../transport_constants.h"
+#include "../../logger/logger.h"
+#include "../../helpers/helpers.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+bool SharedBufferChannel::Attach(ICoreWebView2Environment* environment, ICoreWebView2* webview, std::string& error)
+{
+    if (!environment || !webview) { error = "WebView2 not initialized"; return false; }
+
+    auto env12 = wil::com_ptr<ICoreWebView2Environment>(environment).try_query<ICoreWebView2Environment12>();
+    auto webview17 = wil::com_ptr<ICoreWebView2>(webview).try_query<ICoreWebView2_17>();
+    if (!env12 || !webview17) { error = "WebView2 runtime does not support shared buffers"; return false; }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_attached = false;
+
+    if (!m_buffer) {
+        HRESULT hr = env12->CreateSharedBuffer(BUFFER_SIZE, &m_buffer);
+        if (FAILED(hr) || !m_buffer) {
+            m_buffer.reset();
+            error = "CreateSharedBuffer failed. HRESULT: " + std::to_string(hr);
+            return false;
+        }
+    }
+
+    BYTE* region = nullptr;
+    UINT64 size = 0;
+    if (FAILED(m_buffer->get_Buffer(&region)) || FAILED(m_buffer->get_Size(&size)) || !region) {
+        error = "Shared buffer is not mapped";
+        return false;
+    }
+
+    // A new generation lets the frontend drop descriptors still in flight from
+    // the previous document.
+    if (!m_writer.Attach(region, static_cast<size_t>(size), ++m_generation)) {
+        error = "Shared buffer too small";
+        return false;
+    }
+
+    json info = {
+        {"event", WebViewProtocol::Events::SHARED_BUFFER_ATTACHED},
+        {"payload", {{"generation", m_generation}, {"capacity", m_writer.Capacity()}, {"version", SharedRing::VERSION}}}
+    };
+    std::wstring additionalData = Utf8ToWstring(info.dump());
+    HRESULT hr = webview17->PostSharedBufferToScript(m_buffer.get(), COREWEBVIEW2_SHARED_BUFFER_ACCESS_READ_WRITE, additionalData.c_str());
+    if (FAILED(hr)) {
+        error = "PostSharedBufferToScript failed. HRESULT: " + std::to_string(hr);
+        return false;
+    }
+
+    m_attached = true;
+    LOG_INFO("SharedBufferChannel", "Shared buffer attached (generation " + std::to_string(m_generation) + ", " + std::to_string(m_writer.Capacity()) + " bytes).");
+    return true;
+}
+
+void SharedBufferChannel::Detach()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_attached = false;
+}
+
+bool SharedBufferChannel::IsAttached() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_attached;
+}
+
+std::optional<SharedRing::FrameDescriptor> SharedBufferChannel::Write(uint32_t type, const std::string& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_attached) return std::nullopt;
+    return m_writer.Write(type, data.data(), static_cast<uint32_t>(data.size()));
+}
@@ -0,0 +1,43 @@
+#ifndef SHARED_BUFFER_CHANNEL_H
+#define SHARED_BUFFER_CHANNEL_H
+
+#include <windows.h>
+#include <WebView2.h>
+#include <wil/com.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include "shared_ring.h"
+
+// Native-to-web bulk channel backed by a WebView2 shared buffer. Large event
+// payloads are written into a SharedRing and only a FrameDescriptor travels over
+// PostWebMessageAsJson. The frontend opts in with the attach-shared-buffer
+// command; until then, and whenever the ring is full, events use plain JSON.
+class SharedBufferChannel
+{
+public:
+    SharedBufferChannel() = default;
+
+    // Must run on the UI thread. Creates the buffer on first use, resets the
+    // ring under a new generation and hands the buffer to the current document.
+    bool Attach(ICoreWebView2Environment* environment, ICoreWebView2* webview, std::string& error);
+    void Detach();
+    bool IsAttached() const;
+
+    // Safe from any thread; returns nullopt when the caller must fall back.
+    std::optional<SharedRing::FrameDescriptor> Write(uint32_t type, const std::string& data);
+
+    // The ring takes the largest power of two that fits after the header, so
+    // the header is allocated on top of the capacity rather than out of it.
+    static constexpr uint32_t RING_CAPACITY = 4 * 1024 * 1024;
+    static constexpr UINT64 BUFFER_SIZE = SharedRing::HEADER_SIZE + RING_CAPACITY;
+
+private:
+    mutable std::mutex m_mutex;
+    wil::com_ptr<ICoreWebView2SharedBuffer> m_buffer;
+    SharedRing::Writer m_writer;
+    uint32_t m_generation = 0;
+    bool m_attached = false;
+};
+
+#endif // SHARED_BUFFER_CHANNEL_H
@@ -0,0 +1,138 @@
+#include "shared_ring.h"
+#include <atomic>
+#include <cstring>
+
+namespace SharedRing {
+    static uint32_t* Word(uint8_t* base, size_t index) {
+        return reinterpret_cast<uint32_t*>(base) + index;
+    }
+
+    static uint32_t LoadAcquire(uint8_t* base, size_t index) {
+        return std::atomic_ref<uint32_t>(*Word(base, index)).load(std::memory_order_acquire);
+    }
+
+    static void StoreRelease(uint8_t* base, size_t index, uint32_t value) {
+        std::atomic_ref<uint32_t>(*Word(base, index)).store(value, std::memory_order_release);
+    }
+
+    bool Writer::Attach(uint8_t* region, size_t size, uint32_t generation)
+    {
+        m_base = nullptr;
+        if (!region || size < HEADER_SIZE + 4096) return false;
+
+        uint32_t capacity = 4096;
+        while (static_cast<size_t>(capacity) * 2 + HEADER_SIZE <= size && capacity < (1u << 30)) capacity *= 2;
+
+        std::memset(region, 0, HEADER_SIZE);
+        *Word(region, HDR_MAGIC) = MAGIC;
+        *Word(region, HDR_VERSION) = VERSION;
+        *Word(region, HDR_CAPACITY) = capacity;
+        *Word(region, HDR_GENERATION) = generation;
+        StoreRelease(region, HDR_HEAD, 0);
+        StoreRelease(region, HDR_TAIL, 0);
+
+        m_base = region;
+        m_capacity = capacity;
+        m_generation = generation;
+        m_seq = 0;
+        m_head = 0;
+        m_tail = 0;
+        return true;
+    }
+
+    uint32_t Writer::LoadWord(size_t index) const { return LoadAcquire(m_base, index); }
+    void Writer::StoreWord(size_t index, uint32_t value) { StoreRelease(m_base, index, value); }
+
+    std::optional<uint32_t> Writer::LoadTail() const
+    {
+        // Counters are free-running, so "m_tail <= tail <= m_head" is checked as
+        // distances from m_tail.
+        const uint32_t tail = LoadWord(HDR_TAIL);
+        if (tail - m_tail > m_head - m_tail) return std::nullopt;
+        return tail;
+    }
+
+    uint32_t Writer::Used() const
+    {
+        if (!m_base) return 0;
+        return m_head - LoadTail().value_or(m_tail);
+    }
+
+    void Writer::WriteFrameHeader(uint32_t offset, uint32_t length, uint32_t type, uint32_t seq)
+    {
+        uint32_t* frame = reinterpret_cast<uint32_t*>(m_base + HEADER_SIZE + offset);
+        frame[0] = length;
+        frame[1] = type;
+        frame[2] = seq;
+        frame[3] = 0;
+    }
+
+    std::optional<FrameDescriptor> Writer::Write(uint32_t type, const void* data, uint32_t length)
+    {
+        if (!m_base || type == PADDING) return std::nullopt;
+        const uint32_t frameSize = AlignFrame(length);
+        if (frameSize > m_capacity) return std::nullopt;
+
+        const std::optional<uint32_t> tail = LoadTail();
+        if (!tail) return std::nullopt; // consumer wrote garbage into tail
+        m_tail = *tail;
+        const uint32_t head = m_head;
+        const uint32_t used = head - m_tail;
+
+        uint32_t offset = head & (m_capacity - 1);
+        uint32_t toEnd = m_capacity - offset;
+        uint32_t needed = frameSize <= toEnd ? frameSize : toEnd + frameSize;
+        if (needed > m_capacity - used) return std::nullopt;
+
+        uint32_t newHead = head;
+        if (frameSize > toEnd) {
+            WriteFrameHeader(offset, toEnd - FRAME_HEADER_SIZE, PADDING, 0);
+            newHead += toEnd;
+            offset = 0;
+        }
+
+        const uint32_t seq = ++m_seq;
+        WriteFrameHeader(offset, length, type, seq);
+        if (length) std::memcpy(m_base + HEADER_SIZE + offset + FRAME_HEADER_SIZE, data, length);
+        newHead += frameSize;
+        m_head = newHead;
+        StoreWord(HDR_HEAD, newHead);
+
+        return FrameDescriptor{ m_generation, HEADER_SIZE + offset + FRAME_HEADER_SIZE, length, seq, type };
+    }
+
+    bool Reader::IsValid() const
+    {
+        if (!m_base) return false;
+        uint32_t capacity = *Word(m_base, HDR_CAPACITY);
+        return *Word(m_base, HDR_MAGIC) == MAGIC && *Word(m_base, HDR_VERSION) == VERSION
+            && capacity >= 4096 && (capacity & (capacity - 1)) == 0;
+    }
+
+    std::optional<Frame> Reader::Read()
+    {
+        if (!IsValid()) return std::nullopt;
+        const uint32_t capacity = *Word(m_base, HDR_CAPACITY);
+        while (true) {
+            const uint32_t head = LoadAcquire(m_base, HDR_HEAD);
+            uint32_t tail = LoadAcquire(m_base, HDR_TAIL);
+            if (head == tail) return std::nullopt;
+
+            const uint32_t offset = tail & (capacity - 1);
+            const uint32_t* frame = reinterpret_cast<const uint32_t*>(m_base + HEADER_SIZE + offset);
+            const uint32_t length = frame[0];
+            const uint32_t type = frame[1];
+            if (type == PADDING) {
+                StoreRelease(m_base, HDR_TAIL, tail + (capacity - offset));
+                continue;
+            }
+            if (AlignFrame(length) > capacity - offset) return std::nullopt; // corrupt
+
+            Frame out{ type, frame[2], {} };
+            const uint8_t* payload = m_base + HEADER_SIZE + offset + FRAME_HEADER_SIZE;
+            out.payload.assign(payload, payload + length);
+            StoreRelease(m_base, HDR_TAIL, tail + AlignFrame(length));
+            return out;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef SHARED_RING_H
+#define SHARED_RING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Single-producer/single-consumer frame ring laid out in a caller-provided
+// memory region (a WebView2 shared buffer on Windows, any byte array
+// elsewhere). Nothing here depends on the platform so the framing can be
+// exercised on its own.
+//
+// Layout (all integers little-endian uint32):
+//   header: magic | version | capacity | generation | head | tail | 8 reserved
+//   data:   capacity bytes of frames, each 16-byte aligned:
+//           length | type | seq | reserved | payload[length] | pad
+//
+// head and tail are free-running byte counters; offsets are counter % capacity.
+// A frame never wraps: when it does not fit before the end of the data area a
+// padding frame (type PADDING) fills the remainder and the frame starts at 0.
+// The producer publishes head after the frame bytes; the consumer advances tail
+// once it has copied or finished with a frame. The writer keeps its own copy of
+// head and only trusts a tail that lies between the last tail it accepted and
+// head, so a consumer scribbling over the header cannot make it overwrite
+// frames that were never released.
+namespace SharedRing {
+    constexpr uint32_t MAGIC = 0x53524E47; // "SRNG"
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t HEADER_SIZE = 64;
+    constexpr uint32_t FRAME_HEADER_SIZE = 16;
+    constexpr uint32_t FRAME_ALIGN = 16; // keeps room for a padding header before the end
+    constexpr uint32_t PADDING = 0xFFFFFFFF;
+    constexpr uint32_t FRAME_JSON_EVENT = 1; // payload is a UTF-8 {"event","payload"} message
+
+    // Word offsets into the header.
+    constexpr size_t HDR_MAGIC = 0;
+    constexpr size_t HDR_VERSION = 1;
+    constexpr size_t HDR_CAPACITY = 2;
+    constexpr size_t HDR_GENERATION = 3;
+    constexpr size_t HDR_HEAD = 4;
+    constexpr size_t HDR_TAIL = 5;
+
+    // Small message that tells the consumer where a frame lives.
+    struct FrameDescriptor {
+        uint32_t generation;
+        uint32_t offset;   // byte offset of the payload from the start of the region
+        uint32_t length;
+        uint32_t seq;
+        uint32_t type;
+    };
+
+    struct Frame {
+        uint32_t type;
+        uint32_t seq;
+        std::vector<uint8_t> payload;
+    };
+
+    class Writer {
+    public:
+        Writer() = default;
+        // Formats the header in place. The data capacity is the largest power of
+        // two that fits after the header; regions smaller than 4KB are rejected.
+        bool Attach(uint8_t* region, size_t size, uint32_t generation);
+        bool IsAttached() const { return m_base != nullptr; }
+        uint32_t Capacity() const { return m_capacity; }
+        uint32_t Generation() const { return m_generation; }
+
+        // Bytes the consumer has not released yet.
+        uint32_t Used() const;
+        // Copies a frame into the ring. Returns nullopt when the consumer has not
+        // released enough space or published an invalid tail; callers fall back
+        // to the regular path.
+        std::optional<FrameDescriptor> Write(uint32_t type, const void* data, uint32_t length);
+
+    private:
+        uint32_t LoadWord(size_t index) const;
+        void StoreWord(size_t index, uint32_t value);
+        void WriteFrameHeader(uint32_t offset, uint32_t length, uint32_t type, uint32_t seq);
+        // The consumer's tail when it is within [m_tail, m_head]; nullopt otherwise.
+        std::optional<uint32_t> LoadTail() const;
+
+        uint8_t* m_base = nullptr;
+        uint32_t m_capacity = 0;
+        uint32_t m_generation = 0;
+        uint32_t m_seq = 0;
+        uint32_t m_head = 0;   // authoritative; the shared word is only published
+        uint32_t m_tail = 0;   // last tail accepted from the consumer
+    };
+
+    // Consumer side; the frontend implements the same steps in script.
+    class Reader {
+    public:
+        explicit Reader(uint8_t* region) : m_base(region) {}
+        bool IsValid() const;
+        // Pops the next frame, skipping padding. Returns nullopt when empty.
+        std::optional<Frame> Read();
+
+    private:
+        uint8_t* m_base;
+    };
+
+    constexpr uint32_t AlignFrame(uint32_t length) {
+        return (FRAME_HEADER_SIZE + length + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+    }
+}
+
+#endif // SHARED_RING_H
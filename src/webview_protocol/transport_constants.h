@@ -17,6 +17,18 @@ namespace WebViewProtocol {
         constexpr const char* NAVIGATE = "navigate";
         constexpr const char* UPDATE_INSTALL = "update-install";
         constexpr const char* GET_SETTING = "get-setting";
+        constexpr const char* WAIT_SERVER_READY = "wait-server-ready";
+        constexpr const char* GET_SERVER_STATS = "get-server-stats";
+        constexpr const char* DUMP_STARTUP_TRACE = "dump-startup-trace";
+        constexpr const char* ATTACH_SHARED_BUFFER = "attach-shared-buffer";
+        constexpr const char* CANCEL_REQUEST = "cancel-request";
+        constexpr const char* GET_COMMAND_STATS = "get-command-stats";
+        constexpr const char* GET_EVENT_STATS = "get-event-stats";
+        constexpr const char* GET_METRICS = "get-metrics";
+        constexpr const char* GET_THUMBNAIL = "get-thumbnail";
+        constexpr const char* GET_SPRITE_SHEETS = "get-sprite-sheets";
+        constexpr const char* GET_SPRITE_SHEET = "get-sprite-sheet";
+        constexpr const char* GET_CHAPTER_HINTS = "get-chapter-hints";
     }
 
     namespace Events {
@@ -26,6 +38,14 @@ namespace WebViewProtocol {
         constexpr const char* PLAYBACK_ERROR = "playback-error";
         constexpr const char* AUTH_RESULT = "auth-result";
         constexpr const char* UPDATE_AVAILABLE = "update-available";
+        constexpr const char* SERVER_URL_CHANGED = "server-url-changed";
+        constexpr const char* SERVER_READY = "server-ready";
+        constexpr const char* SHARED_BUFFER_ATTACHED = "shared-buffer-attached";
+        constexpr const char* SHARED_FRAME = "shared-frame";
+        constexpr const char* PLAYBACK_QOS = "playback-qos";
+        constexpr const char* PLAYBACK_QOS_REPORT = "playback-qos-report";
+        constexpr const char* SPRITE_SHEETS = "sprite-sheets";
+        constexpr const char* CHAPTER_HINTS = "chapter-hints";
     }
 }
 
@@ -29,8 +29,10 @@ namespace WebViewProtocol
     {
         std::string url;
         double startTime = 0.0;
+        // Optional; episodes sharing it are matched for intro and credits ranges.
+        std::string seriesId;
     };
-    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlayPayload, url, startTime)
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(PlayPayload, url, startTime, seriesId)
 
     struct SeekPayload
     {
@@ -57,6 +59,12 @@ namespace WebViewProtocol
     };
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(LoadSubtitlePayload, url)
 
+    struct WaitServerReadyPayload
+    {
+        int timeoutMs = 15000;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(WaitServerReadyPayload, timeoutMs)
+
     //================================================================
     // OUTGOING EVENTS (From C++ -> Frontend)
     //================================================================
@@ -74,6 +82,155 @@ namespace WebViewProtocol
     };
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlaybackErrorEventPayload, message)
 
+    struct ServerStatusPayload
+    {
+        bool ready;
+        std::string url;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ServerStatusPayload, ready, url)
+
+    struct ServerReadyEventPayload
+    {
+        std::string url;
+        long long listeningMs;
+        long long firstResponseMs;
+        int attempts;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ServerReadyEventPayload, url, listeningMs, firstResponseMs, attempts)
+
+    struct SharedFrameEventPayload
+    {
+        uint32_t generation;
+        uint32_t offset;
+        uint32_t length;
+        uint32_t seq;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(SharedFrameEventPayload, generation, offset, length, seq)
+
+    // Live playback health, sent periodically when QoS live events are enabled.
+    struct PlaybackQosEventPayload
+    {
+        std::string state;
+        double timePos = 0.0;
+        double cacheSec = 0.0;
+        long long cacheSpeed = 0;  // bytes/s
+        long long droppedFrames = 0;
+        long long decoderDroppedFrames = 0;
+        double avsyncMs = 0.0;
+        int rebuffers = 0;
+        int stalls = 0;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlaybackQosEventPayload, state, timePos, cacheSec, cacheSpeed,
+        droppedFrames, decoderDroppedFrames, avsyncMs, rebuffers, stalls)
+
+    // Summary of one loaded file, sent when it ends.
+    struct PlaybackQosReportEventPayload
+    {
+        std::string url;
+        std::string endReason;
+        double wallSec = 0.0;
+        double playedSec = 0.0;
+        long long startupMs = -1;  // -1 if playback never started
+        int rebuffers = 0;
+        double rebufferSec = 0.0;
+        double longestRebufferSec = 0.0;
+        int stalls = 0;
+        double stallSec = 0.0;
+        double seekWaitSec = 0.0;
+        double rebufferRatio = 0.0;  // (rebuffer + stall) / (played + rebuffer + stall)
+        long long droppedFrames = 0;
+        long long decoderDroppedFrames = 0;
+        double meanCacheSec = 0.0;
+        double minCacheSec = 0.0;
+        int lowCacheSamples = 0;
+        double meanCacheSpeed = 0.0;  // bytes/s
+        double meanAvsyncMs = 0.0;
+        double maxAvsyncMs = 0.0;
+        int samples = 0;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlaybackQosReportEventPayload, url, endReason, wallSec, playedSec, startupMs,
+        rebuffers, rebufferSec, longestRebufferSec, stalls, stallSec, seekWaitSec, rebufferRatio,
+        droppedFrames, decoderDroppedFrames, meanCacheSec, minCacheSec, lowCacheSamples, meanCacheSpeed,
+        meanAvsyncMs, maxAvsyncMs, samples)
+
+    // Seekbar preview for the file being played.
+    struct GetThumbnailPayload
+    {
+        double time = 0.0;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(GetThumbnailPayload, time)
+
+    struct ThumbnailPayload
+    {
+        double time = 0.0;       // position the frame was taken at
+        double bucketStart = 0.0;
+        double bucketSec = 0.0;  // every time in [bucketStart, bucketStart + bucketSec) maps to this image
+        int width = 0;
+        int height = 0;
+        std::string mime;
+        std::string data;        // base64
+        bool cached = false;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ThumbnailPayload, time, bucketStart, bucketSec, width, height, mime, data, cached)
+
+    // Sprite sheets covering the whole file being played, sent whenever more
+    // of it is available. Cue payloads in vtt are "sheet-N.jpg#xywh=x,y,w,h";
+    // fetch sheet N with get-sprite-sheet.
+    struct SpriteSheetsEventPayload
+    {
+        std::string hash;          // identifies the file's content
+        double duration = 0.0;
+        double intervalSec = 0.0;  // time covered by one tile
+        int tileWidth = 0;
+        int tileHeight = 0;
+        int columns = 0;
+        int rows = 0;
+        int tiles = 0;             // tiles available, from the start of the file
+        int sheets = 0;
+        bool complete = false;
+        std::string vtt;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(SpriteSheetsEventPayload, hash, duration, intervalSec, tileWidth, tileHeight,
+        columns, rows, tiles, sheets, complete, vtt)
+
+    struct GetSpriteSheetPayload
+    {
+        std::string hash;
+        int sheet = 0;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(GetSpriteSheetPayload, hash, sheet)
+
+    struct SpriteSheetPayload
+    {
+        std::string hash;
+        int sheet = 0;
+        std::string mime;
+        std::string data;  // base64
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(SpriteSheetPayload, hash, sheet, mime, data)
+
+    struct ChapterHint
+    {
+        std::string kind;   // "intro" or "credits"
+        std::string title;
+        double start = 0.0;
+        double end = 0.0;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ChapterHint, kind, title, start, end)
+
+    // Skippable ranges of the file being played, found by matching its audio
+    // with other episodes of its series. Sent with cached ranges right after
+    // the file starts and again once it was analyzed; complete is set when
+    // nothing more will be found for it.
+    struct ChapterHintsEventPayload
+    {
+        std::string series;
+        std::string hash;   // identifies the file's content
+        bool complete = false;
+        std::vector<ChapterHint> chapters;
+    };
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ChapterHintsEventPayload, series, hash, complete, chapters)
+
 } // namespace WebViewProtocol
 
 #endif // WEBVIEW_PROTOCOL_TYPES_H
\ No newline at end of file
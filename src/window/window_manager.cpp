@@ -6,6 +6,9 @@
 #include "../mpv/mpv_manager.h"
 #include "../webview/webview_manager.h"
 #include "../updater/updater_manager.h"
+#include "../webview_protocol/event_emitter/event_emitter.h"
+#include "../tracer/tracer.h"
+#include "../tracer/startup_report.h"
 #include <windowsx.h>
 #include <gdiplus.h>
 #include <dwmapi.h>
@@ -60,8 +63,12 @@ bool WindowManager::Create(int nCmdShow) {
     
     const auto& settings = m_appManager->GetSettings();
     if (settings.hasSavedWindowPlacement) {
-        SetWindowPlacement(m_hWnd, &settings.windowPlacement);
-        ShowWindow(m_hWnd, settings.windowPlacement.showCmd);
+        const auto& saved = settings.windowPlacement;
+        WINDOWPLACEMENT wp = { sizeof(wp) };
+        wp.showCmd = saved.showCmd;
+        wp.rcNormalPosition = { saved.left, saved.top, saved.right, saved.bottom };
+        SetWindowPlacement(m_hWnd, &wp);
+        ShowWindow(m_hWnd, saved.showCmd);
     } else {
         ShowWindow(m_hWnd, nCmdShow);
     }
@@ -104,6 +111,7 @@ LRESULT WindowManager::MemberWndProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 
     case WM_POST_INITIALIZE:
     {
+        TRACE_SCOPE("WM_POST_INITIALIZE");
         if (m_appManager) {
             m_appManager->InitializeManagers();
         }
@@ -111,6 +119,7 @@ LRESULT WindowManager::MemberWndProc(HWND hWnd, UINT message, WPARAM wParam, LPA
     }
     case WM_NAVIGATE_READY: {
         auto* url = reinterpret_cast<std::wstring*>(lParam);
+        Tracer::Instant("WM_NAVIGATE_READY");
         if (url) {
             LOG_INFO("WindowManager", "Received navigation request for: " + WStringToUtf8(*url));
             m_appManager->GetWebViewManager()->Navigate(*url);
@@ -118,6 +127,9 @@ LRESULT WindowManager::MemberWndProc(HWND hWnd, UINT message, WPARAM wParam, LPA
         }
         return 0;
     }
+    case WM_POST_WEB_MESSAGE:
+        WebViewProtocol::EventEmitter::FlushOutbound();
+        return 0;
     case WM_SIZE:
         if (m_appManager->GetWebViewManager()) m_appManager->GetWebViewManager()->Resize();
         if (m_hSplash) SetWindowPos(m_hSplash, nullptr, 0, 0, LOWORD(lParam), HIWORD(lParam), SWP_NOZORDER);
@@ -195,6 +207,7 @@ void WindowManager::ShowTrayMenu()
 
 void WindowManager::OnFrontendReady()
 {
+    StartupReport::Mark("FRONTEND_READY");
     HideSplashScreen();
     LOG_INFO("WindowManager", "Frontend is ready. Hiding splash screen.");
 }
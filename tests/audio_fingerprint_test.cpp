@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "mpv/audio_fingerprint.h"
+
+static constexpr int RATE = AudioFingerprinter::SAMPLE_RATE;
+
+// Chords changing every quarter second over light noise, like music.
+static std::vector<int16_t> Music(unsigned seed, int seconds)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> note(200, 2000);
+    std::normal_distribution<double> noise(0.0, 1500.0);
+    std::vector<int16_t> audio;
+    double frequency[3] = {};
+    for (int n = 0; n < RATE * seconds; n++) {
+        if (n % (RATE / 4) == 0) for (double& f : frequency) f = note(rng);
+        double value = noise(rng);
+        for (double f : frequency) value += 6000.0 * std::sin(2.0 * 3.14159265358979 * f * n / RATE);
+        audio.push_back(static_cast<int16_t>((std::max)(-32767.0, (std::min)(32767.0, value))));
+    }
+    return audio;
+}
+
+// seconds of noise with shared copied in at sample `at`, slightly disturbed.
+static std::vector<int16_t> Episode(unsigned seed, int seconds, const std::vector<int16_t>& shared, size_t at)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 4000.0);
+    std::vector<int16_t> audio(static_cast<size_t>(RATE) * seconds);
+    for (size_t n = 0; n < audio.size(); n++) {
+        double value = noise(rng);
+        if (n >= at && n - at < shared.size()) value = shared[n - at] + value * 0.05;
+        audio[n] = static_cast<int16_t>((std::max)(-32767.0, (std::min)(32767.0, value)));
+    }
+    return audio;
+}
+
+TEST(AudioFingerprinter, HashesOncePerHopAfterTheFirstFrame)
+{
+    AudioFingerprinter fingerprinter;
+    const std::vector<int16_t> audio = Music(1, 4);
+    EXPECT_EQ(fingerprinter.Compute(audio.data(), audio.size()).size(), (audio.size() - AudioFingerprinter::FRAME_SIZE) / AudioFingerprinter::HOP_SIZE);
+    EXPECT_TRUE(fingerprinter.Compute(audio.data(), AudioFingerprinter::FRAME_SIZE + AudioFingerprinter::HOP_SIZE - 1).empty());
+}
+
+TEST(AudioFingerprinter, SameAudioGivesTheSameHashes)
+{
+    AudioFingerprinter fingerprinter;
+    const std::vector<int16_t> audio = Music(2, 10);
+    const std::vector<uint32_t> first = fingerprinter.Compute(audio.data(), audio.size());
+    const std::vector<uint32_t> second = fingerprinter.Compute(audio.data(), audio.size());
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(AudioFingerprinter::CountMatches(first.data(), second.data(), first.size()), first.size());
+}
+
+TEST(AudioFingerprinter, VectorAndScalarMatchCountsAgree)
+{
+    AudioFingerprinter fingerprinter;
+    const std::vector<int16_t> music = Music(3, 20);
+    const std::vector<int16_t> noisy = Episode(4, 20, music, 0);
+    const std::vector<uint32_t> a = fingerprinter.Compute(music.data(), music.size());
+    const std::vector<uint32_t> b = fingerprinter.Compute(noisy.data(), noisy.size());
+    // Odd lengths exercise the tail after the vector loop.
+    for (size_t count : { size_t(0), size_t(1), size_t(7), a.size() - 3, a.size() }) {
+        EXPECT_EQ(AudioFingerprinter::CountMatches(a.data(), b.data(), count),
+                  AudioFingerprinter::CountMatchesScalar(a.data(), b.data(), count)) << "count " << count;
+    }
+}
+
+TEST(AudioFingerprinter, FindsSharedAudioAtItsOffset)
+{
+    AudioFingerprinter fingerprinter;
+    const std::vector<int16_t> intro = Music(5, 30);
+    // Hop-misaligned in the second episode, as real intros are.
+    const size_t atA = 10 * RATE;
+    const size_t atB = 25 * RATE + 301;
+    const std::vector<int16_t> first = Episode(6, 60, intro, atA);
+    const std::vector<int16_t> second = Episode(7, 60, intro, atB);
+    const std::vector<uint32_t> a = fingerprinter.Compute(first.data(), first.size());
+    const std::vector<uint32_t> b = fingerprinter.Compute(second.data(), second.size());
+
+    const int minLength = static_cast<int>(15.0 / AudioFingerprinter::HASH_SEC);
+    auto segment = AudioFingerprinter::FindSharedSegment(a, b, minLength);
+    ASSERT_TRUE(segment.has_value());
+
+    const double hop = AudioFingerprinter::HOP_SIZE;
+    EXPECT_NEAR(segment->bStart - segment->aStart, (atB - atA) / hop, 1.0);
+    EXPECT_NEAR(segment->aStart * AudioFingerprinter::HASH_SEC, 10.0, 1.0);
+    EXPECT_NEAR(segment->length * AudioFingerprinter::HASH_SEC, 30.0, 2.0);
+    EXPECT_GE(segment->matches, segment->length * 8 / 10);
+}
+
+TEST(AudioFingerprinter, FindsNothingInUnrelatedAudio)
+{
+    AudioFingerprinter fingerprinter;
+    const std::vector<int16_t> first = Music(8, 40);
+    const std::vector<int16_t> second = Music(9, 40);
+    const std::vector<uint32_t> a = fingerprinter.Compute(first.data(), first.size());
+    const std::vector<uint32_t> b = fingerprinter.Compute(second.data(), second.size());
+    EXPECT_FALSE(AudioFingerprinter::FindSharedSegment(a, b, static_cast<int>(15.0 / AudioFingerprinter::HASH_SEC)).has_value());
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include "mpv/cache_policy.h"
+
+static constexpr uint64_t MiB = 1ull << 20;
+static constexpr uint64_t GiB = 1ull << 30;
+
+static Platform::MemoryStatus Memory(uint64_t total, uint64_t available)
+{
+    Platform::MemoryStatus memory;
+    memory.totalBytes = total;
+    memory.availableBytes = available;
+    return memory;
+}
+
+struct CacheCase {
+    const char* name;
+    uint64_t totalBytes;
+    uint64_t availableBytes;
+    double bitrate;
+    bool network;
+    uint64_t maxBytes;
+    uint64_t maxBackBytes;
+    double readaheadSecs;
+};
+
+class CachePolicyDecide : public ::testing::TestWithParam<CacheCase> {};
+
+TEST_P(CachePolicyDecide, SizesTheCacheForBitrateAndMemory)
+{
+    const CacheCase& c = GetParam();
+    const CachePolicy::Decision decision = CachePolicy::Decide(Memory(c.totalBytes, c.availableBytes), c.bitrate, c.network);
+    EXPECT_EQ(decision.maxBytes, c.maxBytes);
+    EXPECT_EQ(decision.maxBackBytes, c.maxBackBytes);
+    EXPECT_EQ(decision.readaheadSecs, c.readaheadSecs);
+    EXPECT_EQ(decision.cacheSecs, decision.readaheadSecs);
+
+    // Whatever the inputs, the seconds asked for fit in the forward bytes.
+    const double bitrate = c.bitrate > 0.0 ? c.bitrate : CachePolicy::UNKNOWN_BITRATE;
+    if (decision.readaheadSecs > CachePolicy::MIN_READAHEAD_SECS) {
+        EXPECT_LE(decision.readaheadSecs * bitrate * CachePolicy::BITRATE_HEADROOM, static_cast<double>(decision.maxBytes));
+    }
+}
+
+// 16 GiB with half free gives a 2 GiB budget: 1.5 GiB forward at most.
+INSTANTIATE_TEST_SUITE_P(Pairs, CachePolicyDecide, ::testing::Values(
+    CacheCase{ "Network2MiBPlentyOfMemory", 16 * GiB, 8 * GiB, 2.0 * MiB, true, 750 * MiB, 375 * MiB, 300.0 },
+    CacheCase{ "Network10MiBHitsTheForwardCap", 16 * GiB, 8 * GiB, 10.0 * MiB, true, 1536 * MiB, 512 * MiB, 122.0 },
+    CacheCase{ "Local2MiBNeedsOnlyThirtySeconds", 16 * GiB, 8 * GiB, 2.0 * MiB, false, 75 * MiB, 37 * MiB + MiB / 2, 30.0 },
+    CacheCase{ "UnknownBitrateAssumesARemux", 16 * GiB, 8 * GiB, 0.0, true, 937 * MiB + MiB / 2, 468 * MiB + 3 * MiB / 4, 300.0 },
+    CacheCase{ "LowMemoryKeepsTheMinimumBudget", 2 * GiB, 100 * MiB, 2.0 * MiB, true, 36 * MiB, 12 * MiB, 14.0 },
+    CacheCase{ "LowBitrateKeepsTheMinimumForward", 16 * GiB, 8 * GiB, 0.05 * MiB, false, 32 * MiB, 16 * MiB, 30.0 },
+    CacheCase{ "UnreadableMemoryUsesTheFallback", 0, 0, 2.0 * MiB, true, 192 * MiB, 64 * MiB, 76.0 },
+    CacheCase{ "HugeMachineStopsAtTheMaximumBudget", 256 * GiB, 200 * GiB, 50.0 * MiB, true, 3 * GiB, 1 * GiB, 49.0 }
+), [](const ::testing::TestParamInfo<CacheCase>& info) { return std::string(info.param.name); });
+
+TEST(CachePolicy, FirstEvaluationAlwaysDecides)
+{
+    CachePolicy policy;
+    policy.Begin(true);
+    EXPECT_TRUE(policy.Evaluate(Memory(16 * GiB, 8 * GiB)).has_value());
+    EXPECT_FALSE(policy.GetLastReason().empty());
+    EXPECT_FALSE(policy.Evaluate(Memory(16 * GiB, 8 * GiB)).has_value());
+
+    policy.Begin(true);
+    EXPECT_TRUE(policy.Evaluate(Memory(16 * GiB, 8 * GiB)).has_value());
+}
+
+TEST(CachePolicy, SmallChangesAreNotApplied)
+{
+    CachePolicy policy;
+    policy.Begin(true);
+    policy.SetContainerBitrate(2.0 * MiB);
+    ASSERT_TRUE(policy.Evaluate(Memory(16 * GiB, 8 * GiB)).has_value());
+
+    policy.SetContainerBitrate(2.2 * MiB);
+    EXPECT_FALSE(policy.Evaluate(Memory(16 * GiB, 8 * GiB)).has_value());
+
+    policy.SetContainerBitrate(3.0 * MiB);
+    auto decision = policy.Evaluate(Memory(16 * GiB, 8 * GiB));
+    ASSERT_TRUE(decision.has_value());
+    EXPECT_GT(decision->maxBytes, 750 * MiB);
+}
+
+TEST(CachePolicy, LowMemoryShrinksEvenByALittle)
+{
+    // Budgets from free memory: a 10% drop shrinks every limit by 10%.
+    CachePolicy plenty;
+    plenty.Begin(true);
+    plenty.SetContainerBitrate(2.0 * MiB);
+    ASSERT_TRUE(plenty.Evaluate(Memory(16 * GiB, 2000 * MiB)).has_value());
+    EXPECT_FALSE(plenty.Evaluate(Memory(16 * GiB, 1800 * MiB)).has_value());
+
+    // Below LOW_MEMORY_SHARE of the total the same drop is applied.
+    CachePolicy scarce;
+    scarce.Begin(true);
+    scarce.SetContainerBitrate(2.0 * MiB);
+    auto first = scarce.Evaluate(Memory(4 * GiB, 300 * MiB));
+    ASSERT_TRUE(first.has_value());
+    auto shrunk = scarce.Evaluate(Memory(4 * GiB, 270 * MiB));
+    ASSERT_TRUE(shrunk.has_value());
+    EXPECT_LT(shrunk->maxBytes, first->maxBytes);
+}
+
+TEST(CachePolicy, SizesForTheHigherOfContainerAndObservedBitrate)
+{
+    CachePolicy policy;
+    policy.Begin(true);
+    EXPECT_EQ(policy.GetEffectiveBitrate(), 0.0);
+
+    policy.SetContainerBitrate(2.0 * MiB);
+    policy.ObserveBitrate(1.0 * MiB);
+    EXPECT_DOUBLE_EQ(policy.GetEffectiveBitrate(), 2.0 * MiB);
+
+    // The observed rate is smoothed: one peak moves it by BITRATE_SMOOTHING.
+    policy.ObserveBitrate(11.0 * MiB);
+    EXPECT_DOUBLE_EQ(policy.GetEffectiveBitrate(), 4.0 * MiB);
+
+    policy.ObserveBitrate(0.0);
+    policy.SetContainerBitrate(-1.0);
+    EXPECT_DOUBLE_EQ(policy.GetEffectiveBitrate(), 4.0 * MiB);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "updater/delta_patch.h"
+
+namespace fs = std::filesystem;
+
+struct Control {
+    int64_t addLen;
+    int64_t extraLen;
+    int64_t seek;
+};
+
+// Writes patches in the STRDIFF1 layout, taking diff bytes against `old`.
+class PatchWriter
+{
+public:
+    explicit PatchWriter(int64_t newSize) { m_data.assign("STRDIFF1", 8); Int64(newSize); }
+
+    void Record(const std::string& old, int64_t& oldPos, const std::string& target, int64_t& newPos, Control control)
+    {
+        Int64(control.addLen);
+        Int64(control.extraLen);
+        Int64(control.seek);
+        for (int64_t i = 0; i < control.addLen; i++) {
+            const char base = oldPos + i < static_cast<int64_t>(old.size()) ? old[static_cast<size_t>(oldPos + i)] : 0;
+            m_data += static_cast<char>(target[static_cast<size_t>(newPos + i)] - base);
+        }
+        m_data.append(target, static_cast<size_t>(newPos + control.addLen), static_cast<size_t>(control.extraLen));
+        oldPos += control.addLen + control.seek;
+        newPos += control.addLen + control.extraLen;
+    }
+
+    // A control triple followed by whatever bytes are given, unchecked.
+    void Raw(Control control, const std::string& payload = {})
+    {
+        Int64(control.addLen);
+        Int64(control.extraLen);
+        Int64(control.seek);
+        m_data += payload;
+    }
+
+    const std::string& Data() const { return m_data; }
+
+private:
+    void Int64(int64_t value)
+    {
+        for (int i = 0; i < 8; i++) m_data += static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+    }
+
+    std::string m_data;
+};
+
+class DeltaPatchTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_dir = fs::temp_directory_path() / ("stremato-delta-" + std::to_string(std::random_device()()));
+        fs::create_directories(m_dir);
+    }
+    void TearDown() override { fs::remove_all(m_dir); }
+
+    static void WriteFile(const fs::path& path, const std::string& data)
+    {
+        std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    static std::string ReadFile(const fs::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    bool Apply(const std::string& old, const std::string& patch, std::string& result, std::string& error)
+    {
+        WriteFile(m_dir / "old", old);
+        WriteFile(m_dir / "patch", patch);
+        if (!DeltaPatch::Apply(m_dir / "old", m_dir / "patch", m_dir / "new", error)) return false;
+        result = ReadFile(m_dir / "new");
+        return true;
+    }
+
+    fs::path m_dir;
+};
+
+static std::string RandomBytes(size_t size, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::string bytes(size, '\0');
+    for (char& c : bytes) c = static_cast<char>(rng());
+    return bytes;
+}
+
+TEST_F(DeltaPatchTest, RoundTripsEditsInsertionsAndSeeks)
+{
+    const std::string old = RandomBytes(200000, 1);
+    // Edited start, an inserted block, a skipped block, and a tail past the old file.
+    std::string target = old.substr(0, 100000);
+    for (size_t i = 0; i < target.size(); i += 997) target[i] ^= 0x5a;
+    target += "inserted bytes";
+    target += old.substr(150000);
+    target += RandomBytes(70000, 2);
+
+    PatchWriter writer(static_cast<int64_t>(target.size()));
+    int64_t oldPos = 0, newPos = 0;
+    writer.Record(old, oldPos, target, newPos, { 100000, 14, 50000 });
+    writer.Record(old, oldPos, target, newPos, { 50000, 0, -10 });
+    // Runs 10 bytes past the old file, which count as zeros, then seeks back inside it.
+    writer.Record(old, oldPos, target, newPos, { 20, static_cast<int64_t>(target.size()) - newPos - 20, -20 });
+    ASSERT_EQ(newPos, static_cast<int64_t>(target.size()));
+
+    std::string result, error;
+    ASSERT_TRUE(Apply(old, writer.Data(), result, error)) << error;
+    EXPECT_EQ(result, target);
+}
+
+TEST_F(DeltaPatchTest, EmptyTargetNeedsNoRecords)
+{
+    std::string result = "stale", error;
+    ASSERT_TRUE(Apply("old", PatchWriter(0).Data(), result, error)) << error;
+    EXPECT_TRUE(result.empty());
+}
+
+TEST_F(DeltaPatchTest, RejectsBadHeader)
+{
+    std::string patch = PatchWriter(0).Data();
+    patch[7] = '2';
+    std::string result, error;
+    EXPECT_FALSE(Apply("old", patch, result, error));
+    EXPECT_EQ(error, "bad patch header");
+}
+
+TEST_F(DeltaPatchTest, RejectsNegativeSize)
+{
+    std::string result, error;
+    EXPECT_FALSE(Apply("old", PatchWriter(-1).Data(), result, error));
+    EXPECT_EQ(error, "bad patch size");
+}
+
+TEST_F(DeltaPatchTest, RejectsTruncatedPatches)
+{
+    const std::string old = RandomBytes(1000, 3);
+    const std::string target = RandomBytes(1000, 4);
+    PatchWriter writer(static_cast<int64_t>(target.size()));
+    int64_t oldPos = 0, newPos = 0;
+    writer.Record(old, oldPos, target, newPos, { 600, 400, 0 });
+    const std::string& full = writer.Data();
+
+    std::string result, error;
+    EXPECT_FALSE(Apply(old, full.substr(0, 16 + 20), result, error));
+    EXPECT_EQ(error, "truncated control block");
+    EXPECT_FALSE(Apply(old, full.substr(0, 16 + 24 + 599), result, error));
+    EXPECT_EQ(error, "truncated diff block");
+    EXPECT_FALSE(Apply(old, full.substr(0, full.size() - 1), result, error));
+    EXPECT_EQ(error, "truncated extra block");
+}
+
+TEST_F(DeltaPatchTest, RejectsLengthsThatWouldOverflow)
+{
+    constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+    const Control corrupt[] = {
+        { MAX, MAX, 0 },    // the sum wraps negative
+        { 10, MAX - 5, 0 },
+        { -1, 5, 0 },
+        { 5, -1, 0 },
+        { 60, 50, 0 },      // past newSize
+    };
+    for (const Control& control : corrupt) {
+        PatchWriter writer(100);
+        writer.Raw(control);
+        std::string result, error;
+        EXPECT_FALSE(Apply("old", writer.Data(), result, error)) << control.addLen << " " << control.extraLen;
+        EXPECT_EQ(error, "corrupt control block");
+    }
+}
+
+TEST_F(DeltaPatchTest, RejectsSeeksOutsideTheOldFile)
+{
+    constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+    constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+    const std::string old = RandomBytes(100, 5);
+    // After the first record the old position is 10, so seeks must be in [-10, 90].
+    for (int64_t seek : { int64_t(-11), int64_t(91), MIN, MAX }) {
+        PatchWriter writer(20);
+        writer.Raw({ 10, 0, seek }, std::string(10, '\0'));
+        writer.Raw({ 10, 0, 0 }, std::string(10, '\0'));
+        std::string result, error;
+        EXPECT_FALSE(Apply(old, writer.Data(), result, error)) << seek;
+        EXPECT_EQ(error, "corrupt seek");
+    }
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "mpv/hwdec_probe.h"
+
+namespace fs = std::filesystem;
+
+static std::vector<std::string> Probed(const std::vector<HwdecProbe::Candidate>& candidates)
+{
+    std::vector<std::string> values;
+    for (const auto& candidate : candidates) values.push_back(candidate.probe);
+    return values;
+}
+
+TEST(HwdecProbe, ParsesACommaSeparatedList)
+{
+    const auto candidates = HwdecProbe::ParseCandidates("vaapi,nvdec-copy");
+    ASSERT_EQ(candidates.size(), 2u);
+    EXPECT_EQ(candidates[0].probe, "vaapi");
+    EXPECT_EQ(candidates[0].apply, "vaapi");
+    EXPECT_EQ(candidates[1].probe, "nvdec-copy");
+    EXPECT_EQ(candidates[1].apply, "nvdec-copy");
+}
+
+TEST(HwdecProbe, SkipsEmptyEntries)
+{
+    EXPECT_EQ(Probed(HwdecProbe::ParseCandidates(",vaapi,,vulkan-copy,")), (std::vector<std::string>{ "vaapi", "vulkan-copy" }));
+}
+
+TEST(HwdecProbe, AnEmptyListMeansThePlatformCandidates)
+{
+    const std::vector<std::string> platform = Probed(HwdecProbe::GetPlatformCandidates());
+    ASSERT_FALSE(platform.empty());
+    EXPECT_EQ(Probed(HwdecProbe::ParseCandidates("")), platform);
+    EXPECT_EQ(Probed(HwdecProbe::ParseCandidates(",,")), platform);
+}
+
+TEST(HwdecProbe, KeysTenBitProfilesSeparately)
+{
+    EXPECT_EQ(HwdecProbe::CodecKey("h264", "High"), "h264");
+    EXPECT_EQ(HwdecProbe::CodecKey("HEVC", "Main"), "hevc");
+    EXPECT_EQ(HwdecProbe::CodecKey("hevc", "Main 10"), "hevc-10bit");
+    EXPECT_EQ(HwdecProbe::CodecKey("vp9", "Profile 0"), "vp9");
+    EXPECT_EQ(HwdecProbe::CodecKey("vp9", "Profile 2"), "vp9-10bit");
+    EXPECT_EQ(HwdecProbe::CodecKey("av1", ""), "av1");
+}
+
+class HwdecTableTest : public testing::Test
+{
+protected:
+    void SetUp() override { m_path = fs::temp_directory_path() / ("stremato-hwdec-" + std::to_string(std::random_device()()) + ".json"); }
+    void TearDown() override { fs::remove(m_path); }
+
+    fs::path m_path;
+};
+
+TEST_F(HwdecTableTest, SurvivesASaveAndLoad)
+{
+    HwdecTable table;
+    table.fingerprint = "gpu 1.2.3\nmpv-version mpv 0.38\ncandidates vaapi-copy";
+    table.probedAt = 1760000000;
+    table.codecs["h264"] = { "vaapi", { { "vaapi-copy", "ok" } }, 120 };
+    table.codecs["av1"] = { "no", { { "vaapi-copy", "fallback" }, { "nvdec-copy", "cannot load the driver" } }, 340 };
+    table.skipped["vp9"] = "no encoder";
+    ASSERT_TRUE(table.Save(m_path));
+
+    HwdecTable loaded;
+    ASSERT_TRUE(loaded.Load(m_path));
+    EXPECT_EQ(loaded.fingerprint, table.fingerprint);
+    EXPECT_EQ(loaded.probedAt, table.probedAt);
+    EXPECT_EQ(json(loaded), json(table));
+    EXPECT_EQ(loaded.Lookup("h264"), "vaapi");
+    EXPECT_EQ(loaded.Lookup("av1"), "no");
+    EXPECT_FALSE(loaded.Lookup("vp9").has_value());
+}
+
+TEST_F(HwdecTableTest, RejectsAMissingOrUnreadableFile)
+{
+    HwdecTable table;
+    EXPECT_FALSE(table.Load(m_path));
+    std::ofstream(m_path) << "{ not json";
+    EXPECT_FALSE(table.Load(m_path));
+}
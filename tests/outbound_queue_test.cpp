@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "webview_protocol/event_emitter/outbound_queue.h"
+
+using WebViewProtocol::EventPriority;
+using WebViewProtocol::OutboundQueue;
+
+static std::vector<std::string> PopAll(OutboundQueue& queue)
+{
+    bool more = false;
+    return queue.PopBatch(64, more);
+}
+
+TEST(OutboundQueueTest, MergedStateIsSentAfterEventsQueuedBeforeTheUpdate)
+{
+    OutboundQueue queue;
+    queue.Push(EventPriority::State, "pause", "pause=1");
+    queue.Push(EventPriority::State, "volume", "volume=50");
+    queue.Push(EventPriority::State, "pause", "pause=0");
+
+    EXPECT_EQ(PopAll(queue), (std::vector<std::string>{ "volume=50", "pause=0" }));
+    EXPECT_EQ(queue.GetStats()["state"]["merged"], 1u);
+}
+
+TEST(OutboundQueueTest, UnkeyedStateIsNeverMerged)
+{
+    OutboundQueue queue;
+    queue.Push(EventPriority::State, "", "a");
+    queue.Push(EventPriority::State, "", "b");
+
+    EXPECT_EQ(PopAll(queue), (std::vector<std::string>{ "a", "b" }));
+}
+
+TEST(OutboundQueueTest, CriticalIsSentFirstAndNeverMerged)
+{
+    OutboundQueue queue;
+    queue.Push(EventPriority::Telemetry, "time", "time=1");
+    queue.Push(EventPriority::Critical, "reply", "reply=1");
+    queue.Push(EventPriority::Critical, "reply", "reply=2");
+
+    EXPECT_EQ(PopAll(queue), (std::vector<std::string>{ "reply=1", "reply=2", "time=1" }));
+}
+
+TEST(OutboundQueueTest, OnlyTheFirstPushSchedulesAFlush)
+{
+    OutboundQueue queue;
+    EXPECT_TRUE(queue.Push(EventPriority::State, "a", "1"));
+    EXPECT_FALSE(queue.Push(EventPriority::State, "b", "2"));
+
+    bool more = true;
+    EXPECT_EQ(queue.PopBatch(1, more).size(), 1u);
+    EXPECT_TRUE(more);
+    EXPECT_EQ(queue.PopBatch(1, more).size(), 1u);
+    EXPECT_FALSE(more);
+    EXPECT_TRUE(queue.Push(EventPriority::State, "c", "3"));
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <optional>
+#include "mpv/playback_qos.h"
+
+using State = PlaybackQos::State;
+using namespace std::chrono_literals;
+
+// Feeds samples at a fixed interval from the moment the session began.
+class PlaybackQosTest : public ::testing::Test
+{
+protected:
+    void SetUp() override { m_qos.Begin("file:///episode.mkv", m_begin); }
+
+    PlaybackQosSample At(std::chrono::milliseconds offset, std::optional<double> timePos)
+    {
+        PlaybackQosSample sample;
+        sample.at = m_begin + offset;
+        sample.timePos = timePos;
+        return sample;
+    }
+
+    // Plays normally from one position to another, one sample per 500 ms.
+    void Play(std::chrono::milliseconds& at, double& pos, int samples)
+    {
+        for (int i = 0; i < samples; i++) {
+            at += 500ms;
+            pos += 0.5;
+            EXPECT_EQ(m_qos.AddSample(At(at, pos)), State::Playing);
+        }
+    }
+
+    PlaybackQos::Clock::time_point m_begin = PlaybackQos::Clock::now();
+    PlaybackQos m_qos;
+};
+
+TEST_F(PlaybackQosTest, StartupEndsWhenThePositionFirstAdvances)
+{
+    EXPECT_EQ(m_qos.AddSample(At(0ms, 0.0)), State::Startup);
+    EXPECT_EQ(m_qos.AddSample(At(500ms, 0.0)), State::Startup);
+    EXPECT_EQ(m_qos.AddSample(At(1000ms, 0.0)), State::Startup);
+    EXPECT_EQ(m_qos.AddSample(At(1500ms, 0.25)), State::Playing);
+
+    auto report = m_qos.End("eof", m_begin + 1500ms);
+    ASSERT_TRUE(report.has_value());
+    // Playback began a quarter second before the sample that saw it.
+    EXPECT_EQ(report->startupMs, 1250);
+    EXPECT_EQ(report->rebuffers, 0);
+    EXPECT_EQ(report->stalls, 0);
+    EXPECT_FALSE(m_qos.IsActive());
+}
+
+TEST_F(PlaybackQosTest, CountsEachRebufferOnceWithItsDuration)
+{
+    auto at = 0ms;
+    double pos = 0.0;
+    m_qos.AddSample(At(at, pos));
+    Play(at, pos, 4);
+
+    for (int i = 0; i < 3; i++) {
+        at += 500ms;
+        PlaybackQosSample sample = At(at, pos);
+        sample.paused = true;
+        sample.pausedForCache = true;
+        EXPECT_EQ(m_qos.AddSample(sample), State::Rebuffering);
+    }
+    Play(at, pos, 2);
+    at += 500ms;
+    PlaybackQosSample sample = At(at, pos);
+    sample.pausedForCache = true;
+    EXPECT_EQ(m_qos.AddSample(sample), State::Rebuffering);
+    Play(at, pos, 1);
+
+    auto report = m_qos.End("eof", m_begin + at);
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(report->rebuffers, 2);
+    EXPECT_DOUBLE_EQ(report->rebufferSec, 2.0);
+    EXPECT_DOUBLE_EQ(report->longestRebufferSec, 1.5);
+    EXPECT_DOUBLE_EQ(report->playedSec, 3.5);
+    EXPECT_DOUBLE_EQ(report->rebufferRatio, 2.0 / 5.5);
+    EXPECT_EQ(report->stalls, 0);
+}
+
+TEST_F(PlaybackQosTest, AFrozenPositionBecomesAStallAfterTheThreshold)
+{
+    auto at = 0ms;
+    double pos = 0.0;
+    m_qos.AddSample(At(at, pos));
+    Play(at, pos, 4);
+
+    // Not paused, not buffering, not moving.
+    EXPECT_EQ(m_qos.AddSample(At(at + 500ms, pos)), State::Playing);
+    EXPECT_EQ(m_qos.AddSample(At(at + 1000ms, pos)), State::Stalled);
+    EXPECT_EQ(m_qos.AddSample(At(at + 1500ms, pos)), State::Stalled);
+    at += 1500ms;
+    Play(at, pos, 2);
+    EXPECT_EQ(m_qos.GetLiveStatus().stalls, 1);
+
+    auto report = m_qos.End("eof", m_begin + at);
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(report->stalls, 1);
+    // Counted from the last sample that moved, including the wait to the threshold.
+    EXPECT_DOUBLE_EQ(report->stallSec, 1.5);
+    EXPECT_EQ(report->rebuffers, 0);
+}
+
+TEST_F(PlaybackQosTest, WaitingAfterASeekOrWhilePausedIsNeitherStallNorRebuffer)
+{
+    auto at = 0ms;
+    double pos = 0.0;
+    m_qos.AddSample(At(at, pos));
+    Play(at, pos, 2);
+
+    // The position jumps ahead and then waits for data inside the grace period.
+    pos = 600.0;
+    at += 500ms;
+    EXPECT_EQ(m_qos.AddSample(At(at, pos)), State::Seeking);
+    at += 500ms;
+    PlaybackQosSample buffering = At(at, pos);
+    buffering.pausedForCache = true;
+    EXPECT_EQ(m_qos.AddSample(buffering), State::Seeking);
+    at += 500ms;
+    EXPECT_EQ(m_qos.AddSample(At(at, pos)), State::Seeking);
+    Play(at, pos, 2);
+
+    for (int i = 0; i < 6; i++) {
+        at += 500ms;
+        PlaybackQosSample paused = At(at, pos);
+        paused.paused = true;
+        EXPECT_EQ(m_qos.AddSample(paused), State::Paused);
+    }
+    Play(at, pos, 1);
+
+    auto report = m_qos.End("stop", m_begin + at);
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(report->stalls, 0);
+    EXPECT_EQ(report->rebuffers, 0);
+    EXPECT_DOUBLE_EQ(report->seekWaitSec, 1.5);
+    EXPECT_DOUBLE_EQ(report->rebufferRatio, 0.0);
+}
+
+TEST_F(PlaybackQosTest, DroppedFramesAreCountedFromTheFirstReading)
+{
+    auto at = 0ms;
+    double pos = 0.0;
+    m_qos.AddSample(At(at, pos));
+    Play(at, pos, 1);
+
+    at += 500ms;
+    pos += 0.5;
+    PlaybackQosSample sample = At(at, pos);
+    sample.frameDrops = 10;
+    sample.cacheDuration = 5.0;
+    m_qos.AddSample(sample);
+    EXPECT_TRUE(m_qos.IsSteady(2.0));
+
+    at += 500ms;
+    pos += 0.5;
+    sample = At(at, pos);
+    sample.frameDrops = 13;
+    sample.cacheDuration = 5.0;
+    m_qos.AddSample(sample);
+    EXPECT_FALSE(m_qos.IsSteady(2.0));
+    EXPECT_EQ(m_qos.GetLiveStatus().droppedFrames, 3);
+
+    auto report = m_qos.End("eof", m_begin + at);
+    ASSERT_TRUE(report.has_value());
+    EXPECT_EQ(report->droppedFrames, 3);
+    EXPECT_EQ(report->samples, 4);
+}
+
+TEST_F(PlaybackQosTest, EndingTwiceReportsOnce)
+{
+    EXPECT_TRUE(m_qos.End("stop", m_begin).has_value());
+    EXPECT_FALSE(m_qos.End("stop", m_begin).has_value());
+    EXPECT_EQ(m_qos.AddSample(At(500ms, 0.0)), State::Idle);
+}
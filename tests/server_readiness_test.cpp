@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "server/server_readiness.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+// Listens on 127.0.0.1 and either hangs up on every connection (a server that
+// has bound its socket but is still booting) or answers it with an empty 200.
+class LocalServer
+{
+public:
+    enum class Mode { HangUp, Respond };
+
+    explicit LocalServer(Mode mode, int port = 0) : m_mode(mode)
+    {
+        m_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address = Loopback(port);
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(m_fd, 8) != 0) {
+            ADD_FAILURE() << "could not listen on port " << port;
+            return;
+        }
+        m_port = BoundPort(m_fd);
+        m_thread = std::thread([this]() { AcceptLoop(); });
+    }
+
+    ~LocalServer()
+    {
+        m_stopping = true;
+        if (m_thread.joinable()) m_thread.join();
+        close(m_fd);
+    }
+
+    int Port() const { return m_port; }
+    std::string Url() const { return "http://127.0.0.1:" + std::to_string(m_port) + "/"; }
+
+    static sockaddr_in Loopback(int port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        return address;
+    }
+
+    static int BoundPort(int fd)
+    {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        return ntohs(address.sin_port);
+    }
+
+private:
+    void AcceptLoop()
+    {
+        while (!m_stopping) {
+            pollfd listening{ m_fd, POLLIN, 0 };
+            if (poll(&listening, 1, 20) <= 0) continue;
+            int client = accept(m_fd, nullptr, nullptr);
+            if (client < 0) continue;
+            if (m_mode == Mode::Respond) {
+                char request[1024];
+                (void)recv(client, request, sizeof(request), 0);
+                const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                (void)send(client, response, sizeof(response) - 1, MSG_NOSIGNAL);
+            }
+            close(client);
+        }
+    }
+
+    Mode m_mode;
+    int m_fd = -1;
+    int m_port = 0;
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+};
+
+// A port that was free a moment ago and has nothing listening on it.
+static int UnusedPort()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = LocalServer::Loopback(0);
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    int port = LocalServer::BoundPort(fd);
+    close(fd);
+    return port;
+}
+
+static std::string UrlFor(int port)
+{
+    return "http://127.0.0.1:" + std::to_string(port) + "/";
+}
+
+TEST(ServerReadinessProbe, StaysRefusedWhileNothingListens)
+{
+    ServerReadinessProbe probe(UrlFor(UnusedPort()));
+    EXPECT_FALSE(probe.Run(300ms, nullptr));
+    const ServerStartupTimeline& timeline = probe.GetTimeline();
+    EXPECT_GE(timeline.attempts, 2);
+    EXPECT_EQ(timeline.listeningMs, -1);
+    EXPECT_EQ(timeline.firstResponseMs, -1);
+}
+
+TEST(ServerReadinessProbe, ListeningIsNotReady)
+{
+    LocalServer server(LocalServer::Mode::HangUp);
+    ServerReadinessProbe probe(server.Url());
+    EXPECT_FALSE(probe.Run(300ms, nullptr));
+    const ServerStartupTimeline& timeline = probe.GetTimeline();
+    EXPECT_GE(timeline.listeningMs, 0);
+    EXPECT_EQ(timeline.firstResponseMs, -1);
+}
+
+TEST(ServerReadinessProbe, ReadyOnTheFirstResponse)
+{
+    LocalServer server(LocalServer::Mode::Respond);
+    ServerReadinessProbe probe(server.Url());
+    ASSERT_TRUE(probe.Run(5000ms, nullptr));
+    const ServerStartupTimeline& timeline = probe.GetTimeline();
+    EXPECT_EQ(timeline.attempts, 1);
+    EXPECT_GE(timeline.listeningMs, 0);
+    EXPECT_EQ(timeline.firstResponseMs, timeline.listeningMs);
+}
+
+TEST(ServerReadinessProbe, MovesFromRefusedThroughListeningToReady)
+{
+    const int port = UnusedPort();
+    ServerReadinessProbe probe(UrlFor(port));
+    probe.MarkSpawned();
+
+    std::unique_ptr<LocalServer> hangUp, respond;
+    std::thread boot([&]() {
+        std::this_thread::sleep_for(150ms);
+        hangUp = std::make_unique<LocalServer>(LocalServer::Mode::HangUp, port);
+        std::this_thread::sleep_for(300ms);
+        hangUp.reset();
+        respond = std::make_unique<LocalServer>(LocalServer::Mode::Respond, port);
+    });
+    const bool ready = probe.Run(5000ms, nullptr);
+    boot.join();
+
+    ASSERT_TRUE(ready);
+    const ServerStartupTimeline& timeline = probe.GetTimeline();
+    EXPECT_GE(timeline.attempts, 3);
+    EXPECT_GE(timeline.listeningMs, 150);
+    EXPECT_GE(timeline.firstResponseMs, 450);
+    EXPECT_GT(timeline.firstResponseMs, timeline.listeningMs);
+}
+
+TEST(ServerReadinessProbe, GivesUpWhenTheServerIsGone)
+{
+    LocalServer server(LocalServer::Mode::Respond);
+    ServerReadinessProbe probe(server.Url());
+    EXPECT_FALSE(probe.Run(5000ms, []() { return false; }));
+    EXPECT_EQ(probe.GetTimeline().attempts, 0);
+}
+
+TEST(ServerReadinessProbe, CancelInterruptsTheBackoff)
+{
+    ServerReadinessProbe probe(UrlFor(UnusedPort()));
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(100ms);
+        probe.Cancel();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(probe.Run(10000ms, nullptr));
+    canceller.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2000ms);
+    EXPECT_EQ(probe.GetTimeline().firstResponseMs, -1);
+}
+#endif
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "server/server_supervisor.h"
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+using namespace std::chrono_literals;
+using Clock = ServerSupervisorPolicy::Clock;
+
+static ServerSupervisorPolicy::Config FastConfig()
+{
+    ServerSupervisorPolicy::Config config;
+    config.maxConsecutiveFailures = 3;
+    config.initialBackoff = 1ms;
+    config.maxBackoff = 4ms;
+    config.stableUptime = 1000ms;
+    return config;
+}
+
+TEST(ServerSupervisorPolicy, BacksOffExponentiallyUpToTheCap)
+{
+    ServerSupervisorPolicy::Config config = FastConfig();
+    config.maxConsecutiveFailures = 10;
+    ServerSupervisorPolicy policy(config);
+    const Clock::time_point now = Clock::now();
+
+    policy.OnStarted(now);
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::Running);
+    const std::chrono::milliseconds expected[] = { 1ms, 2ms, 4ms, 4ms };
+    for (auto delay : expected) {
+        EXPECT_EQ(policy.OnExited(now), delay);
+        EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::BackingOff);
+        policy.OnStarted(now);
+    }
+    EXPECT_EQ(policy.GetRestartCount(), 4);
+    EXPECT_EQ(policy.GetCrashCount(), 4);
+}
+
+TEST(ServerSupervisorPolicy, GivesUpAfterTooManyConsecutiveFailures)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    const Clock::time_point now = Clock::now();
+    policy.OnStarted(now);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(policy.OnExited(now));
+        policy.OnStarted(now);
+    }
+    EXPECT_FALSE(policy.OnExited(now));
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::GaveUp);
+    EXPECT_EQ(policy.GetUptime(now), 0ms);
+}
+
+TEST(ServerSupervisorPolicy, StableRunResetsTheFailureCount)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    const Clock::time_point start = Clock::now();
+    policy.OnStarted(start);
+    ASSERT_TRUE(policy.OnExited(start));
+    policy.OnStarted(start);
+    ASSERT_TRUE(policy.OnExited(start));
+    EXPECT_EQ(policy.GetConsecutiveFailures(), 2);
+
+    policy.OnStarted(start);
+    EXPECT_EQ(policy.GetUptime(start + 1500ms), 1500ms);
+    EXPECT_EQ(policy.OnExited(start + 1500ms), 1ms);
+    EXPECT_EQ(policy.GetConsecutiveFailures(), 1);
+}
+
+TEST(ServerSupervisorPolicy, FailedLaunchCountsAsAnotherFailure)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    const Clock::time_point now = Clock::now();
+    // Not supervising yet: a failed first launch is the caller's to report.
+    EXPECT_FALSE(policy.OnLaunchFailed());
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::Stopped);
+
+    policy.OnStarted(now);
+    EXPECT_EQ(policy.OnExited(now), 1ms);
+    EXPECT_EQ(policy.OnLaunchFailed(), 2ms);
+    EXPECT_EQ(policy.OnLaunchFailed(), 4ms);
+    EXPECT_FALSE(policy.OnLaunchFailed());
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::GaveUp);
+    EXPECT_EQ(policy.GetCrashCount(), 1);
+    EXPECT_EQ(policy.GetRestartCount(), 0);
+}
+
+TEST(ServerSupervisorPolicy, StopClearsFailures)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    const Clock::time_point now = Clock::now();
+    policy.OnStarted(now);
+    ASSERT_TRUE(policy.OnExited(now));
+    policy.OnStopped();
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::Stopped);
+    EXPECT_EQ(policy.GetConsecutiveFailures(), 0);
+    EXPECT_FALSE(policy.OnExited(now));
+}
+
+#ifndef _WIN32
+// Runs `path -c "exit 3"` to completion; false when it could not be launched.
+static bool RunChild(const char* path, int& exitCode)
+{
+    char* argv[] = { const_cast<char*>(path), const_cast<char*>("-c"), const_cast<char*>("exit 3"), nullptr };
+    pid_t pid;
+    if (posix_spawn(&pid, path, nullptr, nullptr, argv, environ) != 0) return false;
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return false;
+    exitCode = WEXITSTATUS(status);
+    return exitCode != 127;
+}
+
+// Drives the policy the way ServerManager's watch thread does, with a child
+// that exits straight away standing in for the server. pathFor(attempt) names
+// the binary to launch on each attempt.
+template <typename PathFor>
+static int Supervise(ServerSupervisorPolicy& policy, PathFor pathFor)
+{
+    int launches = 0, attempt = 0, exitCode = 0;
+    if (!RunChild(pathFor(attempt++), exitCode)) return launches;
+    launches++;
+    policy.OnStarted(Clock::now());
+    std::optional<std::chrono::milliseconds> delay = policy.OnExited(Clock::now());
+    while (delay) {
+        std::this_thread::sleep_for(*delay);
+        if (RunChild(pathFor(attempt++), exitCode)) {
+            EXPECT_EQ(exitCode, 3);
+            launches++;
+            policy.OnStarted(Clock::now());
+            delay = policy.OnExited(Clock::now());
+        } else {
+            delay = policy.OnLaunchFailed();
+        }
+    }
+    return launches;
+}
+
+TEST(ServerSupervisorPolicy, SupervisesACrashingChildUntilItGivesUp)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    EXPECT_EQ(Supervise(policy, [](int) { return "/bin/sh"; }), 4);
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::GaveUp);
+    EXPECT_EQ(policy.GetCrashCount(), 4);
+    EXPECT_EQ(policy.GetRestartCount(), 3);
+}
+
+TEST(ServerSupervisorPolicy, GivesUpWhenTheChildCanNoLongerBeLaunched)
+{
+    ServerSupervisorPolicy policy(FastConfig());
+    const int launches = Supervise(policy, [](int attempt) {
+        return attempt < 2 ? "/bin/sh" : "/nonexistent/stremio-runtime";
+    });
+    EXPECT_EQ(launches, 2);
+    EXPECT_EQ(policy.GetState(), ServerSupervisorPolicy::State::GaveUp);
+    EXPECT_EQ(policy.GetCrashCount(), 2);
+    EXPECT_EQ(policy.GetRestartCount(), 1);
+}
+#endif
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "webview_protocol/shared_channel/shared_ring.h"
+
+// A ring with the smallest accepted capacity, backed by words so the header
+// and frames are aligned the way a mapped buffer is.
+class SharedRingTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32_t CAPACITY = 4096;
+
+    void SetUp() override
+    {
+        m_region.assign((SharedRing::HEADER_SIZE + CAPACITY) / sizeof(uint32_t), 0);
+        ASSERT_TRUE(m_writer.Attach(Base(), SharedRing::HEADER_SIZE + CAPACITY, 7));
+        ASSERT_EQ(m_writer.Capacity(), CAPACITY);
+    }
+
+    uint8_t* Base() { return reinterpret_cast<uint8_t*>(m_region.data()); }
+    uint32_t& Word(size_t index) { return m_region[index]; }
+
+    std::optional<SharedRing::FrameDescriptor> Write(const std::string& payload)
+    {
+        return m_writer.Write(SharedRing::FRAME_JSON_EVENT, payload.data(), static_cast<uint32_t>(payload.size()));
+    }
+
+    std::string Read()
+    {
+        SharedRing::Reader reader(Base());
+        std::optional<SharedRing::Frame> frame = reader.Read();
+        if (!frame) return "<empty>";
+        return std::string(frame->payload.begin(), frame->payload.end());
+    }
+
+    std::vector<uint32_t> m_region;
+    SharedRing::Writer m_writer;
+};
+
+TEST_F(SharedRingTest, EmptyRingReadsNothing)
+{
+    EXPECT_EQ(Read(), "<empty>");
+    EXPECT_EQ(m_writer.Used(), 0u);
+}
+
+TEST_F(SharedRingTest, FramesRoundTripInOrder)
+{
+    auto first = Write("one");
+    auto second = Write("two");
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(first->generation, 7u);
+    EXPECT_EQ(first->offset, SharedRing::HEADER_SIZE + SharedRing::FRAME_HEADER_SIZE);
+    EXPECT_EQ(second->seq, first->seq + 1);
+    EXPECT_EQ(m_writer.Used(), 2 * SharedRing::AlignFrame(3));
+
+    EXPECT_EQ(Read(), "one");
+    EXPECT_EQ(Read(), "two");
+    EXPECT_EQ(Read(), "<empty>");
+    EXPECT_EQ(m_writer.Used(), 0u);
+}
+
+TEST_F(SharedRingTest, FillsExactlyAndRefusesOneMore)
+{
+    // 256-byte frames tile the data area with no padding.
+    const std::string payload(256 - SharedRing::FRAME_HEADER_SIZE, 'x');
+    for (uint32_t i = 0; i < CAPACITY / 256; i++) ASSERT_TRUE(Write(payload)) << i;
+    EXPECT_EQ(m_writer.Used(), CAPACITY);
+    EXPECT_FALSE(Write(""));
+
+    // Releasing one frame makes room for exactly one more, back at offset 0.
+    EXPECT_EQ(Read(), payload);
+    auto wrapped = Write(payload);
+    ASSERT_TRUE(wrapped);
+    EXPECT_EQ(wrapped->offset, SharedRing::HEADER_SIZE + SharedRing::FRAME_HEADER_SIZE);
+    EXPECT_FALSE(Write(""));
+
+    for (uint32_t i = 0; i < CAPACITY / 256; i++) EXPECT_EQ(Read(), payload) << i;
+    EXPECT_EQ(Read(), "<empty>");
+}
+
+TEST_F(SharedRingTest, FrameThatDoesNotFitBeforeTheEndWrapsBehindPadding)
+{
+    const std::string small(1000, 's');
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(Write(small));
+    for (int i = 0; i < 3; i++) ASSERT_EQ(Read(), small);
+
+    // 1024 bytes remain before the end; the frame needs 1520, so the
+    // remainder is padded and the frame starts at 0.
+    const std::string large(1500, 'L');
+    auto descriptor = Write(large);
+    ASSERT_TRUE(descriptor);
+    EXPECT_EQ(descriptor->offset, SharedRing::HEADER_SIZE + SharedRing::FRAME_HEADER_SIZE);
+    EXPECT_EQ(m_writer.Used(), 1024 + SharedRing::AlignFrame(1500));
+
+    EXPECT_EQ(Read(), large);
+    EXPECT_EQ(Read(), "<empty>");
+    EXPECT_EQ(m_writer.Used(), 0u);
+}
+
+TEST_F(SharedRingTest, WrapNeedsRoomForPaddingAndFrame)
+{
+    const std::string small(1000, 's');
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(Write(small));
+    ASSERT_EQ(Read(), small);
+
+    // 1024 free at the end plus 1024 released at the start: a 1520-byte frame
+    // would need 2544 and is refused rather than overwriting unread frames.
+    EXPECT_FALSE(Write(std::string(1500, 'L')));
+    EXPECT_TRUE(Write(std::string(1000, 'f')));
+    EXPECT_EQ(m_writer.Used(), CAPACITY - 1024);
+}
+
+TEST_F(SharedRingTest, TailAheadOfHeadIsRejected)
+{
+    ASSERT_TRUE(Write("one"));
+    Word(SharedRing::HDR_TAIL) = 2 * CAPACITY;
+    EXPECT_FALSE(Write("two"));
+    EXPECT_EQ(m_writer.Used(), SharedRing::AlignFrame(3));
+
+    Word(SharedRing::HDR_TAIL) = 0;
+    EXPECT_TRUE(Write("two"));
+}
+
+TEST_F(SharedRingTest, TailMovingBackwardsIsRejected)
+{
+    ASSERT_TRUE(Write("one"));
+    ASSERT_TRUE(Write("two"));
+    ASSERT_EQ(Read(), "one");
+    ASSERT_TRUE(Write("three")); // the writer has now seen the released tail
+
+    // Rewinding tail would hand the released frame's space back twice.
+    Word(SharedRing::HDR_TAIL) = 0;
+    EXPECT_FALSE(Write("four"));
+    EXPECT_EQ(m_writer.Used(), 2 * SharedRing::AlignFrame(5));
+}
+
+TEST_F(SharedRingTest, ConsumerCannotMoveHead)
+{
+    ASSERT_TRUE(Write("one"));
+    Word(SharedRing::HDR_HEAD) = 3 * CAPACITY;
+    auto descriptor = Write("two");
+    ASSERT_TRUE(descriptor);
+    EXPECT_EQ(descriptor->offset, SharedRing::HEADER_SIZE + SharedRing::AlignFrame(3) + SharedRing::FRAME_HEADER_SIZE);
+    EXPECT_EQ(Read(), "one");
+    EXPECT_EQ(Read(), "two");
+}
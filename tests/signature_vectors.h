@@ -0,0 +1,40 @@
+#ifndef SIGNATURE_VECTORS_H
+#define SIGNATURE_VECTORS_H
+
+// Known-answer vectors for SignatureVerifier, made with
+//   openssl dgst -sha256 -sign signer.pem -out sig message
+// The keys exist only for these tests; the private halves were not kept.
+namespace SignatureVectors {
+    inline constexpr const char* SIGNER_PUBLIC_KEY =
+        "-----BEGIN PUBLIC KEY-----\n"
+        "MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAsO99+JOLdSB+ZKC1v9Ot\n"
+        "bfadgeMELHc5ai3uJYSPCJdWdVN9fZNWXQeLxlpzxYAp5RHCn0b3HWStcYmjDmfF\n"
+        "Rcc8suCR3nuPJLcm2w6oOuOaheIw0ktZVw1BqY6YKTqDth4/h/0ONnqFQPOike9Q\n"
+        "d92QTBjF7JhR1rbkmhk25SrEU5SZtSUYwuYBtKih1M0V6JzeQ2DnKZaba0rAgKkD\n"
+        "0DV3OeIhCEODfp1MFGC4Gdc7plCOI8G9m8SbVAOJE583ZpMm0mw8ZTpce2oU3E00\n"
+        "SwvcDuYlxG5P8ZF9WisL6bQuv29iSkNBUq6eONuQ7zeelHUngSO/DVlmnzFtzzh4\n"
+        "cQIDAQAB\n"
+        "-----END PUBLIC KEY-----\n";
+
+    inline constexpr const char* OTHER_PUBLIC_KEY =
+        "-----BEGIN PUBLIC KEY-----\n"
+        "MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAsvl6JVpit7ST1rgSx+S7\n"
+        "1fbRrOCEZGZq/WzNpxKlaemFwHKHV+WSy3+YCTt2BnqMRZwUF8Z/pjq8JlCaMO/8\n"
+        "JQaKjwMqxOXwMesOcPDN25NgRuc7aziWyIsb/n5rky64DTCddhom6O1H0wbOvvG8\n"
+        "0aK/UbHHDLJ7eieD3bVjkW8bmjCE/RhMLg3vUz82fAitRFjRWqlfkMkifFKtRIBi\n"
+        "xeFSyoyes2+u6mv1mFgFKPHsA7giLfsEkDIOQ5Dr5YeRn/KuA6S8ssSTMIWauFMf\n"
+        "67gIuRpeqEkEd/xo2Ed8iSts2+ovFnDig/wLg+2TkJgCJcPGZ6UuMFM6MSBMbeIf\n"
+        "8wIDAQAB\n"
+        "-----END PUBLIC KEY-----\n";
+
+    inline constexpr const char* MESSAGE = R"({"shellVersion":"5.0.20","files":{}})";
+
+    // RSA/SHA-256 signature of MESSAGE by the signer, base64 with "==" padding.
+    inline constexpr const char* SIGNATURE =
+        "rEzxWlFIL//3CWebbLO8JRfoRZsftchwhmpqrjKUTrkmD4ixjH85q7Z7QZ9ibGVEA9le4jNQLi2/o4Mbfn3ZGhsW"
+        "0PweXBqWcIY31QQeG0SVYkolfIB5C3dkHdiVotG7e0p57bymL56Z+cI9QCoa5ShGpmRSN5wMnjdUAn+2X3qXeyLw"
+        "hISo0IlIITXLUI4+eq9eujrtm3HwJ8Cg7iMmOwi1JtCqb8ppY9Dj5TPGmBYvWjA2ZDUtnARUVTm+ux+G10+YmNDs"
+        "fJdoy37vPVpuuMSiU08xX2FBDD1vZiBqB0v7ltUgsGScinQLvv6Q9FgwFVCljXWXVuxMr+VU114V5A==";
+}
+
+#endif // SIGNATURE_VECTORS_H
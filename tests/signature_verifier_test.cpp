@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <algorithm>
+#include "updater/signature_verifier.h"
+#include "signature_vectors.h"
+
+using namespace SignatureVectors;
+
+TEST(SignatureVerifier, AcceptsTheKnownSignature)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    ASSERT_TRUE(verifier.IsValid());
+    EXPECT_TRUE(verifier.Verify(MESSAGE, SIGNATURE));
+    // The digest context is reused, so a second call must give the same answer.
+    EXPECT_TRUE(verifier.Verify(MESSAGE, SIGNATURE));
+}
+
+TEST(SignatureVerifier, IgnoresWhitespaceInTheSignature)
+{
+    const std::string signature = SIGNATURE;
+    const std::string wrapped = " " + signature.substr(0, 88) + "\r\n" + signature.substr(88) + "\n";
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    EXPECT_TRUE(verifier.Verify(MESSAGE, wrapped));
+}
+
+TEST(SignatureVerifier, RejectsAFlippedBit)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    std::string message = MESSAGE;
+    message[5] ^= 0x01;
+    EXPECT_FALSE(verifier.Verify(message, SIGNATURE));
+
+    // One bit of the decoded signature: the low bit of a base64 digit's value.
+    const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string signature = SIGNATURE;
+    signature[100] = alphabet[alphabet.find(signature[100]) ^ 1];
+    EXPECT_FALSE(verifier.Verify(MESSAGE, signature));
+    EXPECT_TRUE(verifier.Verify(MESSAGE, SIGNATURE));
+}
+
+TEST(SignatureVerifier, RejectsBadBase64Padding)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    const std::string signature = SIGNATURE;
+    const std::string body = signature.substr(0, signature.size() - 2);
+    EXPECT_FALSE(verifier.Verify(MESSAGE, body));                                  // padding dropped
+    EXPECT_FALSE(verifier.Verify(MESSAGE, body + "="));                            // one short
+    EXPECT_FALSE(verifier.Verify(MESSAGE, body + "===="));                         // too much
+    EXPECT_FALSE(verifier.Verify(MESSAGE, body.substr(0, 40) + "=" + body.substr(41) + "=="));  // inside
+    EXPECT_FALSE(verifier.Verify(MESSAGE, body + "=A"));                           // data after padding
+    EXPECT_FALSE(verifier.Verify(MESSAGE, ""));
+    EXPECT_FALSE(verifier.Verify(MESSAGE, "===="));
+}
+
+TEST(SignatureVerifier, RejectsTheWrongKey)
+{
+    SignatureVerifier verifier(OTHER_PUBLIC_KEY);
+    ASSERT_TRUE(verifier.IsValid());
+    EXPECT_FALSE(verifier.Verify(MESSAGE, SIGNATURE));
+}
+
+TEST(SignatureVerifier, RejectsEverythingWithAnUnreadableKey)
+{
+    SignatureVerifier verifier("-----BEGIN PUBLIC KEY-----\nnot a key\n-----END PUBLIC KEY-----\n");
+    EXPECT_FALSE(verifier.IsValid());
+    EXPECT_FALSE(verifier.Verify(MESSAGE, SIGNATURE));
+}
+
+TEST(SignatureVerifier, VerifiesBatches)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    const std::vector<bool> results = verifier.VerifyBatch({
+        { MESSAGE, SIGNATURE },
+        { std::string(MESSAGE) + " ", SIGNATURE },
+        { MESSAGE, SIGNATURE },
+    });
+    EXPECT_EQ(results, (std::vector<bool>{ true, false, true }));
+}
+
+TEST(SignatureVerifier, AcceptsTheKnownSignatureInChunks)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    const std::string message = MESSAGE;
+    for (size_t chunk : { size_t(1), size_t(3), size_t(7), message.size() }) {
+        ASSERT_TRUE(verifier.Begin());
+        for (size_t offset = 0; offset < message.size(); offset += chunk) {
+            ASSERT_TRUE(verifier.Update(message.data() + offset, (std::min)(chunk, message.size() - offset)));
+        }
+        EXPECT_TRUE(verifier.Update(message.data(), 0));
+        EXPECT_TRUE(verifier.Finish(SIGNATURE)) << "chunk size " << chunk;
+    }
+}
+
+TEST(SignatureVerifier, RejectsChunksThatDifferFromTheSignedMessage)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    const std::string message = MESSAGE;
+    const size_t half = message.size() / 2;
+
+    ASSERT_TRUE(verifier.Begin());
+    ASSERT_TRUE(verifier.Update(message.data(), half));
+    EXPECT_FALSE(verifier.Finish(SIGNATURE));                   // truncated
+
+    ASSERT_TRUE(verifier.Begin());
+    ASSERT_TRUE(verifier.Update(message.data() + half, message.size() - half));
+    ASSERT_TRUE(verifier.Update(message.data(), half));
+    EXPECT_FALSE(verifier.Finish(SIGNATURE));                   // reordered
+}
+
+TEST(SignatureVerifier, StreamingNeedsBegin)
+{
+    SignatureVerifier verifier(SIGNER_PUBLIC_KEY);
+    const std::string message = MESSAGE;
+    EXPECT_FALSE(verifier.Update(message.data(), message.size()));
+    EXPECT_FALSE(verifier.Finish(SIGNATURE));
+
+    // Finish ends the verification, so a second Finish has nothing to check.
+    ASSERT_TRUE(verifier.Begin());
+    ASSERT_TRUE(verifier.Update(message.data(), message.size()));
+    EXPECT_TRUE(verifier.Finish(SIGNATURE));
+    EXPECT_FALSE(verifier.Finish(SIGNATURE));
+
+    // A restarted verification discards what was fed before.
+    ASSERT_TRUE(verifier.Begin());
+    ASSERT_TRUE(verifier.Update("junk", 4));
+    ASSERT_TRUE(verifier.Begin());
+    ASSERT_TRUE(verifier.Update(message.data(), message.size()));
+    EXPECT_TRUE(verifier.Finish(SIGNATURE));
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include "mpv/sprite_generator.h"
+
+namespace fs = std::filesystem;
+
+static SpriteSheetIndex Layout(int tiles, double duration)
+{
+    SpriteSheetIndex index;
+    index.duration = duration;
+    index.intervalSec = 10.0;
+    index.tileWidth = 160;
+    index.tileHeight = 90;
+    index.columns = 10;
+    index.rows = 10;
+    index.tiles = tiles;
+    return index;
+}
+
+TEST(SpriteSheetIndex, CountsSheetsForTheTilesWritten)
+{
+    EXPECT_EQ(Layout(0, 0.0).Sheets(), 0);
+    EXPECT_EQ(Layout(1, 0.0).Sheets(), 1);
+    EXPECT_EQ(Layout(100, 0.0).Sheets(), 1);
+    EXPECT_EQ(Layout(101, 0.0).Sheets(), 2);
+    EXPECT_EQ(SpriteSheetIndex().Sheets(), 0);
+    EXPECT_EQ(SpriteSheetIndex::SheetName(0), "sheet-000.jpg");
+    EXPECT_EQ(SpriteSheetIndex::SheetName(12), "sheet-012.jpg");
+}
+
+TEST(SpriteSheetIndex, PlacesTilesRowMajorAcrossSheets)
+{
+    const std::string vtt = Layout(102, 1015.0).ToVtt();
+    EXPECT_EQ(vtt.rfind("WEBVTT\n", 0), 0u);
+    EXPECT_NE(vtt.find("\n00:00:00.000 --> 00:00:10.000\nsheet-000.jpg#xywh=0,0,160,90\n"), std::string::npos);
+    // Tile 13: row 1, column 3.
+    EXPECT_NE(vtt.find("\n00:02:10.000 --> 00:02:20.000\nsheet-000.jpg#xywh=480,90,160,90\n"), std::string::npos);
+    // Tile 99 is the last slot of the first sheet, tile 100 the first of the next.
+    EXPECT_NE(vtt.find("\n00:16:30.000 --> 00:16:40.000\nsheet-000.jpg#xywh=1440,810,160,90\n"), std::string::npos);
+    EXPECT_NE(vtt.find("\n00:16:40.000 --> 00:16:50.000\nsheet-001.jpg#xywh=0,0,160,90\n"), std::string::npos);
+    // The last cue ends with the file.
+    EXPECT_NE(vtt.find("\n00:16:50.000 --> 00:16:55.000\nsheet-001.jpg#xywh=160,0,160,90\n"), std::string::npos);
+}
+
+class SpriteCacheKeyTest : public testing::Test
+{
+protected:
+    void SetUp() override { m_path = fs::temp_directory_path() / ("stremato-sprite-" + std::to_string(std::random_device()()) + ".mkv"); }
+    void TearDown() override { fs::remove(m_path); }
+
+    void Write(const std::string& data) { std::ofstream(m_path, std::ios::binary) << data; }
+
+    std::string Hash()
+    {
+        std::string error;
+        std::string hash = SpriteGenerator::ContentHash(m_path.string(), error);
+        EXPECT_TRUE(error.empty()) << error;
+        return hash;
+    }
+
+    fs::path m_path;
+};
+
+TEST_F(SpriteCacheKeyTest, SumsSizeAndLittleEndianWords)
+{
+    // 16 bytes: both words fall in the head and again in the tail.
+    std::string data(16, '\0');
+    data[0] = 0x01;
+    data[8] = 0x02;
+    Write(data);
+    EXPECT_EQ(Hash(), "0000000000000016");  // 16 + 2 * (1 + 2)
+}
+
+TEST_F(SpriteCacheKeyTest, OnlyTheFirstAndLast64KiBCount)
+{
+    std::mt19937 rng(11);
+    std::string data(300 * 1024, '\0');
+    for (char& c : data) c = static_cast<char>(rng());
+    Write(data);
+    const std::string original = Hash();
+    EXPECT_EQ(original.size(), 16u);
+
+    std::string error;
+    EXPECT_EQ(SpriteGenerator::ContentHash("file://" + m_path.string(), error), original);
+
+    data[150 * 1024] ^= 0x55;  // the middle is not read
+    Write(data);
+    EXPECT_EQ(Hash(), original);
+
+    data[10] ^= 0x55;
+    Write(data);
+    EXPECT_NE(Hash(), original);
+}
+
+TEST_F(SpriteCacheKeyTest, RefusesWhatItCannotHash)
+{
+    std::string error;
+    EXPECT_TRUE(SpriteGenerator::ContentHash(m_path.string(), error).empty());
+    EXPECT_FALSE(error.empty());
+
+    Write("");
+    error.clear();
+    EXPECT_TRUE(SpriteGenerator::ContentHash(m_path.string(), error).empty());
+    EXPECT_EQ(error, "empty file");
+
+    error.clear();
+    EXPECT_TRUE(SpriteGenerator::ContentHash("magnet:?xt=urn:btih:0", error).empty());
+    EXPECT_FALSE(error.empty());
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include "tracer/startup_report.h"
+#include "globals/globals.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+// Marks are process-wide and a report is written once per process, so the
+// whole launch is exercised in one test.
+TEST(StartupReport, RecordsMilestonesInOrderAndAnchorsFrontendMetrics)
+{
+    StartupReport::Mark("WindowCreated");
+    std::this_thread::sleep_for(2ms);
+    // The first navigation fails and is retried; the document comes from the
+    // second one, which completes while a third is still starting.
+    StartupReport::MarkNavigationStarting(1);
+    std::this_thread::sleep_for(2ms);
+    StartupReport::MarkNavigationCompleted(1, false);
+    std::this_thread::sleep_for(2ms);
+    StartupReport::MarkNavigationStarting(2);
+    std::this_thread::sleep_for(2ms);
+    StartupReport::MarkNavigationStarting(3);
+    StartupReport::MarkNavigationCompleted(2, true);
+    std::this_thread::sleep_for(2ms);
+    // Only the first occurrence of a milestone counts.
+    StartupReport::Mark("WindowCreated");
+    EXPECT_TRUE(StartupReport::HasMark("NavigationStarting"));
+    EXPECT_FALSE(StartupReport::HasMark("FrontendReady"));
+
+    const fs::path path = fs::temp_directory_path() / ("stremato-startup-" + std::to_string(std::random_device()()) + ".jsonl");
+    const nlohmann::json frontend = {
+        {"firstPaint", 120.5},
+        {"firstContentfulPaint", 130.0},
+        {"domInteractive", -1},
+        {"loadEventEnd", "soon"}
+    };
+    ASSERT_TRUE(StartupReport::Complete(frontend, path));
+    // Later calls in the same launch append nothing.
+    EXPECT_FALSE(StartupReport::Complete(frontend, path));
+
+    std::ifstream in(path);
+    std::string line;
+    std::vector<nlohmann::json> reports;
+    while (std::getline(in, line)) reports.push_back(nlohmann::json::parse(line));
+    in.close();
+    fs::remove(path);
+    ASSERT_EQ(reports.size(), 1u);
+    const nlohmann::json& report = reports[0];
+
+    EXPECT_EQ(report.at("version"), APP_VERSION);
+    EXPECT_EQ(report.at("frontend"), frontend);
+
+    const nlohmann::json& native = report.at("native");
+    const double window = native.at("WindowCreated").get<double>();
+    const double navigation = native.at("NavigationStarting").get<double>();
+    const double completed = native.at("NavigationCompleted").get<double>();
+    EXPECT_LT(window, navigation);
+    EXPECT_LT(navigation, completed);
+
+    // Frontend offsets land on the native timeline, anchored to the start of
+    // the navigation that produced the document; negative or non-numeric
+    // metrics are left out.
+    const nlohmann::json& derived = report.at("derived");
+    const double document = derived.at("navigationStart").get<double>();
+    EXPECT_GT(document, completed);
+    EXPECT_DOUBLE_EQ(derived.at("firstPaint").get<double>(), document + 120.5);
+    EXPECT_DOUBLE_EQ(derived.at("firstContentfulPaint").get<double>(), document + 130.0);
+    EXPECT_FALSE(derived.contains("domInteractive"));
+    EXPECT_FALSE(derived.contains("loadEventEnd"));
+    EXPECT_LT(derived.at("firstPaint").get<double>(), derived.at("firstContentfulPaint").get<double>());
+}
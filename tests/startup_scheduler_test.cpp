@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "app/startup_scheduler.h"
+
+using Affinity = StartupScheduler::Affinity;
+
+// Stages append their names here as they run.
+class StartupSchedulerTest : public ::testing::Test
+{
+protected:
+    StartupScheduler::StageFunction Record(const std::string& name, bool ok = true)
+    {
+        return [this, name, ok]() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_order.push_back(name);
+            return ok;
+        };
+    }
+
+    std::vector<std::string> Order()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_order;
+    }
+
+    size_t IndexOf(const std::string& name)
+    {
+        std::vector<std::string> order = Order();
+        for (size_t i = 0; i < order.size(); i++) {
+            if (order[i] == name) return i;
+        }
+        ADD_FAILURE() << name << " did not run";
+        return order.size();
+    }
+
+    std::mutex m_mutex;
+    std::vector<std::string> m_order;
+};
+
+TEST_F(StartupSchedulerTest, RunsStagesAfterTheirDependencies)
+{
+    {
+        StartupScheduler scheduler;
+        scheduler.AddStage("webview", Affinity::UIThread, { "commands" }, Record("webview"));
+        scheduler.AddStage("commands", Affinity::UIThread, {}, Record("commands"));
+        scheduler.AddStage("server", Affinity::Worker, {}, Record("server"));
+        scheduler.AddStage("updates", Affinity::Worker, { "server", "webview" }, Record("updates"));
+        EXPECT_TRUE(scheduler.Run());
+    }
+    EXPECT_EQ(Order().size(), 4u);
+    EXPECT_LT(IndexOf("commands"), IndexOf("webview"));
+    EXPECT_LT(IndexOf("server"), IndexOf("updates"));
+    EXPECT_LT(IndexOf("webview"), IndexOf("updates"));
+}
+
+TEST_F(StartupSchedulerTest, ReadyUiStagesRunInTheOrderAdded)
+{
+    StartupScheduler scheduler;
+    scheduler.AddStage("commands", Affinity::UIThread, {}, Record("commands"));
+    scheduler.AddStage("webview", Affinity::UIThread, { "commands" }, Record("webview"));
+    scheduler.AddStage("mpv", Affinity::UIThread, {}, Record("mpv"));
+    EXPECT_TRUE(scheduler.Run());
+    // webview became ready after commands, but was added before mpv.
+    EXPECT_EQ(Order(), (std::vector<std::string>{ "commands", "webview", "mpv" }));
+}
+
+TEST_F(StartupSchedulerTest, UiStagesRunOnTheCallingThreadAndWorkersElsewhere)
+{
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> uiOnCaller{false};
+    std::atomic<bool> workerOnCaller{true};
+    {
+        StartupScheduler scheduler;
+        scheduler.AddStage("ui", Affinity::UIThread, {}, [&]() {
+            uiOnCaller = std::this_thread::get_id() == caller;
+            return true;
+        });
+        scheduler.AddStage("worker", Affinity::Worker, {}, [&]() {
+            workerOnCaller = std::this_thread::get_id() == caller;
+            return true;
+        });
+        EXPECT_TRUE(scheduler.Run());
+    }
+    EXPECT_TRUE(uiOnCaller);
+    EXPECT_FALSE(workerOnCaller);
+}
+
+TEST_F(StartupSchedulerTest, AFailedOptionalStageSkipsOnlyItsDependents)
+{
+    {
+        StartupScheduler scheduler;
+        scheduler.AddStage("commands", Affinity::UIThread, {}, Record("commands"));
+        scheduler.AddStage("server", Affinity::Worker, {}, Record("server", false), false);
+        scheduler.AddStage("updates", Affinity::Worker, { "server" }, Record("updates"), false);
+        scheduler.AddStage("whitelist", Affinity::Worker, {}, []() -> bool { throw std::runtime_error("offline"); }, false);
+        scheduler.AddStage("webview", Affinity::UIThread, { "commands" }, Record("webview"));
+        EXPECT_TRUE(scheduler.Run());
+    }
+    std::vector<std::string> order = Order();
+    EXPECT_EQ(std::count(order.begin(), order.end(), "updates"), 0);
+    EXPECT_EQ(std::count(order.begin(), order.end(), "webview"), 1);
+}
+
+TEST_F(StartupSchedulerTest, AFailedRequiredStageFailsTheRun)
+{
+    StartupScheduler scheduler;
+    scheduler.AddStage("commands", Affinity::UIThread, {}, []() -> bool { throw std::runtime_error("broken"); });
+    scheduler.AddStage("webview", Affinity::UIThread, { "commands" }, Record("webview"));
+    scheduler.AddStage("mpv", Affinity::UIThread, {}, Record("mpv"));
+    EXPECT_FALSE(scheduler.Run());
+    EXPECT_EQ(Order(), (std::vector<std::string>{ "mpv" }));
+}
+
+TEST_F(StartupSchedulerTest, UnknownDependenciesAndCyclesAreSkipped)
+{
+    StartupScheduler scheduler;
+    scheduler.AddStage("orphan", Affinity::Worker, { "missing" }, Record("orphan"), false);
+    scheduler.AddStage("a", Affinity::UIThread, { "b" }, Record("a"), false);
+    scheduler.AddStage("b", Affinity::UIThread, { "a" }, Record("b"), false);
+    EXPECT_TRUE(scheduler.Run());
+    EXPECT_TRUE(Order().empty());
+}
+
+TEST_F(StartupSchedulerTest, RunDoesNotWaitForOptionalWorkers)
+{
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> finished{false};
+    {
+        StartupScheduler scheduler;
+        scheduler.AddStage("commands", Affinity::UIThread, {}, Record("commands"));
+        scheduler.AddStage("discord", Affinity::Worker, {}, [&]() {
+            released.wait();
+            finished = true;
+            return true;
+        }, false);
+        EXPECT_TRUE(scheduler.Run());
+        EXPECT_FALSE(finished);
+        release.set_value();
+    }
+    // The destructor joined it.
+    EXPECT_TRUE(finished);
+}
+
+TEST_F(StartupSchedulerTest, RunWaitsForRequiredWorkers)
+{
+    std::atomic<bool> finished{false};
+    StartupScheduler scheduler;
+    scheduler.AddStage("settings", Affinity::Worker, {}, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+        return true;
+    });
+    EXPECT_TRUE(scheduler.Run());
+    EXPECT_TRUE(finished);
+}
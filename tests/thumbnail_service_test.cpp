@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include "mpv/thumbnail_service.h"
+
+using Cache = ThumbnailService::Cache;
+
+static std::shared_ptr<const ThumbnailService::Thumbnail> Image(int64_t bucket, size_t bytes)
+{
+    auto thumbnail = std::make_shared<ThumbnailService::Thumbnail>();
+    thumbnail->bucket = bucket;
+    thumbnail->time = bucket * ThumbnailService::BUCKET_SEC;
+    thumbnail->jpeg.assign(bytes, 'x');
+    return thumbnail;
+}
+
+TEST(ThumbnailService, BucketsTimesByBucketLength)
+{
+    EXPECT_EQ(ThumbnailService::BucketOf(0.0), 0);
+    EXPECT_EQ(ThumbnailService::BucketOf(4.999), 0);
+    EXPECT_EQ(ThumbnailService::BucketOf(5.0), 1);
+    EXPECT_EQ(ThumbnailService::BucketOf(62.5), 12);
+    EXPECT_EQ(ThumbnailService::BucketOf(7200.0), 1440);
+    // Scrubbing past the start clamps to the first bucket.
+    EXPECT_EQ(ThumbnailService::BucketOf(-3.0), 0);
+}
+
+TEST(ThumbnailCache, EvictsTheLeastRecentlyUsedOnceOverTheLimit)
+{
+    Cache cache(300);
+    EXPECT_EQ(cache.Put("a.mkv", Image(0, 100)), 0u);
+    EXPECT_EQ(cache.Put("a.mkv", Image(1, 100)), 0u);
+    EXPECT_EQ(cache.Put("a.mkv", Image(2, 100)), 0u);
+    EXPECT_EQ(cache.GetBytes(), 300u);
+
+    // Touching bucket 0 makes bucket 1 the oldest.
+    ASSERT_NE(cache.Get("a.mkv", 0), nullptr);
+    EXPECT_EQ(cache.Put("a.mkv", Image(3, 100)), 1u);
+    EXPECT_FALSE(cache.Contains("a.mkv", 1));
+    EXPECT_TRUE(cache.Contains("a.mkv", 0));
+    EXPECT_TRUE(cache.Contains("a.mkv", 2));
+    EXPECT_TRUE(cache.Contains("a.mkv", 3));
+    EXPECT_EQ(cache.GetBytes(), 300u);
+
+    // One large image can push out several.
+    EXPECT_EQ(cache.Put("a.mkv", Image(4, 250)), 3u);
+    EXPECT_EQ(cache.GetCount(), 1u);
+    EXPECT_EQ(cache.GetBytes(), 250u);
+}
+
+TEST(ThumbnailCache, KeepsTheNewestImageEvenWhenItAloneIsTooLarge)
+{
+    Cache cache(100);
+    cache.Put("a.mkv", Image(0, 50));
+    EXPECT_EQ(cache.Put("a.mkv", Image(1, 500)), 1u);
+    EXPECT_TRUE(cache.Contains("a.mkv", 1));
+    EXPECT_EQ(cache.GetBytes(), 500u);
+}
+
+TEST(ThumbnailCache, KeysByFileAndBucket)
+{
+    Cache cache(1000);
+    cache.Put("a.mkv", Image(7, 10));
+    EXPECT_EQ(cache.Get("b.mkv", 7), nullptr);
+    EXPECT_EQ(cache.Get("a.mkv", 8), nullptr);
+
+    // A second image for a cached bucket is ignored.
+    auto first = cache.Get("a.mkv", 7);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(cache.Put("a.mkv", Image(7, 20)), 0u);
+    EXPECT_EQ(cache.Get("a.mkv", 7), first);
+    EXPECT_EQ(cache.GetBytes(), 10u);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include "tracer/tracer.h"
+#include "nlohmann/json.hpp"
+
+namespace fs = std::filesystem;
+
+// The trace buffer is process-wide and never cleared. CTest runs every test in
+// a process of its own; when they share one, tests that need free slots skip
+// once an earlier test filled the buffer.
+class TracerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_path = fs::temp_directory_path() / ("stremato-trace-" + std::to_string(std::random_device()()) + ".json");
+    }
+    void TearDown() override { fs::remove(m_path); }
+
+    nlohmann::json Dump()
+    {
+        EXPECT_TRUE(Tracer::DumpChromeTrace(m_path));
+        std::ifstream in(m_path);
+        return nlohmann::json::parse(in);
+    }
+
+    // Events recorded under names starting with prefix, in buffer order.
+    static std::vector<nlohmann::json> EventsNamed(const nlohmann::json& trace, const std::string& prefix)
+    {
+        std::vector<nlohmann::json> events;
+        for (const auto& event : trace.at("traceEvents")) {
+            if (event.at("name").get<std::string>().rfind(prefix, 0) == 0) events.push_back(event);
+        }
+        return events;
+    }
+
+    fs::path m_path;
+};
+
+TEST_F(TracerTest, WritesSpansAndInstantsAsTraceEvents)
+{
+    if (Tracer::GetDroppedCount() > 0) GTEST_SKIP() << "the trace buffer is already full";
+    {
+        TraceScope outer("json.outer");
+        Tracer::Instant("json.mark");
+        std::thread([]() { TraceScope inner("json.worker"); }).join();
+    }
+
+    const nlohmann::json trace = Dump();
+    EXPECT_EQ(trace.at("displayTimeUnit"), "ms");
+    EXPECT_EQ(trace.at("otherData").at("droppedEvents"), 0);
+
+    const std::vector<nlohmann::json> events = EventsNamed(trace, "json.");
+    ASSERT_EQ(events.size(), 5u);
+    const char* expected[][2] = { {"json.outer", "B"}, {"json.mark", "i"}, {"json.worker", "B"}, {"json.worker", "E"}, {"json.outer", "E"} };
+    for (size_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ(events[i].at("name"), expected[i][0]) << i;
+        EXPECT_EQ(events[i].at("ph"), expected[i][1]) << i;
+        EXPECT_EQ(events[i].at("cat"), "startup");
+        if (i > 0) {
+            EXPECT_GE(events[i].at("ts").get<long long>(), events[i - 1].at("ts").get<long long>()) << i;
+        }
+    }
+    EXPECT_EQ(events[1].at("s"), "t");
+    EXPECT_FALSE(events[0].contains("s"));
+    EXPECT_EQ(events[0].at("tid"), events[4].at("tid"));
+    EXPECT_NE(events[0].at("tid"), events[2].at("tid"));
+}
+
+TEST_F(TracerTest, EscapesAndTruncatesNames)
+{
+    if (Tracer::GetDroppedCount() > 0) GTEST_SKIP() << "the trace buffer is already full";
+    Tracer::Instant("escape.\"quoted\"\\back\nline");
+    const std::string longName = "long." + std::string(100, 'x');
+    Tracer::Instant(longName.c_str());
+
+    const nlohmann::json trace = Dump();
+    const std::vector<nlohmann::json> escaped = EventsNamed(trace, "escape.");
+    ASSERT_EQ(escaped.size(), 1u);
+    EXPECT_EQ(escaped[0].at("name"), "escape.\"quoted\"\\back line");
+
+    const std::vector<nlohmann::json> truncated = EventsNamed(trace, "long.");
+    ASSERT_EQ(truncated.size(), 1u);
+    EXPECT_EQ(truncated[0].at("name"), longName.substr(0, 47));
+}
+
+TEST_F(TracerTest, DropsEventsOnceEverySlotIsTaken)
+{
+    // Far more than the buffer holds, from several threads at once.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 2000; i++) Tracer::Instant("overflow");
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const size_t dropped = Tracer::GetDroppedCount();
+    EXPECT_GT(dropped, 0u);
+
+    Tracer::Instant("overflow.after");
+    EXPECT_EQ(Tracer::GetDroppedCount(), dropped + 1);
+
+    const nlohmann::json trace = Dump();
+    EXPECT_EQ(trace.at("otherData").at("droppedEvents"), dropped + 1);
+    // Every slot (TRACE_CAPACITY in tracer.cpp) is written out, and nothing after them.
+    EXPECT_EQ(trace.at("traceEvents").size(), 4096u);
+    EXPECT_TRUE(EventsNamed(trace, "overflow.after").empty());
+}